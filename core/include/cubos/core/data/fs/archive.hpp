@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <cubos/core/data/fs/file.hpp>
 
 namespace cubos::core::data
@@ -100,5 +103,29 @@ namespace cubos::core::data
         /// @param mode Mode to open the file in.
         /// @return File stream, or nullptr if the file could not be opened.
         virtual std::unique_ptr<memory::Stream> open(std::size_t id, File::Handle handle, File::OpenMode mode) = 0;
+
+        /// @brief Gets the time the file with the given identifier was last modified.
+        ///
+        /// Archives which don't know when their files were modified always return 0.
+        ///
+        /// @param id Identifier of the file.
+        /// @return Implementation-defined time, which changes when the file is modified, or 0 if
+        /// unknown.
+        virtual uint64_t modificationTime(std::size_t id) const
+        {
+            (void)id;
+            return 0;
+        }
+
+        /// @brief Gets the regular files which were modified outside of the virtual file system
+        /// since the last call.
+        ///
+        /// Archives which can't detect such changes don't report any.
+        ///
+        /// @param ids Vector to append the identifiers of the modified files to.
+        virtual void modified(std::vector<std::size_t>& ids)
+        {
+            (void)ids;
+        }
     };
 } // namespace cubos::core::data
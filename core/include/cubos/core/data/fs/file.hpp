@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <future>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string_view>
@@ -122,14 +125,32 @@ namespace cubos::core::data
         ///
         /// If the file is being written to, blocks until the other threads are done with the file.
         ///
+        /// Files written by @ref memory::CompressedStream::compress() are decompressed
+        /// transparently when opened with @ref OpenMode::Read.
+        ///
         /// This method fails on the following conditions:
         /// - this file is a directory.
         /// - this file belongs to a read-only archive and the mode is not @ref OpenMode::Read.
+        /// - this file is compressed, opened for reading, and its compressed data is invalid.
         ///
         /// @param mode Mode to open the file in.
         /// @return Handle to a file stream, or nullptr on failure.
         std::unique_ptr<memory::Stream> open(OpenMode mode);
 
+        /// @brief Asynchronously reads a range of this file into memory.
+        ///
+        /// The read is performed by a bounded pool of I/O threads shared by all files, which allows
+        /// reads of multiple files to overlap with each other and with the caller's work. If the
+        /// range goes past the end of the file, only the bytes up to the end are read.
+        ///
+        /// The future is set to nullptr if the file could not be opened for reading.
+        ///
+        /// @param offset Offset in bytes of the first byte to read.
+        /// @param size Maximum number of bytes to read.
+        /// @return Future for a read-only stream over the read bytes.
+        std::future<std::unique_ptr<memory::Stream>> readAsync(
+            std::size_t offset = 0, std::size_t size = std::numeric_limits<std::size_t>::max());
+
         /// @brief Gets the name of this file.
         /// @return Name of this file.
         std::string_view name() const;
@@ -142,6 +163,10 @@ namespace cubos::core::data
         /// @return Whether this file is a directory.
         bool directory() const;
 
+        /// @brief Gets the time this file was last modified, as reported by its archive.
+        /// @return Modification time, or 0 if unknown.
+        uint64_t modificationTime() const;
+
         /// @brief Gets the archive this file is in.
         /// @return Archive this file is in, or nullptr if the file is not in an archive.
         const std::shared_ptr<Archive>& archive() const;
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <cubos/core/data/fs/file.hpp>
 
 namespace cubos::core::data
@@ -119,5 +122,37 @@ namespace cubos::core::data
         /// @param mode Mode to open the file in.
         /// @return File stream, or nullptr if an error occurred.
         static std::unique_ptr<memory::Stream> open(std::string_view path, File::OpenMode mode);
+
+        /// @brief Asynchronously reads a range of a file into memory.
+        ///
+        /// The future is set to nullptr if the file does not exist or could not be read.
+        ///
+        /// @see File::readAsync()
+        /// @param path Absolute path of the file.
+        /// @param offset Offset in bytes of the first byte to read.
+        /// @param size Maximum number of bytes to read.
+        /// @return Future for a read-only stream over the read bytes.
+        static std::future<std::unique_ptr<memory::Stream>> readAsync(
+            std::string_view path, std::size_t offset = 0, std::size_t size = std::numeric_limits<std::size_t>::max());
+
+        /// @brief Asynchronously reads multiple files into memory.
+        ///
+        /// All reads are submitted at once, and may thus complete in any order.
+        ///
+        /// @param paths Absolute paths of the files.
+        /// @return Futures for read-only streams over the contents of each file, in the same order
+        /// as the paths.
+        static std::vector<std::future<std::unique_ptr<memory::Stream>>> readAsync(
+            const std::vector<std::string>& paths);
+
+        /// @brief Gets the files which were modified outside of the virtual file system since the
+        /// last call.
+        ///
+        /// Only archives which detect such modifications, such as a @ref StandardArchive which is
+        /// being watched, report them.
+        ///
+        /// @see Archive::modified()
+        /// @return Absolute paths of the modified files.
+        static std::vector<std::string> modified();
     };
 } // namespace cubos::core::data
@@ -16,14 +16,17 @@ namespace cubos::core::data
     ///
     /// Can represent both regular files and directories.
     ///
-    /// @todo This implementation does not detect changes in the file system made outside the File
-    /// and FileSystem classes (#263).
+    /// Modifications to existing files made outside the File and FileSystem classes can be
+    /// detected by calling @ref watch(), which is only supported on Linux.
+    ///
+    /// @todo This implementation does not detect files created or removed outside the File and
+    /// FileSystem classes (#263).
     ///
     /// @ingroup core-data-fs
     class StandardArchive : public Archive
     {
     public:
-        ~StandardArchive() override = default;
+        ~StandardArchive() override;
 
         /// @brief Constructs pointing to the regular file or directory with the given @p osPath.
         ///
@@ -35,6 +38,14 @@ namespace cubos::core::data
         /// @param readOnly True if the archive is read-only, false otherwise.
         StandardArchive(const std::filesystem::path& osPath, bool isDirectory, bool readOnly);
 
+        /// @brief Starts watching the files of the archive for modifications made outside of the
+        /// virtual file system, which are then reported by @ref modified().
+        ///
+        /// Uses inotify, and thus fails on platforms other than Linux.
+        ///
+        /// @return Whether the files are being watched.
+        bool watch();
+
         std::size_t create(std::size_t parent, std::string_view name, bool directory = false) override;
         bool destroy(std::size_t id) override;
         std::string name(std::size_t id) const override;
@@ -44,6 +55,8 @@ namespace cubos::core::data
         std::size_t sibling(std::size_t id) const override;
         std::size_t child(std::size_t id) const override;
         std::unique_ptr<memory::Stream> open(std::size_t id, File::Handle file, File::OpenMode mode) override;
+        uint64_t modificationTime(std::size_t id) const override;
+        void modified(std::vector<std::size_t>& ids) override;
 
     private:
         /// @brief Information about a file in the directory.
@@ -60,9 +73,22 @@ namespace cubos::core::data
         /// @param parent Id of the directory.
         void generate(std::size_t parent);
 
+        /// @brief Starts watching the given directory, or the directory containing the root file if
+        /// the root file is a regular file.
+        /// @param id Id of the directory.
+        void addWatch(std::size_t id);
+
+        /// @brief Finds the child of a directory with the given name.
+        /// @param parent Id of the directory, or 0 to look for the root file.
+        /// @param name Name of the file on the host file system.
+        /// @return Id of the child, or 0 if there's none.
+        std::size_t findChild(std::size_t parent, std::string_view name) const;
+
         std::filesystem::path mOsPath;                    ///< Path to the directory in the real file system.
         bool mReadOnly;                                   ///< True if the archive is read-only, false otherwise.
         std::unordered_map<std::size_t, FileInfo> mFiles; ///< Maps file identifiers to file info.
         std::size_t mNextId;                              ///< Next identifier to assign to a file.
+        int mWatchFd{-1};                                 ///< inotify instance, or -1 if not watching.
+        std::unordered_map<int, std::size_t> mWatches;    ///< Maps watch descriptors to watched directories.
     };
 } // namespace cubos::core::data
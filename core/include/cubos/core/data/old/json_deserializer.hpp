@@ -1,17 +1,33 @@
 #pragma once
 
 #include <stack>
-
-#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
 
 #include <cubos/core/data/old/deserializer.hpp>
+#include <cubos/core/memory/stream.hpp>
 
 namespace cubos::core::data::old
 {
     /// Implementation of the abstract Deserializer class for deserializing from JSON.
+    ///
+    /// The input is parsed incrementally, as values are read, without ever building a JSON DOM in
+    /// memory. Object fields are read in the order they appear, and their keys are ignored.
+    ///
+    /// Since arrays and dictionaries must report their length when they're begun, the first time
+    /// one is found its contents are skimmed ahead to count its elements. The lengths of any nested
+    /// arrays and dictionaries found during the skim are remembered, so that each byte is skimmed
+    /// at most once. For this, the stream must support seeking - if it doesn't, its remaining
+    /// contents are read into memory on construction.
+    ///
+    /// Syntax errors are only detected when the invalid part of the input is reached, in which case
+    /// the fail bit is set.
     class JSONDeserializer : public Deserializer
     {
     public:
+        /// @param stream The stream to deserialize from. Must contain a JSON literal/object/array.
+        JSONDeserializer(memory::Stream& stream);
+
         /// @param src The string to deserialize from. Must correspond to a JSON literal/object/array.
         JSONDeserializer(const std::string& src);
 
@@ -45,15 +61,81 @@ namespace cubos::core::data::old
             Dictionary
         };
 
+        /// The possible kinds of scalar tokens.
+        enum class Token
+        {
+            Key,    ///< A dictionary key, which is always a string.
+            String, ///< A string value.
+            Literal ///< A number, boolean or null value.
+        };
+
         /// The current frame of deserialization.
         struct Frame
         {
-            Mode mode;                             ///< The current mode of deserialization.
-            nlohmann::ordered_json::iterator iter; ///< The current node.
-            bool key;                              ///< Whether the current node is a key.
+            Mode mode;         ///< The current mode of deserialization.
+            std::size_t count; ///< Number of elements already read.
+            bool key;          ///< Whether the next node is a key.
         };
 
-        std::stack<Frame> mFrame;     ///< The current frame of the deserializer.
-        nlohmann::ordered_json mJson; ///< The current JSON value being read.
+        /// Reads the next scalar token, handling separators and dictionary keys.
+        /// @param token The token text. Strings are unescaped.
+        /// @param kind The kind of token read.
+        /// @return Whether the token was read successfully.
+        bool readScalar(std::string& token, Token& kind);
+
+        /// Begins a new container with the given opening character.
+        /// @param open The opening character.
+        /// @param mode The mode of the new frame.
+        /// @return The number of elements in the container.
+        std::size_t beginContainer(char open, Mode mode);
+
+        /// Skips any elements left in the current container and pops its frame.
+        void endContainer();
+
+        /// Consumes the separator and, in objects, the key which precede the next value.
+        /// @return Whether the value can be read.
+        bool beginValue();
+
+        /// Updates the current frame after a value has been read.
+        void endValue();
+
+        /// Counts the elements of the container which starts at the current position, without
+        /// consuming any input. The lengths of nested containers are stored in @ref mLengths.
+        /// @return The number of elements in the container.
+        std::size_t skim();
+
+        /// Reads a string token, assuming the opening quote has already been consumed.
+        /// @param out The unescaped string, or nullptr to discard it.
+        /// @return Whether the string was read successfully.
+        bool parseString(std::string* out);
+
+        /// Consumes the given character, after skipping whitespace.
+        /// @param c The expected character.
+        /// @return Whether the character was found.
+        bool expect(char c);
+
+        /// Skips whitespace characters.
+        void skipWhitespace();
+
+        /// @return The current character, or '\0' if the input ended.
+        char peek();
+
+        /// @return The absolute offset of the current character in the input.
+        std::size_t offset() const;
+
+        /// Moves back to a previously read position of the input.
+        /// @param offset Absolute offset to move to.
+        void rewind(std::size_t offset);
+
+        /// Logs a parse error at the current position and sets the fail bit.
+        /// @param what Description of the error.
+        void error(const char* what);
+
+        memory::Stream* mStream;   ///< The stream being read, or nullptr if the whole input is buffered.
+        std::string mBuffer;       ///< Chunk of the input currently loaded.
+        std::size_t mBufferStart;  ///< Absolute offset of the first character of the buffer.
+        std::size_t mCursor;       ///< Position of the current character in the buffer.
+        std::stack<Frame> mFrame;  ///< The current frame of the deserializer.
+        std::unordered_map<std::size_t, std::size_t> mLengths; ///< Skimmed container lengths, by offset.
     };
 } // namespace cubos::core::data::old
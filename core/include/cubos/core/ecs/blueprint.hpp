@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <cubos/core/data/old/binary_deserializer.hpp>
 #include <cubos/core/data/old/binary_serializer.hpp>
 #include <cubos/core/data/old/serialization_map.hpp>
@@ -14,6 +16,8 @@
 
 namespace cubos::core::ecs
 {
+    class Registry;
+
     /// @brief Stores a bundle of entities and their respective components, which can be easily
     /// spawned into a world. This is in a way the 'Prefab' of @b CUBOS., but lower level.
     class Blueprint final
@@ -58,11 +62,33 @@ namespace cubos::core::ecs
         /// specified string.
         /// @param prefix Name to prefix with the merged blueprint.
         /// @param other Other blueprint to merge.
-        void merge(const std::string& prefix, const Blueprint& other);
+        /// @return Whether every component could be merged. Components whose entity references
+        /// couldn't be remapped are skipped.
+        bool merge(const std::string& prefix, const Blueprint& other);
 
         /// @brief Clears the blueprint, removing any added entities and components.
         void clear();
 
+        /// @brief Writes the blueprint to a stream in its compiled binary format.
+        ///
+        /// The format is made of an entity name table, a component type table and, for each
+        /// component type, a block with the indices of the entities which have it, followed by
+        /// their components, serialized in the binary format. Entity references inside the
+        /// components are written as entity indices instead of names.
+        ///
+        /// All component types must be registered in the @ref Registry.
+        ///
+        /// @param stream Stream to write to.
+        /// @return Whether the blueprint was written successfully.
+        bool writeCompiled(memory::Stream& stream) const;
+
+        /// @brief Replaces the contents of the blueprint with a blueprint read from a stream in the
+        /// format written by @ref writeCompiled().
+        /// @param stream Stream to read from.
+        /// @return Whether the blueprint was read successfully. On failure, the blueprint is left
+        /// empty.
+        bool readCompiled(memory::Stream& stream);
+
         /// @brief Returns the internal map that maps entities to their names
         /// @return Map of entities and names.
         inline std::unordered_map<Entity, std::string, EntityHash> getMap() const
@@ -72,33 +98,110 @@ namespace cubos::core::ecs
 
     private:
         friend class CommandBuffer;
+        friend class Registry;
 
-        /// @brief Stores all component data of a certain type.
+        /// @brief Indices of the entities of a blueprint, by name.
+        using NameTable = std::unordered_map<std::string, uint32_t>;
+
+        /// @brief Stores all components of a certain type.
+        ///
+        /// Components are stored already constructed, and are copy constructed into the world
+        /// when the blueprint is spawned. Entity references inside them point to entities of the
+        /// blueprint, and are remapped to the spawned entities through an index table.
         struct IBuffer
         {
-            /// @brief Names of the entities of the components present in the stream, in the same order.
-            std::vector<std::string> names;
-            memory::BufferStream stream; ///< Self growing buffer stream where the component data is stored.
-            std::mutex mutex;            ///< Protect the stream.
+            /// @brief Describes where the entity references of a stored component are.
+            struct References
+            {
+                uint32_t first; ///< Index of the first offset of the component in @ref offsets.
+                uint32_t count; ///< Number of offsets of the component in @ref offsets.
+                bool inPlace;   ///< Whether all references can be patched through @ref offsets.
+            };
+
+            /// @brief Indices of the entities which own each component, in the same order.
+            std::vector<uint32_t> owners;
+
+            /// @brief Where the entity references of each component are, in the same order.
+            std::vector<References> references;
+
+            /// @brief Byte offsets of entity references stored directly inside components.
+            std::vector<uint32_t> offsets;
 
             virtual ~IBuffer() = default;
 
-            /// @brief Adds all of the components stored in the buffer to the specified commands object.
+            /// @brief Adds copies of all of the components stored in the buffer to the spawned
+            /// entities, @p count times.
             /// @param commands Commands object to add the components to.
-            /// @param context Context to use when deserializing the components.
-            virtual void addAll(CommandBuffer& commands, data::old::Context& context) = 0;
-
-            /// @brief Merges the data of another buffer of the same type into this one.
+            /// @param entities Spawned entities, indexed by instance and then by blueprint entity.
+            /// @param count Number of spawned instances.
+            /// @note Components whose entity references couldn't be remapped are skipped, and an
+            /// error is logged.
+            virtual void addAll(CommandBuffer& commands, const std::vector<Entity>& entities,
+                                std::size_t count) const = 0;
+
+            /// @brief Merges copies of the components of another buffer of the same type into
+            /// this one.
             /// @param other Buffer to merge from.
-            /// @param prefix Prefix to add to the names of the components of the other buffer.
-            /// @param src Context to use when serializing the components from the other buffer.
-            /// @param dst Context to use when deserializing the components to this buffer.
-            virtual void merge(IBuffer* other, const std::string& prefix, data::old::Context& src,
-                               data::old::Context& dst) = 0;
+            /// @param entities Entities of this blueprint, indexed by entity of the other blueprint.
+            /// @return Whether every component was merged. Components whose entity references
+            /// couldn't be remapped are skipped.
+            virtual bool merge(const IBuffer& other, const std::vector<Entity>& entities) = 0;
+
+            /// @brief Writes all components stored in the buffer, in order, in the compiled format.
+            /// @param stream Stream to write to.
+            /// @param entityCount Number of entities in the blueprint.
+            /// @return Whether the components were written successfully.
+            virtual bool write(memory::Stream& stream, std::size_t entityCount) const = 0;
+
+            /// @brief Reads components written by @ref write() and adds them to the buffer.
+            /// @param stream Stream to read from.
+            /// @param owners Indices of the entities which own each component to read.
+            /// @param entityCount Number of entities in the blueprint.
+            /// @return Whether the components were read successfully.
+            virtual bool read(memory::Stream& stream, const std::vector<uint32_t>& owners,
+                              std::size_t entityCount) = 0;
 
             /// @brief Creates a new buffer of the same type as this one.
             /// @return New buffer.
-            virtual IBuffer* create() = 0;
+            virtual IBuffer* create() const = 0;
+
+        protected:
+            /// @brief Finds the entity references of a component which was just added to the
+            /// buffer and pushes their description to @ref references.
+            /// @param component Component to search.
+            /// @param size Size of the component type.
+            /// @param write Function which serializes the component.
+            void findReferences(const void* component, std::size_t size,
+                                void (*write)(data::old::Serializer&, const void*));
+
+            /// @brief Pushes a copy of the description of the entity references of a component of
+            /// another buffer, which has the same layout, to @ref references.
+            /// @param other Buffer which holds the component.
+            /// @param index Index of the component in @p other.
+            void copyReferences(const IBuffer& other, std::size_t index);
+
+            /// @brief Patches the entity references found inside a component in place.
+            /// @param component Copy of the component with index @p index.
+            /// @param index Index of the component in the buffer.
+            /// @param entities Entities to map the references to, indexed by blueprint entity.
+            /// @param entityCount Number of entities in @p entities.
+            /// @return Whether all references were patched, which fails if one of them doesn't
+            /// point to an entity of the blueprint.
+            bool patch(void* component, std::size_t index, const Entity* entities, std::size_t entityCount) const;
+
+            /// @brief Creates a map which serializes entity references to blueprint entities as their
+            /// index, and deserializes indices into the entities of a table.
+            ///
+            /// References which don't point to a blueprint entity are serialized as null and raise
+            /// @p failed, instead of aborting.
+            ///
+            /// @param entities Entities to deserialize indices into, indexed by blueprint entity.
+            /// @param entityCount Number of entities in the blueprint.
+            /// @param failed Flag raised when a reference can't be mapped.
+            /// @return Serialization map.
+            static data::old::SerializationMap<Entity, std::string, EntityHash> indexMap(const Entity* entities,
+                                                                                        std::size_t entityCount,
+                                                                                        bool& failed);
         };
 
         /// @brief Implementation of the IBuffer interface for the component type @p ComponentType.
@@ -106,69 +209,165 @@ namespace cubos::core::ecs
         template <typename ComponentType>
         struct Buffer : IBuffer
         {
+            std::vector<ComponentType> components; ///< Stored components.
+
+            /// @brief Adds a component to the buffer.
+            /// @param owner Index of the entity which owns the component.
+            /// @param component Component, with entity references to the blueprint's entities.
+            inline void insert(uint32_t owner, ComponentType component)
+            {
+                this->owners.push_back(owner);
+                this->components.push_back(std::move(component));
+                this->findReferences(&this->components.back(), sizeof(ComponentType),
+                                     [](data::old::Serializer& ser, const void* component) {
+                                         ser.write(*static_cast<const ComponentType*>(component), "data");
+                                     });
+            }
+
+            /// @brief Remaps the entity references of a copy of a stored component.
+            /// @param index Index of the component.
+            /// @param entities Entities to map the references to, indexed by blueprint entity.
+            /// @param entityCount Number of entities in @p entities.
+            /// @param component Copy of the component with index @p index, to remap.
+            /// @return Whether the references could be remapped.
+            inline bool remap(std::size_t index, const Entity* entities, std::size_t entityCount,
+                              ComponentType& component) const
+            {
+                if (this->references[index].inPlace)
+                {
+                    return this->patch(&component, index, entities, entityCount);
+                }
+
+                // The component has references which we couldn't locate, such as ones stored in
+                // containers, and thus we remap them through a serialization round trip.
+                bool failed = false;
+                auto map = IBuffer::indexMap(entities, entityCount, failed);
+                memory::BufferStream stream{};
+                auto ser = data::old::BinarySerializer(stream);
+                ser.context().push(map);
+                ser.write(this->components[index], "data");
+                stream.seek(0, memory::SeekOrigin::Begin);
+                auto des = data::old::BinaryDeserializer(stream);
+                des.context().push(map);
+                des.read(component);
+                return !failed && !ser.failed() && !des.failed();
+            }
+
             // Interface methods implementation.
 
-            inline void addAll(CommandBuffer& commands, data::old::Context& context) override
+            inline void addAll(CommandBuffer& commands, const std::vector<Entity>& entities,
+                               std::size_t count) const override
             {
-                this->mutex.lock();
-                auto pos = this->stream.tell();
-                this->stream.seek(0, memory::SeekOrigin::Begin);
-                auto des = data::old::BinaryDeserializer(this->stream);
-                des.context().pushSubContext(context);
-
-                auto& map = des.context().get<data::old::SerializationMap<Entity, std::string, EntityHash>>();
-                for (const auto& name : this->names)
+                std::size_t size = entities.size() / count;
+                for (std::size_t i = 0; i < count; ++i)
                 {
-                    ComponentType type;
-                    des.read(type);
-                    commands.add(map.getRef(name), std::move(type));
+                    const Entity* instance = entities.data() + i * size;
+                    for (std::size_t j = 0; j < this->components.size(); ++j)
+                    {
+                        ComponentType component = this->components[j];
+                        if (!this->remap(j, instance, size, component))
+                        {
+                            CUBOS_ERROR("Could not remap entities of component of type '{}'",
+                                        typeid(ComponentType).name());
+                            continue;
+                        }
+
+                        commands.add(instance[this->owners[j]], std::move(component));
+                    }
                 }
-                this->stream.seek(static_cast<ptrdiff_t>(pos), memory::SeekOrigin::Begin);
-                this->mutex.unlock();
+            }
 
-                if (des.failed())
+            inline bool merge(const IBuffer& other, const std::vector<Entity>& entities) override
+            {
+                bool success = true;
+                const auto& buffer = static_cast<const Buffer<ComponentType>&>(other);
+                for (std::size_t i = 0; i < buffer.components.size(); ++i)
                 {
-                    CUBOS_CRITICAL("Could not deserialize component of type '{}'", typeid(ComponentType).name());
-                    abort();
+                    ComponentType component = buffer.components[i];
+                    if (!buffer.remap(i, entities.data(), entities.size(), component))
+                    {
+                        CUBOS_ERROR("Could not remap entities of component of type '{}'",
+                                    typeid(ComponentType).name());
+                        success = false;
+                        continue;
+                    }
+
+                    // Remapping doesn't move the references, so they don't have to be found again.
+                    this->owners.push_back(entities[buffer.owners[i]].index);
+                    this->components.push_back(std::move(component));
+                    this->copyReferences(buffer, i);
                 }
+
+                return success;
             }
 
-            inline void merge(IBuffer* other, const std::string& prefix, data::old::Context& src,
-                              data::old::Context& dst) override
+            inline bool write(memory::Stream& stream, std::size_t entityCount) const override
             {
-                auto buffer = static_cast<Buffer<ComponentType>*>(other);
-
-                buffer->mutex.lock();
-                auto pos = buffer->stream.tell();
-                buffer->stream.seek(0, memory::SeekOrigin::Begin);
-                auto ser = data::old::BinarySerializer(this->stream);
-                auto des = data::old::BinaryDeserializer(buffer->stream);
-                ser.context().pushSubContext(dst);
-                des.context().pushSubContext(src);
-                for (const auto& name : buffer->names)
+                // The references of the stored components already hold entity indices.
+                std::vector<Entity> entities;
+                entities.reserve(entityCount);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(entityCount); ++i)
+                {
+                    entities.emplace_back(i, 0);
+                }
+
+                bool failed = false;
+                auto ser = data::old::BinarySerializer(stream);
+                ser.context().push(IBuffer::indexMap(entities.data(), entities.size(), failed));
+                for (const auto& component : this->components)
                 {
-                    std::string path = prefix;
-                    path += '.';
-                    path += name;
-                    this->names.push_back(path);
-                    ComponentType type;
-                    des.read(type);
-                    ser.write(type, "data");
+                    ser.write(component, "data");
                 }
-                buffer->stream.seek(static_cast<ptrdiff_t>(pos), memory::SeekOrigin::Begin);
-                buffer->mutex.unlock();
+                return !failed && !ser.failed();
             }
 
-            inline IBuffer* create() override
+            inline bool read(memory::Stream& stream, const std::vector<uint32_t>& owners,
+                             std::size_t entityCount) override
+            {
+                std::vector<Entity> entities;
+                entities.reserve(entityCount);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(entityCount); ++i)
+                {
+                    entities.emplace_back(i, 0);
+                }
+
+                bool failed = false;
+                auto des = data::old::BinaryDeserializer(stream);
+                des.context().push(IBuffer::indexMap(entities.data(), entities.size(), failed));
+                for (auto owner : owners)
+                {
+                    ComponentType component;
+                    des.read(component);
+                    if (des.failed() || failed)
+                    {
+                        return false;
+                    }
+                    this->insert(owner, std::move(component));
+                }
+
+                return true;
+            }
+
+            inline IBuffer* create() const override
             {
                 return new Buffer<ComponentType>();
             }
         };
 
+        /// @brief Adds a new entity to the blueprint.
+        /// @param name Entity name.
+        /// @return Entity identifier.
+        Entity addEntity(const std::string& name);
+
         /// @brief Stores the entity handles and the associated names.
         data::old::SerializationMap<Entity, std::string, EntityHash> mMap;
 
-        /// @brief Buffers which store the serialized components of each type in this blueprint.
+        /// @brief Indices of the entities by name, shared with the builders of spawned instances,
+        /// so that they don't depend on the blueprint outliving them. Copied before being changed
+        /// if any builder still holds it.
+        std::shared_ptr<NameTable> mNames;
+
+        /// @brief Buffers which store the components of each type in this blueprint.
         memory::TypeMap<IBuffer*> mBuffers;
     };
 
@@ -177,8 +376,7 @@ namespace cubos::core::ecs
     template <typename... ComponentTypes>
     Entity Blueprint::create(const std::string& name, const ComponentTypes&... components)
     {
-        auto entity = Entity(static_cast<uint32_t>(mMap.size()), 0);
-        mMap.add(entity, name);
+        auto entity = this->addEntity(name);
         this->add(entity, components...);
         return entity;
     }
@@ -191,10 +389,10 @@ namespace cubos::core::ecs
 
         (
             [&]() {
-                IBuffer* buf;
+                Buffer<ComponentTypes>* buf;
                 if (mBuffers.contains<ComponentTypes>())
                 {
-                    buf = mBuffers.at<ComponentTypes>();
+                    buf = static_cast<Buffer<ComponentTypes>*>(mBuffers.at<ComponentTypes>());
                 }
                 else
                 {
@@ -202,10 +400,7 @@ namespace cubos::core::ecs
                     mBuffers.insert<ComponentTypes>(buf);
                 }
 
-                auto ser = data::old::BinarySerializer(buf->stream);
-                ser.context().push(mMap);
-                ser.write(components, "data");
-                buf->names.push_back(mMap.getId(entity));
+                buf->insert(entity.index, components);
             }(),
 
             ...);
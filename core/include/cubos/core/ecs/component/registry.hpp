@@ -55,6 +55,13 @@ namespace cubos::core::ecs
         static const reflection::Type* type(std::string_view name);
 
     private:
+        friend class Blueprint;
+
+        /// @brief Instantiates an empty blueprint buffer for the given component type.
+        /// @param type Type of the component.
+        /// @return Buffer, or nullptr if the component type was not found.
+        static Blueprint::IBuffer* createBuffer(const reflection::Type& type);
+
         /// @brief Entry in the component registry.
         struct Entry
         {
@@ -66,6 +73,9 @@ namespace cubos::core::ecs
 
             /// Function for creating the storage for the component.
             std::unique_ptr<IStorage> (*storageCreator)();
+
+            /// Function for creating a blueprint buffer for the component.
+            Blueprint::IBuffer* (*bufferCreator)();
         };
 
         /// @return Global entry registry, indexed by type.
@@ -106,6 +116,7 @@ namespace cubos::core::ecs
                     auto storage = std::make_unique<S>();
                     return std::unique_ptr<IStorage>(storage.release());
                 },
+            .bufferCreator = []() -> Blueprint::IBuffer* { return new Blueprint::Buffer<T>(); },
         });
 
         byType.insert<T>(entry);
@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <cubos/core/ecs/entity/hash.hpp>
 #include <cubos/core/ecs/world.hpp>
@@ -54,6 +57,10 @@ namespace cubos::core::ecs
     };
 
     /// @brief Used to edit a blueprint spawned by a @ref Commands object.
+    ///
+    /// Shares the entity name table of the spawned blueprint, and thus remains valid even if the
+    /// blueprint is changed or destroyed afterwards.
+    ///
     /// @ingroup core-ecs-system
     class BlueprintBuilder final
     {
@@ -92,14 +99,19 @@ namespace cubos::core::ecs
     private:
         friend CommandBuffer;
 
-        data::old::SerializationMap<Entity, std::string, EntityHash>
-            mMap;                 ///< Maps entity names to the instantiated entities.
-        CommandBuffer& mCommands; ///< Commands object that created this entity.
+        /// @brief Indices of the entities of the spawned blueprint, by name.
+        using NameTable = std::unordered_map<std::string, uint32_t>;
+
+        std::vector<Entity> mEntities;           ///< Instantiated entities, indexed by blueprint entity.
+        std::shared_ptr<const NameTable> mNames; ///< Name table of the spawned blueprint.
+        CommandBuffer& mCommands;                ///< Commands object that created this entity.
 
         /// @brief Constructs.
-        /// @param map Map of entity names to the instantiated entities.
+        /// @param entities Instantiated entities, indexed by blueprint entity.
+        /// @param names Name table of the spawned blueprint, which may be null if it's empty.
         /// @param commands Commands object that created this entity.
-        BlueprintBuilder(data::old::SerializationMap<Entity, std::string, EntityHash>&& map, CommandBuffer& commands);
+        BlueprintBuilder(std::vector<Entity>&& entities, std::shared_ptr<const NameTable> names,
+                         CommandBuffer& commands);
     };
 
     /// @brief System argument used to write ECS commands and execute them at a later time.
@@ -146,6 +158,12 @@ namespace cubos::core::ecs
         /// @return Blueprint builder.
         BlueprintBuilder spawn(const Blueprint& blueprint);
 
+        /// @brief Spawns a blueprint into the world multiple times.
+        /// @param blueprint Blueprint to spawn.
+        /// @param count Number of times to spawn the blueprint.
+        /// @return Blueprint builders, one for each spawned instance.
+        std::vector<BlueprintBuilder> spawn(const Blueprint& blueprint, std::size_t count);
+
     private:
         CommandBuffer& mBuffer; ///< Command buffer to write to.
     };
@@ -189,6 +207,12 @@ namespace cubos::core::ecs
         /// @return Blueprint builder.
         BlueprintBuilder spawn(const Blueprint& blueprint);
 
+        /// @brief Spawns a blueprint into the world multiple times.
+        /// @param blueprint Blueprint to spawn.
+        /// @param count Number of times to spawn the blueprint.
+        /// @return Blueprint builders, one for each spawned instance.
+        std::vector<BlueprintBuilder> spawn(const Blueprint& blueprint, std::size_t count);
+
         /// @brief Aborts the commands, rolling back any changes made.
         void abort();
 
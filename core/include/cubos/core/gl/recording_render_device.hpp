@@ -0,0 +1,212 @@
+/// @file
+/// @brief Class @ref cubos::core::gl::RecordingRenderDevice.
+/// @ingroup core-gl
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cubos/core/gl/render_device.hpp>
+
+namespace cubos::core::gl
+{
+    template <typename T>
+    class RecordedObject;
+
+    /// @brief Render device implementation which creates no GPU objects and instead records the
+    /// calls made to it.
+    ///
+    /// Meant for testing and profiling the CPU side of rendering code on machines without a GPU.
+    /// Descriptors and calls are validated like they would be by a real device, and rejected ones
+    /// are logged as errors and return null handles. Every state change, clear, draw, dispatch,
+    /// binding, buffer map and unmap and texture update is counted in @ref stats(), and may also be
+    /// added to an inspectable command log.
+    ///
+    /// Objects are identified in the log by identifiers, which start at 1 and are assigned in
+    /// creation order. Binding points also get identifiers, the first time they are requested.
+    ///
+    /// @warning Objects created by the device must not be used after it is destroyed.
+    /// @ingroup core-gl
+    class RecordingRenderDevice final : public RenderDevice
+    {
+    public:
+        /// @brief Type of a recorded call.
+        enum class Call
+        {
+            SetFramebuffer,                ///< Object: framebuffer, or 0 for the default one.
+            SetRasterState,                ///< Object: raster state, or 0 for the default one.
+            SetDepthStencilState,          ///< Object: depth stencil state, or 0 for the default one.
+            SetBlendState,                 ///< Object: blend state, or 0 for the default one.
+            SetIndexBuffer,                ///< Object: index buffer.
+            SetVertexArray,                ///< Object: vertex array.
+            SetShaderPipeline,             ///< Object: shader pipeline.
+            SetViewport,                   ///< Arguments: x, y, width and height.
+            SetScissor,                    ///< Arguments: x, y, width and height.
+            ClearColor,                    ///< No arguments.
+            ClearTargetColor,              ///< Arguments: target index.
+            ClearDepth,                    ///< No arguments.
+            ClearStencil,                  ///< Arguments: stencil value.
+            DrawTriangles,                 ///< Arguments: offset and vertex count.
+            DrawTrianglesIndexed,          ///< Arguments: offset and index count.
+            DrawTrianglesInstanced,        ///< Arguments: offset, vertex count and instance count.
+            DrawTrianglesIndexedInstanced, ///< Arguments: offset, index count, instance count and base vertex.
+            DispatchCompute,               ///< Arguments: group counts on each axis.
+            MemoryBarrier,                 ///< Arguments: barrier flags.
+            Bind,                          ///< Object: binding point. Arguments: bound object, level, access.
+            SetConstant,                   ///< Object: binding point.
+            Map,                           ///< Object: buffer.
+            Unmap,                         ///< Object: buffer. Arguments: bytes uploaded.
+            UpdateTexture,                 ///< Object: texture. Arguments: bytes uploaded and mip level.
+            GenerateMipmaps,               ///< Object: texture.
+            UpdateBuffer,                  ///< Object: buffer. Arguments: offset and bytes uploaded.
+            CopyBuffer,                    ///< Object: destination. Arguments: source, source offset, offset, size.
+        };
+
+        /// @brief Entry of the command log.
+        struct Command
+        {
+            Call call;          ///< Call which was made.
+            std::size_t object; ///< Identifier of the object the call was made on or with, or 0.
+            int64_t args[4];    ///< Arguments of the call, which depend on its type.
+        };
+
+        /// @brief Counters of the calls made to the device.
+        struct Stats
+        {
+            std::size_t objects{0};               ///< Objects created, including binding points.
+            std::size_t stateChanges{0};          ///< Calls which changed the state, binds and constants included.
+            std::size_t redundantStateChanges{0}; ///< State changes which set an already set object.
+            std::size_t drawCalls{0};             ///< Draw calls.
+            std::size_t triangles{0};             ///< Triangles drawn, counting every instance.
+            std::size_t dispatches{0};            ///< Compute dispatches.
+            std::size_t clears{0};                ///< Clears of the current framebuffer.
+            std::size_t maps{0};                  ///< Buffer map calls.
+            std::size_t unmaps{0};                ///< Buffer unmap calls.
+            std::size_t bytesUploaded{0};         ///< Bytes of initial data, texture updates and unmapped buffers.
+            std::size_t errors{0};                ///< Calls rejected by validation.
+        };
+
+        RecordingRenderDevice();
+
+        /// @brief Gets the command log.
+        /// @return Recorded commands, in the order they were made.
+        const std::vector<Command>& commands() const;
+
+        /// @brief Gets the counters of the calls made since the device was created or last cleared.
+        /// @return Statistics.
+        const Stats& stats() const;
+
+        /// @brief Gets a human readable label for the given object, which is its type, or its name
+        /// if it's a binding point.
+        /// @param object Object identifier.
+        /// @return Label, or an empty string if there's no such object.
+        const std::string& label(std::size_t object) const;
+
+        /// @brief Sets whether calls are added to the command log. Statistics are always counted.
+        ///
+        /// Enabled by default. Benchmarks which only need the counters should disable it, as the
+        /// log grows with every call.
+        ///
+        /// @param enabled Whether the log is enabled.
+        void logCommands(bool enabled);
+
+        /// @brief Clears the command log and resets the statistics. The current state, such as the
+        /// set framebuffer, is kept, so that redundant state changes are still detected.
+        void clear();
+
+        Framebuffer createFramebuffer(const FramebufferDesc& desc) override;
+        void setFramebuffer(Framebuffer fb) override;
+        RasterState createRasterState(const RasterStateDesc& desc) override;
+        void setRasterState(RasterState rs) override;
+        DepthStencilState createDepthStencilState(const DepthStencilStateDesc& desc) override;
+        void setDepthStencilState(DepthStencilState dss) override;
+        BlendState createBlendState(const BlendStateDesc& desc) override;
+        void setBlendState(BlendState bs) override;
+        Sampler createSampler(const SamplerDesc& desc) override;
+        Texture1D createTexture1D(const Texture1DDesc& desc) override;
+        Texture2D createTexture2D(const Texture2DDesc& desc) override;
+        Texture2DArray createTexture2DArray(const Texture2DArrayDesc& desc) override;
+        Texture3D createTexture3D(const Texture3DDesc& desc) override;
+        CubeMap createCubeMap(const CubeMapDesc& desc) override;
+        CubeMapArray createCubeMapArray(const CubeMapArrayDesc& desc) override;
+        ConstantBuffer createConstantBuffer(std::size_t size, const void* data, Usage usage) override;
+        IndexBuffer createIndexBuffer(std::size_t size, const void* data, IndexFormat format, Usage usage) override;
+        void setIndexBuffer(IndexBuffer ib) override;
+        VertexBuffer createVertexBuffer(std::size_t size, const void* data, Usage usage) override;
+        VertexArray createVertexArray(const VertexArrayDesc& desc) override;
+        void setVertexArray(VertexArray va) override;
+        ShaderStage createShaderStage(Stage stage, const char* src) override;
+        ShaderPipeline createShaderPipeline(ShaderStage vs, ShaderStage ps) override;
+        ShaderPipeline createShaderPipeline(ShaderStage vs, ShaderStage gs, ShaderStage ps) override;
+        ShaderPipeline createShaderPipeline(ShaderStage cs) override;
+        void setShaderPipeline(ShaderPipeline pipeline) override;
+        void clearColor(float r, float g, float b, float a) override;
+        void clearTargetColor(std::size_t target, float r, float g, float b, float a) override;
+        void clearDepth(float depth) override;
+        void clearStencil(int stencil) override;
+        void drawTriangles(std::size_t offset, std::size_t count) override;
+        void drawTrianglesIndexed(std::size_t offset, std::size_t count) override;
+        void drawTrianglesInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
+        void drawTrianglesIndexedInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
+        void drawTrianglesIndexedInstancedBaseVertex(std::size_t offset, std::size_t count, std::size_t instanceCount,
+                                                     std::size_t baseVertex) override;
+        void dispatchCompute(std::size_t x, std::size_t y, std::size_t z) override;
+        void memoryBarrier(MemoryBarriers barriers) override;
+        void setViewport(int x, int y, int w, int h) override;
+        void setScissor(int x, int y, int w, int h) override;
+        int getProperty(Property prop) override;
+
+    private:
+        template <typename T>
+        friend class RecordedObject;
+
+        /// @brief Assigns an identifier to a new object.
+        /// @param label Label of the object.
+        /// @return Identifier.
+        std::size_t create(std::string label);
+
+        /// @brief Adds a command to the log, if it's enabled.
+        /// @param call Call made.
+        /// @param object Object identifier.
+        /// @param a First argument.
+        /// @param b Second argument.
+        /// @param c Third argument.
+        /// @param d Fourth argument.
+        void record(Call call, std::size_t object, int64_t a = 0, int64_t b = 0, int64_t c = 0, int64_t d = 0);
+
+        /// @brief Counts a state change, and records it.
+        /// @param call Call made.
+        /// @param current Identifier of the currently set object, which is replaced.
+        /// @param object Identifier of the object being set.
+        void changeState(Call call, std::size_t& current, std::size_t object);
+
+        /// @brief Counts a call rejected by validation, which must have already logged an error.
+        void fail();
+
+        /// @brief Checks whether a draw call can be made with the current state.
+        /// @param indexed Whether the draw call uses the index buffer.
+        /// @param offset Offset of the first index, if indexed.
+        /// @param count Number of indices, if indexed.
+        /// @return Whether the draw call is valid.
+        bool validateDraw(bool indexed, std::size_t offset, std::size_t count);
+
+        std::vector<Command> mCommands;   ///< Command log.
+        std::vector<std::string> mLabels; ///< Labels of the objects, indexed by their identifiers minus one.
+        Stats mStats;                     ///< Call counters.
+        bool mLogCommands{true};          ///< Whether the command log is enabled.
+
+        // Currently set objects, or 0 if none is set.
+        std::size_t mFramebuffer{0};
+        std::size_t mRasterState{0};
+        std::size_t mDepthStencilState{0};
+        std::size_t mBlendState{0};
+        std::size_t mVertexArray{0};
+        std::size_t mShaderPipeline{0};
+        std::size_t mIndexBuffer{0};
+
+        std::size_t mIndexCount{0};    ///< Number of indices in the set index buffer.
+        bool mComputePipeline{false}; ///< Whether the set shader pipeline is a compute pipeline.
+    };
+} // namespace cubos::core::gl
@@ -176,6 +176,10 @@ namespace cubos::core::gl
 
         /// @brief Specifies whether compute shaders and memory barriers are supported (0 or 1).
         ComputeSupported,
+
+        /// @brief Specifies the alignment, in bytes, required for the offsets of constant buffer
+        /// ranges bound to binding points.
+        ConstantBufferOffsetAlignment,
     };
 
     /// @brief Usage mode for buffers and textures.
@@ -907,6 +911,15 @@ namespace cubos::core::gl
         virtual void drawTrianglesIndexedInstanced(std::size_t offset, std::size_t count,
                                                    std::size_t instanceCount) = 0;
 
+        /// @brief Draws tringles multiple times with an index buffer, adding an offset to every
+        /// index, so that meshes which share a vertex buffer can keep indices local to them.
+        /// @param offset Index of the first indice to be drawn.
+        /// @param count Number of indices that will be drawn.
+        /// @param instanceCount Number of instances drawn.
+        /// @param baseVertex Value added to each index before fetching its vertex.
+        virtual void drawTrianglesIndexedInstancedBaseVertex(std::size_t offset, std::size_t count,
+                                                             std::size_t instanceCount, std::size_t baseVertex) = 0;
+
         /// @brief Dispatches a compute pipeline.
         /// @param x X dimension of the work group.
         /// @param y Y dimension of the work group.
@@ -1151,6 +1164,20 @@ namespace cubos::core::gl
             /// @return Pointer to the memory region.
             virtual void* map() = 0;
 
+            /// @brief Maps a range of the constant buffer to a region in memory, without waiting
+            /// for previously submitted commands which use the buffer. Must be matched with a call
+            /// to @ref unmap().
+            ///
+            /// Meant for buffers which are written as a ring: unless @p discard is true, the range
+            /// must not be used by commands which may still be pending. If it's true, the previous
+            /// contents of the whole buffer are discarded, and pending commands keep seeing them.
+            ///
+            /// @param offset Offset of the range, in bytes.
+            /// @param size Size of the range, in bytes.
+            /// @param discard Whether the previous contents of the buffer can be discarded.
+            /// @return Pointer to the memory region, or nullptr if the range is out of bounds.
+            virtual void* mapRange(std::size_t offset, std::size_t size, bool discard) = 0;
+
             /// @brief Unmaps the constant buffer, updating it with data written to the mapped
             /// region.
             virtual void unmap() = 0;
@@ -1173,6 +1200,22 @@ namespace cubos::core::gl
             /// @brief Unmaps the index buffer, updating it with data written to the mapped region.
             virtual void unmap() = 0;
 
+            /// @brief Updates a range of the index buffer, after previously submitted commands
+            /// which use it are done with it.
+            /// @param offset Offset of the range, in bytes.
+            /// @param size Size of the range, in bytes.
+            /// @param data Data to write to the range.
+            virtual void update(std::size_t offset, std::size_t size, const void* data) = 0;
+
+            /// @brief Copies a range of another index buffer to this one, without going through the
+            /// CPU.
+            /// @param source Buffer to copy from, which must not be this one.
+            /// @param sourceOffset Offset of the range on the source buffer, in bytes.
+            /// @param offset Offset of the range on this buffer, in bytes.
+            /// @param size Size of the range, in bytes.
+            virtual void copy(const IndexBuffer& source, std::size_t sourceOffset, std::size_t offset,
+                              std::size_t size) = 0;
+
         protected:
             IndexBuffer() = default;
         };
@@ -1192,6 +1235,22 @@ namespace cubos::core::gl
             /// region.
             virtual void unmap() = 0;
 
+            /// @brief Updates a range of the vertex buffer, after previously submitted commands
+            /// which use it are done with it.
+            /// @param offset Offset of the range, in bytes.
+            /// @param size Size of the range, in bytes.
+            /// @param data Data to write to the range.
+            virtual void update(std::size_t offset, std::size_t size, const void* data) = 0;
+
+            /// @brief Copies a range of another vertex buffer to this one, without going through the
+            /// CPU.
+            /// @param source Buffer to copy from, which must not be this one.
+            /// @param sourceOffset Offset of the range on the source buffer, in bytes.
+            /// @param offset Offset of the range on this buffer, in bytes.
+            /// @param size Size of the range, in bytes.
+            virtual void copy(const VertexBuffer& source, std::size_t sourceOffset, std::size_t offset,
+                              std::size_t size) = 0;
+
         protected:
             VertexBuffer() = default;
         };
@@ -1296,6 +1355,16 @@ namespace cubos::core::gl
             /// @param cb Constant buffer to bind.
             virtual void bind(gl::ConstantBuffer cb) = 0;
 
+            /// @brief Binds a range of a constant buffer to the binding point.
+            ///
+            /// If this binding point doesn't support a constant buffer, an error is logged.
+            ///
+            /// @param cb Constant buffer to bind.
+            /// @param offset Offset of the range, in bytes, which must be a multiple of
+            /// @ref Property::ConstantBufferOffsetAlignment.
+            /// @param size Size of the range, in bytes.
+            virtual void bind(gl::ConstantBuffer cb, std::size_t offset, std::size_t size) = 0;
+
             /// @brief Binds a level of a 2D texture to an image unit.
             ///
             /// If this binding point doesn't support an image unit, an error is logged.
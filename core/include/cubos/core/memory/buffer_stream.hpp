@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <cubos/core/memory/stream.hpp>
 
 namespace cubos::core::memory
@@ -30,6 +32,12 @@ namespace cubos::core::memory
         /// @param size Initial size of the buffer.
         BufferStream(std::size_t size = 16);
 
+        /// @brief Constructs using an existing buffer, which the stream takes ownership of, and
+        /// which grows as needed.
+        /// @param buffer Buffer to read/write from, allocated with `new char[]`. Must not be null.
+        /// @param size Size of the buffer.
+        BufferStream(std::unique_ptr<char[]> buffer, std::size_t size);
+
         /// @brief Constructs a copy of another buffer stream. If the given buffer stream owns its
         /// buffer, the copy will also create its own buffer. Otherwise, it will share the buffer
         /// with the original.
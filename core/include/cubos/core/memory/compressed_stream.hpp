@@ -0,0 +1,105 @@
+/// @file
+/// @brief Class @ref cubos::core::memory::CompressedStream.
+/// @ingroup core-memory
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <cubos/core/memory/stream.hpp>
+
+namespace cubos::core::memory
+{
+    /// @brief Read-only stream which decompresses data stored in a block compressed format.
+    ///
+    /// The data is split into blocks of a fixed size, each compressed independently with the LZ4
+    /// block format, and preceded by a header with a table of the offsets of each block. This
+    /// allows seeking to any position while decompressing only the block which contains it.
+    ///
+    /// Data in this format is written by @ref compress(). The virtual file system detects it
+    /// through its magic number and decompresses it transparently when files are opened for
+    /// reading.
+    ///
+    /// @ingroup core-memory
+    class CompressedStream : public Stream
+    {
+    public:
+        /// @brief Default size of the blocks the data is split into.
+        static constexpr std::size_t DefaultBlockSize = 64 * 1024;
+
+        ~CompressedStream() override = default;
+
+        /// @brief Constructs, reading the header of the compressed data from the current position
+        /// of the given stream.
+        ///
+        /// If the header is invalid, @ref failed() returns true and the stream behaves as if empty.
+        ///
+        /// @param stream Seekable stream to read the compressed data from.
+        CompressedStream(std::unique_ptr<Stream> stream);
+
+        /// @brief Checks whether a stream holds compressed data, by looking at its magic number.
+        ///
+        /// The position of the stream is left unchanged.
+        ///
+        /// @param stream Seekable stream to check.
+        /// @return Whether the data at the current position of the stream is compressed.
+        static bool detect(Stream& stream);
+
+        /// @brief Compresses all data read from a stream and writes it in the format read by this
+        /// stream.
+        /// @param in Stream to read the data from, until its end.
+        /// @param out Stream to write the compressed data to.
+        /// @param blockSize Size of the blocks the data is split into.
+        /// @return Whether the data was written successfully.
+        static bool compress(Stream& in, Stream& out, std::size_t blockSize = DefaultBlockSize);
+
+        /// @brief Checks whether the header of the compressed data was invalid.
+        /// @return Whether the stream failed to be constructed.
+        bool failed() const;
+
+        /// @brief Gets the size of the decompressed data.
+        /// @return Decompressed size in bytes.
+        std::size_t size() const;
+
+        // Method implementations.
+
+        std::size_t read(void* data, std::size_t size) override;
+        std::size_t write(const void* data, std::size_t size) override;
+        std::size_t tell() const override;
+        void seek(ptrdiff_t offset, SeekOrigin origin) override;
+        bool eof() const override;
+        char peek() const override;
+
+    private:
+        /// @brief Decompresses a block into the given buffer.
+        /// @param index Index of the block.
+        /// @param out Buffer with enough space for the whole block.
+        /// @return Whether the block was decompressed successfully.
+        bool decompress(std::size_t index, char* out) const;
+
+        /// @brief Makes the block with the given index the cached block.
+        /// @param index Index of the block.
+        /// @return Whether the block was decompressed successfully.
+        bool cache(std::size_t index) const;
+
+        /// @brief Gets the decompressed size of the block with the given index.
+        /// @param index Index of the block.
+        /// @return Size in bytes.
+        std::size_t blockSize(std::size_t index) const;
+
+        std::unique_ptr<Stream> mStream; ///< Stream the compressed data is read from.
+        std::size_t mDataStart{0};       ///< Position in the underlying stream where the blocks start.
+        std::size_t mSize{0};            ///< Size of the decompressed data.
+        std::size_t mBlockSize{0};       ///< Size of each decompressed block, except possibly the last.
+        std::vector<uint64_t> mOffsets;  ///< Offsets of each block, plus the end of the last one.
+        std::size_t mPosition{0};        ///< Current position in the decompressed data.
+        bool mReachedEof{false};         ///< Whether a read reached the end of the data.
+        bool mFailed{false};             ///< Whether the header was invalid.
+
+        mutable std::vector<char> mBlock;      ///< Decompressed data of the cached block.
+        mutable std::size_t mBlockIndex;       ///< Index of the cached block, or SIZE_MAX if none.
+        mutable std::vector<char> mCompressed; ///< Scratch buffer for the compressed data of a block.
+    };
+} // namespace cubos::core::memory
@@ -1,8 +1,13 @@
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include <cubos/core/data/fs/archive.hpp>
 #include <cubos/core/data/fs/file.hpp>
 #include <cubos/core/log.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
+#include <cubos/core/thread_pool.hpp>
 
 using namespace cubos::core;
 using namespace cubos::core::data;
@@ -35,6 +40,17 @@ static bool validateRelativePath(std::string_view path)
     return false;
 }
 
+/// @brief Maximum number of threads used to read files asynchronously.
+static constexpr std::size_t MaxIOThreads = 4;
+
+/// @brief Gets the pool of threads which perform asynchronous reads.
+/// @return Thread pool.
+static ThreadPool& ioThreadPool()
+{
+    static ThreadPool pool{std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, MaxIOThreads)};
+    return pool;
+}
+
 File::File(Handle parent, std::string_view name)
     : mName(name)
     , mDirectory(true)
@@ -403,7 +419,75 @@ std::unique_ptr<memory::Stream> File::open(OpenMode mode)
         return nullptr;
     }
 
-    return mArchive->open(mId, this->shared_from_this(), mode);
+    auto stream = mArchive->open(mId, this->shared_from_this(), mode);
+
+    // Compressed files are decompressed transparently when read.
+    if (stream != nullptr && mode == OpenMode::Read && memory::CompressedStream::detect(*stream))
+    {
+        auto compressed = std::make_unique<memory::CompressedStream>(std::move(stream));
+        if (compressed->failed())
+        {
+            CUBOS_ERROR("Could not open file '{}': invalid compressed data", mPath);
+            return nullptr;
+        }
+
+        return compressed;
+    }
+
+    return stream;
+}
+
+std::future<std::unique_ptr<memory::Stream>> File::readAsync(std::size_t offset, std::size_t size)
+{
+    // std::function must be copyable, and thus the promise is shared with the task.
+    auto promise = std::make_shared<std::promise<std::unique_ptr<memory::Stream>>>();
+    auto future = promise->get_future();
+
+    ioThreadPool().addTask([file = this->shared_from_this(), promise, offset, size]() {
+        auto stream = file->open(OpenMode::Read);
+        if (stream == nullptr)
+        {
+            CUBOS_ERROR("Could not read file '{}' asynchronously: failed to open it", file->mPath);
+            promise->set_value(nullptr);
+            return;
+        }
+
+        // Find how many bytes are in the range, so that the buffer can be allocated up front.
+        stream->seek(0, memory::SeekOrigin::End);
+        auto end = stream->tell();
+        auto length = end > offset ? std::min(size, end - offset) : 0;
+        stream->seek(static_cast<ptrdiff_t>(offset), memory::SeekOrigin::Begin);
+
+        // Read straight into the buffer which the stream takes ownership of.
+        std::unique_ptr<char[]> data{length > 0 ? new char[length] : nullptr};
+        std::size_t read = 0;
+        while (read < length)
+        {
+            auto chunk = stream->read(data.get() + read, length - read);
+            if (chunk == 0)
+            {
+                break;
+            }
+
+            read += chunk;
+        }
+
+        // Owned buffer streams are as large as their buffer, and must not be empty.
+        static const char Empty = 0;
+        std::unique_ptr<memory::BufferStream> buffer;
+        if (read == 0)
+        {
+            buffer = std::make_unique<memory::BufferStream>(&Empty, 0);
+        }
+        else
+        {
+            buffer = std::make_unique<memory::BufferStream>(std::move(data), read);
+        }
+
+        promise->set_value(std::move(buffer));
+    });
+
+    return future;
 }
 
 std::string_view File::name() const
@@ -421,6 +505,12 @@ bool File::directory() const
     return mDirectory;
 }
 
+uint64_t File::modificationTime() const
+{
+    std::lock_guard lock(mMutex);
+    return mArchive == nullptr ? 0 : mArchive->modificationTime(mId);
+}
+
 const std::shared_ptr<Archive>& File::archive() const
 {
     std::lock_guard lock(mMutex);
@@ -108,3 +108,67 @@ std::unique_ptr<memory::Stream> FileSystem::open(std::string_view path, File::Op
     CUBOS_ERROR("Could not open file for writing at path '{}': the file could not be created", path);
     return nullptr;
 }
+
+std::future<std::unique_ptr<memory::Stream>> FileSystem::readAsync(std::string_view path, std::size_t offset,
+                                                                    std::size_t size)
+{
+    if (auto file = FileSystem::find(path))
+    {
+        return file->readAsync(offset, size);
+    }
+
+    CUBOS_ERROR("Could not read file at '{}': the file does not exist", path);
+    std::promise<std::unique_ptr<memory::Stream>> promise;
+    promise.set_value(nullptr);
+    return promise.get_future();
+}
+
+std::vector<std::future<std::unique_ptr<memory::Stream>>> FileSystem::readAsync(const std::vector<std::string>& paths)
+{
+    std::vector<std::future<std::unique_ptr<memory::Stream>>> futures;
+    futures.reserve(paths.size());
+    for (const auto& path : paths)
+    {
+        futures.push_back(FileSystem::readAsync(path));
+    }
+    return futures;
+}
+
+std::vector<std::string> FileSystem::modified()
+{
+    std::vector<std::string> paths;
+    std::vector<std::size_t> ids;
+
+    // Look for the mount points of archives, which are never inside other archives.
+    std::vector<File::Handle> stack{FileSystem::root()};
+    while (!stack.empty())
+    {
+        auto file = std::move(stack.back());
+        stack.pop_back();
+
+        auto archive = file->archive();
+        if (archive == nullptr)
+        {
+            for (auto child = file->child(); child != nullptr; child = child->sibling())
+            {
+                stack.push_back(child);
+            }
+            continue;
+        }
+
+        // Build the paths of the modified files from the tree of the archive.
+        ids.clear();
+        archive->modified(ids);
+        for (auto id : ids)
+        {
+            std::string path;
+            for (; id != 1; id = archive->parent(id))
+            {
+                path.insert(0, "/" + archive->name(id));
+            }
+            paths.emplace_back(std::string(file->path()) + path);
+        }
+    }
+
+    return paths;
+}
@@ -1,3 +1,10 @@
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
 #include <cubos/core/data/fs/file_stream.hpp>
 #include <cubos/core/data/fs/standard_archive.hpp>
 #include <cubos/core/log.hpp>
@@ -81,6 +88,89 @@ StandardArchive::StandardArchive(const std::filesystem::path& osPath, bool isDir
     }
 }
 
+StandardArchive::~StandardArchive()
+{
+#ifdef __linux__
+    if (mWatchFd != -1)
+    {
+        close(mWatchFd);
+    }
+#endif
+}
+
+bool StandardArchive::watch()
+{
+    INIT_OR_RETURN(false);
+
+#ifdef __linux__
+    if (mWatchFd != -1)
+    {
+        return true;
+    }
+
+    mWatchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mWatchFd == -1)
+    {
+        CUBOS_ERROR("inotify_init1() failed: {}", strerror(errno));
+        return false;
+    }
+
+    // Watch every directory, as inotify doesn't watch subdirectories recursively.
+    for (const auto& [id, info] : mFiles)
+    {
+        if (info.directory || id == 1)
+        {
+            this->addWatch(id);
+        }
+    }
+
+    CUBOS_DEBUG("Watching '{}' for modifications", mOsPath.string());
+    return true;
+#else
+    CUBOS_ERROR("Could not watch '{}': watching files is only supported on Linux", mOsPath.string());
+    return false;
+#endif
+}
+
+void StandardArchive::addWatch(std::size_t id)
+{
+#ifdef __linux__
+    const auto& info = mFiles.at(id);
+
+    // Editors often save files by writing to a temporary file and renaming it over the original,
+    // so we also need to look for files being moved into the directory.
+    auto path = info.directory ? info.osPath.string() : info.osPath.parent_path().string();
+    int wd = inotify_add_watch(mWatchFd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd == -1)
+    {
+        CUBOS_ERROR("inotify_add_watch() failed for '{}': {}", path, strerror(errno));
+        return;
+    }
+
+    mWatches[wd] = info.directory ? id : 0;
+#else
+    (void)id;
+#endif
+}
+
+std::size_t StandardArchive::findChild(std::size_t parent, std::string_view name) const
+{
+    if (parent == 0)
+    {
+        return mFiles.at(1).osPath.filename() == name ? 1 : 0;
+    }
+
+    for (auto child = mFiles.at(parent).child; child != 0; child = mFiles.at(child).sibling)
+    {
+        if (mFiles.at(child).osPath.filename() == name)
+        {
+            return child;
+        }
+    }
+
+    return 0;
+}
+
 void StandardArchive::generate(std::size_t parent)
 {
     auto& parentInfo = mFiles[parent];
@@ -140,6 +230,12 @@ std::size_t StandardArchive::create(std::size_t parent, std::string_view name, b
     std::size_t id = mNextId++;
     mFiles[id] = {osPath, parent, parentInfo.child, 0, directory};
     parentInfo.child = id;
+
+    if (directory && mWatchFd != -1)
+    {
+        this->addWatch(id);
+    }
+
     return id;
 }
 
@@ -271,3 +367,64 @@ std::unique_ptr<Stream> StandardArchive::open(std::size_t id, File::Handle file,
 
     return std::make_unique<FileStream<memory::StandardStream>>(file, mode, memory::StandardStream(fd, true));
 }
+
+uint64_t StandardArchive::modificationTime(std::size_t id) const
+{
+    INIT_OR_RETURN(0);
+
+    auto it = mFiles.find(id);
+    CUBOS_DEBUG_ASSERT(it != mFiles.end());
+
+    std::error_code err;
+    auto time = std::filesystem::last_write_time(it->second.osPath, err);
+    if (err)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(time.time_since_epoch().count());
+}
+
+void StandardArchive::modified(std::vector<std::size_t>& ids)
+{
+#ifdef __linux__
+    if (mWatchFd == -1)
+    {
+        return;
+    }
+
+    // Read all pending events - the descriptor is non-blocking, so this stops once there are none.
+    alignas(inotify_event) char buffer[4096];
+    ssize_t len;
+    while ((len = read(mWatchFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < len;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            // The watch is removed automatically when its directory is.
+            if ((event->mask & IN_IGNORED) != 0U)
+            {
+                mWatches.erase(event->wd);
+                continue;
+            }
+
+            auto it = mWatches.find(event->wd);
+            if (it == mWatches.end() || event->len == 0)
+            {
+                continue;
+            }
+
+            // Files which aren't in the archive's tree are ignored (#263).
+            auto id = this->findChild(it->second, event->name);
+            if (id != 0 && !mFiles.at(id).directory && std::find(ids.begin(), ids.end(), id) == ids.end())
+            {
+                ids.push_back(id);
+            }
+        }
+    }
+#else
+    (void)ids;
+#endif
+}
@@ -1,200 +1,716 @@
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <vector>
+
 #include <cubos/core/data/old/json_deserializer.hpp>
 #include <cubos/core/log.hpp>
 
 using namespace cubos::core;
 using namespace cubos::core::data::old;
 
-#define CHECK_ERROR(exp)                                                                                               \
+/// Number of bytes read from the stream at once.
+static constexpr std::size_t ChunkSize = 16384;
+
+#define CHECK_FAIL_BIT(ret)                                                                                            \
     do                                                                                                                 \
     {                                                                                                                  \
         if (mFailBit)                                                                                                  \
         {                                                                                                              \
             CUBOS_WARN("Deserializer fail bit is set");                                                                \
-        }                                                                                                              \
-        else                                                                                                           \
-        {                                                                                                              \
-            try                                                                                                        \
-            {                                                                                                          \
-                exp                                                                                                    \
-            }                                                                                                          \
-            catch (nlohmann::json::exception & e)                                                                      \
-            {                                                                                                          \
-                CUBOS_ERROR("Caught JSON exception '{}'", e.what());                                                   \
-                mFailBit = true;                                                                                       \
-            }                                                                                                          \
+            return ret;                                                                                                \
         }                                                                                                              \
     } while (false)
 
 // NOLINTBEGIN(bugprone-macro-parentheses)
-#define READ_GENERIC(out, type, fromStr)                                                                               \
-    CHECK_ERROR(do {                                                                                                   \
-        if (mFrame.top().mode == Mode::Dictionary)                                                                     \
-        {                                                                                                              \
-            if (mFrame.top().key)                                                                                      \
-            {                                                                                                          \
-                out = static_cast<type>(fromStr(mFrame.top().iter.key()));                                             \
-                mFrame.top().key = false;                                                                              \
-            }                                                                                                          \
-            else                                                                                                       \
-            {                                                                                                          \
-                out = mFrame.top().iter.value();                                                                       \
-                mFrame.top().iter++;                                                                                   \
-                mFrame.top().key = true;                                                                               \
-            }                                                                                                          \
-        }                                                                                                              \
-        else                                                                                                           \
+#define READ_GENERIC(out, fromStr)                                                                                     \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        std::string token;                                                                                             \
+        Token kind;                                                                                                    \
+        if (this->readScalar(token, kind) && (kind == Token::String || !fromStr(token, out)))                          \
         {                                                                                                              \
-            out = mFrame.top().iter.value();                                                                           \
-            mFrame.top().iter++;                                                                                       \
+            CUBOS_ERROR("Couldn't convert JSON value '{}' to the requested type", token);                              \
+            mFailBit = true;                                                                                           \
         }                                                                                                              \
-    } while (false);)
+    } while (false)
 // NOLINTEND(bugprone-macro-parentheses)
 
+template <typename T>
+static bool parseInteger(const std::string& str, T& value)
+{
+    const char* first = str.data();
+    const char* last = first + str.size();
+
+    int64_t i64;
+    if (auto [ptr, ec] = std::from_chars(first, last, i64); ec == std::errc() && ptr == last)
+    {
+        value = static_cast<T>(i64);
+        return true;
+    }
+
+    uint64_t u64;
+    if (auto [ptr, ec] = std::from_chars(first, last, u64); ec == std::errc() && ptr == last)
+    {
+        value = static_cast<T>(u64);
+        return true;
+    }
+
+    // Numbers with a fraction or an exponent are truncated.
+    double f64;
+    if (auto [ptr, ec] = std::from_chars(first, last, f64); ec == std::errc() && ptr == last)
+    {
+        value = static_cast<T>(f64);
+        return true;
+    }
+
+    if (str == "true" || str == "false")
+    {
+        value = static_cast<T>(str == "true");
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+static bool parseFloat(const std::string& str, T& value)
+{
+    const char* first = str.data();
+    const char* last = first + str.size();
+
+    if (auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc() && ptr == last)
+    {
+        return true;
+    }
+
+    if (str == "true" || str == "false")
+    {
+        value = static_cast<T>(str == "true");
+        return true;
+    }
+
+    return false;
+}
+
+static bool parseBool(const std::string& str, bool& value)
+{
+    if (str == "true" || str == "false")
+    {
+        value = str == "true";
+        return true;
+    }
+
+    return false;
+}
+
+static void appendUtf8(std::string& str, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        str.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+JSONDeserializer::JSONDeserializer(memory::Stream& stream)
+    : mStream(&stream)
+    , mBufferStart(stream.tell())
+    , mCursor(0)
+{
+    if (mBufferStart == SIZE_MAX)
+    {
+        // We won't be able to seek back after skimming, so we must keep the whole input in memory.
+        mStream = nullptr;
+        mBufferStart = 0;
+
+        std::size_t read;
+        do
+        {
+            auto size = mBuffer.size();
+            mBuffer.resize(size + ChunkSize);
+            read = stream.read(mBuffer.data() + size, ChunkSize);
+            mBuffer.resize(size + read);
+        } while (read > 0);
+    }
+
+    mFrame.push({Mode::Array, 0, false});
+}
+
 JSONDeserializer::JSONDeserializer(const std::string& src)
+    : mStream(nullptr)
+    , mBuffer(src)
+    , mBufferStart(0)
+    , mCursor(0)
 {
-    CHECK_ERROR(do {
-        mJson = nlohmann::ordered_json::array();
-        mJson.push_back(nlohmann::ordered_json::parse(src));
-        mFrame.push({Mode::Array, mJson.begin(), false});
-    } while (false););
+    mFrame.push({Mode::Array, 0, false});
 }
 
 void JSONDeserializer::readI8(int8_t& value)
 {
-    READ_GENERIC(value, int8_t, std::stoi);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readI16(int16_t& value)
 {
-    READ_GENERIC(value, int16_t, std::stoi);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readI32(int32_t& value)
 {
-    READ_GENERIC(value, int32_t, std::stol);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readI64(int64_t& value)
 {
-    READ_GENERIC(value, int64_t, std::stoll);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readU8(uint8_t& value)
 {
-    READ_GENERIC(value, uint8_t, std::stoul);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readU16(uint16_t& value)
 {
-    READ_GENERIC(value, uint16_t, std::stoul);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readU32(uint32_t& value)
 {
-    READ_GENERIC(value, uint32_t, std::stoul);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readU64(uint64_t& value)
 {
-    READ_GENERIC(value, uint64_t, std::stoull);
+    READ_GENERIC(value, parseInteger);
 }
 
 void JSONDeserializer::readF32(float& value)
 {
-    READ_GENERIC(value, float, std::stof);
+    READ_GENERIC(value, parseFloat);
 }
 
 void JSONDeserializer::readF64(double& value)
 {
-    READ_GENERIC(value, double, std::stod);
+    READ_GENERIC(value, parseFloat);
 }
 
 void JSONDeserializer::readBool(bool& value)
 {
-    READ_GENERIC(value, bool, [](const std::string& s) { return s == "true"; });
+    READ_GENERIC(value, parseBool);
 }
 
 void JSONDeserializer::readString(std::string& value)
 {
-    READ_GENERIC(value, std::string, [](const std::string& s) { return s; });
+    std::string token;
+    Token kind;
+    if (this->readScalar(token, kind))
+    {
+        if (kind == Token::Literal)
+        {
+            CUBOS_ERROR("Couldn't convert JSON value '{}' to a string", token);
+            mFailBit = true;
+        }
+        else
+        {
+            value = std::move(token);
+        }
+    }
 }
 
 void JSONDeserializer::beginObject()
 {
     assert(!mFrame.top().key); // Objects can't be used as keys.
-
-    CHECK_ERROR(do {
-        auto iter = mFrame.top().iter.value().begin();
-        mFrame.push({Mode::Object, std::move(iter), false});
-    } while (false););
+    this->beginContainer('{', Mode::Object);
 }
 
 void JSONDeserializer::endObject()
 {
-    assert(mFrame.size() > 1);
+    this->endContainer();
+}
+
+std::size_t JSONDeserializer::beginArray()
+{
+    assert(!mFrame.top().key); // Arrays can't be used as keys.
+    return this->beginContainer('[', Mode::Array);
+}
+
+void JSONDeserializer::endArray()
+{
+    this->endContainer();
+}
+
+std::size_t JSONDeserializer::beginDictionary()
+{
+    assert(!mFrame.top().key); // Dictionaries can't be used as keys.
+    return this->beginContainer('{', Mode::Dictionary);
+}
 
-    CHECK_ERROR(do {
-        mFrame.pop();
-        mFrame.top().iter++;
-        if (mFrame.top().mode == Mode::Dictionary)
+void JSONDeserializer::endDictionary()
+{
+    this->endContainer();
+}
+
+bool JSONDeserializer::readScalar(std::string& token, Token& kind)
+{
+    CHECK_FAIL_BIT(false);
+
+    if (!this->beginValue())
+    {
+        return false;
+    }
+
+    auto& frame = mFrame.top();
+    this->skipWhitespace();
+    if (this->peek() == '"')
+    {
+        mCursor += 1;
+        if (!this->parseString(&token))
         {
-            mFrame.top().key = true;
+            return false;
         }
-    } while (false););
+
+        if (frame.mode == Mode::Dictionary && frame.key)
+        {
+            // Keys are followed by their values, so we don't end the value here.
+            frame.key = false;
+            kind = Token::Key;
+            return this->expect(':');
+        }
+
+        kind = Token::String;
+    }
+    else if (frame.mode == Mode::Dictionary && frame.key)
+    {
+        this->error("expected a string key");
+        return false;
+    }
+    else
+    {
+        token.clear();
+        for (char c = this->peek(); std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '+' || c == '.';
+             c = this->peek())
+        {
+            token.push_back(c);
+            mCursor += 1;
+        }
+
+        if (token.empty())
+        {
+            this->error("expected a value");
+            return false;
+        }
+
+        kind = Token::Literal;
+    }
+
+    this->endValue();
+    return true;
 }
 
-std::size_t JSONDeserializer::beginArray()
+std::size_t JSONDeserializer::beginContainer(char open, Mode mode)
 {
-    assert(!mFrame.top().key); // Arrays can't be used as keys.
+    CHECK_FAIL_BIT(0);
+
+    if (!this->beginValue() || !this->expect(open))
+    {
+        return 0;
+    }
 
-    CHECK_ERROR(do {
-        auto iter = mFrame.top().iter.value().begin();
-        auto len = mFrame.top().iter.value().size();
-        mFrame.push({Mode::Array, std::move(iter), false});
-        return len;
-    } while (false););
+    // If this container was found while skimming an outer one, we already know its length.
+    std::size_t length = 0;
+    if (auto it = mLengths.find(this->offset()); it != mLengths.end())
+    {
+        length = it->second;
+        mLengths.erase(it);
+    }
+    else if (mode != Mode::Object)
+    {
+        length = this->skim();
+    }
 
-    return 0;
+    mFrame.push({mode, 0, mode == Mode::Dictionary});
+    return length;
 }
 
-void JSONDeserializer::endArray()
+void JSONDeserializer::endContainer()
 {
+    CHECK_FAIL_BIT();
     assert(mFrame.size() > 1);
 
-    CHECK_ERROR(do {
-        mFrame.pop();
-        mFrame.top().iter++;
-        if (mFrame.top().mode == Mode::Dictionary)
+    // Skip any elements which were not read, until the matching closing character.
+    char close = mFrame.top().mode == Mode::Array ? ']' : '}';
+    std::size_t depth = 0;
+    for (;;)
+    {
+        char c = this->peek();
+        if (c == '\0')
+        {
+            this->error("unexpected end of input");
+            return;
+        }
+
+        mCursor += 1;
+        if (c == '"')
+        {
+            if (!this->parseString(nullptr))
+            {
+                return;
+            }
+        }
+        else if (c == '[' || c == '{')
+        {
+            depth += 1;
+        }
+        else if (c == ']' || c == '}')
         {
-            mFrame.top().key = true;
+            if (depth == 0)
+            {
+                if (c != close)
+                {
+                    this->error("mismatched closing character");
+                    return;
+                }
+                break;
+            }
+            depth -= 1;
         }
-    } while (false););
+    }
+
+    mFrame.pop();
+    this->endValue();
+
+    if (mFrame.size() == 1)
+    {
+        // Nothing else will be read, so we don't need the lengths of any skipped containers.
+        mLengths.clear();
+    }
 }
 
-std::size_t JSONDeserializer::beginDictionary()
+bool JSONDeserializer::beginValue()
 {
-    assert(!mFrame.top().key); // Dictionaries can't be used as keys.
+    auto& frame = mFrame.top();
+
+    if (frame.count > 0 && (frame.mode != Mode::Dictionary || frame.key) && !this->expect(','))
+    {
+        return false;
+    }
 
-    CHECK_ERROR(do {
-        auto iter = mFrame.top().iter.value().begin();
-        auto len = mFrame.top().iter.value().size();
-        mFrame.push({Mode::Dictionary, std::move(iter), true});
-        return len;
-    } while (false););
+    if (frame.mode == Mode::Object)
+    {
+        // Object keys are ignored, since fields are read in order.
+        return this->expect('"') && this->parseString(nullptr) && this->expect(':');
+    }
 
-    return 0;
+    return true;
 }
 
-void JSONDeserializer::endDictionary()
+void JSONDeserializer::endValue()
 {
-    assert(mFrame.size() > 1);
+    auto& frame = mFrame.top();
+    frame.count += 1;
+    if (frame.mode == Mode::Dictionary)
+    {
+        frame.key = true;
+    }
+}
+
+std::size_t JSONDeserializer::skim()
+{
+    /// A container whose elements are being counted.
+    struct Pending
+    {
+        std::size_t offset; ///< Offset right after the opening character.
+        std::size_t commas; ///< Number of commas found directly inside it.
+        bool empty;         ///< Whether no elements were found yet.
+    };
 
-    CHECK_ERROR(do {
-        mFrame.pop();
-        mFrame.top().iter++;
-        if (mFrame.top().mode == Mode::Dictionary)
+    auto start = this->offset();
+    std::vector<Pending> pending{{start, 0, true}};
+    std::size_t length = 0;
+
+    while (!pending.empty())
+    {
+        char c = this->peek();
+        if (c == '\0')
         {
-            mFrame.top().key = true;
+            this->error("unexpected end of input");
+            break;
         }
-    } while (false););
+
+        mCursor += 1;
+        switch (c)
+        {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            break;
+        case ',':
+            pending.back().commas += 1;
+            break;
+        case '[':
+        case '{':
+            pending.back().empty = false;
+            pending.push_back({this->offset(), 0, true});
+            break;
+        case ']':
+        case '}': {
+            auto container = pending.back();
+            auto count = container.empty ? 0 : container.commas + 1;
+            pending.pop_back();
+            if (pending.empty())
+            {
+                length = count;
+            }
+            else
+            {
+                mLengths[container.offset] = count;
+            }
+            break;
+        }
+        case '"':
+            pending.back().empty = false;
+            if (!this->parseString(nullptr))
+            {
+                pending.clear();
+            }
+            break;
+        default:
+            pending.back().empty = false;
+            break;
+        }
+    }
+
+    this->rewind(start);
+    return length;
+}
+
+bool JSONDeserializer::parseString(std::string* out)
+{
+    auto hex = [this](uint32_t& value) {
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = this->peek();
+            if (c >= '0' && c <= '9')
+            {
+                value = value * 16 + static_cast<uint32_t>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                value = value * 16 + static_cast<uint32_t>(c - 'a' + 10);
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                value = value * 16 + static_cast<uint32_t>(c - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+            mCursor += 1;
+        }
+        return true;
+    };
+
+    for (;;)
+    {
+        char c = this->peek();
+        if (c == '\0')
+        {
+            this->error("unterminated string");
+            return false;
+        }
+
+        mCursor += 1;
+        if (c == '"')
+        {
+            return true;
+        }
+
+        if (c != '\\')
+        {
+            if (out != nullptr)
+            {
+                out->push_back(c);
+            }
+            continue;
+        }
+
+        c = this->peek();
+        if (c == '\0')
+        {
+            this->error("unterminated string");
+            return false;
+        }
+
+        mCursor += 1;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'u': {
+            uint32_t codePoint;
+            if (!hex(codePoint))
+            {
+                this->error("invalid unicode escape sequence");
+                return false;
+            }
+
+            // Code points outside the basic multilingual plane are encoded as surrogate pairs.
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+            {
+                uint32_t low = 0;
+                bool valid = this->peek() == '\\';
+                if (valid)
+                {
+                    mCursor += 1;
+                    valid = this->peek() == 'u';
+                }
+                if (valid)
+                {
+                    mCursor += 1;
+                    valid = hex(low) && low >= 0xDC00 && low <= 0xDFFF;
+                }
+                if (!valid)
+                {
+                    this->error("invalid unicode surrogate pair");
+                    return false;
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            }
+
+            if (out != nullptr)
+            {
+                appendUtf8(*out, codePoint);
+            }
+            continue;
+        }
+        default:
+            this->error("invalid escape sequence");
+            return false;
+        }
+
+        if (out != nullptr)
+        {
+            out->push_back(c);
+        }
+    }
+}
+
+bool JSONDeserializer::expect(char c)
+{
+    this->skipWhitespace();
+    char found = this->peek();
+    if (found == c)
+    {
+        mCursor += 1;
+        return true;
+    }
+
+    if (found == '\0')
+    {
+        CUBOS_ERROR("Couldn't parse JSON at offset {}: expected '{}', found end of input", this->offset(), c);
+    }
+    else
+    {
+        CUBOS_ERROR("Couldn't parse JSON at offset {}: expected '{}', found '{}'", this->offset(), c, found);
+    }
+    mFailBit = true;
+    return false;
+}
+
+void JSONDeserializer::skipWhitespace()
+{
+    for (char c = this->peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = this->peek())
+    {
+        mCursor += 1;
+    }
+}
+
+char JSONDeserializer::peek()
+{
+    if (mCursor == mBuffer.size())
+    {
+        if (mStream == nullptr)
+        {
+            return '\0';
+        }
+
+        // Load the next chunk of the stream.
+        mBufferStart += mBuffer.size();
+        mBuffer.resize(ChunkSize);
+        mBuffer.resize(mStream->read(mBuffer.data(), ChunkSize));
+        mCursor = 0;
+
+        if (mBuffer.empty())
+        {
+            return '\0';
+        }
+    }
+
+    return mBuffer[mCursor];
+}
+
+std::size_t JSONDeserializer::offset() const
+{
+    return mBufferStart + mCursor;
+}
+
+void JSONDeserializer::rewind(std::size_t offset)
+{
+    if (offset >= mBufferStart && offset <= mBufferStart + mBuffer.size())
+    {
+        mCursor = offset - mBufferStart;
+        return;
+    }
+
+    // The position is no longer buffered, so we must seek back in the stream.
+    assert(mStream != nullptr);
+    mStream->seek(static_cast<ptrdiff_t>(offset), memory::SeekOrigin::Begin);
+    mBufferStart = offset;
+    mBuffer.clear();
+    mCursor = 0;
+}
+
+void JSONDeserializer::error(const char* what)
+{
+    CUBOS_ERROR("Couldn't parse JSON at offset {}: {}", this->offset(), what);
+    mFailBit = true;
 }
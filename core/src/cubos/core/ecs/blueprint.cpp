@@ -1,5 +1,10 @@
+#include <cstdlib>
+#include <new>
+
 #include <cubos/core/ecs/blueprint.hpp>
 #include <cubos/core/ecs/component/registry.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/reflection/type.hpp>
 
 using namespace cubos::core::ecs;
 
@@ -27,29 +32,20 @@ Entity Blueprint::entity(const std::string& name) const
     return mMap.getRef(name);
 }
 
-void Blueprint::merge(const std::string& prefix, const Blueprint& other)
+bool Blueprint::merge(const std::string& prefix, const Blueprint& other)
 {
-    // First, merge the maps.
-    data::old::SerializationMap<Entity, std::string, EntityHash> srcMap;
+    // First, merge the maps, keeping an index table from the other blueprint's entities to ours.
+    std::vector<Entity> entities;
+    entities.reserve(other.mMap.size());
     for (uint32_t i = 0; i < static_cast<uint32_t>(other.mMap.size()); ++i)
     {
-        // Deserialize from the source buffer using the original entity names.
-        // Serialize into the destination buffer using the prefixed entity names.
-
-        auto srcName = other.mMap.getId(Entity(i, 0));
-        auto dstName = prefix + ".";
-        dstName += srcName;
-
-        srcMap.add(Entity(static_cast<uint32_t>(mMap.size()), 0), srcName);
-        mMap.add(Entity(static_cast<uint32_t>(mMap.size()), 0), dstName);
+        auto name = prefix + ".";
+        name += other.mMap.getId(Entity(i, 0));
+        entities.push_back(this->addEntity(name));
     }
 
-    data::old::Context src;
-    data::old::Context dst;
-    src.push(srcMap);
-    dst.push(mMap);
-
     /// Then, merge the buffers.
+    bool success = true;
     for (const auto& buffer : other.mBuffers)
     {
         IBuffer* buf;
@@ -63,16 +59,276 @@ void Blueprint::merge(const std::string& prefix, const Blueprint& other)
             mBuffers.insert(*buffer.first, buf);
         }
 
-        buf->merge(buffer.second, prefix, src, dst);
+        success &= buf->merge(*buffer.second, entities);
     }
+
+    return success;
 }
 
 void Blueprint::clear()
 {
     mMap.clear();
+    mNames.reset();
     for (const auto& buffer : mBuffers)
     {
         delete buffer.second;
     }
     mBuffers.clear();
 }
+
+bool Blueprint::writeCompiled(memory::Stream& stream) const
+{
+    data::old::BinarySerializer ser{stream};
+
+    // Write the entity name table, in index order, so that names can be referred to by index.
+    std::vector<std::string> names;
+    names.reserve(mMap.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(mMap.size()); ++i)
+    {
+        names.push_back(mMap.getId(Entity(i, 0)));
+    }
+    ser.write(names, "entities");
+
+    // Write the component type table.
+    std::vector<std::string> types;
+    types.reserve(mBuffers.size());
+    for (const auto& buffer : mBuffers)
+    {
+        auto name = Registry::name(*buffer.first);
+        if (!name.has_value())
+        {
+            CUBOS_ERROR("Could not compile blueprint: component type '{}' is not registered",
+                        buffer.first->name());
+            return false;
+        }
+        types.emplace_back(*name);
+    }
+    ser.write(types, "types");
+
+    // Write the entity indices and the components of each buffer, in the same order as the types.
+    // Entity references inside the components are written as entity indices.
+    for (const auto& buffer : mBuffers)
+    {
+        ser.write(buffer.second->owners, "owners");
+        if (ser.failed() || !buffer.second->write(stream, mMap.size()))
+        {
+            CUBOS_ERROR("Could not compile blueprint: failed to write components of type '{}'",
+                        buffer.first->name());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Blueprint::readCompiled(memory::Stream& stream)
+{
+    this->clear();
+
+    data::old::BinaryDeserializer des{stream};
+
+    std::vector<std::string> names;
+    std::vector<std::string> types;
+    des.read(names);
+    des.read(types);
+    if (des.failed())
+    {
+        CUBOS_ERROR("Could not read compiled blueprint: invalid header");
+        return false;
+    }
+
+    for (const auto& name : names)
+    {
+        this->addEntity(name);
+    }
+
+    for (const auto& typeName : types)
+    {
+        const auto* type = Registry::type(typeName);
+        if (type == nullptr)
+        {
+            CUBOS_ERROR("Could not read compiled blueprint: component type '{}' is not registered", typeName);
+            this->clear();
+            return false;
+        }
+
+        auto* buffer = Registry::createBuffer(*type);
+        mBuffers.insert(*type, buffer);
+
+        std::vector<uint32_t> owners;
+        des.read(owners);
+        for (auto owner : owners)
+        {
+            if (owner >= names.size())
+            {
+                CUBOS_ERROR("Could not read compiled blueprint: entity index {} out of bounds", owner);
+                this->clear();
+                return false;
+            }
+        }
+
+        if (des.failed() || !buffer->read(stream, owners, names.size()))
+        {
+            CUBOS_ERROR("Could not read compiled blueprint: invalid block for component type '{}'", typeName);
+            this->clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Blueprint::IBuffer::findReferences(const void* component, std::size_t size,
+                                        void (*write)(data::old::Serializer&, const void*))
+{
+    /// Serializer which discards everything written to it.
+    class NullSerializer : public data::old::Serializer
+    {
+    public:
+        void writeI8(int8_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeI16(int16_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeI32(int32_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeI64(int64_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeU8(uint8_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeU16(uint16_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeU32(uint32_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeU64(uint64_t /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeF32(float /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeF64(double /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeBool(bool /*value*/, const char* /*name*/) override
+        {
+        }
+        void writeString(const char* /*str*/, const char* /*name*/) override
+        {
+        }
+        void beginObject(const char* /*name*/) override
+        {
+        }
+        void endObject() override
+        {
+        }
+        void beginArray(std::size_t /*length*/, const char* /*name*/) override
+        {
+        }
+        void endArray() override
+        {
+        }
+        void beginDictionary(std::size_t /*length*/, const char* /*name*/) override
+        {
+        }
+        void endDictionary() override
+        {
+        }
+    };
+
+    // Serialize the component and catch every non-null entity reference it writes. References
+    // which live inside the component itself can later be patched directly, through their offset.
+    References refs{static_cast<uint32_t>(this->offsets.size()), 0, true};
+    const auto* begin = static_cast<const char*>(component);
+    NullSerializer ser{};
+    ser.context().push(data::old::SerializationMap<Entity, std::string, EntityHash>{
+        [&](const Entity& entity, std::string& /*id*/) {
+            const auto* address = reinterpret_cast<const char*>(&entity);
+            if (address >= begin && address + sizeof(Entity) <= begin + size)
+            {
+                this->offsets.push_back(static_cast<uint32_t>(address - begin));
+                refs.count += 1;
+            }
+            else
+            {
+                refs.inPlace = false;
+            }
+            return true;
+        },
+        [](Entity& /*entity*/, const std::string& /*id*/) { return false; }});
+    write(ser, component);
+
+    this->references.push_back(refs);
+}
+
+void Blueprint::IBuffer::copyReferences(const IBuffer& other, std::size_t index)
+{
+    const auto& refs = other.references[index];
+    this->references.push_back({static_cast<uint32_t>(this->offsets.size()), refs.count, refs.inPlace});
+    this->offsets.insert(this->offsets.end(), other.offsets.begin() + refs.first,
+                         other.offsets.begin() + refs.first + refs.count);
+}
+
+bool Blueprint::IBuffer::patch(void* component, std::size_t index, const Entity* entities,
+                               std::size_t entityCount) const
+{
+    const auto& refs = this->references[index];
+    for (uint32_t i = refs.first; i < refs.first + refs.count; ++i)
+    {
+        auto* entity = std::launder(reinterpret_cast<Entity*>(static_cast<char*>(component) + this->offsets[i]));
+        if (entity->index >= entityCount)
+        {
+            return false;
+        }
+        *entity = entities[entity->index];
+    }
+
+    return true;
+}
+
+cubos::core::data::old::SerializationMap<Entity, std::string, EntityHash> Blueprint::IBuffer::indexMap(
+    const Entity* entities, std::size_t entityCount, bool& failed)
+{
+    return {[entityCount, &failed](const Entity& entity, std::string& id) {
+                if (entity.index >= entityCount)
+                {
+                    failed = true;
+                    id = "null";
+                }
+                else
+                {
+                    id = std::to_string(entity.index);
+                }
+                return true;
+            },
+            [entities, entityCount](Entity& entity, const std::string& id) {
+                char* end = nullptr;
+                auto index = std::strtoul(id.c_str(), &end, 10);
+                if (id.empty() || *end != '\0' || index >= entityCount)
+                {
+                    return false;
+                }
+
+                entity = entities[index];
+                return true;
+            }};
+}
+
+Entity Blueprint::addEntity(const std::string& name)
+{
+    auto entity = Entity(static_cast<uint32_t>(mMap.size()), 0);
+    mMap.add(entity, name);
+
+    // Builders of spawned instances may still hold the name table, and must not see it change.
+    if (mNames == nullptr || mNames.use_count() > 1)
+    {
+        mNames = mNames == nullptr ? std::make_shared<NameTable>() : std::make_shared<NameTable>(*mNames);
+    }
+    mNames->emplace(name, entity.index);
+    return entity;
+}
@@ -25,6 +25,17 @@ std::unique_ptr<IStorage> Registry::createStorage(const reflection::Type& type)
     return nullptr;
 }
 
+Blueprint::IBuffer* Registry::createBuffer(const reflection::Type& type)
+{
+    auto& creators = Registry::entriesByType();
+    if (creators.contains(type))
+    {
+        return creators.at(type)->bufferCreator();
+    }
+
+    return nullptr;
+}
+
 std::optional<std::string_view> Registry::name(const reflection::Type& type)
 {
     auto& entries = Registry::entriesByType();
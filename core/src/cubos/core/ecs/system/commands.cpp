@@ -15,9 +15,10 @@ Entity EntityBuilder::entity() const
     return mEntity;
 }
 
-BlueprintBuilder::BlueprintBuilder(data::old::SerializationMap<Entity, std::string, EntityHash>&& map,
+BlueprintBuilder::BlueprintBuilder(std::vector<Entity>&& entities, std::shared_ptr<const NameTable> names,
                                    CommandBuffer& commands)
-    : mMap(std::move(map))
+    : mEntities(std::move(entities))
+    , mNames(std::move(names))
     , mCommands(commands)
 {
     // Do nothing.
@@ -25,13 +26,14 @@ BlueprintBuilder::BlueprintBuilder(data::old::SerializationMap<Entity, std::stri
 
 Entity BlueprintBuilder::entity(const std::string& name) const
 {
-    if (!mMap.hasId(name))
+    auto it = mNames == nullptr ? NameTable::const_iterator{} : mNames->find(name);
+    if (mNames == nullptr || it == mNames->end())
     {
         CUBOS_CRITICAL("No entity with name '{}'", name);
         abort();
     }
 
-    return mMap.getRef(name);
+    return mEntities[it->second];
 }
 
 Commands::Commands(CommandBuffer& buffer)
@@ -50,6 +52,11 @@ BlueprintBuilder Commands::spawn(const Blueprint& blueprint)
     return mBuffer.spawn(blueprint);
 }
 
+std::vector<BlueprintBuilder> Commands::spawn(const Blueprint& blueprint, std::size_t count)
+{
+    return mBuffer.spawn(blueprint, count);
+}
+
 CommandBuffer::CommandBuffer(World& world)
     : mWorld(world)
 {
@@ -70,20 +77,42 @@ void CommandBuffer::destroy(Entity entity)
 
 BlueprintBuilder CommandBuffer::spawn(const Blueprint& blueprint)
 {
-    data::old::SerializationMap<Entity, std::string, EntityHash> map;
-    for (uint32_t i = 0; i < static_cast<uint32_t>(blueprint.mMap.size()); ++i)
+    return std::move(this->spawn(blueprint, 1).front());
+}
+
+std::vector<BlueprintBuilder> CommandBuffer::spawn(const Blueprint& blueprint, std::size_t count)
+{
+    std::vector<BlueprintBuilder> builders;
+    if (count == 0)
     {
-        map.add(this->create().entity(), blueprint.mMap.getId(Entity(i, 0)));
+        return builders;
+    }
+
+    // Create the entities of every instance, which are then indexed by instance and then by their
+    // index in the blueprint.
+    std::size_t size = blueprint.mMap.size();
+    std::vector<Entity> entities;
+    entities.reserve(size * count);
+    for (std::size_t i = 0; i < size * count; ++i)
+    {
+        entities.push_back(this->create().entity());
     }
 
-    data::old::Context context;
-    context.push(map);
     for (const auto& buf : blueprint.mBuffers)
     {
-        buf.second->addAll(*this, context);
+        buf.second->addAll(*this, entities, count);
+    }
+
+    // Every builder shares the same name table, which outlives the blueprint if needed.
+    builders.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto begin = entities.begin() + static_cast<std::ptrdiff_t>(i * size);
+        builders.push_back(BlueprintBuilder(std::vector<Entity>(begin, begin + static_cast<std::ptrdiff_t>(size)),
+                                            blueprint.mNames, *this));
     }
 
-    return {std::move(map), *this};
+    return builders;
 }
 
 void CommandBuffer::commit()
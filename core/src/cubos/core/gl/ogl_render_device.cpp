@@ -788,6 +788,15 @@ public:
         return glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
     }
 
+    void* mapRange(std::size_t offset, std::size_t size, bool discard) override
+    {
+        GLbitfield access = GL_MAP_WRITE_BIT;
+        access |= discard ? GL_MAP_INVALIDATE_BUFFER_BIT : (GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        glBindBuffer(GL_UNIFORM_BUFFER, this->id);
+        return glMapBufferRange(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                                access);
+    }
+
     void unmap() override
     {
         glUnmapBuffer(GL_UNIFORM_BUFFER);
@@ -822,6 +831,20 @@ public:
         glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
     }
 
+    void update(std::size_t offset, std::size_t size, const void* data) override
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    }
+
+    void copy(const impl::IndexBuffer& source, std::size_t sourceOffset, std::size_t offset, std::size_t size) override
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, static_cast<const OGLIndexBuffer&>(source).id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(sourceOffset),
+                            static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    }
+
     GLuint id;
     GLenum format;
     std::size_t indexSz;
@@ -851,6 +874,20 @@ public:
         glUnmapBuffer(GL_ARRAY_BUFFER);
     }
 
+    void update(std::size_t offset, std::size_t size, const void* data) override
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    }
+
+    void copy(const impl::VertexBuffer& source, std::size_t sourceOffset, std::size_t offset, std::size_t size) override
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, static_cast<const OGLVertexBuffer&>(source).id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(sourceOffset),
+                            static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    }
+
     GLuint id;
 };
 
@@ -1017,6 +1054,20 @@ public:
         }
     }
 
+    void bind(ConstantBuffer cb, std::size_t offset, std::size_t size) override
+    {
+        if (cb)
+        {
+            glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(this->loc),
+                              std::static_pointer_cast<OGLConstantBuffer>(cb)->id, static_cast<GLintptr>(offset),
+                              static_cast<GLsizeiptr>(size));
+        }
+        else
+        {
+            glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(this->loc), 0);
+        }
+    }
+
     void bind(gl::Texture2D tex, int level, Access access) override
     {
         auto texImpl = std::static_pointer_cast<OGLTexture2D>(tex);
@@ -2466,6 +2517,15 @@ void OGLRenderDevice::drawTrianglesIndexedInstanced(std::size_t offset, std::siz
                             static_cast<GLsizei>(instanceCount));
 }
 
+void OGLRenderDevice::drawTrianglesIndexedInstancedBaseVertex(std::size_t offset, std::size_t count,
+                                                              std::size_t instanceCount, std::size_t baseVertex)
+{
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(count),
+                                      static_cast<GLenum>(mCurrentIndexFormat),
+                                      reinterpret_cast<const void*>(offset * mCurrentIndexSz),
+                                      static_cast<GLsizei>(instanceCount), static_cast<GLint>(baseVertex));
+}
+
 void OGLRenderDevice::dispatchCompute(std::size_t x, std::size_t y, std::size_t z)
 {
     glDispatchCompute(static_cast<GLuint>(x), static_cast<GLuint>(y), static_cast<GLuint>(z));
@@ -2535,6 +2595,13 @@ int OGLRenderDevice::getProperty(Property prop)
         glGetIntegerv(GL_MINOR_VERSION, &minor);
         return (major >= 4 && minor >= 3) ? 1 : 0;
 
+    case Property::ConstantBufferOffsetAlignment:
+    {
+        GLint alignment;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        return alignment;
+    }
+
     default:
         return -1;
     }
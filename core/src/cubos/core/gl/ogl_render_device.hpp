@@ -45,6 +45,8 @@ namespace cubos::core::gl
         void drawTrianglesIndexed(std::size_t offset, std::size_t count) override;
         void drawTrianglesInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
         void drawTrianglesIndexedInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount) override;
+        void drawTrianglesIndexedInstancedBaseVertex(std::size_t offset, std::size_t count, std::size_t instanceCount,
+                                                     std::size_t baseVertex) override;
         void dispatchCompute(std::size_t x, std::size_t y, std::size_t z) override;
         void memoryBarrier(MemoryBarriers barriers) override;
         void setViewport(int x, int y, int w, int h) override;
@@ -0,0 +1,1279 @@
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include <cubos/core/gl/recording_render_device.hpp>
+#include <cubos/core/log.hpp>
+
+using namespace cubos::core::gl;
+
+using Call = RecordingRenderDevice::Call;
+
+namespace cubos::core::gl
+{
+    /// @brief Base class of the objects created by @ref RecordingRenderDevice.
+    /// @tparam T Interface implemented by the object.
+    template <typename T>
+    class RecordedObject : public T
+    {
+    public:
+        RecordedObject(RecordingRenderDevice& device, std::string label)
+            : mDevice(device)
+            , mId(device.create(std::move(label)))
+        {
+        }
+
+        std::size_t id() const
+        {
+            return mId;
+        }
+
+    protected:
+        void record(Call call, int64_t a = 0, int64_t b = 0, int64_t c = 0, int64_t d = 0)
+        {
+            mDevice.record(call, mId, a, b, c, d);
+        }
+
+        RecordingRenderDevice::Stats& stats()
+        {
+            return mDevice.mStats;
+        }
+
+        void fail()
+        {
+            mDevice.fail();
+        }
+
+        RecordingRenderDevice& mDevice;
+        std::size_t mId;
+    };
+} // namespace cubos::core::gl
+
+/// @brief Alignment reported for constant buffer range offsets, which is the largest required by
+/// common GPUs, so that offsets which pass validation work everywhere.
+static constexpr std::size_t ConstantBufferOffsetAlignment = 256;
+
+/// @brief Gets the identifier of an object created by a recording device.
+/// @tparam T Object interface.
+/// @param handle Object handle.
+/// @return Identifier, or 0 if the handle is null.
+template <typename T>
+static std::size_t idOf(const std::shared_ptr<T>& handle)
+{
+    return handle == nullptr ? 0 : static_cast<const RecordedObject<T>&>(*handle).id();
+}
+
+static bool isDepthFormat(TextureFormat format)
+{
+    return format == TextureFormat::Depth16 || format == TextureFormat::Depth32 ||
+           format == TextureFormat::Depth24Stencil8 || format == TextureFormat::Depth32Stencil8;
+}
+
+/// @brief Gets the size of a texel in the given format, in bytes.
+/// @param format Texture format.
+/// @return Texel size.
+static std::size_t texelSize(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::R8SNorm:
+    case TextureFormat::R8UNorm:
+    case TextureFormat::R8SInt:
+    case TextureFormat::R8UInt:
+        return 1;
+    case TextureFormat::R16SNorm:
+    case TextureFormat::RG8SNorm:
+    case TextureFormat::R16UNorm:
+    case TextureFormat::RG8UNorm:
+    case TextureFormat::R16SInt:
+    case TextureFormat::RG8SInt:
+    case TextureFormat::R16UInt:
+    case TextureFormat::RG8UInt:
+    case TextureFormat::R16Float:
+    case TextureFormat::Depth16:
+        return 2;
+    case TextureFormat::RG16SNorm:
+    case TextureFormat::RGBA8SNorm:
+    case TextureFormat::RG16UNorm:
+    case TextureFormat::RGBA8UNorm:
+    case TextureFormat::RG16SInt:
+    case TextureFormat::RGBA8SInt:
+    case TextureFormat::RG16UInt:
+    case TextureFormat::RGBA8UInt:
+    case TextureFormat::R32Float:
+    case TextureFormat::RG16Float:
+    case TextureFormat::Depth32:
+    case TextureFormat::Depth24Stencil8:
+        return 4;
+    case TextureFormat::RGB16Float:
+        return 6;
+    case TextureFormat::RGBA16SNorm:
+    case TextureFormat::RGBA16UNorm:
+    case TextureFormat::RGBA16SInt:
+    case TextureFormat::RGBA16UInt:
+    case TextureFormat::RG32Float:
+    case TextureFormat::RGBA16Float:
+    case TextureFormat::Depth32Stencil8:
+        return 8;
+    case TextureFormat::RGB32Float:
+        return 12;
+    case TextureFormat::RGBA32Float:
+        return 16;
+    }
+
+    abort(); // Invalid enum value
+}
+
+namespace
+{
+    /// @brief Dimensions and format of a texture, used for validation.
+    struct TextureInfo
+    {
+        TextureFormat format;
+        std::size_t width;
+        std::size_t height;
+        std::size_t depth;  ///< Depth, which is halved on each mip level.
+        std::size_t layers; ///< Number of layers, which isn't affected by mip levels.
+        std::size_t levels;
+    };
+
+    class RecordingFramebuffer final : public RecordedObject<impl::Framebuffer>
+    {
+    public:
+        RecordingFramebuffer(RecordingRenderDevice& device)
+            : RecordedObject(device, "Framebuffer")
+        {
+        }
+    };
+
+    class RecordingRasterState final : public RecordedObject<impl::RasterState>
+    {
+    public:
+        RecordingRasterState(RecordingRenderDevice& device)
+            : RecordedObject(device, "RasterState")
+        {
+        }
+    };
+
+    class RecordingDepthStencilState final : public RecordedObject<impl::DepthStencilState>
+    {
+    public:
+        RecordingDepthStencilState(RecordingRenderDevice& device)
+            : RecordedObject(device, "DepthStencilState")
+        {
+        }
+    };
+
+    class RecordingBlendState final : public RecordedObject<impl::BlendState>
+    {
+    public:
+        RecordingBlendState(RecordingRenderDevice& device)
+            : RecordedObject(device, "BlendState")
+        {
+        }
+    };
+
+    class RecordingSampler final : public RecordedObject<impl::Sampler>
+    {
+    public:
+        RecordingSampler(RecordingRenderDevice& device)
+            : RecordedObject(device, "Sampler")
+        {
+        }
+    };
+
+    template <typename T>
+    class RecordingTexture : public RecordedObject<T>
+    {
+    public:
+        RecordingTexture(RecordingRenderDevice& device, std::string label, TextureInfo info)
+            : RecordedObject<T>(device, std::move(label))
+            , mInfo(info)
+        {
+        }
+
+        const TextureInfo& info() const
+        {
+            return mInfo;
+        }
+
+        void generateMipmaps() override
+        {
+            this->record(Call::GenerateMipmaps);
+        }
+
+    protected:
+        /// @brief Validates and records an update of a region of the texture.
+        void updateRegion(std::size_t x, std::size_t y, std::size_t z, std::size_t width, std::size_t height,
+                          std::size_t depth, std::size_t layer, const void* data, std::size_t level)
+        {
+            if (level >= mInfo.levels)
+            {
+                CUBOS_ERROR("Texture has {} mip levels, can't update level {}", mInfo.levels, level);
+                this->fail();
+                return;
+            }
+
+            auto levelWidth = std::max<std::size_t>(1, mInfo.width >> level);
+            auto levelHeight = std::max<std::size_t>(1, mInfo.height >> level);
+            auto levelDepth = std::max<std::size_t>(1, mInfo.depth >> level);
+            if (data == nullptr || x + width > levelWidth || y + height > levelHeight || z + depth > levelDepth ||
+                layer >= mInfo.layers)
+            {
+                CUBOS_ERROR("Invalid texture update region or data");
+                this->fail();
+                return;
+            }
+
+            auto bytes = width * height * depth * texelSize(mInfo.format);
+            this->stats().bytesUploaded += bytes;
+            this->record(Call::UpdateTexture, static_cast<int64_t>(bytes), static_cast<int64_t>(level));
+        }
+
+    private:
+        TextureInfo mInfo;
+    };
+
+    class RecordingTexture1D final : public RecordingTexture<impl::Texture1D>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t width, const void* data, std::size_t level) override
+        {
+            this->updateRegion(x, 0, 0, width, 1, 1, 0, data, level);
+        }
+    };
+
+    class RecordingTexture2D final : public RecordingTexture<impl::Texture2D>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t y, std::size_t width, std::size_t height, const void* data,
+                    std::size_t level) override
+        {
+            this->updateRegion(x, y, 0, width, height, 1, 0, data, level);
+        }
+    };
+
+    class RecordingTexture2DArray final : public RecordingTexture<impl::Texture2DArray>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t y, std::size_t i, std::size_t width, std::size_t height,
+                    const void* data, std::size_t level) override
+        {
+            this->updateRegion(x, y, 0, width, height, 1, i, data, level);
+        }
+    };
+
+    class RecordingTexture3D final : public RecordingTexture<impl::Texture3D>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t y, std::size_t z, std::size_t width, std::size_t height,
+                    std::size_t depth, const void* data, std::size_t level) override
+        {
+            this->updateRegion(x, y, z, width, height, depth, 0, data, level);
+        }
+    };
+
+    class RecordingCubeMap final : public RecordingTexture<impl::CubeMap>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t y, std::size_t width, std::size_t height, const void* data,
+                    CubeFace face, std::size_t level) override
+        {
+            this->updateRegion(x, y, 0, width, height, 1, static_cast<std::size_t>(face), data, level);
+        }
+    };
+
+    class RecordingCubeMapArray final : public RecordingTexture<impl::CubeMapArray>
+    {
+    public:
+        using RecordingTexture::RecordingTexture;
+
+        void update(std::size_t x, std::size_t y, std::size_t i, std::size_t width, std::size_t height,
+                    const void* data, CubeFace face, std::size_t level) override
+        {
+            this->updateRegion(x, y, 0, width, height, 1, i * 6 + static_cast<std::size_t>(face), data, level);
+        }
+    };
+
+    template <typename T>
+    class RecordingBuffer : public RecordedObject<T>
+    {
+    public:
+        RecordingBuffer(RecordingRenderDevice& device, std::string label, std::size_t size)
+            : RecordedObject<T>(device, std::move(label))
+            , mSize(size)
+        {
+        }
+
+        void* map() override
+        {
+            return this->mapRegion(0, mSize);
+        }
+
+        void unmap() override
+        {
+            if (!mMapped)
+            {
+                CUBOS_ERROR("Buffer isn't mapped");
+                this->fail();
+                return;
+            }
+
+            mMapped = false;
+            this->stats().unmaps += 1;
+            this->stats().bytesUploaded += mMappedSize;
+            this->record(Call::Unmap, static_cast<int64_t>(mMappedSize));
+        }
+
+    protected:
+        /// @brief Validates and records an update of a range of the buffer.
+        void updateRegion(std::size_t offset, std::size_t size, const void* data)
+        {
+            if (mMapped || data == nullptr || offset + size > mSize)
+            {
+                CUBOS_ERROR("Invalid buffer update range [{}, {}) or data, on a buffer of {} bytes", offset,
+                            offset + size, mSize);
+                this->fail();
+                return;
+            }
+
+            this->stats().bytesUploaded += size;
+            this->record(Call::UpdateBuffer, static_cast<int64_t>(offset), static_cast<int64_t>(size));
+        }
+
+        /// @brief Validates and records a copy of a range of another buffer to this one.
+        void copyRegion(const RecordingBuffer& source, std::size_t sourceOffset, std::size_t offset,
+                        std::size_t size)
+        {
+            if (&source == this || mMapped || source.mMapped || sourceOffset + size > source.mSize ||
+                offset + size > mSize)
+            {
+                CUBOS_ERROR("Invalid buffer copy of {} bytes from offset {} of a buffer of {} bytes to offset {} "
+                            "of a buffer of {} bytes",
+                            size, sourceOffset, source.mSize, offset, mSize);
+                this->fail();
+                return;
+            }
+
+            this->record(Call::CopyBuffer, static_cast<int64_t>(source.id()), static_cast<int64_t>(sourceOffset),
+                         static_cast<int64_t>(offset), static_cast<int64_t>(size));
+        }
+
+        void* mapRegion(std::size_t offset, std::size_t size)
+        {
+            if (mMapped)
+            {
+                CUBOS_ERROR("Buffer is already mapped");
+                this->fail();
+                return nullptr;
+            }
+
+            if (offset + size > mSize)
+            {
+                CUBOS_ERROR("Mapped range [{}, {}) is out of the buffer's bounds ({} bytes)", offset, offset + size,
+                            mSize);
+                this->fail();
+                return nullptr;
+            }
+
+            // Only buffers which are mapped need storage, as initial data isn't kept.
+            mStorage.resize(mSize);
+            mMapped = true;
+            mMappedSize = size;
+            this->stats().maps += 1;
+            this->record(Call::Map, static_cast<int64_t>(offset));
+            return mStorage.data() + offset;
+        }
+
+    private:
+        std::size_t mSize;
+        std::vector<unsigned char> mStorage;
+        bool mMapped{false};
+        std::size_t mMappedSize{0};
+    };
+
+    class RecordingConstantBuffer final : public RecordingBuffer<impl::ConstantBuffer>
+    {
+    public:
+        RecordingConstantBuffer(RecordingRenderDevice& device, std::size_t size)
+            : RecordingBuffer(device, "ConstantBuffer", size)
+        {
+        }
+
+        void* mapRange(std::size_t offset, std::size_t size, bool /*discard*/) override
+        {
+            return this->mapRegion(offset, size);
+        }
+    };
+
+    class RecordingIndexBuffer final : public RecordingBuffer<impl::IndexBuffer>
+    {
+    public:
+        RecordingIndexBuffer(RecordingRenderDevice& device, std::size_t size, std::size_t indexCount)
+            : RecordingBuffer(device, "IndexBuffer", size)
+            , count(indexCount)
+        {
+        }
+
+        void update(std::size_t offset, std::size_t size, const void* data) override
+        {
+            this->updateRegion(offset, size, data);
+        }
+
+        void copy(const impl::IndexBuffer& source, std::size_t sourceOffset, std::size_t offset,
+                  std::size_t size) override
+        {
+            this->copyRegion(static_cast<const RecordingIndexBuffer&>(source), sourceOffset, offset, size);
+        }
+
+        std::size_t count; ///< Number of indices in the buffer.
+    };
+
+    class RecordingVertexBuffer final : public RecordingBuffer<impl::VertexBuffer>
+    {
+    public:
+        RecordingVertexBuffer(RecordingRenderDevice& device, std::size_t size)
+            : RecordingBuffer(device, "VertexBuffer", size)
+        {
+        }
+
+        void update(std::size_t offset, std::size_t size, const void* data) override
+        {
+            this->updateRegion(offset, size, data);
+        }
+
+        void copy(const impl::VertexBuffer& source, std::size_t sourceOffset, std::size_t offset,
+                  std::size_t size) override
+        {
+            this->copyRegion(static_cast<const RecordingVertexBuffer&>(source), sourceOffset, offset, size);
+        }
+    };
+
+    class RecordingVertexArray final : public RecordedObject<impl::VertexArray>
+    {
+    public:
+        RecordingVertexArray(RecordingRenderDevice& device)
+            : RecordedObject(device, "VertexArray")
+        {
+        }
+    };
+
+    class RecordingShaderStage final : public RecordedObject<impl::ShaderStage>
+    {
+    public:
+        RecordingShaderStage(RecordingRenderDevice& device, Stage stage)
+            : RecordedObject(device, "ShaderStage")
+            , mStage(stage)
+        {
+        }
+
+        Stage getType() override
+        {
+            return mStage;
+        }
+
+    private:
+        Stage mStage;
+    };
+
+    class RecordingShaderBindingPoint final : public RecordedObject<impl::ShaderBindingPoint>
+    {
+    public:
+        RecordingShaderBindingPoint(RecordingRenderDevice& device, std::string name)
+            : RecordedObject(device, std::move(name))
+        {
+        }
+
+        void bind(Sampler sampler) override
+        {
+            this->bindObject(idOf(sampler));
+        }
+
+        void bind(Texture1D tex) override
+        {
+            this->bindObject(idOf(tex));
+        }
+
+        void bind(Texture2D tex) override
+        {
+            this->bindObject(idOf(tex));
+        }
+
+        void bind(Texture2DArray tex) override
+        {
+            this->bindObject(idOf(tex));
+        }
+
+        void bind(Texture3D tex) override
+        {
+            this->bindObject(idOf(tex));
+        }
+
+        void bind(CubeMap cubeMap) override
+        {
+            this->bindObject(idOf(cubeMap));
+        }
+
+        void bind(CubeMapArray cubeMap) override
+        {
+            this->bindObject(idOf(cubeMap));
+        }
+
+        void bind(ConstantBuffer cb) override
+        {
+            this->bindObject(idOf(cb));
+        }
+
+        void bind(ConstantBuffer cb, std::size_t offset, std::size_t size) override
+        {
+            if (offset % ConstantBufferOffsetAlignment != 0)
+            {
+                CUBOS_ERROR("Constant buffer range offset {} isn't a multiple of {}", offset,
+                            ConstantBufferOffsetAlignment);
+                this->fail();
+                return;
+            }
+
+            this->bindObject(idOf(cb), static_cast<int64_t>(offset), static_cast<int64_t>(size));
+        }
+
+        void bind(Texture2D tex, int level, Access access) override
+        {
+            this->bindObject(idOf(tex), level, static_cast<int64_t>(access));
+        }
+
+        void setConstant(glm::vec2 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::vec3 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::vec4 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::ivec2 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::ivec3 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::ivec4 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::uvec2 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::uvec3 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::uvec4 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(glm::mat4 /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(float /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(int /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        void setConstant(unsigned int /*val*/) override
+        {
+            this->setConstant();
+        }
+
+        bool queryConstantBufferStructure(ConstantBufferStructure* /*structure*/) override
+        {
+            // Shaders aren't compiled, so the layout of their constant buffers is unknown.
+            return false;
+        }
+
+    private:
+        void bindObject(std::size_t object, int64_t level = 0, int64_t access = 0)
+        {
+            this->stats().stateChanges += 1;
+            this->record(Call::Bind, static_cast<int64_t>(object), level, access);
+        }
+
+        void setConstant()
+        {
+            this->stats().stateChanges += 1;
+            this->record(Call::SetConstant);
+        }
+    };
+
+    class RecordingShaderPipeline final : public RecordedObject<impl::ShaderPipeline>
+    {
+    public:
+        RecordingShaderPipeline(RecordingRenderDevice& device, bool isCompute)
+            : RecordedObject(device, "ShaderPipeline")
+            , compute(isCompute)
+        {
+        }
+
+        ShaderBindingPoint getBindingPoint(const char* name) override
+        {
+            // Shaders aren't compiled, so every name is assumed to exist.
+            auto& bp = mBindingPoints[name];
+            if (bp == nullptr)
+            {
+                bp = std::make_unique<RecordingShaderBindingPoint>(mDevice, name);
+            }
+            return bp.get();
+        }
+
+        bool compute; ///< Whether the pipeline is a compute pipeline.
+
+    private:
+        std::unordered_map<std::string, std::unique_ptr<RecordingShaderBindingPoint>> mBindingPoints;
+    };
+} // namespace
+
+/// @brief Gets the texture info of a framebuffer target.
+/// @param target Target.
+/// @return Texture info, or nullptr if the target's handle is null.
+static const TextureInfo* targetInfo(const FramebufferDesc::FramebufferTarget& target)
+{
+    switch (target.getTargetType())
+    {
+    case FramebufferDesc::TargetType::CubeMap:
+        if (const auto& handle = target.getCubeMapTarget().handle)
+        {
+            return &std::static_pointer_cast<RecordingCubeMap>(handle)->info();
+        }
+        break;
+    case FramebufferDesc::TargetType::Texture2D:
+        if (const auto& handle = target.getTexture2DTarget().handle)
+        {
+            return &std::static_pointer_cast<RecordingTexture2D>(handle)->info();
+        }
+        break;
+    case FramebufferDesc::TargetType::CubeMapArray:
+        if (const auto& handle = target.getCubeMapArrayTarget().handle)
+        {
+            return &std::static_pointer_cast<RecordingCubeMapArray>(handle)->info();
+        }
+        break;
+    case FramebufferDesc::TargetType::Texture2DArray:
+        if (const auto& handle = target.getTexture2DArrayTarget().handle)
+        {
+            return &std::static_pointer_cast<RecordingTexture2DArray>(handle)->info();
+        }
+        break;
+    }
+
+    return nullptr;
+}
+
+/// @brief Validates the common fields of a texture descriptor.
+/// @return Whether the fields are valid.
+static bool validateTexture(std::size_t width, std::size_t height, std::size_t depth, std::size_t levels)
+{
+    if (width == 0 || height == 0 || depth == 0)
+    {
+        CUBOS_ERROR("Textures must have a non-zero size");
+        return false;
+    }
+
+    if (levels == 0 || levels > CUBOS_CORE_GL_MAX_MIP_LEVEL_COUNT)
+    {
+        CUBOS_ERROR("Textures must have between 1 and {} mip levels", CUBOS_CORE_GL_MAX_MIP_LEVEL_COUNT);
+        return false;
+    }
+
+    return true;
+}
+
+RecordingRenderDevice::RecordingRenderDevice() = default;
+
+const std::vector<RecordingRenderDevice::Command>& RecordingRenderDevice::commands() const
+{
+    return mCommands;
+}
+
+const RecordingRenderDevice::Stats& RecordingRenderDevice::stats() const
+{
+    return mStats;
+}
+
+const std::string& RecordingRenderDevice::label(std::size_t object) const
+{
+    static const std::string Empty;
+    return object == 0 || object > mLabels.size() ? Empty : mLabels[object - 1];
+}
+
+void RecordingRenderDevice::logCommands(bool enabled)
+{
+    mLogCommands = enabled;
+}
+
+void RecordingRenderDevice::clear()
+{
+    mCommands.clear();
+    mStats = {};
+}
+
+Framebuffer RecordingRenderDevice::createFramebuffer(const FramebufferDesc& desc)
+{
+    if (desc.targetCount == 0 || desc.targetCount > CUBOS_CORE_GL_MAX_FRAMEBUFFER_RENDER_TARGET_COUNT)
+    {
+        CUBOS_ERROR("Framebuffer must have between 1 and {} render targets",
+                    CUBOS_CORE_GL_MAX_FRAMEBUFFER_RENDER_TARGET_COUNT);
+        this->fail();
+        return nullptr;
+    }
+
+    for (uint32_t i = 0; i < desc.targetCount; ++i)
+    {
+        const auto* info = desc.targets[i].isSet() ? targetInfo(desc.targets[i]) : nullptr;
+        if (info == nullptr)
+        {
+            CUBOS_ERROR("Target {} is nullptr", i);
+            this->fail();
+            return nullptr;
+        }
+
+        if (isDepthFormat(info->format) || desc.targets[i].mipLevel >= info->levels)
+        {
+            CUBOS_ERROR("Target {} must be a color texture with mip level {}", i, desc.targets[i].mipLevel);
+            this->fail();
+            return nullptr;
+        }
+    }
+
+    if (desc.depthStencil.isSet())
+    {
+        const auto* info = targetInfo(desc.depthStencil);
+        if (info == nullptr || !isDepthFormat(info->format))
+        {
+            CUBOS_ERROR("Invalid depth stencil target format");
+            this->fail();
+            return nullptr;
+        }
+    }
+
+    return std::make_shared<RecordingFramebuffer>(*this);
+}
+
+void RecordingRenderDevice::setFramebuffer(Framebuffer fb)
+{
+    this->changeState(Call::SetFramebuffer, mFramebuffer, idOf(fb));
+}
+
+RasterState RecordingRenderDevice::createRasterState(const RasterStateDesc& /*desc*/)
+{
+    return std::make_shared<RecordingRasterState>(*this);
+}
+
+void RecordingRenderDevice::setRasterState(RasterState rs)
+{
+    this->changeState(Call::SetRasterState, mRasterState, idOf(rs));
+}
+
+DepthStencilState RecordingRenderDevice::createDepthStencilState(const DepthStencilStateDesc& /*desc*/)
+{
+    return std::make_shared<RecordingDepthStencilState>(*this);
+}
+
+void RecordingRenderDevice::setDepthStencilState(DepthStencilState dss)
+{
+    this->changeState(Call::SetDepthStencilState, mDepthStencilState, idOf(dss));
+}
+
+BlendState RecordingRenderDevice::createBlendState(const BlendStateDesc& /*desc*/)
+{
+    return std::make_shared<RecordingBlendState>(*this);
+}
+
+void RecordingRenderDevice::setBlendState(BlendState bs)
+{
+    this->changeState(Call::SetBlendState, mBlendState, idOf(bs));
+}
+
+Sampler RecordingRenderDevice::createSampler(const SamplerDesc& desc)
+{
+    if (desc.maxAnisotropy == 0 ||
+        desc.maxAnisotropy > static_cast<std::size_t>(this->getProperty(Property::MaxAnisotropy)))
+    {
+        CUBOS_ERROR("Sampler max anisotropy must be between 1 and {}", this->getProperty(Property::MaxAnisotropy));
+        this->fail();
+        return nullptr;
+    }
+
+    return std::make_shared<RecordingSampler>(*this);
+}
+
+Texture1D RecordingRenderDevice::createTexture1D(const Texture1DDesc& desc)
+{
+    if (!validateTexture(desc.width, 1, 1, desc.mipLevelCount) || isDepthFormat(desc.format))
+    {
+        CUBOS_ERROR("Invalid 1D texture descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, 1, 1, 1, desc.mipLevelCount};
+    for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+    {
+        mStats.bytesUploaded += desc.data[i] == nullptr ? 0 : (desc.width >> i) * texelSize(desc.format);
+    }
+    return std::make_shared<RecordingTexture1D>(*this, "Texture1D", info);
+}
+
+Texture2D RecordingRenderDevice::createTexture2D(const Texture2DDesc& desc)
+{
+    if (!validateTexture(desc.width, desc.height, 1, desc.mipLevelCount))
+    {
+        CUBOS_ERROR("Invalid 2D texture descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, desc.height, 1, 1, desc.mipLevelCount};
+    for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+    {
+        mStats.bytesUploaded +=
+            desc.data[i] == nullptr ? 0 : (desc.width >> i) * (desc.height >> i) * texelSize(desc.format);
+    }
+    return std::make_shared<RecordingTexture2D>(*this, "Texture2D", info);
+}
+
+Texture2DArray RecordingRenderDevice::createTexture2DArray(const Texture2DArrayDesc& desc)
+{
+    if (!validateTexture(desc.width, desc.height, desc.size, desc.mipLevelCount) ||
+        desc.size > CUBOS_CORE_GL_MAX_TEXTURE_2D_ARRAY_SIZE)
+    {
+        CUBOS_ERROR("Invalid 2D texture array descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, desc.height, 1, desc.size, desc.mipLevelCount};
+    for (std::size_t layer = 0; layer < desc.size; ++layer)
+    {
+        for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+        {
+            mStats.bytesUploaded += desc.data[layer][i] == nullptr
+                                        ? 0
+                                        : (desc.width >> i) * (desc.height >> i) * texelSize(desc.format);
+        }
+    }
+    return std::make_shared<RecordingTexture2DArray>(*this, "Texture2DArray", info);
+}
+
+Texture3D RecordingRenderDevice::createTexture3D(const Texture3DDesc& desc)
+{
+    if (!validateTexture(desc.width, desc.height, desc.depth, desc.mipLevelCount) || isDepthFormat(desc.format))
+    {
+        CUBOS_ERROR("Invalid 3D texture descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, desc.height, desc.depth, 1, desc.mipLevelCount};
+    for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+    {
+        mStats.bytesUploaded += desc.data[i] == nullptr ? 0
+                                                        : (desc.width >> i) * (desc.height >> i) * (desc.depth >> i) *
+                                                              texelSize(desc.format);
+    }
+    return std::make_shared<RecordingTexture3D>(*this, "Texture3D", info);
+}
+
+CubeMap RecordingRenderDevice::createCubeMap(const CubeMapDesc& desc)
+{
+    if (!validateTexture(desc.width, desc.height, 1, desc.mipLevelCount))
+    {
+        CUBOS_ERROR("Invalid cube map descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, desc.height, 1, 6, desc.mipLevelCount};
+    for (const auto& face : desc.data)
+    {
+        for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+        {
+            mStats.bytesUploaded +=
+                face[i] == nullptr ? 0 : (desc.width >> i) * (desc.height >> i) * texelSize(desc.format);
+        }
+    }
+    return std::make_shared<RecordingCubeMap>(*this, "CubeMap", info);
+}
+
+CubeMapArray RecordingRenderDevice::createCubeMapArray(const CubeMapArrayDesc& desc)
+{
+    if (!validateTexture(desc.width, desc.height, desc.size, desc.mipLevelCount) ||
+        desc.size > CUBOS_CORE_GL_MAX_CUBEMAP_ARRAY_SIZE)
+    {
+        CUBOS_ERROR("Invalid cube map array descriptor");
+        this->fail();
+        return nullptr;
+    }
+
+    auto info = TextureInfo{desc.format, desc.width, desc.height, 1, desc.size * 6, desc.mipLevelCount};
+    for (std::size_t cube = 0; cube < desc.size; ++cube)
+    {
+        for (const auto& face : desc.data[cube])
+        {
+            for (std::size_t i = 0; i < desc.mipLevelCount; ++i)
+            {
+                mStats.bytesUploaded +=
+                    face[i] == nullptr ? 0 : (desc.width >> i) * (desc.height >> i) * texelSize(desc.format);
+            }
+        }
+    }
+    return std::make_shared<RecordingCubeMapArray>(*this, "CubeMapArray", info);
+}
+
+ConstantBuffer RecordingRenderDevice::createConstantBuffer(std::size_t size, const void* data, Usage usage)
+{
+    if (size == 0 || (usage == Usage::Static && data == nullptr))
+    {
+        CUBOS_ERROR("Constant buffers must be non-empty, and static ones must have initial data");
+        this->fail();
+        return nullptr;
+    }
+
+    mStats.bytesUploaded += data == nullptr ? 0 : size;
+    return std::make_shared<RecordingConstantBuffer>(*this, size);
+}
+
+IndexBuffer RecordingRenderDevice::createIndexBuffer(std::size_t size, const void* data, IndexFormat format,
+                                                     Usage usage)
+{
+    std::size_t indexSize = format == IndexFormat::UShort ? 2 : 4;
+    if (size % indexSize != 0 || (usage == Usage::Static && data == nullptr))
+    {
+        CUBOS_ERROR("Index buffer size must be a multiple of the index size, and static ones must have initial data");
+        this->fail();
+        return nullptr;
+    }
+
+    mStats.bytesUploaded += data == nullptr ? 0 : size;
+    return std::make_shared<RecordingIndexBuffer>(*this, size, size / indexSize);
+}
+
+void RecordingRenderDevice::setIndexBuffer(IndexBuffer ib)
+{
+    this->changeState(Call::SetIndexBuffer, mIndexBuffer, idOf(ib));
+    mIndexCount = ib == nullptr ? 0 : std::static_pointer_cast<RecordingIndexBuffer>(ib)->count;
+}
+
+VertexBuffer RecordingRenderDevice::createVertexBuffer(std::size_t size, const void* data, Usage usage)
+{
+    if (usage == Usage::Static && data == nullptr)
+    {
+        CUBOS_ERROR("Static vertex buffers must have initial data");
+        this->fail();
+        return nullptr;
+    }
+
+    mStats.bytesUploaded += data == nullptr ? 0 : size;
+    return std::make_shared<RecordingVertexBuffer>(*this, size);
+}
+
+VertexArray RecordingRenderDevice::createVertexArray(const VertexArrayDesc& desc)
+{
+    if (desc.shaderPipeline == nullptr)
+    {
+        CUBOS_ERROR("Vertex arrays must have a shader pipeline");
+        this->fail();
+        return nullptr;
+    }
+
+    if (desc.elementCount == 0 || desc.elementCount > CUBOS_CORE_GL_MAX_VERTEX_ARRAY_ELEMENT_COUNT)
+    {
+        CUBOS_ERROR("Vertex arrays must have between 1 and {} elements", CUBOS_CORE_GL_MAX_VERTEX_ARRAY_ELEMENT_COUNT);
+        this->fail();
+        return nullptr;
+    }
+
+    for (std::size_t i = 0; i < desc.elementCount; ++i)
+    {
+        const auto& element = desc.elements[i];
+        if (element.name == nullptr || element.size == 0 || element.size > 4 ||
+            element.buffer.index >= CUBOS_CORE_GL_MAX_VERTEX_ARRAY_BUFFER_COUNT ||
+            desc.buffers[element.buffer.index] == nullptr)
+        {
+            CUBOS_ERROR("Vertex element {} must have a name, 1 to 4 components and an existing buffer", i);
+            this->fail();
+            return nullptr;
+        }
+    }
+
+    return std::make_shared<RecordingVertexArray>(*this);
+}
+
+void RecordingRenderDevice::setVertexArray(VertexArray va)
+{
+    this->changeState(Call::SetVertexArray, mVertexArray, idOf(va));
+}
+
+ShaderStage RecordingRenderDevice::createShaderStage(Stage stage, const char* src)
+{
+    if (src == nullptr)
+    {
+        CUBOS_ERROR("Shader stages must have source code");
+        this->fail();
+        return nullptr;
+    }
+
+    return std::make_shared<RecordingShaderStage>(*this, stage);
+}
+
+ShaderPipeline RecordingRenderDevice::createShaderPipeline(ShaderStage vs, ShaderStage ps)
+{
+    if (vs == nullptr || ps == nullptr || vs->getType() != Stage::Vertex || ps->getType() != Stage::Pixel)
+    {
+        CUBOS_ERROR("Shader pipelines must have a vertex and a pixel stage");
+        this->fail();
+        return nullptr;
+    }
+
+    return std::make_shared<RecordingShaderPipeline>(*this, false);
+}
+
+ShaderPipeline RecordingRenderDevice::createShaderPipeline(ShaderStage vs, ShaderStage gs, ShaderStage ps)
+{
+    if (gs == nullptr || gs->getType() != Stage::Geometry)
+    {
+        CUBOS_ERROR("Geometry stage is missing or isn't a geometry stage");
+        this->fail();
+        return nullptr;
+    }
+
+    return this->createShaderPipeline(std::move(vs), std::move(ps));
+}
+
+ShaderPipeline RecordingRenderDevice::createShaderPipeline(ShaderStage cs)
+{
+    if (cs == nullptr || cs->getType() != Stage::Compute)
+    {
+        CUBOS_ERROR("Compute pipelines must have a compute stage");
+        this->fail();
+        return nullptr;
+    }
+
+    return std::make_shared<RecordingShaderPipeline>(*this, true);
+}
+
+void RecordingRenderDevice::setShaderPipeline(ShaderPipeline pipeline)
+{
+    this->changeState(Call::SetShaderPipeline, mShaderPipeline, idOf(pipeline));
+    mComputePipeline = pipeline != nullptr && std::static_pointer_cast<RecordingShaderPipeline>(pipeline)->compute;
+}
+
+void RecordingRenderDevice::clearColor(float /*r*/, float /*g*/, float /*b*/, float /*a*/)
+{
+    mStats.clears += 1;
+    this->record(Call::ClearColor, 0);
+}
+
+void RecordingRenderDevice::clearTargetColor(std::size_t target, float /*r*/, float /*g*/, float /*b*/, float /*a*/)
+{
+    mStats.clears += 1;
+    this->record(Call::ClearTargetColor, 0, static_cast<int64_t>(target));
+}
+
+void RecordingRenderDevice::clearDepth(float /*depth*/)
+{
+    mStats.clears += 1;
+    this->record(Call::ClearDepth, 0);
+}
+
+void RecordingRenderDevice::clearStencil(int stencil)
+{
+    mStats.clears += 1;
+    this->record(Call::ClearStencil, 0, stencil);
+}
+
+void RecordingRenderDevice::drawTriangles(std::size_t offset, std::size_t count)
+{
+    this->drawTrianglesInstanced(offset, count, 1);
+}
+
+void RecordingRenderDevice::drawTrianglesIndexed(std::size_t offset, std::size_t count)
+{
+    this->drawTrianglesIndexedInstanced(offset, count, 1);
+}
+
+void RecordingRenderDevice::drawTrianglesInstanced(std::size_t offset, std::size_t count, std::size_t instanceCount)
+{
+    if (!this->validateDraw(false, offset, count))
+    {
+        return;
+    }
+
+    mStats.drawCalls += 1;
+    mStats.triangles += count / 3 * instanceCount;
+    if (instanceCount == 1)
+    {
+        this->record(Call::DrawTriangles, 0, static_cast<int64_t>(offset), static_cast<int64_t>(count));
+    }
+    else
+    {
+        this->record(Call::DrawTrianglesInstanced, 0, static_cast<int64_t>(offset), static_cast<int64_t>(count),
+                     static_cast<int64_t>(instanceCount));
+    }
+}
+
+void RecordingRenderDevice::drawTrianglesIndexedInstanced(std::size_t offset, std::size_t count,
+                                                          std::size_t instanceCount)
+{
+    this->drawTrianglesIndexedInstancedBaseVertex(offset, count, instanceCount, 0);
+}
+
+void RecordingRenderDevice::drawTrianglesIndexedInstancedBaseVertex(std::size_t offset, std::size_t count,
+                                                                    std::size_t instanceCount, std::size_t baseVertex)
+{
+    if (!this->validateDraw(true, offset, count))
+    {
+        return;
+    }
+
+    mStats.drawCalls += 1;
+    mStats.triangles += count / 3 * instanceCount;
+    if (instanceCount == 1 && baseVertex == 0)
+    {
+        this->record(Call::DrawTrianglesIndexed, 0, static_cast<int64_t>(offset), static_cast<int64_t>(count));
+    }
+    else
+    {
+        this->record(Call::DrawTrianglesIndexedInstanced, 0, static_cast<int64_t>(offset),
+                     static_cast<int64_t>(count), static_cast<int64_t>(instanceCount),
+                     static_cast<int64_t>(baseVertex));
+    }
+}
+
+void RecordingRenderDevice::dispatchCompute(std::size_t x, std::size_t y, std::size_t z)
+{
+    if (mShaderPipeline == 0 || !mComputePipeline)
+    {
+        CUBOS_ERROR("Compute dispatches require a compute pipeline to be set");
+        this->fail();
+        return;
+    }
+
+    mStats.dispatches += 1;
+    this->record(Call::DispatchCompute, 0, static_cast<int64_t>(x), static_cast<int64_t>(y),
+                 static_cast<int64_t>(z));
+}
+
+void RecordingRenderDevice::memoryBarrier(MemoryBarriers barriers)
+{
+    this->record(Call::MemoryBarrier, 0, static_cast<int64_t>(barriers));
+}
+
+void RecordingRenderDevice::setViewport(int x, int y, int w, int h)
+{
+    mStats.stateChanges += 1;
+    this->record(Call::SetViewport, 0, x, y, w, h);
+}
+
+void RecordingRenderDevice::setScissor(int x, int y, int w, int h)
+{
+    mStats.stateChanges += 1;
+    this->record(Call::SetScissor, 0, x, y, w, h);
+}
+
+int RecordingRenderDevice::getProperty(Property prop)
+{
+    switch (prop)
+    {
+    case Property::MaxAnisotropy:
+        return 16;
+    case Property::ComputeSupported:
+        return 1;
+    case Property::ConstantBufferOffsetAlignment:
+        return static_cast<int>(ConstantBufferOffsetAlignment);
+    }
+
+    abort(); // Invalid enum value
+}
+
+std::size_t RecordingRenderDevice::create(std::string label)
+{
+    mStats.objects += 1;
+    mLabels.push_back(std::move(label));
+    return mLabels.size();
+}
+
+void RecordingRenderDevice::record(Call call, std::size_t object, int64_t a, int64_t b, int64_t c, int64_t d)
+{
+    if (mLogCommands)
+    {
+        mCommands.push_back(Command{call, object, {a, b, c, d}});
+    }
+}
+
+void RecordingRenderDevice::changeState(Call call, std::size_t& current, std::size_t object)
+{
+    mStats.stateChanges += 1;
+    if (current == object)
+    {
+        mStats.redundantStateChanges += 1;
+    }
+
+    current = object;
+    this->record(call, object);
+}
+
+void RecordingRenderDevice::fail()
+{
+    mStats.errors += 1;
+}
+
+bool RecordingRenderDevice::validateDraw(bool indexed, std::size_t offset, std::size_t count)
+{
+    if (mShaderPipeline == 0 || mComputePipeline || mVertexArray == 0)
+    {
+        CUBOS_ERROR("Draw calls require a vertex array and a non-compute shader pipeline to be set");
+        this->fail();
+        return false;
+    }
+
+    if (indexed && (mIndexBuffer == 0 || offset + count > mIndexCount))
+    {
+        CUBOS_ERROR("Indexed draw call reads past the end of the set index buffer");
+        this->fail();
+        return false;
+    }
+
+    return true;
+}
@@ -41,6 +41,21 @@ BufferStream::BufferStream(std::size_t size)
     mOwned = true;
 }
 
+BufferStream::BufferStream(std::unique_ptr<char[]> buffer, std::size_t size)
+{
+    if (buffer == nullptr)
+    {
+        abort();
+    }
+
+    mBuffer = buffer.release();
+    mSize = size;
+    mPosition = 0;
+    mReadOnly = false;
+    mReachedEof = false;
+    mOwned = true;
+}
+
 BufferStream::~BufferStream()
 {
     if (mOwned)
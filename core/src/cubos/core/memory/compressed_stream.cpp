@@ -0,0 +1,454 @@
+#include <algorithm>
+#include <cstring>
+
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+using namespace cubos::core::memory;
+
+/// @brief Magic number at the start of compressed data.
+static constexpr char Magic[4] = {'\x89', 'C', 'B', 'Z'};
+
+/// @brief Size of the fixed part of the header, before the block offset table.
+static constexpr std::size_t HeaderSize = sizeof(Magic) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+/// @brief Minimum length of a match in the LZ4 block format.
+static constexpr std::size_t MinMatch = 4;
+
+/// @brief The last match must start at least this many bytes before the end of a block.
+static constexpr std::size_t MatchStartLimit = 12;
+
+/// @brief The last this many bytes of a block are always literals.
+static constexpr std::size_t LastLiterals = 5;
+
+/// @brief Number of bits of the hash table used to find matches.
+static constexpr std::size_t HashBits = 12;
+
+template <typename T>
+static bool readValue(Stream& stream, T& value)
+{
+    if (stream.read(&value, sizeof(T)) != sizeof(T))
+    {
+        return false;
+    }
+
+    value = fromLittleEndian(value);
+    return true;
+}
+
+template <typename T>
+static bool writeValue(Stream& stream, T value)
+{
+    value = toLittleEndian(value);
+    return stream.write(&value, sizeof(T)) == sizeof(T);
+}
+
+static uint32_t read32(const char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static void writeLength(std::vector<char>& out, std::size_t length)
+{
+    while (length >= 255)
+    {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+/// @brief Writes a sequence in the LZ4 block format.
+/// @param out Buffer to append the sequence to.
+/// @param literals Literals of the sequence.
+/// @param literalCount Number of literals.
+/// @param offset Offset of the match, or 0 if this is the last sequence.
+/// @param matchLength Length of the match.
+static void writeSequence(std::vector<char>& out, const char* literals, std::size_t literalCount, std::size_t offset,
+                          std::size_t matchLength)
+{
+    auto matchCode = offset == 0 ? 0 : matchLength - MinMatch;
+    out.push_back(static_cast<char>((std::min<std::size_t>(literalCount, 15) << 4) | std::min<std::size_t>(matchCode, 15)));
+    if (literalCount >= 15)
+    {
+        writeLength(out, literalCount - 15);
+    }
+    out.insert(out.end(), literals, literals + literalCount);
+
+    if (offset != 0)
+    {
+        out.push_back(static_cast<char>(offset & 0xFF));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (matchCode >= 15)
+        {
+            writeLength(out, matchCode - 15);
+        }
+    }
+}
+
+/// @brief Compresses a block with the LZ4 block format, using a greedy hash table match finder.
+/// @param in Data to compress.
+/// @param size Size of the data.
+/// @param out Buffer to append the compressed data to.
+static void compressBlock(const char* in, std::size_t size, std::vector<char>& out)
+{
+    std::size_t anchor = 0;
+
+    if (size > MatchStartLimit)
+    {
+        std::vector<uint32_t> table(std::size_t{1} << HashBits, UINT32_MAX);
+        std::size_t limit = size - MatchStartLimit;
+        std::size_t i = 0;
+        while (i < limit)
+        {
+            auto sequence = read32(in + i);
+            auto hash = (sequence * 2654435761U) >> (32 - HashBits);
+            auto candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(i);
+
+            if (candidate == UINT32_MAX || i - candidate > 0xFFFF || read32(in + candidate) != sequence)
+            {
+                i += 1;
+                continue;
+            }
+
+            // Extend the match as far as possible, leaving the last literals untouched.
+            std::size_t length = MinMatch;
+            std::size_t maxLength = size - LastLiterals - i;
+            while (length < maxLength && in[candidate + length] == in[i + length])
+            {
+                length += 1;
+            }
+
+            writeSequence(out, in + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+        }
+    }
+
+    writeSequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+/// @brief Decompresses a block in the LZ4 block format.
+/// @param in Compressed data.
+/// @param size Size of the compressed data.
+/// @param out Buffer to write the decompressed data to.
+/// @param outSize Expected size of the decompressed data.
+/// @return Whether the block was valid and decompressed to exactly @p outSize bytes.
+static bool decompressBlock(const char* in, std::size_t size, char* out, std::size_t outSize)
+{
+    const auto* ip = reinterpret_cast<const uint8_t*>(in);
+    const auto* end = ip + size;
+    std::size_t op = 0;
+
+    auto readLength = [&](std::size_t& length) {
+        uint8_t byte;
+        do
+        {
+            if (ip == end)
+            {
+                return false;
+            }
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < end)
+    {
+        auto token = *ip++;
+
+        // Copy the literals.
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals))
+        {
+            return false;
+        }
+        if (literals > static_cast<std::size_t>(end - ip) || literals > outSize - op)
+        {
+            return false;
+        }
+        std::memcpy(out + op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence has no match.
+        if (ip == end)
+        {
+            break;
+        }
+
+        // Copy the match, byte by byte, as it may overlap with itself.
+        if (end - ip < 2)
+        {
+            return false;
+        }
+        std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !readLength(length))
+        {
+            return false;
+        }
+        length += MinMatch;
+        if (offset == 0 || offset > op || length > outSize - op)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < length; ++i, ++op)
+        {
+            out[op] = out[op - offset];
+        }
+    }
+
+    return op == outSize;
+}
+
+CompressedStream::CompressedStream(std::unique_ptr<Stream> stream)
+    : mStream(std::move(stream))
+    , mBlockIndex(SIZE_MAX)
+{
+    char magic[sizeof(Magic)];
+    uint32_t blockSize = 0;
+    uint64_t size = 0;
+    uint32_t blockCount = 0;
+    if (mStream->read(magic, sizeof(magic)) != sizeof(magic) || std::memcmp(magic, Magic, sizeof(Magic)) != 0 ||
+        !readValue(*mStream, blockSize) || !readValue(*mStream, size) || !readValue(*mStream, blockCount) ||
+        blockSize == 0 || blockCount != (size + blockSize - 1) / blockSize)
+    {
+        CUBOS_ERROR("Could not read compressed stream: invalid header");
+        mFailed = true;
+        return;
+    }
+
+    mSize = static_cast<std::size_t>(size);
+    mBlockSize = blockSize;
+
+    // Read the block offset table. Blocks are never stored with more bytes than their
+    // decompressed size, which we check here so that we don't have to later.
+    for (uint32_t i = 0; i <= blockCount; ++i)
+    {
+        uint64_t offset;
+        if (!readValue(*mStream, offset) || (i == 0 && offset != 0) ||
+            (i > 0 && (offset < mOffsets.back() || offset - mOffsets.back() > this->blockSize(i - 1))))
+        {
+            CUBOS_ERROR("Could not read compressed stream: invalid block offset table");
+            mFailed = true;
+            mSize = 0;
+            mOffsets.clear();
+            return;
+        }
+        mOffsets.push_back(offset);
+    }
+
+    mDataStart = mStream->tell();
+}
+
+bool CompressedStream::detect(Stream& stream)
+{
+    char magic[sizeof(Magic)];
+    auto read = stream.read(magic, sizeof(magic));
+    stream.seek(-static_cast<ptrdiff_t>(read), SeekOrigin::Current);
+    return read == sizeof(magic) && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+bool CompressedStream::compress(Stream& in, Stream& out, std::size_t blockSize)
+{
+    CUBOS_ASSERT(blockSize > 0 && blockSize <= UINT32_MAX, "Invalid block size");
+
+    // Read all of the data, as the header must be written before the blocks.
+    std::vector<char> data;
+    char chunk[4096];
+    for (;;)
+    {
+        auto read = in.read(chunk, sizeof(chunk));
+        if (read == 0)
+        {
+            break;
+        }
+        data.insert(data.end(), chunk, chunk + read);
+    }
+
+    // Compress each block, keeping it uncompressed if compression doesn't reduce its size.
+    std::vector<char> blocks;
+    std::vector<uint64_t> offsets{0};
+    for (std::size_t i = 0; i < data.size(); i += blockSize)
+    {
+        auto size = std::min(blockSize, data.size() - i);
+        auto start = blocks.size();
+        compressBlock(data.data() + i, size, blocks);
+        if (blocks.size() - start >= size)
+        {
+            blocks.resize(start);
+            blocks.insert(blocks.end(), data.data() + i, data.data() + i + size);
+        }
+        offsets.push_back(blocks.size());
+    }
+
+    if (out.write(Magic, sizeof(Magic)) != sizeof(Magic) || !writeValue(out, static_cast<uint32_t>(blockSize)) ||
+        !writeValue(out, static_cast<uint64_t>(data.size())) ||
+        !writeValue(out, static_cast<uint32_t>(offsets.size() - 1)))
+    {
+        return false;
+    }
+
+    for (auto offset : offsets)
+    {
+        if (!writeValue(out, offset))
+        {
+            return false;
+        }
+    }
+
+    return out.write(blocks.data(), blocks.size()) == blocks.size();
+}
+
+bool CompressedStream::failed() const
+{
+    return mFailed;
+}
+
+std::size_t CompressedStream::size() const
+{
+    return mSize;
+}
+
+std::size_t CompressedStream::read(void* data, std::size_t size)
+{
+    auto* out = static_cast<char*>(data);
+    std::size_t total = 0;
+    while (total < size && mPosition < mSize)
+    {
+        auto index = mPosition / mBlockSize;
+        auto offset = mPosition % mBlockSize;
+        auto length = std::min(size - total, this->blockSize(index) - offset);
+
+        if (offset == 0 && length == this->blockSize(index) && index != mBlockIndex)
+        {
+            // Whole blocks are decompressed directly to the destination, skipping the cache.
+            if (!this->decompress(index, out + total))
+            {
+                break;
+            }
+        }
+        else
+        {
+            if (!this->cache(index))
+            {
+                break;
+            }
+            std::memcpy(out + total, mBlock.data() + offset, length);
+        }
+
+        total += length;
+        mPosition += length;
+    }
+
+    if (total < size)
+    {
+        mReachedEof = true;
+    }
+
+    return total;
+}
+
+std::size_t CompressedStream::write(const void* /*data*/, std::size_t /*size*/)
+{
+    return 0;
+}
+
+std::size_t CompressedStream::tell() const
+{
+    return mPosition;
+}
+
+void CompressedStream::seek(ptrdiff_t offset, SeekOrigin origin)
+{
+    ptrdiff_t base = 0;
+    if (origin == SeekOrigin::Current)
+    {
+        base = static_cast<ptrdiff_t>(mPosition);
+    }
+    else if (origin == SeekOrigin::End)
+    {
+        base = static_cast<ptrdiff_t>(mSize);
+    }
+
+    mPosition = static_cast<std::size_t>(std::clamp<ptrdiff_t>(base + offset, 0, static_cast<ptrdiff_t>(mSize)));
+    mReachedEof = false;
+}
+
+bool CompressedStream::eof() const
+{
+    return mReachedEof;
+}
+
+char CompressedStream::peek() const
+{
+    if (mPosition == mSize || !this->cache(mPosition / mBlockSize))
+    {
+        return '\0';
+    }
+
+    return mBlock[mPosition % mBlockSize];
+}
+
+bool CompressedStream::decompress(std::size_t index, char* out) const
+{
+    auto compressedSize = static_cast<std::size_t>(mOffsets[index + 1] - mOffsets[index]);
+    auto size = this->blockSize(index);
+
+    // Uncompressed blocks are read directly.
+    mStream->seek(static_cast<ptrdiff_t>(mDataStart + mOffsets[index]), SeekOrigin::Begin);
+    if (compressedSize == size)
+    {
+        if (mStream->read(out, size) != size)
+        {
+            CUBOS_ERROR("Could not read block {} of compressed stream: unexpected end of data", index);
+            return false;
+        }
+        return true;
+    }
+
+    mCompressed.resize(compressedSize);
+    if (mStream->read(mCompressed.data(), compressedSize) != compressedSize)
+    {
+        CUBOS_ERROR("Could not read block {} of compressed stream: unexpected end of data", index);
+        return false;
+    }
+
+    if (!decompressBlock(mCompressed.data(), compressedSize, out, size))
+    {
+        CUBOS_ERROR("Could not read block {} of compressed stream: corrupted data", index);
+        return false;
+    }
+
+    return true;
+}
+
+bool CompressedStream::cache(std::size_t index) const
+{
+    if (index == mBlockIndex)
+    {
+        return true;
+    }
+
+    mBlock.resize(this->blockSize(index));
+    if (!this->decompress(index, mBlock.data()))
+    {
+        mBlockIndex = SIZE_MAX;
+        return false;
+    }
+
+    mBlockIndex = index;
+    return true;
+}
+
+std::size_t CompressedStream::blockSize(std::size_t index) const
+{
+    return std::min(mBlockSize, mSize - index * mBlockSize);
+}
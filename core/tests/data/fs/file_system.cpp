@@ -160,6 +160,28 @@ TEST_CASE("data::FileSystem") // NOLINT(readability-function-size)
         REQUIRE(dump(*stream) == "text");
         stream = nullptr; // Close the file.
 
+        // File can be read asynchronously, either whole or just a range.
+        auto whole = FileSystem::readAsync("/foo");
+        auto range = foo->readAsync(1, 2);
+        auto past = foo->readAsync(2, 16);
+        auto beyond = foo->readAsync(8);
+        stream = whole.get();
+        REQUIRE(stream != nullptr);
+        REQUIRE(dump(*stream) == "text");
+        stream = range.get();
+        REQUIRE(stream != nullptr);
+        REQUIRE(dump(*stream) == "ex");
+        stream = past.get();
+        REQUIRE(stream != nullptr);
+        REQUIRE(dump(*stream) == "xt");
+        stream = beyond.get();
+        REQUIRE(stream != nullptr);
+        REQUIRE(dump(*stream).empty());
+        stream = nullptr;
+
+        // Reading a file which doesn't exist asynchronously fails.
+        REQUIRE(FileSystem::readAsync("/bar").get() == nullptr);
+
         if (readOnly)
         {
             // But not written.
@@ -262,6 +262,10 @@ TEST_CASE("data::StandardArchive") // NOLINT(readability-function-size)
         CHECK(archive->child(baz) == 0);
         CHECK(archive->name(baz) == "baz");
 
+        // Files on disk always have a known modification time.
+        CHECK(archive->modificationTime(foo) != 0);
+        CHECK(archive->modificationTime(baz) != 0);
+
         // Check if "foo" has "foo" written on it.
         auto stream = archive->open(foo, nullptr, File::OpenMode::Read);
         CHECK(stream->peek() == 'f');
@@ -313,4 +317,42 @@ TEST_CASE("data::StandardArchive") // NOLINT(readability-function-size)
         REQUIRE(archive.readOnly());
         assertInitializationFailed(archive);
     }
+
+#ifdef __linux__
+    SUBCASE("modifications made outside the archive are detected")
+    {
+        std::filesystem::create_directory(path);
+        std::filesystem::create_directory(path / "bar");
+        std::ofstream{path / "foo"} << "foo";
+        std::ofstream{path / "bar" / "baz"} << "baz";
+
+        StandardArchive archive{path, true, true};
+        REQUIRE(archive.watch());
+        auto bar = archive.name(archive.child(1)) == "bar" ? archive.child(1) : archive.sibling(archive.child(1));
+        auto baz = archive.child(bar);
+
+        // Nothing was modified yet.
+        std::vector<std::size_t> ids;
+        archive.modified(ids);
+        CHECK(ids.empty());
+
+        // Modify a file in a subdirectory, and replace it by renaming another file over it.
+        std::ofstream{path / "bar" / "baz"} << "qux";
+        archive.modified(ids);
+        REQUIRE(ids.size() == 1);
+        CHECK(ids[0] == baz);
+
+        ids.clear();
+        std::ofstream{path / "tmp"} << "qux";
+        std::filesystem::rename(path / "tmp", path / "bar" / "baz");
+        archive.modified(ids);
+        REQUIRE(ids.size() == 1);
+        CHECK(ids[0] == baz);
+
+        // Events are only reported once.
+        ids.clear();
+        archive.modified(ids);
+        CHECK(ids.empty());
+    }
+#endif // __linux__
 }
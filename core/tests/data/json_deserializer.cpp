@@ -0,0 +1,144 @@
+#include <doctest/doctest.h>
+
+#include <cubos/core/data/old/json_deserializer.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+
+#include "utils.hpp"
+
+using cubos::core::data::old::JSONDeserializer;
+using cubos::core::memory::BufferStream;
+
+TEST_CASE("data::old::JSONDeserializer")
+{
+    cubos::core::disableLogging();
+
+    SUBCASE("primitives")
+    {
+        JSONDeserializer des{R"([-12, 300, 1.5e2, true, "a\"bé"])"};
+        int32_t i32 = 0;
+        uint16_t u16 = 0;
+        float f32 = 0.0F;
+        bool b = false;
+        std::string str;
+
+        REQUIRE(des.beginArray() == 5);
+        des.read(i32);
+        des.read(u16);
+        des.read(f32);
+        des.read(b);
+        des.read(str);
+        des.endArray();
+
+        REQUIRE_FALSE(des.failed());
+        CHECK(i32 == -12);
+        CHECK(u16 == 300);
+        CHECK(f32 == 150.0F);
+        CHECK(b);
+        CHECK(str == "a\"b\xC3\xA9");
+    }
+
+    SUBCASE("nested containers from a stream")
+    {
+        std::string json = R"({ "a": [[1, 2, 3], [], [4]], "b": { "x": 1, "y": 2 }, "c": 7 })";
+        BufferStream stream{json.data(), json.size()};
+        JSONDeserializer des{stream};
+
+        std::vector<std::vector<int32_t>> vec;
+        std::unordered_map<std::string, int32_t> map;
+        int32_t c = 0;
+
+        des.beginObject();
+        des.read(vec);
+        des.read(map);
+        des.read(c);
+        des.endObject();
+
+        REQUIRE_FALSE(des.failed());
+        REQUIRE(vec.size() == 3);
+        CHECK(vec[0] == std::vector<int32_t>{1, 2, 3});
+        CHECK(vec[1].empty());
+        CHECK(vec[2] == std::vector<int32_t>{4});
+        CHECK(map.size() == 2);
+        CHECK(map["x"] == 1);
+        CHECK(map["y"] == 2);
+        CHECK(c == 7);
+    }
+
+    SUBCASE("dictionary keys are converted")
+    {
+        JSONDeserializer des{R"({"1": "one", "22": "twenty-two"})"};
+        std::unordered_map<int32_t, std::string> map;
+        des.read(map);
+
+        REQUIRE_FALSE(des.failed());
+        CHECK(map.size() == 2);
+        CHECK(map[1] == "one");
+        CHECK(map[22] == "twenty-two");
+    }
+
+    SUBCASE("unread elements are skipped")
+    {
+        JSONDeserializer des{R"([{"a": 1, "b": [1, {"c": "]"}]}, 2])"};
+        int32_t a = 0;
+        int32_t second = 0;
+
+        REQUIRE(des.beginArray() == 2);
+        des.beginObject();
+        des.read(a);
+        des.endObject();
+        des.read(second);
+        des.endArray();
+
+        REQUIRE_FALSE(des.failed());
+        CHECK(a == 1);
+        CHECK(second == 2);
+    }
+
+    SUBCASE("large input is read in chunks")
+    {
+        std::string json = "[";
+        for (int i = 0; i < 10000; ++i)
+        {
+            json += (i == 0 ? "[" : ",[") + std::to_string(i) + ", \"foo\"]";
+        }
+        json += "]";
+
+        BufferStream stream{json.data(), json.size()};
+        JSONDeserializer des{stream};
+
+        std::vector<std::pair<int32_t, std::string>> vec;
+        std::size_t len = des.beginArray();
+        REQUIRE(len == 10000);
+        for (std::size_t i = 0; i < len; ++i)
+        {
+            REQUIRE(des.beginArray() == 2);
+            vec.emplace_back();
+            des.read(vec.back().first);
+            des.read(vec.back().second);
+            des.endArray();
+        }
+        des.endArray();
+
+        REQUIRE_FALSE(des.failed());
+        CHECK(vec[9999].first == 9999);
+        CHECK(vec[9999].second == "foo");
+    }
+
+    SUBCASE("type mismatch fails")
+    {
+        JSONDeserializer des{R"(["not a number"])"};
+        int32_t i32 = 0;
+        des.beginArray();
+        des.read(i32);
+        CHECK(des.failed());
+    }
+
+    SUBCASE("truncated input fails")
+    {
+        JSONDeserializer des{"[1, 2,"};
+        std::vector<int32_t> vec;
+        des.read(vec);
+        CHECK(des.failed());
+    }
+}
@@ -11,6 +11,8 @@ using cubos::core::ecs::CommandBuffer;
 using cubos::core::ecs::Commands;
 using cubos::core::ecs::Entity;
 using cubos::core::ecs::World;
+using cubos::core::memory::BufferStream;
+using cubos::core::memory::SeekOrigin;
 
 TEST_CASE("ecs::Blueprint")
 {
@@ -73,6 +75,70 @@ TEST_CASE("ecs::Blueprint")
         CHECK(bazPkg.field("integer").get<int>() == 2);
     }
 
+    SUBCASE("spawn the blueprint multiple times")
+    {
+        // Spawn the blueprint three times and get the identifiers of the spawned entities.
+        auto spawned = cmds.spawn(blueprint, 3);
+        REQUIRE(spawned.size() == 3);
+        std::vector<Entity> spawnedBars;
+        std::vector<Entity> spawnedBazs;
+        for (const auto& instance : spawned)
+        {
+            spawnedBars.push_back(instance.entity("bar"));
+            spawnedBazs.push_back(instance.entity("baz"));
+        }
+        cmdBuffer.commit();
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            // Each instance gets its own entities.
+            for (std::size_t j = 0; j < i; ++j)
+            {
+                CHECK(spawnedBars[i] != spawnedBars[j]);
+                CHECK(spawnedBazs[i] != spawnedBazs[j]);
+            }
+
+            // Each "baz" has its parent set to the "bar" of the same instance.
+            auto bazPkg = world.pack(spawnedBazs[i]);
+            CHECK(bazPkg.fields().size() == 2);
+            CHECK(bazPkg.field("parent").get<Entity>() == spawnedBars[i]);
+            CHECK(bazPkg.field("integer").get<int>() == 2);
+        }
+    }
+
+    SUBCASE("builders remain valid after the blueprint is cleared")
+    {
+        auto spawned = cmds.spawn(blueprint);
+        blueprint.clear();
+        blueprint.create("qux");
+
+        auto spawnedBar = spawned.entity("bar");
+        auto spawnedBaz = spawned.entity("baz");
+        cmdBuffer.commit();
+
+        CHECK(world.pack(spawnedBaz).field("parent").get<Entity>() == spawnedBar);
+    }
+
+    SUBCASE("components which reference entities outside the blueprint are skipped")
+    {
+        blueprint.add(bar, ParentComponent{Entity(42, 0)});
+
+        auto spawned = cmds.spawn(blueprint);
+        auto spawnedBar = spawned.entity("bar");
+        auto spawnedBaz = spawned.entity("baz");
+        cmdBuffer.commit();
+
+        CHECK(world.pack(spawnedBar).fields().size() == 0);
+        CHECK(world.pack(spawnedBaz).field("parent").get<Entity>() == spawnedBar);
+
+        Blueprint merged{};
+        CHECK_FALSE(merged.merge("sub", blueprint));
+        CHECK_FALSE(merged.entity("sub.baz").isNull());
+
+        BufferStream stream{};
+        CHECK_FALSE(blueprint.writeCompiled(stream));
+    }
+
     SUBCASE("merge one blueprint into another blueprint and then spawn it")
     {
         // Create another blueprint with one entity.
@@ -80,7 +146,7 @@ TEST_CASE("ecs::Blueprint")
         auto foo = merged.create("foo", IntegerComponent{1});
 
         // Merge the original blueprint into the new one.
-        merged.merge("sub", blueprint);
+        CHECK(merged.merge("sub", blueprint));
 
         // Then the new blueprint has the correct entities.
         CHECK(merged.entity("foo") == foo);
@@ -114,4 +180,39 @@ TEST_CASE("ecs::Blueprint")
         CHECK(bazPkg.field("parent").get<Entity>() == spawnedBar);
         CHECK(bazPkg.field("integer").get<int>() == 2);
     }
+
+    SUBCASE("compile the blueprint, read it back and spawn it")
+    {
+        BufferStream stream{};
+        REQUIRE(blueprint.writeCompiled(stream));
+        stream.seek(0, SeekOrigin::Begin);
+
+        Blueprint compiled{};
+        REQUIRE(compiled.readCompiled(stream));
+        CHECK_FALSE(compiled.entity("bar").isNull());
+        CHECK_FALSE(compiled.entity("baz").isNull());
+
+        // Spawn the read blueprint into the world and get the identifiers of the spawned entities.
+        auto spawned = cmds.spawn(compiled);
+        auto spawnedBar = spawned.entity("bar");
+        auto spawnedBaz = spawned.entity("baz");
+        cmdBuffer.commit();
+
+        // "baz" has a ParentComponent with parent = "bar" and an IntegerComponent with integer = 2.
+        auto bazPkg = world.pack(spawnedBaz);
+        CHECK(bazPkg.fields().size() == 2);
+        CHECK(bazPkg.field("parent").get<Entity>() == spawnedBar);
+        CHECK(bazPkg.field("integer").get<int>() == 2);
+    }
+
+    SUBCASE("reading a truncated compiled blueprint fails")
+    {
+        BufferStream stream{};
+        REQUIRE(blueprint.writeCompiled(stream));
+        BufferStream truncated{stream.getBuffer(), stream.tell() - 1};
+
+        Blueprint compiled{};
+        CHECK_FALSE(compiled.readCompiled(truncated));
+        CHECK(compiled.entity("bar").isNull());
+    }
 }
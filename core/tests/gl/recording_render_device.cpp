@@ -0,0 +1,191 @@
+#include <cstring>
+
+#include <doctest/doctest.h>
+
+#include <cubos/core/gl/recording_render_device.hpp>
+#include <cubos/core/log.hpp>
+
+using cubos::core::disableLogging;
+using namespace cubos::core::gl;
+
+using Call = RecordingRenderDevice::Call;
+
+TEST_CASE("gl::RecordingRenderDevice")
+{
+    disableLogging();
+
+    RecordingRenderDevice device{};
+
+    auto vs = device.createShaderStage(Stage::Vertex, "");
+    auto ps = device.createShaderStage(Stage::Pixel, "");
+    auto pipeline = device.createShaderPipeline(vs, ps);
+    REQUIRE(pipeline != nullptr);
+
+    unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+    auto vb = device.createVertexBuffer(64, indices, Usage::Static);
+    auto ib = device.createIndexBuffer(sizeof(indices), indices, IndexFormat::UInt, Usage::Static);
+
+    VertexArrayDesc vaDesc;
+    vaDesc.elementCount = 1;
+    vaDesc.elements[0].name = "position";
+    vaDesc.elements[0].size = 3;
+    vaDesc.buffers[0] = vb;
+    vaDesc.shaderPipeline = pipeline;
+    auto va = device.createVertexArray(vaDesc);
+    REQUIRE(va != nullptr);
+
+    CHECK(device.stats().errors == 0);
+    CHECK(device.stats().bytesUploaded == 64 + sizeof(indices));
+    CHECK(device.label(1) == "ShaderStage");
+    CHECK(device.label(0).empty());
+
+    SUBCASE("invalid descriptors are rejected")
+    {
+        CHECK(device.createShaderPipeline(ps, vs) == nullptr);
+        CHECK(device.createIndexBuffer(3, indices, IndexFormat::UShort, Usage::Static) == nullptr);
+
+        Texture2DDesc texDesc;
+        texDesc.width = 0;
+        texDesc.height = 4;
+        texDesc.format = TextureFormat::RGBA8UNorm;
+        CHECK(device.createTexture2D(texDesc) == nullptr);
+
+        // Depth textures can't be used as color targets.
+        texDesc.width = 4;
+        texDesc.format = TextureFormat::Depth24Stencil8;
+        FramebufferDesc fbDesc;
+        fbDesc.targets[0].setTexture2DTarget(device.createTexture2D(texDesc));
+        CHECK(device.createFramebuffer(fbDesc) == nullptr);
+
+        vaDesc.buffers[0] = nullptr;
+        CHECK(device.createVertexArray(vaDesc) == nullptr);
+
+        CHECK(device.stats().errors == 5);
+    }
+
+    SUBCASE("draws are recorded")
+    {
+        device.clear();
+        device.setShaderPipeline(pipeline);
+        device.setVertexArray(va);
+        device.setIndexBuffer(ib);
+        device.setVertexArray(va);
+        device.drawTrianglesIndexed(0, 6);
+        device.drawTrianglesIndexedInstanced(3, 3, 4);
+
+        CHECK(device.stats().stateChanges == 4);
+        CHECK(device.stats().redundantStateChanges == 1);
+        CHECK(device.stats().drawCalls == 2);
+        CHECK(device.stats().triangles == 6);
+
+        const auto& commands = device.commands();
+        REQUIRE(commands.size() == 6);
+        CHECK(commands[0].call == Call::SetShaderPipeline);
+        CHECK(device.label(commands[0].object) == "ShaderPipeline");
+        CHECK(commands[4].call == Call::DrawTrianglesIndexed);
+        CHECK(commands[4].args[1] == 6);
+        CHECK(commands[5].call == Call::DrawTrianglesIndexedInstanced);
+        CHECK(commands[5].args[2] == 4);
+
+        // Reading past the end of the index buffer is an error, and isn't recorded.
+        device.drawTrianglesIndexed(3, 6);
+        CHECK(device.stats().errors == 1);
+        CHECK(device.stats().drawCalls == 2);
+        CHECK(device.commands().size() == 6);
+    }
+
+    SUBCASE("draws without a vertex array are rejected")
+    {
+        device.setShaderPipeline(pipeline);
+        device.drawTriangles(0, 3);
+        CHECK(device.stats().errors == 1);
+        CHECK(device.stats().drawCalls == 0);
+    }
+
+    SUBCASE("bindings and buffer maps are recorded")
+    {
+        auto cb = device.createConstantBuffer(32, nullptr, Usage::Dynamic);
+        auto bp = pipeline->getBindingPoint("MVP");
+        REQUIRE(bp != nullptr);
+        CHECK(pipeline->getBindingPoint("MVP") == bp);
+
+        device.clear();
+        std::memset(cb->map(), 0, 32);
+        CHECK(cb->map() == nullptr);
+        cb->unmap();
+        bp->bind(cb);
+        bp->setConstant(1.0F);
+
+        CHECK(device.stats().maps == 1);
+        CHECK(device.stats().unmaps == 1);
+        CHECK(device.stats().bytesUploaded == 32);
+        CHECK(device.stats().stateChanges == 2);
+        CHECK(device.stats().errors == 1);
+
+        const auto& commands = device.commands();
+        REQUIRE(commands.size() == 4);
+        CHECK(commands[1].call == Call::Unmap);
+        CHECK(commands[1].args[0] == 32);
+        CHECK(commands[2].call == Call::Bind);
+        CHECK(device.label(commands[2].object) == "MVP");
+        CHECK(device.label(static_cast<std::size_t>(commands[2].args[0])) == "ConstantBuffer");
+    }
+
+    SUBCASE("constant buffer ranges are validated")
+    {
+        auto alignment = static_cast<std::size_t>(device.getProperty(Property::ConstantBufferOffsetAlignment));
+        auto cb = device.createConstantBuffer(4 * alignment, nullptr, Usage::Dynamic);
+        auto bp = pipeline->getBindingPoint("Instances");
+
+        device.clear();
+        std::memset(cb->mapRange(alignment, 2 * alignment, false), 0, 2 * alignment);
+        cb->unmap();
+        CHECK(cb->mapRange(3 * alignment, 2 * alignment, true) == nullptr);
+        bp->bind(cb, alignment, 2 * alignment);
+        bp->bind(cb, 1, alignment);
+
+        CHECK(device.stats().maps == 1);
+        CHECK(device.stats().bytesUploaded == 2 * alignment);
+        CHECK(device.stats().stateChanges == 1);
+        CHECK(device.stats().errors == 2);
+    }
+
+    SUBCASE("buffer updates and copies are validated")
+    {
+        auto pool = device.createIndexBuffer(4 * sizeof(indices), nullptr, IndexFormat::UInt, Usage::Dynamic);
+
+        device.clear();
+        pool->update(sizeof(indices), sizeof(indices), indices);
+        pool->copy(*ib, 0, 0, sizeof(indices));
+        pool->update(3 * sizeof(indices), 2 * sizeof(indices), indices);
+        pool->copy(*pool, 0, sizeof(indices), sizeof(indices));
+        vb->copy(*vb, 0, 32, 32);
+
+        CHECK(device.stats().bytesUploaded == sizeof(indices));
+        CHECK(device.stats().errors == 3);
+        REQUIRE(device.commands().size() == 2);
+        CHECK(device.commands()[0].call == Call::UpdateBuffer);
+        CHECK(device.commands()[1].call == Call::CopyBuffer);
+        CHECK(device.commands()[1].args[3] == sizeof(indices));
+
+        // Meshes sharing the buffer are drawn with indices local to each of them.
+        device.setShaderPipeline(pipeline);
+        device.setVertexArray(va);
+        device.setIndexBuffer(pool);
+        device.drawTrianglesIndexedInstancedBaseVertex(6, 6, 1, 4);
+        CHECK(device.commands().back().call == Call::DrawTrianglesIndexedInstanced);
+        CHECK(device.commands().back().args[3] == 4);
+        CHECK(device.stats().triangles == 2);
+    }
+
+    SUBCASE("the command log can be disabled")
+    {
+        device.clear();
+        device.logCommands(false);
+        device.setViewport(0, 0, 16, 16);
+        device.clearDepth(1.0F);
+        CHECK(device.commands().empty());
+        CHECK(device.stats().stateChanges == 1);
+        CHECK(device.stats().clears == 1);
+    }
+}
@@ -0,0 +1,120 @@
+#include <cstring>
+#include <vector>
+
+#include <doctest/doctest.h>
+
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
+
+#include "../utils.hpp"
+
+using cubos::core::disableLogging;
+using cubos::core::memory::BufferStream;
+using cubos::core::memory::CompressedStream;
+using cubos::core::memory::SeekOrigin;
+
+/// Compresses the given data and returns a compressed stream which reads it back.
+static CompressedStream roundTrip(const std::vector<char>& data, std::size_t blockSize,
+                                  std::vector<char>& compressed)
+{
+    BufferStream in{data.data(), data.size()};
+    BufferStream out{};
+    REQUIRE(CompressedStream::compress(in, out, blockSize));
+
+    const auto* buffer = static_cast<const char*>(out.getBuffer());
+    compressed.assign(buffer, buffer + out.tell());
+
+    auto stream = std::make_unique<BufferStream>(compressed.data(), compressed.size());
+    REQUIRE(CompressedStream::detect(*stream));
+    REQUIRE(stream->tell() == 0);
+    return CompressedStream{std::move(stream)};
+}
+
+TEST_CASE("memory::CompressedStream")
+{
+    disableLogging();
+
+    std::vector<char> compressed;
+
+    SUBCASE("mostly zeros")
+    {
+        // Similar to the contents of a voxel grid, which should compress very well.
+        std::vector<char> data(100000, 0);
+        for (std::size_t i = 0; i < data.size(); i += 97)
+        {
+            data[i] = static_cast<char>(i % 7 + 1);
+        }
+
+        auto stream = roundTrip(data, 4096, compressed);
+        REQUIRE_FALSE(stream.failed());
+        CHECK(stream.size() == data.size());
+        CHECK(compressed.size() < data.size() / 4);
+
+        // Read everything at once.
+        std::vector<char> read(data.size());
+        CHECK(stream.read(read.data(), read.size()) == data.size());
+        CHECK(read == data);
+        CHECK_FALSE(stream.eof());
+        CHECK(stream.read(read.data(), 1) == 0);
+        CHECK(stream.eof());
+
+        // Seek to arbitrary positions, across block boundaries.
+        stream.seek(4090, SeekOrigin::Begin);
+        CHECK(stream.peek() == data[4090]);
+        CHECK(stream.read(read.data(), 20) == 20);
+        CHECK(std::memcmp(read.data(), data.data() + 4090, 20) == 0);
+        CHECK(stream.tell() == 4110);
+
+        stream.seek(-5, SeekOrigin::End);
+        CHECK(stream.read(read.data(), 20) == 5);
+        CHECK(std::memcmp(read.data(), data.data() + data.size() - 5, 5) == 0);
+    }
+
+    SUBCASE("incompressible data")
+    {
+        // Blocks which don't compress are stored as they are.
+        std::vector<char> data(10000);
+        uint32_t state = 1;
+        for (auto& byte : data)
+        {
+            state = state * 1664525U + 1013904223U;
+            byte = static_cast<char>(state >> 24);
+        }
+
+        auto stream = roundTrip(data, 1000, compressed);
+        REQUIRE_FALSE(stream.failed());
+
+        std::vector<char> read(data.size());
+        CHECK(stream.read(read.data(), read.size()) == data.size());
+        CHECK(read == data);
+    }
+
+    SUBCASE("empty data")
+    {
+        auto stream = roundTrip({}, CompressedStream::DefaultBlockSize, compressed);
+        REQUIRE_FALSE(stream.failed());
+        CHECK(stream.size() == 0);
+
+        char byte;
+        CHECK(stream.read(&byte, 1) == 0);
+        CHECK(stream.eof());
+    }
+
+    SUBCASE("uncompressed data is not detected")
+    {
+        BufferStream stream{"text", 4};
+        CHECK_FALSE(CompressedStream::detect(stream));
+        CHECK(stream.tell() == 0);
+    }
+
+    SUBCASE("truncated data fails")
+    {
+        std::vector<char> data(1000, 'a');
+        roundTrip(data, 100, compressed);
+        compressed.resize(20);
+
+        CompressedStream stream{std::make_unique<BufferStream>(compressed.data(), compressed.size())};
+        CHECK(stream.failed());
+    }
+}
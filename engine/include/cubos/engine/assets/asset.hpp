@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include <uuid.h>
 
 #include <cubos/core/reflection/reflect.hpp>
@@ -26,6 +28,10 @@ namespace cubos::engine
     /// assigned to each asset when it is imported or created. Default constructed handles are
     /// null handles, which are not associated with any asset.
     ///
+    /// Handles returned by @ref Assets also remember the slot of the asset in the manager's
+    /// registry, so that looking them up doesn't require hashing their UUID. Handles constructed
+    /// directly from a UUID fall back to the UUID lookup.
+    ///
     /// Serialization:
     /// - can be serialized or deserialized without context, i.e. the UUID is stored directly.
     /// - when deserialized, the handle is always a weak handle.
@@ -119,7 +125,11 @@ namespace cubos::engine
 
         uuids::uuid mId; ///< UUID of the asset.
         void* mRefCount; ///< Void pointer to avoid including `<atomic>` in the header.
+        void* mEntry;    ///< Entry of the asset in its manager, cached by strong handles.
         int mVersion;    ///< Last known version of the asset.
+
+        uint32_t mSlot;       ///< Slot of the asset in its manager's registry, plus one, or zero if unknown.
+        uint32_t mGeneration; ///< Generation of the manager which assigned the slot and entry.
     };
 
     /// @brief Handle to an asset of a specific type.
@@ -172,7 +182,10 @@ namespace cubos::engine
         asset.reflectedId = reflectedId;
         asset.mId = mId;
         asset.mRefCount = mRefCount;
+        asset.mEntry = mEntry;
         asset.mVersion = mVersion;
+        asset.mSlot = mSlot;
+        asset.mGeneration = mGeneration;
         asset.incRef();
         return asset;
     }
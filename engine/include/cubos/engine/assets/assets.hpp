@@ -4,18 +4,29 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <future>
 #include <memory>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <cubos/core/memory/guards.hpp>
+#include <cubos/core/memory/stream.hpp>
 #include <cubos/core/memory/type_map.hpp>
 
 #include <cubos/engine/assets/bridge.hpp>
+#include <cubos/engine/assets/derived_cache.hpp>
+#include <cubos/engine/assets/group.hpp>
 #include <cubos/engine/assets/meta.hpp>
+#include <cubos/engine/assets/meta_index.hpp>
 
 namespace cubos::engine
 {
@@ -43,6 +54,12 @@ namespace cubos::engine
     /// storing them in memory, and providing access to them.
     ///
     /// Assets are all identified through @ref Asset handles.
+    ///
+    /// Assets are loaded in the background by a pool of loader threads, which take queued assets in
+    /// order of priority. Loader threads never block waiting for other assets: a task whose
+    /// dependencies aren't loaded yet is suspended, its dependencies are queued, and it is queued
+    /// again once the last of them finishes loading. Dependencies are either declared on the
+    /// metadata of the asset, or found by its bridge through @ref require().
     /// @ingroup assets-plugin
     class Assets final
     {
@@ -56,6 +73,64 @@ namespace cubos::engine
             Loaded,   ///< The asset is loaded.
         };
 
+        /// @brief Priorities with which assets can be queued for loading.
+        ///
+        /// Queued assets are loaded in order of priority, and in the order they were queued within
+        /// the same priority.
+        enum class Priority
+        {
+            Low,    ///< For assets which aren't needed yet, e.g., prefetching.
+            Normal, ///< Default priority.
+            High,   ///< For assets which are needed right now, e.g., blocking reads.
+        };
+
+        /// @brief Number of buckets in the load time histograms of @ref BridgeStats.
+        static constexpr std::size_t LoadTimeBuckets = 12;
+
+        /// @brief Timing statistics of the loads performed through a bridge.
+        struct BridgeStats
+        {
+            std::size_t loads{0};     ///< Number of successful loads.
+            std::size_t failures{0};  ///< Number of failed loads.
+            double totalTime{0.0};    ///< Time spent on all loads, in seconds.
+            double maxTime{0.0};      ///< Time spent on the slowest load, in seconds.
+            std::size_t bytesRead{0}; ///< Size of the files opened by all loads, in bytes.
+
+            /// @brief Number of loads by duration. Bucket `i` counts the loads which took less than
+            /// `2^i` milliseconds, and the last bucket also counts all slower loads.
+            std::array<std::size_t, LoadTimeBuckets> loadTimes{};
+        };
+
+        /// @brief Time a thread spent blocked waiting for assets to load.
+        struct WaitStats
+        {
+            std::size_t waits{0};  ///< Number of times the thread blocked.
+            double totalTime{0.0}; ///< Time spent blocked, in seconds.
+            double maxTime{0.0};   ///< Longest time spent blocked at once, in seconds.
+        };
+
+        /// @brief Statistics of the loader queue and of the threads waiting for it.
+        struct LoaderStats
+        {
+            std::size_t queued{0};         ///< Number of assets currently queued for loading.
+            std::size_t suspended{0};      ///< Number of assets waiting for their dependencies to load.
+            std::size_t maxQueued{0};      ///< Highest number of assets queued at once.
+            std::size_t prefetchHits{0};   ///< Number of files opened which had already been read ahead.
+            std::size_t prefetchMisses{0}; ///< Number of files opened which had to be read on demand.
+
+            /// @brief Time spent blocked in reads of assets which were still loading, by thread.
+            std::unordered_map<std::string, WaitStats> waits;
+        };
+
+        /// @brief Memory usage statistics of the loaded assets.
+        struct MemoryStats
+        {
+            std::size_t budget{0};    ///< Memory budget, in bytes, or zero if unused assets aren't kept.
+            std::size_t used{0};      ///< Memory used by loaded assets, as reported by bridges.
+            std::size_t loaded{0};    ///< Number of loaded assets.
+            std::size_t evictions{0}; ///< Number of unused assets unloaded by @ref cleanup().
+        };
+
         ~Assets();
 
         /// @brief Constructs an empty manager without any bridges or metadata.
@@ -67,6 +142,15 @@ namespace cubos::engine
         /// @brief Forbid moving.
         Assets(Assets&&) = delete;
 
+        /// @brief Sets the number of loader threads.
+        ///
+        /// Waits for the assets currently being loaded before replacing the threads. Queued assets
+        /// are kept, and loaded by the new threads. Bridges must support being called concurrently
+        /// when more than one thread is used.
+        ///
+        /// @param count Number of loader threads, at least one.
+        void loaderThreads(std::size_t count);
+
         /// @brief Registers a new bridge for the given extension.
         ///
         /// If more than one extension match a given asset's name, the longest extension is picked.
@@ -75,8 +159,24 @@ namespace cubos::engine
         /// @param bridge Bridge to register.
         void registerBridge(const std::string& extension, std::shared_ptr<AssetBridge> bridge);
 
-        /// @brief Cleans up all assets that are not in use. Should be called periodically to free
-        /// up memory.
+        /// @brief Sets how much memory loaded assets may use before unused ones start being
+        /// unloaded.
+        ///
+        /// The memory used by each asset is reported by a bridge registered for its type, including
+        /// for assets which were stored or created directly. Assets which are no longer referenced
+        /// are kept loaded while the budget isn't exceeded, so that they don't have to be loaded
+        /// again if they're needed shortly after. With a budget of zero, the default, assets are
+        /// unloaded as soon as they're no longer referenced.
+        ///
+        /// @param bytes Memory budget in bytes.
+        void memoryBudget(std::size_t bytes);
+
+        /// @brief Unloads assets which are no longer referenced. Should be called periodically to
+        /// free up memory.
+        ///
+        /// Each call only visits a few assets, continuing from where the previous call stopped. If
+        /// a memory budget is set, unused assets are only unloaded while the budget is exceeded,
+        /// and assets accessed since they were last visited are given a second chance.
         void cleanup();
 
         /// @brief Loads all metadata from the virtual filesystem, in the given path. If the path
@@ -84,6 +184,27 @@ namespace cubos::engine
         /// @param path Path to load metadata from.
         void loadMeta(std::string_view path);
 
+        /// @brief Loads all metadata from the virtual filesystem, in the given path, taking it from
+        /// the given index whenever possible.
+        ///
+        /// Directories which weren't modified since the index was built are taken from the index,
+        /// without being listed. In the remaining directories, metadata files which were indexed
+        /// and weren't modified since are not read at all, and the others are read as in @ref
+        /// loadMeta(std::string_view).
+        ///
+        /// @param path Path to load metadata from, which should be the path the index was built from.
+        /// @param index Index of the metadata files in the path.
+        void loadMeta(std::string_view path, const AssetMetaIndex& index);
+
+        /// @brief Reloads the assets whose files were modified.
+        ///
+        /// Modified metadata files are loaded again. Assets whose files were modified are
+        /// invalidated, and if they're still in use, queued for loading again.
+        ///
+        /// @param paths Absolute paths of the modified files.
+        /// @return Handles of the reloaded assets.
+        std::vector<AnyAsset> reloadModified(const std::vector<std::string>& paths);
+
         /// @brief Loads the asset with the given handle, upgrading the handle to a strong one.
         ///
         /// This method doesn't block, thus the asset may have not yet been loaded when it returns.
@@ -91,9 +212,45 @@ namespace cubos::engine
         /// is returned. If an error occurs while loading the asset, it will only fail in @ref
         /// read() or be visible through @ref status().
         ///
+        /// If the asset is already queued with a lower priority, it is moved up to @p priority.
+        ///
         /// @param handle Handle to load the asset for.
+        /// @param priority Priority with which the asset is queued.
         /// @return Strong handle to the asset, or a null handle if an error occurred.
-        AnyAsset load(AnyAsset handle) const;
+        AnyAsset load(AnyAsset handle, Priority priority = Priority::Normal) const;
+
+        /// @brief Loads the given assets and, recursively, all of their dependencies.
+        ///
+        /// Dependencies are declared on the metadata of each asset, in the `dependencies` field,
+        /// as a comma separated list of UUIDs. All assets are queued at once, dependencies before
+        /// their dependents, and are loaded in parallel by the loader threads.
+        ///
+        /// Like @ref load(), this method doesn't block. The returned group can be used to check
+        /// the progress of the whole load, or to wait for it.
+        ///
+        /// @param handles Handles of the assets to load.
+        /// @param priority Priority with which the assets are queued.
+        /// @return Group with strong handles to all the assets.
+        AssetGroup loadGroup(const std::vector<AnyAsset>& handles, Priority priority = Priority::Normal) const;
+
+        /// @brief Checks whether an asset needed by the asset being loaded is ready to be read.
+        ///
+        /// Must be called by bridges, from @ref AssetBridge::load(), before reading other assets.
+        /// If the asset isn't loaded yet, it is queued and false is returned, in which case the
+        /// bridge must return false without storing anything. Its load isn't treated as a failure:
+        /// it is suspended, and retried from the start once all the assets it required are loaded.
+        ///
+        /// Outside of loader threads, blocks until the asset is loaded instead. In both cases, the
+        /// handle is upgraded to a strong one, so that the asset stays loaded while it's read.
+        ///
+        /// @param handle Handle of the asset needed.
+        /// @return Whether the asset can be read.
+        bool require(AnyAsset& handle) const;
+
+        /// @brief Gets the dependencies declared on the metadata of the given asset.
+        /// @param handle Handle of the asset.
+        /// @return Weak handles to the dependencies.
+        std::vector<AnyAsset> dependencies(const AnyAsset& handle) const;
 
         /// @brief Saves changes made to an asset's metadata.
         ///
@@ -139,7 +296,7 @@ namespace cubos::engine
         inline AssetRead<T> read(Asset<T> handle) const
         {
             // Create a strong handle to the asset, so that the asset starts loading if it isn't already.
-            auto strong = this->load(handle);
+            auto strong = this->load(handle, Priority::High);
             auto lock = this->lockRead(strong);
             auto data = static_cast<const T*>(this->access(strong, typeid(T), lock, false));
             return AssetRead<T>(*data, std::move(lock));
@@ -157,12 +314,64 @@ namespace cubos::engine
         inline AssetWrite<T> write(Asset<T> handle)
         {
             // Create a strong handle to the asset, so that the asset starts loading if it isn't already.
-            auto strong = this->load(handle);
+            auto strong = this->load(handle, Priority::High);
             auto lock = this->lockWrite(strong);
             auto data = static_cast<T*>(this->access(strong, typeid(T), lock, true));
             return AssetWrite<T>(*data, std::move(lock));
         }
 
+        /// @brief Gets read-write access to the data of an asset stored with @ref storeCoarse(), so
+        /// that its bridge can refine it in place.
+        ///
+        /// Unlike @ref write(), this doesn't increase the asset's version nor report it as
+        /// modified, so that users of the asset only pick up the changes once the bridge calls
+        /// @ref markRefined().
+        ///
+        /// @tparam T Type of the asset data.
+        /// @param handle Handle of the asset.
+        /// @return Reference to the asset data.
+        template <typename T>
+        inline AssetWrite<T> refine(const AnyAsset& handle)
+        {
+            auto lock = this->lockWrite(handle);
+            auto data = static_cast<T*>(this->access(handle, typeid(T), lock, false));
+            return AssetWrite<T>(*data, std::move(lock));
+        }
+
+        /// @brief Opens the file associated with the given asset for reading.
+        ///
+        /// Bridges should use this instead of opening the file at the asset's path themselves:
+        /// while earlier assets are being loaded, the loader threads read the files of the next
+        /// queued assets in the background, and if that's the case, the already read contents are
+        /// returned.
+        ///
+        /// @param handle Handle of the asset.
+        /// @return File stream, or nullptr if the asset has no path or the file couldn't be opened.
+        std::unique_ptr<core::memory::Stream> openFile(const AnyAsset& handle) const;
+
+        /// @brief Gets the cache for data derived from assets, which bridges and other consumers
+        /// of assets can use to avoid computing it again on every run.
+        /// @return Derived data cache, which is disabled unless configured.
+        inline const DerivedCache& cache() const
+        {
+            return *mCache;
+        }
+
+        /// @brief Gets the cache for data derived from assets.
+        /// @return Derived data cache, which can be replaced to configure it.
+        inline DerivedCache& cache()
+        {
+            return *mCache;
+        }
+
+        /// @brief Gets shared ownership of the cache for data derived from assets, for consumers
+        /// which may outlive the manager, such as background tasks.
+        /// @return Derived data cache.
+        inline std::shared_ptr<const DerivedCache> sharedCache() const
+        {
+            return mCache;
+        }
+
         /// @brief Gets the status of the asset with the given handle.
         /// @param handle Handle to check the status for.
         /// @return Status of the asset.
@@ -207,6 +416,61 @@ namespace cubos::engine
                                [](void* data) { delete static_cast<T*>(data); });
         }
 
+        /// @brief Stores a coarse version of an asset which is still being loaded by its bridge.
+        ///
+        /// Meant for bridges of large assets, which publish a usable version of the asset as soon
+        /// as possible, and then refine it in place through @ref refine() until they return.
+        /// Meanwhile, the asset can be read without blocking, but its status is still reported as
+        /// @ref Status::Loading, and it is never unloaded by @ref cleanup().
+        ///
+        /// @tparam T Type of the asset data.
+        /// @param handle Handle to associate the asset with.
+        /// @param data Coarse asset data to store.
+        /// @return Strong handle to the asset.
+        template <typename T>
+        inline AnyAsset storeCoarse(AnyAsset handle, T data)
+        {
+            return this->store(handle, typeid(T), new T(std::move(data)),
+                               [](void* data) { delete static_cast<T*>(data); }, true);
+        }
+
+        /// @brief Reports that the coarse version of an asset was refined, so that users of the asset
+        /// can pick up the changes. This increases the asset's version.
+        ///
+        /// Called by bridges after a significant part of an asset stored with @ref storeCoarse() is
+        /// refined. Reported automatically when the bridge finishes.
+        ///
+        /// @param handle Handle of the asset.
+        void markRefined(const AnyAsset& handle);
+
+        /// @brief Gets the assets which were modified since the last call.
+        ///
+        /// Includes assets which were written to, stored again, invalidated or refined, and thus
+        /// also those reloaded by @ref reloadModified() which were loaded.
+        ///
+        /// @return Handles of the modified assets.
+        std::vector<AnyAsset> takeModified();
+
+        /// @brief Gets the timing statistics of the loads performed through each bridge.
+        /// @return Statistics by the extension the bridge was registered with.
+        std::unordered_map<std::string, BridgeStats> bridgeStats() const;
+
+        /// @brief Gets the memory usage statistics of the loaded assets.
+        /// @return Memory statistics.
+        MemoryStats memoryStats() const;
+
+        /// @brief Gets the statistics of the loader queue and of the threads waiting for it.
+        /// @return Loader statistics.
+        LoaderStats loaderStats() const;
+
+        /// @brief Writes all statistics of the manager, including those of its cache, as JSON.
+        ///
+        /// Meant to be dumped at the end of automated runs, so that loading performance can be
+        /// tracked over time.
+        ///
+        /// @param stream Stream to write to.
+        void writeStats(core::memory::Stream& stream) const;
+
         /// @brief Gets all assets that have been registered
         /// @return Vector with all registered assets.
         std::vector<AnyAsset> listAll() const;
@@ -222,6 +486,8 @@ namespace cubos::engine
         std::type_index type(const AnyAsset& handle) const;
 
     private:
+        friend AssetGroup;
+
         /// @brief Represents a known asset - may or may not be loaded.
         struct Entry
         {
@@ -238,13 +504,54 @@ namespace cubos::engine
             void* data{nullptr};       ///< Pointer to the asset data, if loaded. Otherwise, nullptr.
             std::type_index type;      ///< The type of the asset data - initially typeid(void).
             void (*destructor)(void*); ///< The destructor for the asset data - initially nullptr.
+
+            std::size_t size{0};               ///< Memory used by the asset data, as reported by a bridge.
+            std::atomic<bool> used{false};     ///< Whether the asset was accessed since cleanup last visited it.
+            std::atomic<bool> refining{false}; ///< Whether a coarse version is stored and still being refined.
+
+            uint32_t slot{0}; ///< Slot of the entry in the registry, plus one.
         };
 
+        /// @brief Part of the asset registry, holding the entries of the assets whose UUIDs hash to it.
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;                                 ///< Protects the entries map.
+            std::unordered_map<uuids::uuid, std::unique_ptr<Entry>> entries; ///< Entries by UUID.
+        };
+
+        /// @brief Number of shards the asset registry is split into.
+        static constexpr std::size_t ShardCount = 16;
+
+        /// @brief Number of slots in each block of the slot table.
+        static constexpr std::size_t SlotBlockSize = 4096;
+
+        /// @brief Maximum number of blocks in the slot table.
+        static constexpr std::size_t SlotBlockCount = 1024;
+
+        /// @brief Block of the slot table, which maps slots to entries.
+        using SlotBlock = std::array<std::atomic<Entry*>, SlotBlockSize>;
+
         /// @brief Stores all data necessary to load an asset.
         struct Task
         {
             AnyAsset handle;                     ///< The handle to load the asset for.
             std::shared_ptr<AssetBridge> bridge; ///< The bridge to use to load the asset.
+            std::string extension;               ///< Extension the bridge was registered with.
+            std::string path;                    ///< Path of the asset's file, used for prefetching.
+            Priority priority;                   ///< Priority the asset was queued with.
+
+            /// @brief Assets which must be loaded before the task runs. Made strong before the
+            /// task runs, so that they aren't unloaded before it does.
+            std::vector<AnyAsset> dependencies;
+
+            bool dependencyFailed{false}; ///< Whether one of the dependencies failed to load.
+        };
+
+        /// @brief Task waiting for its dependencies to finish loading.
+        struct SuspendedTask
+        {
+            Task task;           ///< The suspended task.
+            std::size_t pending; ///< Number of dependencies still loading.
         };
 
         /// @brief Untyped version of @ref create().
@@ -259,14 +566,16 @@ namespace cubos::engine
         /// @param type Type of the asset data.
         /// @param data Asset data to store.
         /// @param destructor Destructor for the asset data.
+        /// @param coarse Whether the data is a coarse version which its bridge is still refining.
         /// @return Strong handle to the asset.
-        AnyAsset store(AnyAsset handle, std::type_index type, void* data, void (*destructor)(void*));
+        AnyAsset store(AnyAsset handle, std::type_index type, void* data, void (*destructor)(void*),
+                       bool coarse = false);
 
         /// @brief Gets a pointer to the asset data associated with the given handle.
         ///
         /// If the asset is not loaded, this blocks until it is. If the asset cannot be loaded,
-        /// abort is called. If this function is called from the loader thread, instead of waiting
-        /// for the asset to load, it will be loaded synchronously.
+        /// abort is called. Loader threads must never block, and thus can only access assets
+        /// which are loaded, which bridges make sure of through @ref require().
         ///
         /// @tparam Lock The type of the lock guard.
         /// @param handle Handle to get the asset data for.
@@ -277,6 +586,15 @@ namespace cubos::engine
         template <typename Lock>
         void* access(const AnyAsset& handle, std::type_index type, Lock& lock, bool incVersion) const;
 
+        /// @brief Records that the current thread was blocked waiting for an asset to load.
+        /// @param time Time spent blocked, in seconds.
+        void recordWait(double time) const;
+
+        /// @brief Blocks until the given asset is no longer loading.
+        /// @param handle Handle of the asset.
+        /// @return Whether the asset is loaded.
+        bool wait(const AnyAsset& handle) const;
+
         /// @brief Locks the given asset for reading.
         /// @param handle Handle to lock.
         /// @return Lock guard.
@@ -287,48 +605,185 @@ namespace cubos::engine
         /// @return Lock guard.
         std::unique_lock<std::shared_mutex> lockWrite(const AnyAsset& handle) const;
 
+        /// @brief Gets the shard of the registry which holds the entry of the given asset.
+        /// @param id UUID of the asset.
+        /// @return Registry shard.
+        Shard& shard(const uuids::uuid& id) const;
+
+        /// @brief Gets the entry in the slot remembered by the given handle, without locking.
+        /// @param handle Handle to get the entry for.
+        /// @return Entry, or nullptr if the handle has no slot or it was assigned by another manager.
+        Entry* slot(const AnyAsset& handle) const;
+
+        /// @brief Gets the entry cached by a strong handle, or the one in the slot remembered by
+        /// the given handle, without locking.
+        /// @param handle Handle to get the entry for.
+        /// @return Entry, or nullptr if the handle remembers neither or was created by another manager.
+        Entry* cached(const AnyAsset& handle) const;
+
         /// @brief Gets a pointer to the entry associated with the given handle.
+        ///
+        /// Entries are never removed while the manager exists, and thus the returned pointer stays
+        /// valid. Strong handles cache it, and for them no lookup is necessary. Handles which
+        /// remember their slot are looked up in the slot table, and only the remaining ones hash
+        /// their UUID.
+        ///
         /// @param handle Handle to get the entry for.
         /// @return Entry for the given handle, or nullptr if there is no such entry.
-        std::shared_ptr<Entry> entry(const AnyAsset& handle) const;
+        Entry* entry(const AnyAsset& handle) const;
 
         /// @brief Gets a pointer to the entry associated with the given handle.
         /// @param handle Handle to get the entry for.
         /// @param create Whether to create the entry if it doesn't exist.
         /// @return Entry for the given handle, or nullptr if the handle is invalid.
-        std::shared_ptr<Entry> entry(const AnyAsset& handle, bool create);
+        Entry* entry(const AnyAsset& handle, bool create);
+
+        /// @brief Makes the given handle remember the slot of the given entry.
+        /// @param handle Handle to modify.
+        /// @param entry Entry of the asset.
+        void assignSlot(AnyAsset& handle, const Entry& entry) const;
+
+        /// @brief Makes the given handle a strong handle to the given entry.
+        /// @param handle Handle to upgrade.
+        /// @param entry Entry of the asset.
+        void makeStrong(AnyAsset& handle, Entry& entry) const;
 
         /// @brief Gets a pointer to the bridge to be used for loading the asset identified by the
         /// given handle.
         /// @param handle Handle to get the bridge for.
+        /// @param extension Optional output for the extension the bridge was registered with.
         /// @return Bridge used for the given asset, or nullptr if there's no bridge.
-        std::shared_ptr<AssetBridge> bridge(const AnyAsset& handle) const;
+        std::shared_ptr<AssetBridge> bridge(const AnyAsset& handle, std::string* extension = nullptr) const;
+
+        /// @brief Estimates the memory used by asset data, using a bridge registered for its type.
+        /// @param type Type of the asset data.
+        /// @param data Asset data.
+        /// @return Size in bytes, or zero if no bridge loads assets of the given type.
+        std::size_t memorySize(std::type_index type, const void* data) const;
+
+        /// @brief Records that an asset was modified, so that it's returned by @ref takeModified().
+        /// @param handle Handle of the asset.
+        void markModified(const AnyAsset& handle) const;
+
+        /// @brief Stores the metadata read from a metadata file, replacing the asset's metadata.
+        /// @param path Path of the metadata file.
+        /// @param meta Metadata read from the file.
+        void registerMeta(std::string_view path, AssetMeta meta);
 
         /// @brief Unloads the given asset. Can be used to force assets to be reloaded.
         /// @param handle Handle to unload.
         /// @param shouldLock Locks the asset if true, otherwise assumes the asset is already locked.
         void invalidate(const AnyAsset& handle, bool shouldLock);
 
-        /// @brief Function run by the loader thread.
+        /// @brief Frees the data of the given asset, which must be locked and have data.
+        /// @param entry Entry of the asset.
+        void unload(Entry& entry);
+
+        /// @brief Function run by the loader threads.
         void loader();
 
+        /// @brief Checks whether the current thread is one of the loader threads.
+        /// @return Whether the current thread is a loader thread.
+        bool isLoaderThread() const;
+
+        /// @brief Starts the given number of loader threads.
+        /// @param count Number of threads.
+        void startLoaders(std::size_t count);
+
+        /// @brief Stops all loader threads, waiting for them to finish their current tasks.
+        void stopLoaders();
+
+        /// @brief Suspends a task taken from the loader queue if some of its dependencies aren't
+        /// loaded yet, queueing them.
+        /// @param task Task to suspend, moved from if it is suspended.
+        /// @return Whether the task was suspended.
+        bool suspendTask(Task& task) const;
+
+        /// @brief Loads the asset of a task, which must have been taken from the loader queue.
+        ///
+        /// If the bridge required assets which aren't loaded yet, they're added to the task's
+        /// dependencies, and the task must be suspended again.
+        ///
+        /// @param task Task to run.
+        /// @return Whether the task finished, either successfully or not.
+        bool runTask(Task& task) const;
+
+        /// @brief Queues again the tasks suspended waiting for the given asset, once it was the
+        /// last of their dependencies to finish loading.
+        ///
+        /// Must be called with @ref mLoaderMutex locked.
+        ///
+        /// @param handle Handle of the asset which finished loading.
+        /// @param success Whether the asset was loaded successfully.
+        void resumeDependents(const AnyAsset& handle, bool success) const;
+
         /// @brief Bridges associated to their supported extensions.
         std::unordered_map<std::string, std::shared_ptr<AssetBridge>> mBridges;
 
-        /// @brief Info for all known assets.
-        std::unordered_map<uuids::uuid, std::shared_ptr<Entry>> mEntries;
+        /// @brief Info for all known assets, split into shards by UUID so that lookups of different
+        /// assets rarely contend for the same lock.
+        mutable std::array<Shard, ShardCount> mShards;
+
+        /// @brief All known assets, in the order they're visited by @ref cleanup().
+        std::vector<std::pair<uuids::uuid, Entry*>> mEntryList;
+        std::atomic<std::size_t> mCleanupHand{0}; ///< Counts the entries visited by @ref cleanup().
+
+        /// @brief Maps the slots of the entries, which are their indices in @ref mEntryList, to the
+        /// entries. Blocks are allocated under @ref mMutex and never moved, so reads don't lock.
+        std::array<std::atomic<SlotBlock*>, SlotBlockCount> mSlotBlocks{};
+        uint32_t mGeneration; ///< Distinguishes the handles of this manager from those of others.
+
+        std::atomic<std::size_t> mMemoryBudget{0};       ///< Memory budget in bytes, or zero if there's none.
+        mutable std::atomic<std::size_t> mMemoryUsed{0}; ///< Memory used by loaded assets, in bytes.
+        std::atomic<std::size_t> mLoadedCount{0};        ///< Number of loaded assets.
+        std::atomic<std::size_t> mEvictions{0};          ///< Number of unused assets unloaded by cleanup.
+
+        /// @brief Identifiers of the assets with metadata files, by the path of the asset's file.
+        /// Protected by @ref mMutex.
+        std::unordered_map<std::string, uuids::uuid> mPathIds;
+
+        /// @brief Assets modified since @ref takeModified() was last called. Protected by @ref mMutex.
+        mutable std::vector<AnyAsset> mModified;
+
+        /// @brief Cache for data derived from assets, shared with consumers which may outlive the manager.
+        std::shared_ptr<DerivedCache> mCache{std::make_shared<DerivedCache>()};
 
         /// @brief Mersenne Twister used for random UUID generation.
         std::optional<std::mt19937> mRandom;
 
-        /// @brief Read-write lock protecting the bridges and entries maps.
+        /// @brief Read-write lock protecting the bridges map, the entry list and the path index.
         mutable std::shared_mutex mMutex;
 
-        /// @brief Loader thread for asynchronous loading.
-        std::thread mLoaderThread;
-        mutable std::deque<Task> mLoaderQueue;       ///< Queued tasks for the loader thread.
-        mutable std::mutex mLoaderMutex;             ///< Mutex for the loader queue.
-        mutable std::condition_variable mLoaderCond; ///< Triggered on queue change or on exit.
-        bool mLoaderShouldExit;                      ///< Whether the loader thread should exit.
+        /// @brief Loader threads for asynchronous loading.
+        std::vector<std::thread> mLoaderThreads;
+        mutable std::array<std::deque<Task>, 3> mLoaderQueue; ///< Queued tasks, by priority.
+        mutable std::mutex mLoaderMutex;                      ///< Mutex for the loader queue.
+        mutable std::condition_variable mLoaderCond;          ///< Triggered on queue change or on exit.
+        bool mLoaderShouldExit;                               ///< Whether the loader threads should exit.
+
+        /// @brief Timing statistics of each bridge, by extension. Protected by @ref mLoaderMutex.
+        mutable std::unordered_map<std::string, BridgeStats> mBridgeStats;
+
+        /// @brief Tasks waiting for their dependencies to load, by asset. Protected by @ref mLoaderMutex.
+        mutable std::unordered_map<uuids::uuid, SuspendedTask> mLoaderSuspended;
+
+        /// @brief Suspended tasks waiting for each asset, by the asset they wait for. Protected by
+        /// @ref mLoaderMutex.
+        mutable std::unordered_multimap<uuids::uuid, uuids::uuid> mLoaderDependents;
+
+        /// @brief Highest number of queued tasks at once. Protected by @ref mLoaderMutex.
+        mutable std::size_t mLoaderMaxQueued{0};
+
+        /// @brief Number of files opened with and without having been prefetched.
+        mutable std::atomic<std::size_t> mPrefetchHits{0};
+        mutable std::atomic<std::size_t> mPrefetchMisses{0};
+
+        /// @brief Time spent blocked waiting for assets, by thread. Protected by @ref mLoaderMutex.
+        mutable std::unordered_map<std::thread::id, WaitStats> mWaitStats;
+
+        /// @brief Contents of the files of queued assets which are being read in the background.
+        /// Protected by @ref mLoaderMutex.
+        mutable std::unordered_map<uuids::uuid, std::future<std::unique_ptr<core::memory::Stream>>>
+            mLoaderPrefetched;
     };
 } // namespace cubos::engine
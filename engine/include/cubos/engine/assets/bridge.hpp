@@ -22,7 +22,7 @@ namespace cubos::engine
     /// which could be loaded but not saved, for example.
     ///
     /// Bridges should take into account that the asset manager calls them from a different thread
-    /// than the one that created them.
+    /// than the one that created them, and possibly from multiple threads at once.
     ///
     /// @ingroup assets-plugin
     class AssetBridge
@@ -40,7 +40,9 @@ namespace cubos::engine
 
         /// @brief Loads an asset.
         ///
-        /// The metadata of the given asset should already be present in the asset manager.
+        /// The metadata of the given asset should already be present in the asset manager. Other
+        /// assets must be passed to @ref Assets::require() before being read, and if it returns
+        /// false, this must return false too, to be called again once they're loaded.
         ///
         /// @param assets Manager to write into.
         /// @param handle Handle of the asset being loaded.
@@ -56,6 +58,29 @@ namespace cubos::engine
         /// @return Whether the asset was successfully saved.
         virtual bool save(const Assets& assets, const AnyAsset& handle);
 
+        /// @brief Estimates how much memory the data of an asset loaded by this bridge uses.
+        ///
+        /// Used by the asset manager to account for the memory used by loaded assets, and to decide
+        /// when unused assets must be evicted. Bridges which don't override it report zero, which
+        /// means their assets don't count towards the memory budget. The generic file bridges
+        /// only count the size of the asset type itself, and thus bridges for types which own heap
+        /// memory should override this to include it.
+        ///
+        /// @param data Asset data, of the type returned by @ref assetType().
+        /// @return Size in bytes.
+        virtual std::size_t memorySize(const void* data) const;
+
+        /// @brief Checks whether the bridge stores coarse versions of its assets and refines them
+        /// while reading their files, as described in @ref Assets::storeCoarse().
+        ///
+        /// The files of assets loaded by progressive bridges aren't read into memory ahead of time.
+        ///
+        /// @return Whether the bridge is progressive.
+        virtual bool progressive() const
+        {
+            return false;
+        }
+
         /// @brief Gets the type of the assets the bridge loads.
         /// @return Type of the asset.
         inline std::type_index assetType() const
@@ -32,6 +32,12 @@ namespace cubos::engine
         {
         }
 
+        /// @copydoc AssetBridge::memorySize
+        std::size_t memorySize(const void* /*data*/) const override
+        {
+            return sizeof(T);
+        }
+
     protected:
         bool loadFromFile(Assets& assets, const AnyAsset& handle, core::memory::Stream& stream) override
         {
@@ -35,13 +35,17 @@ namespace cubos::engine
         {
         }
 
+        /// @copydoc AssetBridge::memorySize
+        std::size_t memorySize(const void* /*data*/) const override
+        {
+            return sizeof(T);
+        }
+
     protected:
         bool loadFromFile(Assets& assets, const AnyAsset& handle, core::memory::Stream& stream) override
         {
-            // Dump the file stream into a string and initialize a JSON deserializer with it.
-            std::string json{};
-            stream.readUntil(json, nullptr);
-            core::data::old::JSONDeserializer deserializer{json};
+            // Initialize a JSON deserializer which reads directly from the file stream.
+            core::data::old::JSONDeserializer deserializer{stream};
 
             // Deserialize the asset and store it in the asset manager.
             T data{};
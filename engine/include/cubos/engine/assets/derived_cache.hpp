@@ -0,0 +1,112 @@
+/// @file
+/// @brief Class @ref cubos::engine::DerivedCache.
+/// @ingroup assets-plugin
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cubos::engine
+{
+    /// @brief Persistent cache for data derived from assets, such as the meshes of voxel grids,
+    /// which is expensive to compute but can be computed again at any time.
+    ///
+    /// Entries are identified by a kind, which groups entries of the same type, and a key, which
+    /// should be a hash of everything the data was derived from - see @ref hash(). Each entry also
+    /// stores the version of the code which produced it, and reading it with a different version
+    /// is a miss, so that changing the derivation only requires increasing its version.
+    ///
+    /// Entries are stored compressed in a directory of the virtual file system, one file per
+    /// entry. A cache constructed without a directory is disabled, and all reads miss.
+    ///
+    /// Can be used from multiple threads at once.
+    ///
+    /// @ingroup assets-plugin
+    class DerivedCache final
+    {
+    public:
+        /// @brief Seed used by @ref hash() by default.
+        static constexpr uint64_t DefaultSeed = 0xCBF29CE484222325ULL;
+
+        /// @brief Usage statistics of the cache.
+        struct Stats
+        {
+            std::size_t hits{0};   ///< Number of reads which found a matching entry.
+            std::size_t misses{0}; ///< Number of reads which didn't.
+            std::size_t writes{0}; ///< Number of entries written.
+        };
+
+        /// @brief Constructs a disabled cache.
+        DerivedCache() = default;
+
+        /// @brief Copy constructs, including the statistics.
+        /// @param other Cache to copy.
+        DerivedCache(const DerivedCache& other);
+
+        /// @brief Copy assigns, including the statistics.
+        /// @param other Cache to copy.
+        /// @return This cache.
+        DerivedCache& operator=(const DerivedCache& other);
+
+        /// @brief Constructs a cache which stores its entries in the given directory.
+        /// @param root Absolute path of the directory in the virtual file system.
+        explicit DerivedCache(std::string root);
+
+        /// @brief Checks whether the cache is enabled.
+        /// @return Whether the cache has a directory.
+        bool enabled() const;
+
+        /// @brief Hashes the given bytes, to be used as or combined into a key.
+        /// @param data Bytes to hash.
+        /// @param size Number of bytes.
+        /// @param seed Hash to continue from, used to combine multiple hashes.
+        /// @return Hash of the data.
+        static uint64_t hash(const void* data, std::size_t size, uint64_t seed = DefaultSeed);
+
+        /// @brief Reads the data of an entry.
+        /// @param kind Kind of the entry.
+        /// @param key Key of the entry.
+        /// @param version Version of the code which derives the data.
+        /// @param data Output for the data.
+        /// @return Whether the entry was found, with a matching version.
+        bool read(std::string_view kind, uint64_t key, uint32_t version, std::vector<char>& data) const;
+
+        /// @brief Writes the data of an entry, replacing it if it already exists.
+        /// @param kind Kind of the entry.
+        /// @param key Key of the entry.
+        /// @param version Version of the code which derived the data.
+        /// @param data Data to store.
+        /// @param size Size of the data in bytes.
+        /// @return Whether the entry was written successfully.
+        bool write(std::string_view kind, uint64_t key, uint32_t version, const void* data, std::size_t size) const;
+
+        /// @brief Gets the usage statistics of the cache.
+        /// @return Statistics.
+        Stats stats() const;
+
+    private:
+        /// @brief Reads the data of an entry, without updating the statistics.
+        /// @param kind Kind of the entry.
+        /// @param key Key of the entry.
+        /// @param version Version of the code which derives the data.
+        /// @param data Output for the data.
+        /// @return Whether the entry was found, with a matching version.
+        bool readEntry(std::string_view kind, uint64_t key, uint32_t version, std::vector<char>& data) const;
+
+        /// @brief Gets the path of the file of an entry.
+        /// @param kind Kind of the entry.
+        /// @param key Key of the entry.
+        /// @return Absolute path in the virtual file system.
+        std::string path(std::string_view kind, uint64_t key) const;
+
+        std::string mRoot; ///< Directory where the entries are stored, or empty if disabled.
+
+        mutable std::atomic<std::size_t> mHits{0};   ///< Number of reads which found a matching entry.
+        mutable std::atomic<std::size_t> mMisses{0}; ///< Number of reads which didn't.
+        mutable std::atomic<std::size_t> mWrites{0}; ///< Number of entries written.
+    };
+} // namespace cubos::engine
@@ -0,0 +1,70 @@
+/// @file
+/// @brief Class @ref cubos::engine::AssetGroup.
+/// @ingroup assets-plugin
+
+#pragma once
+
+#include <vector>
+
+#include <cubos/engine/assets/asset.hpp>
+
+namespace cubos::engine
+{
+    class Assets;
+
+    /// @brief Handle to a group of assets which are loaded together, returned by @ref
+    /// Assets::loadGroup().
+    ///
+    /// Holds strong handles to all assets in the group, and thus keeps them loaded while it
+    /// exists. Can be used to implement loading screens, by checking the progress of the group
+    /// every frame instead of blocking on the first read of one of its assets.
+    ///
+    /// @ingroup assets-plugin
+    class AssetGroup final
+    {
+    public:
+        /// @brief Constructs an empty group, which is always done.
+        AssetGroup() = default;
+
+        /// @brief Gets the handles of the assets in the group, in the order they were queued.
+        /// @return Strong handles to the assets, dependencies before their dependents.
+        inline const std::vector<AnyAsset>& assets() const
+        {
+            return mAssets;
+        }
+
+        /// @brief Gets the number of assets in the group.
+        /// @return Number of assets.
+        std::size_t total() const;
+
+        /// @brief Gets the number of assets in the group which are loaded.
+        /// @return Number of loaded assets.
+        std::size_t loaded() const;
+
+        /// @brief Gets the number of assets in the group which failed to load.
+        /// @return Number of assets which failed to load.
+        std::size_t failed() const;
+
+        /// @brief Gets the fraction of the assets in the group which are no longer loading.
+        /// @return Value between 0 and 1.
+        float progress() const;
+
+        /// @brief Checks whether all assets in the group finished loading, successfully or not.
+        /// @return Whether the group is done.
+        bool done() const;
+
+        /// @brief Blocks until all assets in the group finish loading, successfully or not.
+        ///
+        /// Must not be called from a bridge.
+        ///
+        /// @return Whether all assets were loaded successfully.
+        bool wait() const;
+
+    private:
+        friend Assets;
+
+        const Assets* mManager{nullptr}; ///< Manager which is loading the assets.
+        std::vector<AnyAsset> mAssets;   ///< Strong handles to the assets.
+        std::size_t mUnqueued{0};        ///< Number of assets which couldn't even be queued.
+    };
+} // namespace cubos::engine
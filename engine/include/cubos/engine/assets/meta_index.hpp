@@ -0,0 +1,113 @@
+/// @file
+/// @brief Class @ref cubos::engine::AssetMetaIndex.
+/// @ingroup assets-plugin
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <cubos/core/data/fs/file.hpp>
+#include <cubos/core/memory/stream.hpp>
+
+#include <cubos/engine/assets/meta.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Pre-built index of the metadata files in a directory, which allows @ref
+    /// Assets::loadMeta() to skip opening and parsing every single `.meta` file.
+    ///
+    /// Stores the parameters of each `.meta` file as they are written in the file, along with the
+    /// file's modification time, and the contents and modification time of each directory.
+    /// Directories which weren't modified since the index was built are taken from the index as
+    /// they are, without listing them. Modified directories are listed again, and their `.meta`
+    /// files are only parsed again if they were modified too.
+    ///
+    /// Since modifying a file in place doesn't modify its directory, such changes are only picked
+    /// up after the index is built again.
+    ///
+    /// Paths are stored relative to the directory the index was built from, so that the directory
+    /// can be mounted anywhere on the virtual file system.
+    ///
+    /// @ingroup assets-plugin
+    class AssetMetaIndex final
+    {
+    public:
+        /// @brief Version of the binary format of the index.
+        static constexpr uint32_t Version = 2;
+
+        /// @brief Entry of the index, corresponding to a single `.meta` file.
+        struct Entry
+        {
+            uint64_t modificationTime; ///< Modification time of the file when it was indexed.
+            AssetMeta meta;            ///< Parameters in the file.
+        };
+
+        /// @brief Directory of the index, with the files it contained when it was indexed.
+        struct Directory
+        {
+            uint64_t modificationTime;            ///< Modification time of the directory when it was indexed.
+            std::vector<std::string> directories; ///< Names of its subdirectories.
+            std::vector<std::string> metas;       ///< Names of its indexed `.meta` files.
+        };
+
+        /// @brief Reads the metadata of a single `.meta` file.
+        /// @param file Metadata file.
+        /// @param meta Output metadata.
+        /// @return Whether the file was read successfully.
+        static bool readFile(core::data::File& file, AssetMeta& meta);
+
+        /// @brief Adds every `.meta` file in the given directory, recursively, to the index.
+        /// @param path Path of the directory in the virtual file system.
+        /// @return Whether all metadata files were read successfully.
+        bool build(std::string_view path);
+
+        /// @brief Adds or replaces an entry.
+        /// @param path Path of the `.meta` file, relative to the indexed directory.
+        /// @param entry Entry.
+        void insert(std::string path, Entry entry);
+
+        /// @brief Finds the entry of a `.meta` file.
+        /// @param path Path of the `.meta` file, relative to the indexed directory.
+        /// @return Entry, or nullptr if the file isn't indexed.
+        const Entry* find(const std::string& path) const;
+
+        /// @brief Adds or replaces a directory.
+        /// @param path Path of the directory, relative to the indexed directory, which is empty for
+        /// the indexed directory itself.
+        /// @param directory Directory.
+        void insertDirectory(std::string path, Directory directory);
+
+        /// @brief Finds a directory.
+        /// @param path Path of the directory, relative to the indexed directory.
+        /// @return Directory, or nullptr if it isn't indexed.
+        const Directory* findDirectory(const std::string& path) const;
+
+        /// @brief Gets the number of entries in the index.
+        /// @return Number of entries.
+        std::size_t size() const;
+
+        /// @brief Reads the index from a stream, replacing its current entries.
+        /// @param stream Stream to read from.
+        /// @return Whether the index was read successfully and has a matching version.
+        bool read(core::memory::Stream& stream);
+
+        /// @brief Writes the index to a stream.
+        /// @param stream Stream to write to.
+        /// @return Whether the index was written successfully.
+        bool write(core::memory::Stream& stream) const;
+
+    private:
+        /// @brief Adds a `.meta` file to the index, and ignores any other file.
+        /// @param file File.
+        /// @param path Path of the file, relative to the indexed directory.
+        /// @return Whether the file was read successfully.
+        bool buildFile(core::data::File& file, std::string path);
+
+        std::unordered_map<std::string, Entry> mEntries;         ///< Entries indexed by relative path.
+        std::unordered_map<std::string, Directory> mDirectories; ///< Directories indexed by relative path.
+    };
+} // namespace cubos::engine
@@ -20,9 +20,16 @@ namespace cubos::engine
     /// - `assets.io.enabled` - whether asset I/O should be done (default: `true`).
     /// - `assets.io.path` - path to the assets directory - will be mounted to `/assets/` (default: `assets/`).
     /// - `assets.io.readOnly` - if true, the assets directory will be mounted as read-only (default: `true`).
+    /// - `assets.io.watch` - if true, assets whose files are modified are reloaded (default: `false`, Linux only).
+    /// - `assets.io.index` - metadata index in the assets directory, empty to disable (default: `assets.index`).
+    /// - `assets.loader.threads` - number of threads which load assets (default: half of the hardware threads).
+    /// - `assets.cache.enabled` - whether data derived from assets is cached on disk (default: `false`).
+    /// - `assets.cache.path` - path to the cache directory - will be mounted to `/cache/` (default: `cache/`).
+    /// - `assets.memory.budget` - memory in MiB unused assets are kept loaded within (default: `0`).
     ///
     /// ## Events
-    /// - @ref AssetEvent - (TODO) emitted when an asset is either loaded, modified or unloaded.
+    /// - @ref AssetModifiedEvent - emitted when an asset is reloaded because its file was modified,
+    ///   written to, stored again, invalidated, or when a coarse asset is refined by its bridge.
     ///
     /// ## Resources
     /// - @ref Assets - the asset manager, used to access asset data.
@@ -33,11 +40,22 @@ namespace cubos::engine
     /// - `cubos.assets` - startup systems which load assets should be tagged with this.
     ///
     /// ## Tags
-    /// - `cubos.assets.cleanup` - frees any assets no longer in use.
+    /// - `cubos.assets.cleanup` - frees assets no longer in use, a few at a time.
+    /// - `cubos.assets.watch` - reloads assets whose files were modified, if `assets.io.watch` is enabled,
+    ///   and reports modified assets.
     ///
     /// ## Dependencies
     /// - @ref settings-plugin
 
+    /// @brief Event sent when an asset is modified: when it's reloaded because its file was
+    /// modified, written to through @ref Assets::write(), stored again, invalidated, or when a coarse
+    /// version of it, stored with @ref Assets::storeCoarse(), is refined.
+    /// @ingroup assets-plugin
+    struct AssetModifiedEvent
+    {
+        AnyAsset asset; ///< Handle to the modified asset.
+    };
+
     /// @brief Plugin entry function.
     /// @param cubos @b CUBOS. main class.
     /// @ingroup assets-plugin
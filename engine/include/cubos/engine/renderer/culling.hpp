@@ -0,0 +1,29 @@
+/// @file
+/// @brief Function @ref cubos::engine::cullDrawCmds.
+/// @ingroup renderer-plugin
+
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <cubos/engine/renderer/frame.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Finds which draw commands may be visible through a camera, by testing the bounding
+    /// boxes of their grids against the camera's view frustum.
+    ///
+    /// Draw commands are tested in batches, with the world space boxes of each batch laid out on
+    /// separate arrays per component, so that the tests of the whole batch are vectorized. The
+    /// test is conservative: some boxes near the corners of the frustum may pass it while not
+    /// being visible.
+    ///
+    /// @param viewProjection Projection matrix of the camera multiplied by its view matrix.
+    /// @param drawCmds Draw commands to test.
+    /// @param visible Indices of the draw commands which passed the test, in increasing order.
+    /// @ingroup renderer-plugin
+    void cullDrawCmds(const glm::mat4& viewProjection, const std::vector<RendererFrame::DrawCmd>& drawCmds,
+                      std::vector<std::size_t>& visible);
+} // namespace cubos::engine
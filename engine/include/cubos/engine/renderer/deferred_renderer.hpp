@@ -4,28 +4,41 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <cubos/core/gl/render_device.hpp>
 
+#include <cubos/engine/renderer/light_clusters.hpp>
 #include <cubos/engine/renderer/renderer.hpp>
 #include <cubos/engine/renderer/vertex.hpp>
 #include <cubos/engine/settings/settings.hpp>
 
 // TODO: make these defines proper constants (we're using C++!)
-#define CUBOS_DEFERRED_RENDERER_MAX_SPOT_LIGHT_COUNT 128
 #define CUBOS_DEFERRED_RENDERER_MAX_DIRECTIONAL_LIGHT_COUNT 128
-#define CUBOS_DEFERRED_RENDERER_MAX_POINT_LIGHT_COUNT 128
 
 namespace cubos::engine
 {
+    namespace impl
+    {
+        class DeferredMeshPage;
+    } // namespace impl
+
     /// @brief Renderer implementation which uses deferred rendering.
     ///
-    /// Voxel grids are first triangulated, and then the triangles are uploaded to the GPU.
+    /// Voxel grids are first triangulated, and then the triangles are uploaded to the GPU. If the
+    /// `cubos.renderer.vertices.packed` setting is enabled, vertices are uploaded with the compact
+    /// @ref PackedVoxelVertex layout, except for grids too large for it. Meshes aren't given buffers
+    /// of their own: they're sub-allocated from large shared vertex and index buffers, using a
+    /// @ref MeshAllocator for each, and drawn with base vertex offsets.
     /// The rendering is done in two passes:
     /// 1. Render the scene to the GBuffer textures: position, normal and material.
     /// 2. Take the GBuffer textures and calculate the color of the pixels with the lighting applied.
     ///
+    /// Point and spot lights are assigned to the clusters of the camera's view frustum on the CPU,
+    /// using @ref LightClusters, and each pixel is only lit by the lights of its cluster, so there's
+    /// no fixed limit on their number.
+    ///
     /// @ingroup renderer-plugin
     class DeferredRenderer : public BaseRenderer
     {
@@ -40,17 +53,54 @@ namespace cubos::engine
 
         // Implement interface methods.
 
-        RendererGrid upload(const VoxelGrid& grid) override;
         void setPalette(const VoxelPalette& palette) override;
 
     protected:
         // Implement interface methods.
 
+        RendererGrid onUpload(const std::vector<VoxelVertex>& vertices, const std::vector<uint32_t>& indices) override;
         void onResize(glm::uvec2 size) override;
         void onRender(const glm::mat4& view, const Viewport& viewport, const Camera& camera, const RendererFrame& frame,
                       core::gl::Framebuffer target) override;
 
     private:
+        /// @brief Finds room for a mesh on the shared mesh buffers, defragmenting them or creating
+        /// new ones if needed.
+        /// @param packed Whether the mesh's vertices use the packed layout.
+        /// @param shortIndices Whether the mesh's indices fit in 16 bits.
+        /// @param vertexCount Number of vertices of the mesh.
+        /// @param indexCount Number of indices of the mesh.
+        /// @param baseVertex Offset of the vertices allocated for the mesh.
+        /// @param firstIndex Offset of the indices allocated for the mesh.
+        /// @return Buffers the mesh was allocated from.
+        std::shared_ptr<impl::DeferredMeshPage> allocateMesh(bool packed, bool shortIndices, std::size_t vertexCount,
+                                                             std::size_t indexCount, std::size_t& baseVertex,
+                                                             std::size_t& firstIndex);
+
+        /// @brief Moves the meshes of a page to the start of new buffers, merging its free space.
+        /// @param page Page to defragment.
+        void defragment(impl::DeferredMeshPage& page);
+
+        /// @brief Creates a vertex array which reads the vertices of a page.
+        /// @param packed Whether the vertices use the packed layout.
+        /// @param vb Vertex buffer of the page.
+        /// @return Vertex array.
+        core::gl::VertexArray createMeshVertexArray(bool packed, core::gl::VertexBuffer vb);
+
+        /// @brief Writes the model matrices of the visible draw commands to the instances ring
+        /// buffer, in batches which are bound separately.
+        /// @param frame Frame being drawn.
+        /// @return Offset of the first batch in the buffer, in bytes.
+        std::size_t writeInstances(const RendererFrame& frame);
+
+        /// @brief Assigns the point and spot lights of the frame to the clusters of the camera's
+        /// view frustum, and uploads them along with their clusters.
+        /// @param view View matrix of the camera.
+        /// @param camera Camera being drawn.
+        /// @param aspect Aspect ratio of the viewport.
+        /// @param frame Frame being drawn.
+        void clusterLights(const glm::mat4& view, const Camera& camera, float aspect, const RendererFrame& frame);
+
         void createSSAOTextures();
         void generateSSAONoise();
 
@@ -67,11 +117,33 @@ namespace cubos::engine
 
         core::gl::ShaderPipeline mGeometryPipeline;
         core::gl::ShaderBindingPoint mVpBp;
+        core::gl::ShaderBindingPoint mInstancesBp;
+        core::gl::ShaderBindingPoint mBaseInstanceBp;
         core::gl::ConstantBuffer mVpBuffer;
+        core::gl::ConstantBuffer mInstancesBuffer; ///< Ring of batches of instance model matrices.
+        std::size_t mInstancesBatchStride{0};      ///< Distance in bytes between consecutive batches.
+        std::size_t mInstancesBatches{0};          ///< Number of batches which fit in the ring.
+        std::size_t mInstancesHead{0};             ///< Batch where the next render starts writing.
         core::gl::RasterState mGeometryRasterState;
         core::gl::BlendState mGeometryBlendState;
         core::gl::DepthStencilState mGeometryDepthStencilState;
 
+        // Geometry pass pipeline for grids with packed vertices.
+
+        bool mPackedVertices = false;
+        core::gl::ShaderPipeline mPackedGeometryPipeline;
+        core::gl::ShaderBindingPoint mPackedVpBp;
+        core::gl::ShaderBindingPoint mPackedInstancesBp;
+        core::gl::ShaderBindingPoint mPackedBaseInstanceBp;
+
+        // Shared vertex and index buffers which the meshes of grids are allocated from.
+
+        std::vector<std::shared_ptr<impl::DeferredMeshPage>> mMeshPages;
+
+        // Indices of the draw commands which passed frustum culling, kept to reuse its memory.
+
+        std::vector<std::size_t> mVisibleDrawCmds;
+
         // Lighting pass pipeline.
 
         core::gl::ShaderPipeline mLightingPipeline;
@@ -88,10 +160,30 @@ namespace cubos::engine
         core::gl::ShaderBindingPoint mSkyGradientTopBp;
         core::gl::ShaderBindingPoint mInvVBp;
         core::gl::ShaderBindingPoint mInvPBp;
+        core::gl::ShaderBindingPoint mVBp;
+        core::gl::ShaderBindingPoint mClusterScaleBp;
+        core::gl::ShaderBindingPoint mClusterBiasBp;
+        core::gl::ShaderBindingPoint mClustersBp;
+        core::gl::ShaderBindingPoint mLightIndicesBp;
+        core::gl::ShaderBindingPoint mLightDataBp;
         core::gl::Sampler mSampler;
         core::gl::Texture2D mPaletteTex;
         core::gl::ConstantBuffer mLightsBuffer;
 
+        // Point and spot lights, and the clusters they were assigned to. The CPU side data is kept
+        // to reuse its memory.
+
+        LightClusters mLightClusters;
+        std::vector<glm::vec4> mLightSpheres;    ///< Bounding sphere of each light.
+        std::vector<glm::vec4> mLightData;       ///< Four texels of data per light.
+        std::vector<uint16_t> mClustersData;     ///< Offset and count of the lights of each cluster.
+        std::vector<uint16_t> mLightIndicesData; ///< Lists of lights of every cluster.
+        core::gl::Texture2D mLightDataTex;       ///< One row per light.
+        core::gl::Texture2D mClustersTex;        ///< One texel per cluster.
+        core::gl::Texture2D mLightIndicesTex;    ///< Light lists, wrapped into rows.
+        std::size_t mLightDataRows{1};           ///< Number of rows of the light data texture.
+        std::size_t mLightIndicesRows{1};        ///< Number of rows of the light indices texture.
+
         // Screen quad used for the lighting pass.
 
         core::gl::VertexArray mScreenQuadVa;
@@ -0,0 +1,96 @@
+/// @file
+/// @brief Class @ref cubos::engine::LightClusters.
+/// @ingroup renderer-plugin
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace cubos::engine
+{
+    /// @brief Assigns lights with a limited range to the clusters of a camera's view frustum, so
+    /// that each pixel only has to be lit by the lights of the cluster it's in.
+    ///
+    /// The frustum is split into @ref TilesX by @ref TilesY tiles on the screen, and each tile is
+    /// split into @ref Slices depth slices, which grow exponentially from the near plane to the far
+    /// plane, so that clusters have roughly the same proportions at every depth.
+    ///
+    /// Lights are bounded by spheres. Their clusters are found by testing the spheres of a whole
+    /// batch of lights against each tile plane at once, on separate arrays per component, so that
+    /// the tests are vectorized. The test is conservative: a sphere is assigned to every cluster in
+    /// the box of tiles and slices which contains it, even if it doesn't touch the corners of it.
+    ///
+    /// @ingroup renderer-plugin
+    class LightClusters final
+    {
+    public:
+        /// @brief Number of tiles on the horizontal axis of the screen.
+        static constexpr uint32_t TilesX = 16;
+
+        /// @brief Number of tiles on the vertical axis of the screen.
+        static constexpr uint32_t TilesY = 9;
+
+        /// @brief Number of depth slices of each tile.
+        static constexpr uint32_t Slices = 24;
+
+        /// @brief Total number of clusters.
+        static constexpr uint32_t Count = TilesX * TilesY * Slices;
+
+        /// @brief Assigns lights to the clusters of the given camera, replacing the previous ones.
+        /// @param view View matrix of the camera.
+        /// @param fovY Vertical field of view of the camera, in degrees.
+        /// @param aspect Aspect ratio of the camera.
+        /// @param zNear Distance to the near plane of the camera.
+        /// @param zFar Distance to the far plane of the camera.
+        /// @param spheres World space position and radius of each light.
+        void build(const glm::mat4& view, float fovY, float aspect, float zNear, float zFar,
+                   const std::vector<glm::vec4>& spheres);
+
+        /// @brief Gets the index of a cluster.
+        /// @param cluster Tile and slice of the cluster.
+        /// @return Cluster index, from 0 to @ref Count.
+        static std::size_t index(const glm::uvec3& cluster);
+
+        /// @brief Gets the offset of the lights of each cluster in @ref indices().
+        /// @return Offsets, indexed by cluster index.
+        const std::vector<uint32_t>& offsets() const;
+
+        /// @brief Gets the number of lights of each cluster.
+        /// @return Light counts, indexed by cluster index.
+        const std::vector<uint32_t>& counts() const;
+
+        /// @brief Gets the lists of lights of every cluster, one after the other.
+        /// @return Indices of the lights in the spheres passed to @ref build().
+        const std::vector<uint32_t>& indices() const;
+
+        /// @brief Gets the scale which maps the logarithm of a view depth to its slice.
+        ///
+        /// The slice of a depth `d` is `floor(log(d) * depthScale() + depthBias())`.
+        ///
+        /// @return Depth scale.
+        float depthScale() const;
+
+        /// @brief Gets the bias which maps the logarithm of a view depth to its slice.
+        /// @return Depth bias.
+        float depthBias() const;
+
+    private:
+        /// @brief Box of clusters which contains a light. Empty if any of its minimums is greater
+        /// than its maximum.
+        struct Bounds
+        {
+            glm::uvec3 min; ///< First tile and slice.
+            glm::uvec3 max; ///< Last tile and slice.
+        };
+
+        std::vector<uint32_t> mOffsets; ///< Offset of each cluster's lights.
+        std::vector<uint32_t> mCounts;  ///< Number of lights of each cluster.
+        std::vector<uint32_t> mIndices; ///< Light lists of every cluster.
+        std::vector<Bounds> mBounds;    ///< Clusters of each light, kept to reuse its memory.
+        float mDepthScale{0.0F};        ///< Scale of the logarithm of depths.
+        float mDepthBias{0.0F};         ///< Bias of the logarithm of depths.
+    };
+} // namespace cubos::engine
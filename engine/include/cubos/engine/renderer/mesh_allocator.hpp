@@ -0,0 +1,89 @@
+/// @file
+/// @brief Class @ref cubos::engine::MeshAllocator.
+/// @ingroup renderer-plugin
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace cubos::engine
+{
+    /// @brief Sub-allocates ranges of elements, such as vertices or indices, out of a larger
+    /// buffer, so that the meshes of many grids can share the same GPU buffers.
+    ///
+    /// Free ranges are kept on a list sorted by offset, and adjacent ones are merged when a range
+    /// is freed. Allocations pick the smallest free range they fit in, to keep large ranges
+    /// available. When the free space is split into ranges too small to be used, @ref defragment()
+    /// packs every allocation at the start of the buffer, and returns how each of them moved, so
+    /// that the data can be copied accordingly.
+    ///
+    /// Doesn't touch the GPU, and only keeps track of offsets.
+    ///
+    /// @ingroup renderer-plugin
+    class MeshAllocator final
+    {
+    public:
+        /// @brief Offset returned by @ref allocate() when there's no room for the allocation.
+        static constexpr std::size_t InvalidOffset = std::numeric_limits<std::size_t>::max();
+
+        /// @brief Describes how an allocation moved during defragmentation.
+        struct Move
+        {
+            std::size_t from; ///< Offset before defragmenting.
+            std::size_t to;   ///< Offset after defragmenting.
+            std::size_t size; ///< Size of the allocation.
+        };
+
+        /// @brief Constructs an empty allocator.
+        /// @param capacity Number of elements available.
+        MeshAllocator(std::size_t capacity);
+
+        /// @brief Allocates a range of elements.
+        /// @param size Number of elements, which must be greater than 0.
+        /// @return Offset of the range, or @ref InvalidOffset if there's no free range big enough.
+        std::size_t allocate(std::size_t size);
+
+        /// @brief Frees a range of elements previously allocated.
+        /// @param offset Offset returned by @ref allocate().
+        void free(std::size_t offset);
+
+        /// @brief Increases the number of elements available, which are added to the end.
+        /// @param capacity New capacity, which must not be smaller than the current one.
+        void grow(std::size_t capacity);
+
+        /// @brief Moves every allocation to the start of the buffer, in the same order, leaving
+        /// a single free range at the end.
+        ///
+        /// Allocations which stay at the same offset are also returned, so that the data can be
+        /// copied to a new buffer instead of being moved in place.
+        ///
+        /// @return Moves of every allocation, in increasing order of offset.
+        std::vector<Move> defragment();
+
+        /// @brief Gets the number of elements available.
+        /// @return Capacity.
+        std::size_t capacity() const;
+
+        /// @brief Gets the number of elements allocated.
+        /// @return Number of elements used.
+        std::size_t used() const;
+
+        /// @brief Gets the size of the largest free range, which is the largest allocation which
+        /// can currently succeed.
+        /// @return Size of the largest free range.
+        std::size_t largestFree() const;
+
+        /// @brief Checks whether nothing is allocated.
+        /// @return Whether the allocator is empty.
+        bool empty() const;
+
+    private:
+        std::size_t mCapacity;                         ///< Number of elements available.
+        std::size_t mUsed{0};                          ///< Number of elements allocated.
+        std::map<std::size_t, std::size_t> mFree;      ///< Size of each free range, by offset.
+        std::map<std::size_t, std::size_t> mAllocated; ///< Size of each allocation, by offset.
+    };
+} // namespace cubos::engine
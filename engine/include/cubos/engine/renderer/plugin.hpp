@@ -13,6 +13,7 @@
 
 #include <cubos/engine/assets/plugin.hpp>
 #include <cubos/engine/renderer/renderer.hpp>
+#include <cubos/engine/voxels/chunked_grid.hpp>
 #include <cubos/engine/voxels/grid.hpp>
 #include <cubos/engine/voxels/palette.hpp>
 
@@ -24,19 +25,24 @@ namespace cubos::engine
     /// @see Take a look at the @ref examples-engine-renderer example for a demonstration of this
     /// plugin.
     ///
-    /// Renders all entities with the @ref RenderableGrid component, using as cameras entities with
-    /// the @ref Camera component selected by the @ref ActiveCameras resource. Lights are rendered
-    /// using entities with @ref SpotLight, @ref DirectionalLight or @ref PointLight components.
+    /// Renders all entities with the @ref RenderableGrid or @ref RenderableChunkedGrid components,
+    /// using as cameras entities with the @ref Camera component selected by the @ref ActiveCameras
+    /// resource. Lights are rendered using entities with @ref SpotLight, @ref DirectionalLight or
+    /// @ref PointLight components.
     ///
     /// @note Entities with the above entities will be ignored if they do not possess
     /// @ref LocalToWorld components.
     ///
+    /// Grids are triangulated in the background. Until a grid's mesh is ready, its previous mesh is
+    /// drawn, or nothing, if it's being uploaded for the first time.
+    ///
     /// The rendering environment, such as the ambient lighting and sky color, can be set through
     /// the resource @ref RendererEnvironment.
     ///
     /// ## Settings
     /// - `cubos.renderer.ssao.enabled` - whether SSAO is enabled.
     /// - `cubos.renderer.bloom.enabled` - whether bloom is enabled.
+    /// - `cubos.renderer.vertices.packed` - whether grids are uploaded with the packed vertex layout.
     ///
     /// ## Resources
     /// - @ref Renderer - handle to the renderer.
@@ -46,6 +52,7 @@ namespace cubos::engine
     ///
     /// ## Components
     /// - @ref RenderableGrid - a grid to be rendered.
+    /// - @ref RenderableChunkedGrid - a chunked grid to be rendered.
     /// - @ref Camera - holds camera information.
     /// - @ref SpotLight - emits a spot light.
     /// - @ref DirectionalLight - emits a directional light.
@@ -74,6 +81,27 @@ namespace cubos::engine
         Asset<VoxelGrid> asset;                          ///< Handle to the grid asset to be rendered.
         glm::vec3 offset = {0.0F, 0.0F, 0.0F};           ///< Translation applied to the voxel grid before any other.
         [[cubos::ignore]] RendererGrid handle = nullptr; ///< Handle to the uploaded grid - set automatically.
+
+        /// @brief Job triangulating the grid in the background, if any - set automatically.
+        [[cubos::ignore]] RendererMeshJob pending = nullptr;
+    };
+
+    /// @brief Component which makes a chunked voxel grid be rendered by the renderer plugin.
+    ///
+    /// Meant for large grids which are edited at runtime, through @ref grid. Only the chunks
+    /// affected by an edit are triangulated and uploaded again.
+    ///
+    /// @note Should be used with @ref LocalToWorld.
+    /// @ingroup renderer-plugin
+    struct [[cubos::component("cubos/renderable_chunked_grid", VecStorage)]] RenderableChunkedGrid
+    {
+        CUBOS_REFLECT;
+
+        [[cubos::ignore]] ChunkedVoxelGrid grid; ///< Grid to be rendered.
+        glm::vec3 offset = {0.0F, 0.0F, 0.0F};   ///< Translation applied to the voxel grid before any other.
+
+        /// @brief Handles to the uploaded chunks - set automatically.
+        [[cubos::ignore]] std::vector<RendererGrid> chunks;
     };
 
     /// @brief Resource which identifies the camera entities to be used by the renderer.
@@ -7,14 +7,20 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <glm/glm.hpp>
 
+#include <cubos/core/geom/aabb.hpp>
 #include <cubos/core/gl/render_device.hpp>
 #include <cubos/core/io/window.hpp>
+#include <cubos/core/thread_pool.hpp>
 
 #include <cubos/engine/renderer/camera.hpp>
 #include <cubos/engine/renderer/pps/manager.hpp>
 #include <cubos/engine/renderer/vertex.hpp>
+#include <cubos/engine/voxels/chunked_grid.hpp>
 #include <cubos/engine/voxels/grid.hpp>
 #include <cubos/engine/voxels/palette.hpp>
 
@@ -23,16 +29,23 @@ namespace cubos::engine
     class RendererFrame;
     class BaseRenderer;
     class PostProcessingPass;
+    class DerivedCache;
 
     namespace impl
     {
         class RendererGrid;
-    }
+        class RendererMeshJob;
+    } // namespace impl
 
     /// @brief Handle to a grid uploaded to the GPU, to be used for rendering.
     /// @ingroup renderer-plugin
     using RendererGrid = std::shared_ptr<impl::RendererGrid>;
 
+    /// @brief Handle to a grid being triangulated in the background, which can be polled for the
+    /// uploaded grid once its mesh is ready.
+    /// @ingroup renderer-plugin
+    using RendererMeshJob = std::shared_ptr<impl::RendererMeshJob>;
+
     /// @brief Resource which is an handle to a generic renderer.
     /// @ingroup renderer-plugin
     using Renderer = std::shared_ptr<BaseRenderer>;
@@ -43,6 +56,9 @@ namespace cubos::engine
     /// rendering method as we need to, without changing the API. This is useful since not all
     /// computers support realtime raytracing.
     ///
+    /// Grids may be triangulated on a pool of worker threads with @ref uploadAsync(), so that
+    /// uploading large or frequently modified grids doesn't stall the thread which renders.
+    ///
     /// @note This code was written previously to the development of the @ref Cubos class, and
     /// thats why it is structured this way. In the future it would be better to simply abstract
     /// away renderer implementations using different plugins which would just switch the systems
@@ -72,9 +88,44 @@ namespace cubos::engine
         BaseRenderer(const BaseRenderer&) = delete;
 
         /// @brief Uploads a grid to the GPU and returns an handle which can be used to draw it.
+        ///
+        /// The grid is triangulated on the calling thread, which blocks until it's done.
+        ///
         /// @param grid Grid to upload.
         /// @return Handle of the grid.
-        virtual RendererGrid upload(const VoxelGrid& grid) = 0;
+        RendererGrid upload(const VoxelGrid& grid);
+
+        /// @brief Starts triangulating a grid on a worker thread, so that it can be uploaded later
+        /// with @ref poll() without blocking.
+        ///
+        /// If every handle to the job is dropped before a worker picks it up, the grid is never
+        /// triangulated.
+        ///
+        /// @param grid Grid to upload. A snapshot of it is taken, which shares its data until it's
+        /// modified, so it may be modified while the job runs.
+        /// @return Handle of the job.
+        RendererMeshJob uploadAsync(const VoxelGrid& grid);
+
+        /// @brief Uploads the mesh of a job started by @ref uploadAsync() to the GPU, if it's ready.
+        ///
+        /// Must be called from the thread which uses the render device. Once a job has been
+        /// uploaded, further calls return the same grid handle.
+        ///
+        /// @param job Job to poll.
+        /// @return Handle of the grid, or nullptr if its mesh isn't ready yet.
+        RendererGrid poll(const RendererMeshJob& job);
+
+        /// @brief Uploads the dirty chunks of a chunked grid to the GPU, and marks them as clean.
+        ///
+        /// Each chunk is uploaded as a separate grid, so that editing a voxel only requires its
+        /// chunk, and the neighbouring ones if it's on a border, to be triangulated again. All
+        /// chunks should be drawn with the same transform.
+        ///
+        /// @param grid Grid to upload.
+        /// @param chunks Handles of the chunks, indexed by @ref ChunkedVoxelGrid::chunkIndex(),
+        /// which are resized and updated as needed. Empty chunks get null handles.
+        /// @return Number of chunks which were uploaded again.
+        std::size_t upload(ChunkedVoxelGrid& grid, std::vector<RendererGrid>& chunks);
 
         /// @brief Sets the current palette of the renderer.
         /// @param palette Palette to set.
@@ -103,8 +154,24 @@ namespace cubos::engine
         /// @return Post processing manager.
         PostProcessingManager& pps();
 
+        /// @brief Sets the cache where the meshes of uploaded grids are stored, so that grids
+        /// which were already uploaded on a previous run don't have to be triangulated again.
+        /// @param cache Cache to use, or nullptr to always triangulate grids.
+        void meshCache(std::shared_ptr<const DerivedCache> cache);
+
     protected:
-        core::gl::RenderDevice& mRenderDevice; ///< Render device being used.
+        core::gl::RenderDevice& mRenderDevice;          ///< Render device being used.
+        std::shared_ptr<const DerivedCache> mMeshCache; ///< Cache for the meshes of uploaded grids.
+
+        /// @brief Called when a grid is uploaded, with its triangulated mesh.
+        ///
+        /// Renderer implementations should implement this function to upload the mesh to the GPU.
+        ///
+        /// @param vertices Vertices of the mesh.
+        /// @param indices Indices of the mesh.
+        /// @return Handle of the grid.
+        virtual RendererGrid onUpload(const std::vector<VoxelVertex>& vertices,
+                                      const std::vector<uint32_t>& indices) = 0;
 
         /// @brief Called when resize() is called.
         ///
@@ -131,10 +198,18 @@ namespace cubos::engine
         /// @brief Called when the internal texture used for post processing needs to be resized.
         void resizeTex(glm::uvec2 size);
 
+        /// @brief Uploads a mesh through @ref onUpload() and sets the bounding box of its grid.
+        /// @param vertices Vertices of the mesh.
+        /// @param indices Indices of the mesh.
+        /// @return Handle of the grid.
+        RendererGrid uploadMesh(const std::vector<VoxelVertex>& vertices, const std::vector<uint32_t>& indices);
+
         PostProcessingManager mPpsManager;  ///< Post processing manager.
         core::gl::Framebuffer mFramebuffer; ///< Framebuffer where the frame is drawn.
         core::gl::Texture2D mTexture;       ///< Texture where the frame is drawn.
         glm::uvec2 mSize;
+
+        core::ThreadPool mMeshingPool; ///< Threads where grids are triangulated in the background.
     };
 
     /// @brief Namespace to store the abstract types implemented by the renderer implementations.
@@ -146,6 +221,10 @@ namespace cubos::engine
         public:
             virtual ~RendererGrid() = default;
 
+            /// @brief Local space bounding box of the grid's mesh, used to cull grids which are
+            /// out of view.
+            core::geom::AABB localAABB{};
+
         protected:
             RendererGrid() = default;
         };
@@ -1,9 +1,12 @@
 /// @file
-/// @brief Class @ref cubos::engine::VoxelVertex and function @ref cubos::engine::triangulate.
+/// @brief Classes @ref cubos::engine::VoxelVertex, @ref cubos::engine::PackedVoxelVertex and function
+/// @ref cubos::engine::triangulate.
 /// @ingroup renderer-plugin
 
 #pragma once
 
+#include <vector>
+
 #include <glm/glm.hpp>
 
 #include <cubos/core/data/old/deserializer.hpp>
@@ -12,6 +15,8 @@
 namespace cubos::engine
 {
     class VoxelGrid;
+    class ChunkedVoxelGrid;
+    class DerivedCache;
 
     /// @brief Represents a voxel vertex.
     /// @ingroup renderer-plugin
@@ -22,12 +27,72 @@ namespace cubos::engine
         uint16_t material;   ///< Index of the material on the palette.
     };
 
+    /// @brief Compact alternative to @ref VoxelVertex, which takes 8 bytes instead of 28.
+    ///
+    /// The position is stored with 10 bits per axis, x on the lowest bits. The material is stored
+    /// on the lower 16 bits of @ref data, and the face the vertex belongs to on the 3 bits above,
+    /// as twice the index of the axis of its normal, plus one if the normal points backwards.
+    ///
+    /// @ingroup renderer-plugin
+    struct PackedVoxelVertex
+    {
+        /// @brief Largest coordinate which can be stored in a packed position.
+        static constexpr uint32_t MaxCoordinate = 1023;
+
+        uint32_t position; ///< Packed position of the vertex.
+        uint32_t data;     ///< Packed material and face of the vertex.
+    };
+
+    /// @brief Packs vertices into the compact layout.
+    /// @param vertices Vertices to pack.
+    /// @param packed Packed vertices.
+    /// @return Whether the vertices could be packed, which fails if a coordinate is larger than
+    /// @ref PackedVoxelVertex::MaxCoordinate.
+    /// @ingroup renderer-plugin
+    bool pack(const std::vector<VoxelVertex>& vertices, std::vector<PackedVoxelVertex>& packed);
+
     /// @brief Triangulates a grid of voxels into an indexed mesh.
     /// @param grid Grid to triangulate.
     /// @param vertices Vertices of the mesh.
     /// @param indices Indices of the mesh.
     /// @ingroup renderer-plugin
     void triangulate(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices, std::vector<uint32_t>& indices);
+
+    /// @brief Triangulates a single chunk of a chunked grid into an indexed mesh.
+    ///
+    /// Faces shared with neighbouring chunks are only generated by the chunk which holds the
+    /// solid voxel, so that the meshes of all chunks, drawn with the same transform, are
+    /// equivalent to the mesh of the whole grid. Vertex positions are relative to the grid.
+    ///
+    /// @param grid Grid to triangulate.
+    /// @param chunk Chunk coordinates.
+    /// @param vertices Vertices of the mesh.
+    /// @param indices Indices of the mesh.
+    /// @ingroup renderer-plugin
+    void triangulate(const ChunkedVoxelGrid& grid, const glm::uvec3& chunk, std::vector<VoxelVertex>& vertices,
+                     std::vector<uint32_t>& indices);
+
+    /// @brief Version of the meshes produced by @ref triangulate(). Must be increased whenever its
+    /// output changes, so that meshes stored in caches are discarded.
+    /// @ingroup renderer-plugin
+    constexpr uint32_t TriangulateVersion = 1;
+
+    /// @brief Triangulates a grid of voxels into an indexed mesh, reusing the mesh stored in the
+    /// given cache, if there's one, and storing it otherwise.
+    ///
+    /// Meshes are keyed by the contents of the grid, and are appended to the output just like
+    /// @ref triangulate() does. Cached meshes with indices out of their vertices are discarded.
+    ///
+    /// Chunks of chunked grids aren't cached: their meshes also depend on the voxels of the
+    /// neighbouring chunks, and a single chunk is meshed faster than its entry would be read.
+    ///
+    /// @param grid Grid to triangulate.
+    /// @param vertices Vertices of the mesh.
+    /// @param indices Indices of the mesh.
+    /// @param cache Cache to look for the mesh in.
+    /// @ingroup renderer-plugin
+    void triangulate(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices, std::vector<uint32_t>& indices,
+                     const DerivedCache& cache);
 } // namespace cubos::engine
 
 namespace cubos::core::data::old
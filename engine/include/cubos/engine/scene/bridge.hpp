@@ -42,6 +42,13 @@ namespace cubos::engine
     /// prefix all of its entities with `foo.`. The entity `foo.bar` will override the entity `bar`
     /// from the imported scene, while the entity `baz` will be added to the scene.
     ///
+    /// Scenes may also be stored in a compiled binary format, written by @ref saveCompiled() and
+    /// produced from JSON scenes by the `quadrados scene` tool. These files start with the magic
+    /// number `CSCN`, which the bridge uses to tell them apart from JSON scenes. Loading them skips
+    /// JSON parsing and component name lookups, as components are deserialized from binary and
+    /// their entity references are stored as indices. Since the imported scenes are already merged
+    /// into the compiled blueprint, they are not loaded again.
+    ///
     /// @ingroup scene-plugin
     class SceneBridge : public AssetBridge
     {
@@ -55,5 +62,12 @@ namespace cubos::engine
 
         bool load(Assets& assets, const AnyAsset& handle) override;
         bool save(const Assets& assets, const AnyAsset& handle) override;
+
+        /// @brief Writes a scene in the compiled binary format.
+        /// @note All of the scene's component types must be registered.
+        /// @param scene Scene to write.
+        /// @param stream Stream to write to.
+        /// @return Whether the scene was written successfully.
+        static bool saveCompiled(const Scene& scene, core::memory::Stream& stream);
     };
 } // namespace cubos::engine
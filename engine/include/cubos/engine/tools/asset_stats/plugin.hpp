@@ -0,0 +1,33 @@
+/// @dir
+/// @brief @ref asset-stats-tool-plugin plugin directory.
+
+/// @file
+/// @brief Plugin entry point.
+/// @ingroup asset-stats-tool-plugin
+
+#pragma once
+
+#include <cubos/engine/cubos.hpp>
+
+namespace cubos::engine::tools
+{
+    /// @defgroup asset-stats-tool-plugin Asset statistics
+    /// @ingroup tool-plugins
+    /// @brief Shows the loading statistics of the asset manager through a ImGui window.
+    ///
+    /// Displays the loader queue depth over time, the load time histograms of each bridge, the
+    /// time threads spent waiting for assets, and the memory and cache statistics. The statistics
+    /// can also be dumped to a JSON file.
+    ///
+    /// ## Settings
+    /// - `assets.stats.path` - path of the file the statistics are dumped to (default: `asset_stats.json`).
+    ///
+    /// ## Dependencies
+    /// - @ref imgui-plugin
+    /// - @ref assets-plugin
+
+    /// @brief Plugin entry function.
+    /// @param cubos @b CUBOS. main class
+    /// @ingroup asset-stats-tool-plugin
+    void assetStatsPlugin(Cubos& cubos);
+} // namespace cubos::engine::tools
@@ -0,0 +1,110 @@
+/// @file
+/// @brief Class @ref cubos::engine::ChunkedVoxelGrid.
+/// @ingroup voxels-plugin
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace cubos::engine
+{
+    class VoxelGrid;
+
+    /// @brief Represents a voxel object using a 3D grid split into cubic chunks, which can be
+    /// meshed, uploaded and drawn independently.
+    ///
+    /// Meant for large grids which are edited often, such as worlds. Chunks with no voxels don't
+    /// store any data. Each chunk has a dirty flag, which is set whenever one of its voxels, or a
+    /// voxel of a neighbouring chunk on the shared border, is modified, since both affect the
+    /// chunk's mesh.
+    ///
+    /// @see Each voxel stores a material index to be used with a @ref VoxelPalette.
+    /// @ingroup voxels-plugin
+    class ChunkedVoxelGrid final
+    {
+    public:
+        /// @brief Size of the chunks on each axis.
+        static constexpr uint32_t ChunkSize = 32;
+
+        /// @brief Constructs an empty single-voxel grid.
+        ChunkedVoxelGrid();
+
+        /// @brief Constructs an empty grid with the given size.
+        /// @param size Size of the grid.
+        ChunkedVoxelGrid(const glm::uvec3& size);
+
+        /// @brief Constructs a grid with the same size and voxels as the given grid.
+        /// @param grid Grid to copy.
+        explicit ChunkedVoxelGrid(const VoxelGrid& grid);
+
+        /// @brief Gets the size of the grid.
+        /// @return Size of the grid.
+        const glm::uvec3& size() const;
+
+        /// @brief Gets the number of chunks on each axis.
+        /// @return Number of chunks.
+        const glm::uvec3& chunkCount() const;
+
+        /// @brief Sets the material index of a voxel, marking the chunks whose meshes it affects as
+        /// dirty if it changed.
+        /// @param position Voxel coordinates.
+        /// @param mat Material index to set.
+        void set(const glm::ivec3& position, uint16_t mat);
+
+        /// @brief Gets the material index of a voxel.
+        /// @param position Voxel coordinates.
+        /// @return Material index of the voxel, or 0 if it's outside of the grid.
+        uint16_t get(const glm::ivec3& position) const;
+
+        /// @brief Checks whether a chunk has no voxels.
+        /// @param chunk Chunk coordinates.
+        /// @return Whether the chunk is empty.
+        bool empty(const glm::uvec3& chunk) const;
+
+        /// @brief Gets the voxels of a chunk.
+        /// @note Voxels are stored in x, y, z order, with x varying the fastest, and with rows of
+        /// @ref ChunkSize voxels even for chunks cut short by the edges of the grid.
+        /// @param chunk Chunk coordinates.
+        /// @return Pointer to the material indices of the chunk, or nullptr if it's empty.
+        const uint16_t* chunkData(const glm::uvec3& chunk) const;
+
+        /// @brief Checks whether a chunk's mesh must be rebuilt.
+        /// @param chunk Chunk coordinates.
+        /// @return Whether the chunk is dirty.
+        bool dirty(const glm::uvec3& chunk) const;
+
+        /// @brief Clears the dirty flag of a chunk, after its mesh has been rebuilt.
+        /// @param chunk Chunk coordinates.
+        void clean(const glm::uvec3& chunk);
+
+        /// @brief Gets the coordinates of the chunks which are dirty.
+        /// @return Dirty chunks.
+        std::vector<glm::uvec3> dirtyChunks() const;
+
+        /// @brief Gets the index of a chunk, which can be used to store per-chunk data in flat
+        /// arrays with a size equal to the total number of chunks.
+        /// @param chunk Chunk coordinates.
+        /// @return Chunk index.
+        std::size_t chunkIndex(const glm::uvec3& chunk) const;
+
+    private:
+        /// @brief Voxel data of a chunk.
+        struct Chunk
+        {
+            std::vector<uint16_t> voxels; ///< Voxels of the chunk, or empty if none is set.
+            std::size_t count{0};         ///< Number of non-empty voxels.
+            bool dirty{true};             ///< Whether the chunk's mesh must be rebuilt.
+        };
+
+        /// @brief Marks the chunk at the given coordinates as dirty, if there's one.
+        /// @param chunk Chunk coordinates.
+        void markDirty(const glm::ivec3& chunk);
+
+        glm::uvec3 mSize;           ///< Size of the grid.
+        glm::uvec3 mChunkCount;     ///< Number of chunks on each axis.
+        std::vector<Chunk> mChunks; ///< Chunks of the grid, in x, y, z order.
+    };
+} // namespace cubos::engine
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -27,6 +28,11 @@ namespace cubos::core::data::old
 namespace cubos::engine
 {
     /// @brief Represents a voxel object using a 3D grid.
+    ///
+    /// Copies share their voxel data until one of them is modified, so that a snapshot of a grid
+    /// can be taken in constant time, for example to triangulate it on another thread. Pointers
+    /// returned by @ref data() are invalidated when the grid is copied or copied to.
+    ///
     /// @see Each voxel stores a material index to be used with a @ref VoxelPalette.
     /// @ingroup voxels-plugin
     class VoxelGrid final
@@ -54,7 +60,7 @@ namespace cubos::engine
         /// @param other Other grid.
         VoxelGrid(VoxelGrid&& other) noexcept;
 
-        /// @brief Makes this grid a copy of another grid.
+        /// @brief Makes this grid a copy of another grid, sharing its data until either is modified.
         /// @param rhs Other grid.
         /// @return This grid, for chaining.
         VoxelGrid& operator=(const VoxelGrid& rhs);
@@ -67,6 +73,17 @@ namespace cubos::engine
         /// @return Size of the grid.
         const glm::uvec3& size() const;
 
+        /// @brief Gets a pointer to the array of material indices of the grid.
+        /// @note Voxels are stored in x, y, z order, with x varying the fastest.
+        /// @return Pointer to the array of material indices.
+        const uint16_t* data() const;
+
+        /// @brief Gets a pointer to the array of material indices of the grid, which can be used to
+        /// fill the grid in bulk. If the data is shared with a copy, it's copied first.
+        /// @note Voxels are stored in x, y, z order, with x varying the fastest.
+        /// @return Pointer to the array of material indices.
+        uint16_t* data();
+
         /// @brief Sets all voxels to 0.
         void clear();
 
@@ -96,7 +113,10 @@ namespace cubos::engine
                                                const char* /*name*/);
         friend void core::data::old::deserialize(core::data::old::Deserializer& /*deserializer*/, VoxelGrid& /*grid*/);
 
-        glm::uvec3 mSize;               ///< Size of the grid.
-        std::vector<uint16_t> mIndices; ///< Indices of the grid.
+        /// @brief Makes sure the indices aren't shared with any copy, so that they can be modified.
+        void detach();
+
+        glm::uvec3 mSize;                                ///< Size of the grid.
+        std::shared_ptr<std::vector<uint16_t>> mIndices; ///< Indices of the grid, shared between copies.
     };
 } // namespace cubos::engine
@@ -22,7 +22,10 @@ AnyAsset::~AnyAsset()
 
 AnyAsset::AnyAsset(std::nullptr_t)
     : mRefCount(nullptr)
+    , mEntry(nullptr)
     , mVersion(-1)
+    , mSlot(0)
+    , mGeneration(0)
 {
 }
 
@@ -30,13 +33,19 @@ AnyAsset::AnyAsset(uuids::uuid id)
     : reflectedId(id)
     , mId(id)
     , mRefCount(nullptr)
+    , mEntry(nullptr)
     , mVersion(-1)
+    , mSlot(0)
+    , mGeneration(0)
 {
 }
 
 AnyAsset::AnyAsset(std::string_view str)
     : mRefCount(nullptr)
+    , mEntry(nullptr)
     , mVersion(-1)
+    , mSlot(0)
+    , mGeneration(0)
 {
     if (auto id = uuids::uuid::from_string(str))
     {
@@ -53,7 +62,10 @@ AnyAsset::AnyAsset(const AnyAsset& other)
     : reflectedId(other.reflectedId)
     , mId(other.mId)
     , mRefCount(other.mRefCount)
+    , mEntry(other.mEntry)
     , mVersion(other.mVersion)
+    , mSlot(other.mSlot)
+    , mGeneration(other.mGeneration)
 {
     this->incRef();
 }
@@ -62,7 +74,10 @@ AnyAsset::AnyAsset(AnyAsset&& other) noexcept
     : reflectedId(other.reflectedId)
     , mId(other.mId)
     , mRefCount(other.mRefCount)
+    , mEntry(other.mEntry)
     , mVersion(other.mVersion)
+    , mSlot(other.mSlot)
+    , mGeneration(other.mGeneration)
 {
     other.mRefCount = nullptr;
 }
@@ -73,7 +88,10 @@ AnyAsset& AnyAsset::operator=(const AnyAsset& other)
     reflectedId = other.reflectedId;
     mId = other.mId;
     mRefCount = other.mRefCount;
+    mEntry = other.mEntry;
     mVersion = other.mVersion;
+    mSlot = other.mSlot;
+    mGeneration = other.mGeneration;
     this->incRef();
     return *this;
 }
@@ -84,7 +102,10 @@ AnyAsset& AnyAsset::operator=(AnyAsset&& other) noexcept
     reflectedId = other.mId;
     mId = other.mId;
     mRefCount = other.mRefCount;
+    mEntry = other.mEntry;
     mVersion = other.mVersion;
+    mSlot = other.mSlot;
+    mGeneration = other.mGeneration;
     other.mRefCount = nullptr;
     return *this;
 }
@@ -113,6 +134,7 @@ void AnyAsset::makeWeak()
 {
     this->decRef();
     mRefCount = nullptr;
+    mEntry = nullptr;
 }
 
 cubos::core::reflection::Type& AnyAsset::makeType(std::string name)
@@ -155,7 +177,10 @@ void AnyAsset::deserialize(core::data::old::Deserializer& des)
         reflectedId = id.value();
         mId = id.value();
         mRefCount = nullptr;
+        mEntry = nullptr;
         mVersion = -1;
+        mSlot = 0;
+        mGeneration = 0;
     }
     else
     {
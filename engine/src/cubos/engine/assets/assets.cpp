@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <unordered_set>
 #include <utility>
 
 #include <cubos/core/data/fs/file_system.hpp>
 #include <cubos/core/data/old/debug_serializer.hpp>
-#include <cubos/core/data/old/json_deserializer.hpp>
 #include <cubos/core/data/old/json_serializer.hpp>
 #include <cubos/core/log.hpp>
 
@@ -10,7 +13,27 @@
 
 using namespace cubos::engine;
 
+/// @brief How many queued assets ahead of the one being loaded have their files read in the
+/// background.
+static constexpr std::size_t PrefetchCount = 4;
+
+/// @brief How many assets are visited by each call to @ref Assets::cleanup().
+static constexpr std::size_t CleanupStep = 64;
+
+/// @brief Manager whose loader threads the current thread belongs to, if any.
+static thread_local const Assets* currentLoaderOwner = nullptr;
+
+/// @brief Counter of the bytes opened by the load running on the current thread, if any.
+static thread_local std::size_t* currentBytesRead = nullptr;
+
+/// @brief Assets required by the load running on the current thread which weren't loaded yet.
+static thread_local std::vector<AnyAsset>* currentRequired = nullptr;
+
+/// @brief Generation of the next manager to be constructed.
+static std::atomic<uint32_t> nextGeneration{1};
+
 Assets::Assets()
+    : mGeneration(nextGeneration++)
 {
     // Initialize the UUID generator.
     std::random_device rd;
@@ -19,31 +42,37 @@ Assets::Assets()
     std::seed_seq seq(seedData.begin(), seedData.end());
     mRandom = std::mt19937(seq);
 
-    // Spawn the loaded thread.
-    mLoaderShouldExit = false;
-    mLoaderThread = std::thread([this]() { this->loader(); });
+    // Spawn a single loader thread, until told otherwise.
+    this->startLoaders(1);
 }
 
 Assets::~Assets()
 {
-    // Signal the loader thread to exit.
-    {
-        std::unique_lock loaderLock(mLoaderMutex);
-        mLoaderShouldExit = true;
-        mLoaderCond.notify_one();
-    }
-
-    // Wait for the loader thread to exit.
-    mLoaderThread.join();
+    this->stopLoaders();
 
     // Destroy all assets.
-    for (auto& entry : mEntries)
+    for (auto& [id, entry] : mEntryList)
     {
-        if (entry.second->status == Assets::Status::Loaded)
+        if (entry->status == Assets::Status::Loaded)
         {
-            entry.second->destructor(entry.second->data);
+            entry->destructor(entry->data);
         }
     }
+
+    for (auto& block : mSlotBlocks)
+    {
+        delete block.load();
+    }
+}
+
+void Assets::loaderThreads(std::size_t count)
+{
+    CUBOS_ASSERT(count > 0, "There must be at least one loader thread");
+    CUBOS_ASSERT(!this->isLoaderThread(), "Loader threads can't be changed from a loader thread");
+
+    this->stopLoaders();
+    this->startLoaders(count);
+    CUBOS_DEBUG("Using {} asset loader threads", count);
 }
 
 void Assets::registerBridge(const std::string& extension, std::shared_ptr<AssetBridge> bridge)
@@ -61,107 +90,238 @@ void Assets::registerBridge(const std::string& extension, std::shared_ptr<AssetB
     CUBOS_TRACE("Registered asset bridge for extension '{}'", extension);
 }
 
+void Assets::memoryBudget(std::size_t bytes)
+{
+    mMemoryBudget = bytes;
+    CUBOS_DEBUG("Set asset memory budget to {} bytes", bytes);
+}
+
 void Assets::cleanup()
 {
     std::shared_lock lock(mMutex);
 
-    for (const auto& entry : mEntries)
+    // Visit the next few entries, going around all of them over multiple calls. The hand is only
+    // advanced atomically, as concurrent calls only hold a shared lock.
+    auto count = std::min(CleanupStep, mEntryList.size());
+    for (std::size_t i = 0; i < count; ++i)
     {
-        std::unique_lock assetLock(entry.second->mutex);
+        const auto& [id, entry] = mEntryList[mCleanupHand.fetch_add(1) % mEntryList.size()];
+
+        // Skip assets which are being used by another thread, we'll get to them on the next round.
+        std::unique_lock assetLock(entry->mutex, std::try_to_lock);
+        if (!assetLock.owns_lock() || entry->status != Status::Loaded || entry->refCount != 0 || entry->refining)
+        {
+            continue;
+        }
 
-        if (entry.second->status == Status::Loaded && entry.second->refCount == 0)
+        if (auto budget = mMemoryBudget.load(); budget != 0)
         {
-            entry.second->status = Status::Unloaded;
-            entry.second->destructor(entry.second->data);
-            entry.second->data = nullptr;
-            CUBOS_DEBUG("Unloaded asset {}", core::data::old::Debug(AnyAsset(entry.first)));
+            // Keep unused assets while there's room for them, and give those which were accessed
+            // recently a second chance.
+            if (mMemoryUsed <= budget || entry->used.exchange(false))
+            {
+                continue;
+            }
         }
+
+        this->unload(*entry);
+        mEvictions += 1;
+        CUBOS_DEBUG("Unloaded asset {}", core::data::old::Debug(AnyAsset(id)));
     }
 }
 
 void Assets::loadMeta(std::string_view path)
 {
-    auto file = core::data::FileSystem::find(path);
-    if (file == nullptr)
+    this->loadMeta(path, AssetMetaIndex{});
+}
+
+void Assets::loadMeta(std::string_view path, const AssetMetaIndex& index)
+{
+    auto root = core::data::FileSystem::find(path);
+    if (root == nullptr)
     {
         CUBOS_ERROR("Couldn't load asset metadata: file '{}' not found", path);
         return;
     }
 
-    if (file->directory())
+    std::size_t indexed = 0;
+    std::size_t parsed = 0;
+
+    std::vector<core::data::File::Handle> stack{root};
+    while (!stack.empty())
     {
-        auto child = file->child();
-        while (child != nullptr)
+        auto file = std::move(stack.back());
+        stack.pop_back();
+
+        auto relative = std::string(file->path().substr(root->path().size()));
+        if (file->directory())
         {
-            this->loadMeta(child->path());
-            child = child->sibling();
+            // Directories which weren't modified since the index was built are taken from the
+            // index as they are, without listing them or checking each of their files.
+            const auto* directory = index.findDirectory(relative);
+            if (directory != nullptr && directory->modificationTime == file->modificationTime())
+            {
+                for (const auto& name : directory->metas)
+                {
+                    const auto* entry = index.find(relative + "/" + name);
+                    if (entry != nullptr)
+                    {
+                        this->registerMeta(std::string(file->path()) + "/" + name, entry->meta);
+                        indexed += 1;
+                    }
+                }
+
+                for (const auto& name : directory->directories)
+                {
+                    if (auto child = file->find(name))
+                    {
+                        stack.push_back(std::move(child));
+                    }
+                }
+                continue;
+            }
+
+            for (auto child = file->child(); child != nullptr; child = child->sibling())
+            {
+                stack.push_back(child);
+            }
+            continue;
         }
-    }
-    else if (file->name().ends_with(".meta"))
-    {
-        CUBOS_DEBUG("Loading asset metadata from '{}'", path);
 
-        // Read the file contents into a string.
-        std::string contents;
+        if (!file->name().ends_with(".meta"))
         {
-            auto stream = file->open(core::data::File::OpenMode::Read);
-            stream->readUntil(contents, nullptr);
+            continue;
         }
 
-        // Deserialize the asset metadata from the JSON string.
-        auto meta = AssetMeta();
-        auto des = core::data::old::JSONDeserializer(contents);
-        des.read(meta);
-        if (des.failed())
+        // Files in modified directories must only be parsed if they were modified too.
+        const auto* entry = index.find(relative);
+        if (entry != nullptr && entry->modificationTime == file->modificationTime())
         {
-            CUBOS_ERROR("Couldn't load asset metadata: JSON deserialization failed for file '{}'", path);
-            return;
+            this->registerMeta(file->path(), entry->meta);
+            indexed += 1;
+            continue;
         }
 
-        // Check if the metadata has a path field, which is always ignored.
-        if (meta.get("path").has_value())
+        CUBOS_DEBUG("Loading asset metadata from '{}'", file->path());
+
+        // Deserialize the asset metadata directly from the file stream.
+        auto meta = AssetMeta();
+        if (!AssetMetaIndex::readFile(*file, meta))
         {
-            CUBOS_WARN("Asset metadata at '{}' has a path field, which is always ignored, since it is derived from the "
-                       "file path",
-                       path);
+            CUBOS_ERROR("Couldn't load asset metadata: JSON deserialization failed for file '{}'", file->path());
+            continue;
         }
 
-        // Get the asset's path from the metadata path - excluding the .meta.
-        auto pathWithoutMeta = path.substr(0, path.size() - 5);
-        uuids::uuid id;
+        this->registerMeta(file->path(), std::move(meta));
+        parsed += 1;
+    }
+
+    if (index.size() != 0)
+    {
+        CUBOS_INFO("Loaded metadata of {} assets in '{}' from its index, and parsed {} outdated metadata files",
+                   indexed, path, parsed);
+    }
+}
+
+void Assets::registerMeta(std::string_view path, AssetMeta meta)
+{
+    // Check if the metadata has a path field, which is always ignored.
+    if (meta.get("path").has_value())
+    {
+        CUBOS_WARN("Asset metadata at '{}' has a path field, which is always ignored, since it is derived from the "
+                   "file path",
+                   path);
+    }
+
+    // Get the asset's path from the metadata path - excluding the .meta.
+    auto pathWithoutMeta = path.substr(0, path.size() - 5);
+    uuids::uuid id;
 
-        // Get the UUID from the metadata, if it exists.
-        if (meta.get("id").has_value())
+    // Get the UUID from the metadata, if it exists.
+    if (meta.get("id").has_value())
+    {
+        id = uuids::uuid::from_string(meta.get("id").value()).value_or(uuids::uuid());
+    }
+
+    // If the UUID is invalid, generate a new random one.
+    if (id.is_nil())
+    {
+        CUBOS_WARN("Asset metadata at '{}' has an unspecified/invalid UUID, generating a random one", path);
+        id = uuids::uuid_random_generator(mRandom.value())();
+    }
+
+    // Update the metadata with the patth and UUID.
+    meta.set("path", pathWithoutMeta);
+    meta.set("id", uuids::to_string(id));
+
+    {
+        std::unique_lock lock(mMutex);
+        mPathIds[std::string(pathWithoutMeta)] = id;
+    }
+
+    // Create a handle for the asset and store its metadata.
+    auto handle = AnyAsset(id);
+    {
+        auto guard = this->writeMeta(handle);
+        *guard = std::move(meta);
+        // Force the asset to be reloaded. No need to lock it again, the guard is already write
+        // locking the asset.
+        this->invalidate(handle, false);
+    }
+
+    CUBOS_DEBUG("Loaded asset {} metadata from '{}'", core::data::old::Debug(handle), path);
+}
+
+std::vector<AnyAsset> Assets::reloadModified(const std::vector<std::string>& paths)
+{
+    std::vector<AnyAsset> reloaded;
+
+    for (const auto& path : paths)
+    {
+        // Loading the metadata again already invalidates the asset.
+        bool isMeta = path.ends_with(".meta");
+        if (isMeta)
         {
-            id = uuids::uuid::from_string(meta.get("id").value()).value_or(uuids::uuid());
+            this->loadMeta(path);
         }
 
-        // If the UUID is invalid, generate a new random one.
-        if (id.is_nil())
+        // Find the asset associated to the modified file.
+        AnyAsset handle;
         {
-            CUBOS_WARN("Asset metadata at '{}' has an unspecified/invalid UUID, generating a random one", path);
-            id = uuids::uuid_random_generator(mRandom.value())();
+            std::shared_lock lock(mMutex);
+            auto it = mPathIds.find(isMeta ? path.substr(0, path.size() - 5) : path);
+            if (it == mPathIds.end())
+            {
+                continue;
+            }
+            handle = AnyAsset(it->second);
         }
 
-        // Update the metadata with the patth and UUID.
-        meta.set("path", pathWithoutMeta);
-        meta.set("id", uuids::to_string(id));
+        if (std::any_of(reloaded.begin(), reloaded.end(),
+                        [&](const AnyAsset& other) { return other.getId() == handle.getId(); }))
+        {
+            continue;
+        }
+
+        if (!isMeta)
+        {
+            this->invalidate(handle);
+        }
 
-        // Create a handle for the asset and store its metadata.
-        auto handle = AnyAsset(id);
+        // If the asset is still in use, start loading it again right away.
+        if (this->entry(handle)->refCount > 0)
         {
-            auto guard = this->writeMeta(handle);
-            *guard = meta;
-            // Force the asset to be reloaded. No need to lock it again, the guard is already write
-            // locking the asset.
-            this->invalidate(handle, false);
+            this->load(handle);
         }
 
-        CUBOS_DEBUG("Loaded asset {} metadata from '{}'", core::data::old::Debug(handle), path);
+        CUBOS_INFO("Reloading asset {} as '{}' was modified", core::data::old::Debug(handle), path);
+        reloaded.push_back(handle);
     }
+
+    return reloaded;
 }
 
-AnyAsset Assets::load(AnyAsset handle) const
+AnyAsset Assets::load(AnyAsset handle, Priority priority) const
 {
     auto assetEntry = this->entry(handle);
     if (assetEntry == nullptr)
@@ -173,33 +333,185 @@ AnyAsset Assets::load(AnyAsset handle) const
     if (assetEntry->status != Assets::Status::Loaded)
     {
         // Find a bridge for the asset.
-        auto bridge = this->bridge(handle);
+        std::string extension;
+        auto bridge = this->bridge(handle, &extension);
         if (bridge == nullptr)
         {
             CUBOS_ERROR("Could not load asset");
             return {};
         }
 
+        // If a bridge was found, then the asset must have a path.
+        auto path = this->readMeta(handle)->get("path").value();
+        auto dependencies = this->dependencies(handle);
+
         // We need to lock this to prevent the asset from being queued twice by a concurrent thread.
-        // We also check if this is being called from the loader thread, in which case we don't need
-        // to queue the asset.
         std::unique_lock lock(mLoaderMutex);
-        if (assetEntry->status == Assets::Status::Unloaded && std::this_thread::get_id() != mLoaderThread.get_id())
+        if (assetEntry->status == Assets::Status::Unloaded)
         {
             CUBOS_TRACE("Queuing asset {} for loading", core::data::old::Debug(handle));
             assetEntry->status = Assets::Status::Loading;
-            mLoaderQueue.push_back(Task{handle, bridge});
+            mLoaderQueue[static_cast<std::size_t>(priority)].push_back(
+                Task{handle, bridge, extension, path, priority, std::move(dependencies)});
             mLoaderCond.notify_one();
+
+            std::size_t queued = 0;
+            for (const auto& queue : mLoaderQueue)
+            {
+                queued += queue.size();
+            }
+            mLoaderMaxQueued = std::max(mLoaderMaxQueued, queued);
+        }
+        else if (assetEntry->status == Assets::Status::Loading)
+        {
+            // If the asset is still queued with a lower priority, move it up.
+            for (auto i = static_cast<std::size_t>(priority); i-- > 0;)
+            {
+                auto& queue = mLoaderQueue[i];
+                auto it = std::find_if(queue.begin(), queue.end(),
+                                       [&](const Task& task) { return task.handle.getId() == handle.getId(); });
+                if (it != queue.end())
+                {
+                    it->priority = priority;
+                    mLoaderQueue[static_cast<std::size_t>(priority)].push_back(std::move(*it));
+                    queue.erase(it);
+                    break;
+                }
+            }
         }
         lock.unlock();
     }
 
     // Return a strong handle to the asset.
-    assetEntry->refCount += 1;
-    handle.mRefCount = &assetEntry->refCount;
+    makeStrong(handle, *assetEntry);
     return handle;
 }
 
+AssetGroup Assets::loadGroup(const std::vector<AnyAsset>& handles, Priority priority) const
+{
+    // Find the closure of the given assets through a depth-first search, so that dependencies end
+    // up before the assets which depend on them.
+    std::vector<AnyAsset> order;
+    std::unordered_set<uuids::uuid> visited;
+    std::vector<std::pair<AnyAsset, bool>> stack;
+    for (auto it = handles.rbegin(); it != handles.rend(); ++it)
+    {
+        stack.emplace_back(*it, false);
+    }
+
+    while (!stack.empty())
+    {
+        auto [handle, expanded] = std::move(stack.back());
+        stack.pop_back();
+
+        if (expanded)
+        {
+            order.push_back(std::move(handle));
+            continue;
+        }
+
+        if (handle.isNull() || !visited.insert(handle.getId()).second)
+        {
+            continue;
+        }
+
+        // Come back to the asset once all its dependencies were visited.
+        auto dependencies = this->dependencies(handle);
+        stack.emplace_back(handle, true);
+        for (auto it = dependencies.rbegin(); it != dependencies.rend(); ++it)
+        {
+            stack.emplace_back(std::move(*it), false);
+        }
+    }
+
+    CUBOS_DEBUG("Loading group of {} assets", order.size());
+
+    AssetGroup group;
+    group.mManager = this;
+    group.mAssets.reserve(order.size());
+    for (const auto& handle : order)
+    {
+        if (auto strong = this->load(handle, priority); !strong.isNull())
+        {
+            group.mAssets.push_back(std::move(strong));
+        }
+        else
+        {
+            group.mUnqueued += 1;
+        }
+    }
+
+    return group;
+}
+
+bool Assets::require(AnyAsset& handle) const
+{
+    // Outside of loader threads, blocking is fine.
+    if (!this->isLoaderThread())
+    {
+        handle = this->load(handle, Priority::High);
+        return !handle.isNull() && this->wait(handle);
+    }
+
+    CUBOS_ASSERT(currentRequired != nullptr, "Assets can only be required by bridges while loading");
+
+    // Hold a strong reference, so that the asset isn't unloaded while the bridge reads it.
+    auto* assetEntry = this->entry(handle);
+    if (assetEntry == nullptr)
+    {
+        return false;
+    }
+    this->makeStrong(handle, *assetEntry);
+
+    if (this->status(handle) == Status::Loaded)
+    {
+        return true;
+    }
+
+    // The task is suspended after its bridge returns, and retried once the asset is loaded.
+    currentRequired->push_back(handle);
+    return false;
+}
+
+std::vector<AnyAsset> Assets::dependencies(const AnyAsset& handle) const
+{
+    auto assetEntry = this->entry(handle);
+    if (assetEntry == nullptr)
+    {
+        return {};
+    }
+
+    std::string list;
+    {
+        std::shared_lock lock(assetEntry->mutex);
+        list = assetEntry->meta.get("dependencies").value_or("");
+    }
+
+    std::vector<AnyAsset> dependencies;
+    std::size_t start = 0;
+    while (start < list.size())
+    {
+        auto end = std::min(list.find(',', start), list.size());
+        auto id = std::string_view(list).substr(start, end - start);
+        while (!id.empty() && id.front() == ' ')
+        {
+            id.remove_prefix(1);
+        }
+        while (!id.empty() && id.back() == ' ')
+        {
+            id.remove_suffix(1);
+        }
+
+        if (!id.empty())
+        {
+            dependencies.emplace_back(id);
+        }
+        start = end + 1;
+    }
+
+    return dependencies;
+}
+
 bool Assets::saveMeta(const AnyAsset& handle) const
 {
     // Get the asset metadata.
@@ -253,18 +565,76 @@ bool Assets::save(const AnyAsset& handle) const
     return bridge->save(*this, handle);
 }
 
+std::unique_ptr<cubos::core::memory::Stream> Assets::openFile(const AnyAsset& handle) const
+{
+    // Check if the file is already being read in the background.
+    std::future<std::unique_ptr<core::memory::Stream>> prefetched;
+    {
+        std::unique_lock loaderLock(mLoaderMutex);
+        auto it = mLoaderPrefetched.find(handle.getId());
+        if (it != mLoaderPrefetched.end())
+        {
+            prefetched = std::move(it->second);
+            mLoaderPrefetched.erase(it);
+        }
+    }
+
+    std::unique_ptr<core::memory::Stream> stream;
+    if (prefetched.valid())
+    {
+        stream = prefetched.get();
+    }
+
+    if (stream != nullptr)
+    {
+        mPrefetchHits += 1;
+    }
+    else
+    {
+        auto path = this->readMeta(handle)->get("path");
+        if (!path.has_value())
+        {
+            CUBOS_ERROR("Could not open file of asset {}: asset does not have a path", core::data::old::Debug(handle));
+            return nullptr;
+        }
+
+        stream = core::data::FileSystem::open(*path, core::data::File::OpenMode::Read);
+        if (stream == nullptr)
+        {
+            return nullptr;
+        }
+        mPrefetchMisses += 1;
+    }
+
+    // Account for the size of the file in the statistics of the bridge loading it.
+    if (currentBytesRead != nullptr)
+    {
+        stream->seek(0, core::memory::SeekOrigin::End);
+        *currentBytesRead += stream->tell();
+        stream->seek(0, core::memory::SeekOrigin::Begin);
+    }
+
+    return stream;
+}
+
 Assets::Status Assets::status(const AnyAsset& handle) const
 {
-    std::shared_lock lock(mMutex);
+    // Assets which are still being refined are reported as loading, even though they can be read.
+    if (const auto* assetEntry = this->cached(handle))
+    {
+        return assetEntry->refining ? Status::Loading : assetEntry->status;
+    }
 
     // Do not use .entry() here because we don't want to log errors if the asset is unknown.
-    auto it = mEntries.find(handle.getId());
-    if (it == mEntries.end())
+    auto& shard = this->shard(handle.getId());
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.entries.find(handle.getId());
+    if (it == shard.entries.end())
     {
         return Status::Unknown;
     }
 
-    return it->second->status;
+    return it->second->refining ? Status::Loading : it->second->status;
 }
 
 bool Assets::update(AnyAsset& handle) const
@@ -302,15 +672,19 @@ void Assets::invalidate(const AnyAsset& handle, bool shouldLock)
         lock.lock();
     }
 
+    // Coarse data is still being written to by its bridge, and thus can't be freed yet.
+    if (assetEntry->refining)
+    {
+        CUBOS_WARN("Could not invalidate asset {}: it is still being loaded", core::data::old::Debug(handle));
+        return;
+    }
+
     // If it has associated data, free it.
     if (assetEntry->data != nullptr)
     {
-        CUBOS_ASSERT(assetEntry->destructor != nullptr, "No destructor registered for asset type {}",
-                     assetEntry->type.name());
-        assetEntry->destructor(assetEntry->data);
-        assetEntry->data = nullptr;
-        assetEntry->status = Status::Unloaded;
+        this->unload(*assetEntry);
         assetEntry->version++;
+        this->markModified(handle);
 
         CUBOS_DEBUG("Invalidated asset {}", core::data::old::Debug(handle));
     }
@@ -347,7 +721,7 @@ AnyAsset Assets::create(std::type_index type, void* data, void (*destructor)(voi
     return this->store(AnyAsset(id), type, data, destructor);
 }
 
-AnyAsset Assets::store(AnyAsset handle, std::type_index type, void* data, void (*destructor)(void*))
+AnyAsset Assets::store(AnyAsset handle, std::type_index type, void* data, void (*destructor)(void*), bool coarse)
 {
     // Get or create a new entry for the asset.
     auto assetEntry = this->entry(handle, true);
@@ -357,30 +731,37 @@ AnyAsset Assets::store(AnyAsset handle, std::type_index type, void* data, void (
         return {};
     }
 
+    // Measure the data before locking the asset, as it needs to look for a bridge of its type.
+    auto size = this->memorySize(type, data);
+
     // Lock the asset.
     std::unique_lock lock(assetEntry->mutex);
 
-    // If it has associated data, free it.
+    // If it has associated data, free it. Only replaced data is reported as modified, as assets
+    // which were unloaded were already reported when they were invalidated, if they had to be.
     if (assetEntry->data != nullptr)
     {
-        CUBOS_ASSERT(assetEntry->destructor != nullptr, "No destructor registered for asset type {}",
-                     assetEntry->type.name());
-        assetEntry->destructor(assetEntry->data);
+        this->unload(*assetEntry);
+        this->markModified(handle);
     }
 
     // Mark it as loaded and set its data.
+    mLoadedCount += 1;
+    mMemoryUsed += size;
+    assetEntry->size = size;
+    assetEntry->used = true;
     assetEntry->status = Status::Loaded;
     assetEntry->version++;
     assetEntry->data = data;
     assetEntry->type = type;
     assetEntry->destructor = destructor;
+    assetEntry->refining = coarse;
     assetEntry->cond.notify_all();
 
     CUBOS_DEBUG("Stored data of type {} for asset {}", type.name(), core::data::old::Debug(handle));
 
     // Return a strong handle to the asset.
-    assetEntry->refCount.fetch_add(1);
-    handle.mRefCount = &assetEntry->refCount;
+    makeStrong(handle, *assetEntry);
     handle.mVersion = assetEntry->version;
     return handle;
 }
@@ -394,38 +775,30 @@ void* Assets::access(const AnyAsset& handle, std::type_index type, Lock& lock, b
     auto assetEntry = this->entry(handle);
     CUBOS_ASSERT(assetEntry != nullptr, "Could not access asset");
 
-    // If this is being called from the loader thread, we should load the asset synchronously.
-    if (std::this_thread::get_id() == mLoaderThread.get_id() && assetEntry->status != Status::Loaded)
-    {
-        CUBOS_DEBUG("Loading asset {} as a dependency", core::data::old::Debug(handle));
-
-        auto bridge = this->bridge(handle);
-        CUBOS_ASSERT(bridge != nullptr, "Could not access asset");
-
-        // Load the asset - the const_cast is okay since the const qualifiers are only used to make
-        // the interface more readable. We need to unlock temporarily to avoid a deadlock, since the
-        // bridge will call back into the asset manager.
-        lock.unlock();
-        if (!bridge->load(const_cast<Assets&>(*this), handle))
-        {
-            CUBOS_CRITICAL("Could not load asset {}", core::data::old::Debug(handle));
-            abort();
-        }
-        lock.lock();
-    }
+    // Loader threads must never wait for other loads, as all of them could end up waiting for
+    // tasks which no thread is free to run. Bridges suspend their loads through require() instead.
+    CUBOS_ASSERT(!this->isLoaderThread() || assetEntry->status == Status::Loaded,
+                 "Bridges must require() asset {} before reading it", core::data::old::Debug(handle));
 
     // Wait until the asset finishes loading.
-    while (assetEntry->status == Status::Loading)
+    if (assetEntry->status == Status::Loading)
     {
-        assetEntry->cond.wait(lock);
+        auto start = std::chrono::steady_clock::now();
+        while (assetEntry->status == Status::Loading)
+        {
+            assetEntry->cond.wait(lock);
+        }
+        this->recordWait(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
     }
 
     CUBOS_ASSERT(assetEntry->status == Status::Loaded && assetEntry->data != nullptr, "Could not access asset");
     CUBOS_ASSERT(assetEntry->type == type, "Type mismatch, expected {}, got {}", type.name(), assetEntry->type.name());
 
+    assetEntry->used = true;
     if (incVersion)
     {
         assetEntry->version++;
+        this->markModified(handle);
         CUBOS_DEBUG("Incremented version of asset {}", core::data::old::Debug(handle));
     }
 
@@ -440,6 +813,35 @@ template void* Assets::access<std::shared_lock<std::shared_mutex>>(const AnyAsse
 template void* Assets::access<std::unique_lock<std::shared_mutex>>(const AnyAsset&, std::type_index,
                                                                    std::unique_lock<std::shared_mutex>&, bool) const;
 
+bool Assets::wait(const AnyAsset& handle) const
+{
+    CUBOS_ASSERT(!this->isLoaderThread(), "Loader threads can't wait for other assets to load");
+
+    auto assetEntry = this->entry(handle);
+    CUBOS_ASSERT(assetEntry != nullptr, "Could not wait for asset");
+
+    std::shared_lock lock(assetEntry->mutex);
+    if (assetEntry->status == Status::Loading || assetEntry->refining)
+    {
+        auto start = std::chrono::steady_clock::now();
+        while (assetEntry->status == Status::Loading || assetEntry->refining)
+        {
+            assetEntry->cond.wait(lock);
+        }
+        this->recordWait(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return assetEntry->status == Status::Loaded;
+}
+
+void Assets::recordWait(double time) const
+{
+    std::unique_lock loaderLock(mLoaderMutex);
+    auto& stats = mWaitStats[std::this_thread::get_id()];
+    stats.waits += 1;
+    stats.totalTime += time;
+    stats.maxTime = std::max(stats.maxTime, time);
+}
+
 std::shared_lock<std::shared_mutex> Assets::lockRead(const AnyAsset& handle) const
 {
     if (auto entry = this->entry(handle))
@@ -462,7 +864,43 @@ std::unique_lock<std::shared_mutex> Assets::lockWrite(const AnyAsset& handle) co
     abort();
 }
 
-std::shared_ptr<Assets::Entry> Assets::entry(const AnyAsset& handle) const
+Assets::Shard& Assets::shard(const uuids::uuid& id) const
+{
+    return mShards[std::hash<uuids::uuid>{}(id) % ShardCount];
+}
+
+Assets::Entry* Assets::slot(const AnyAsset& handle) const
+{
+    // Handles whose UUID was changed through reflection no longer refer to the asset of their slot.
+    if (handle.mSlot == 0 || handle.mGeneration != mGeneration || handle.reflectedId != handle.mId)
+    {
+        return nullptr;
+    }
+
+    auto index = static_cast<std::size_t>(handle.mSlot - 1);
+    auto* block = mSlotBlocks[index / SlotBlockSize].load(std::memory_order_acquire);
+    return (*block)[index % SlotBlockSize].load(std::memory_order_acquire);
+}
+
+Assets::Entry* Assets::cached(const AnyAsset& handle) const
+{
+    // Handles only remember entries of the manager which created them, as their slots and entries
+    // mean nothing to other managers.
+    if (handle.mGeneration != mGeneration || handle.reflectedId != handle.mId)
+    {
+        return nullptr;
+    }
+
+    // Strong handles already point to their entry.
+    if (handle.isStrong())
+    {
+        return static_cast<Entry*>(handle.mEntry);
+    }
+
+    return this->slot(handle);
+}
+
+Assets::Entry* Assets::entry(const AnyAsset& handle) const
 {
     // If the handle is null, we can't access the asset.
     if (handle.isNull())
@@ -471,22 +909,33 @@ std::shared_ptr<Assets::Entry> Assets::entry(const AnyAsset& handle) const
         return nullptr;
     }
 
-    // Lock the entries map for reading.
-    auto sharedLock = std::shared_lock(mMutex);
+    if (auto* assetEntry = this->cached(handle))
+    {
+        return assetEntry;
+    }
+
+    // Lock the shard of the entry for reading.
+    auto& shard = this->shard(handle.getId());
+    auto sharedLock = std::shared_lock(shard.mutex);
 
     // Search for the entry in the map.
-    auto it = mEntries.find(handle.getId());
-    if (it == mEntries.end())
+    auto it = shard.entries.find(handle.getId());
+    if (it == shard.entries.end())
     {
         CUBOS_ERROR("No such asset {}", core::data::old::Debug(handle));
         return nullptr;
     }
 
-    return it->second;
+    return it->second.get();
 }
 
-std::shared_ptr<Assets::Entry> Assets::entry(const AnyAsset& handle, bool create)
+Assets::Entry* Assets::entry(const AnyAsset& handle, bool create)
 {
+    if (!create)
+    {
+        return std::as_const(*this).entry(handle);
+    }
+
     // If the handle is null, we can't access the asset.
     if (handle.isNull())
     {
@@ -494,43 +943,67 @@ std::shared_ptr<Assets::Entry> Assets::entry(const AnyAsset& handle, bool create
         return nullptr;
     }
 
-    // If we're creating the asset, we need to lock the entries map for writing.
-    // Otherwise, we can lock it for reading.
-    auto uniqueLock = std::unique_lock(mMutex, std::defer_lock);
-    auto sharedLock = std::shared_lock(mMutex, std::defer_lock);
-    if (create)
+    if (auto* assetEntry = this->cached(handle))
     {
-        uniqueLock.lock();
-    }
-    else
-    {
-        sharedLock.lock();
+        return assetEntry;
     }
 
-    // Search for an existing entry for the asset.
-    auto it = mEntries.find(handle.getId());
-    if (it == mEntries.end())
+    // We may need to create the asset, so we need to lock its shard for writing.
+    auto& shard = this->shard(handle.getId());
+    auto uniqueLock = std::unique_lock(shard.mutex);
+
+    // Search for an existing entry for the asset, and if there's none, create a new one.
+    auto it = shard.entries.find(handle.getId());
+    if (it == shard.entries.end())
     {
-        // If we're creating the asset, create a new entry for it.
-        // Otherwise, return nullptr.
-        if (create)
-        {
-            auto entry = std::make_shared<Entry>();
-            entry->meta.set("id", uuids::to_string(handle.getId()));
-            it = mEntries.emplace(handle.getId(), std::move(entry)).first;
-            CUBOS_TRACE("Created new asset entry for {}", core::data::old::Debug(handle));
-        }
-        else
+        auto entry = std::make_unique<Entry>();
+        entry->meta.set("id", uuids::to_string(handle.getId()));
         {
-            CUBOS_ERROR("No such asset {}", core::data::old::Debug(handle));
-            return nullptr;
+            std::unique_lock lock(mMutex);
+            auto index = mEntryList.size();
+            CUBOS_ASSERT(index < SlotBlockSize * SlotBlockCount, "Too many assets");
+
+            // Slots are assigned in the order entries are created, allocating blocks as needed.
+            auto& block = mSlotBlocks[index / SlotBlockSize];
+            if (index % SlotBlockSize == 0)
+            {
+                block.store(new SlotBlock{}, std::memory_order_release);
+            }
+            auto* slots = block.load(std::memory_order_relaxed);
+            (*slots)[index % SlotBlockSize].store(entry.get(), std::memory_order_release);
+
+            entry->slot = static_cast<uint32_t>(index + 1);
+            mEntryList.emplace_back(handle.getId(), entry.get());
         }
+        it = shard.entries.emplace(handle.getId(), std::move(entry)).first;
+        CUBOS_TRACE("Created new asset entry for {}", core::data::old::Debug(handle));
     }
 
-    return it->second;
+    return it->second.get();
 }
 
-std::shared_ptr<AssetBridge> Assets::bridge(const AnyAsset& handle) const
+void Assets::assignSlot(AnyAsset& handle, const Entry& entry) const
+{
+    handle.mSlot = entry.slot;
+    handle.mGeneration = mGeneration;
+}
+
+void Assets::makeStrong(AnyAsset& handle, Entry& entry) const
+{
+    // If the handle is already strong, it already holds its own reference.
+    if (handle.isStrong())
+    {
+        return;
+    }
+
+    this->assignSlot(handle, entry);
+
+    entry.refCount += 1;
+    handle.mRefCount = &entry.refCount;
+    handle.mEntry = &entry;
+}
+
+std::shared_ptr<AssetBridge> Assets::bridge(const AnyAsset& handle, std::string* extension) const
 {
     auto meta = this->readMeta(handle);
     if (auto path = meta->get("path"))
@@ -546,6 +1019,10 @@ std::shared_ptr<AssetBridge> Assets::bridge(const AnyAsset& handle) const
             {
                 best = bridge.second;
                 bestLen = bridge.first.length();
+                if (extension != nullptr)
+                {
+                    *extension = bridge.first;
+                }
             }
         }
 
@@ -561,13 +1038,46 @@ std::shared_ptr<AssetBridge> Assets::bridge(const AnyAsset& handle) const
     return nullptr;
 }
 
+std::size_t Assets::memorySize(std::type_index type, const void* data) const
+{
+    std::shared_lock lock(mMutex);
+
+    // Assets aren't tied to a bridge, so any bridge which loads assets of the same type can measure them.
+    for (const auto& [extension, bridge] : mBridges)
+    {
+        if (bridge->assetType() == type)
+        {
+            return bridge->memorySize(data);
+        }
+    }
+
+    return 0;
+}
+
+void Assets::unload(Entry& entry)
+{
+    CUBOS_ASSERT(entry.destructor != nullptr, "No destructor registered for asset type {}", entry.type.name());
+    entry.destructor(entry.data);
+    entry.data = nullptr;
+    entry.status = Status::Unloaded;
+
+    mMemoryUsed -= entry.size;
+    mLoadedCount -= 1;
+    entry.size = 0;
+}
+
 void Assets::loader()
 {
+    currentLoaderOwner = this;
+
     for (;;)
     {
         // Wait for a new asset to load.
         std::unique_lock<std::mutex> loaderLock(mLoaderMutex);
-        mLoaderCond.wait(loaderLock, [this]() { return !mLoaderQueue.empty() || mLoaderShouldExit; });
+        mLoaderCond.wait(loaderLock, [this]() {
+            return mLoaderShouldExit ||
+                   std::any_of(mLoaderQueue.begin(), mLoaderQueue.end(), [](const auto& q) { return !q.empty(); });
+        });
 
         // If the loader thread should exit, exit.
         if (mLoaderShouldExit)
@@ -575,35 +1085,408 @@ void Assets::loader()
             return;
         }
 
-        // Get the next asset to load.
-        auto task = mLoaderQueue.front();
-        mLoaderQueue.pop_front();
+        // Get the next asset to load, with the highest priority.
+        auto queue = std::find_if(mLoaderQueue.rbegin(), mLoaderQueue.rend(), [](const auto& q) { return !q.empty(); });
+        auto task = std::move(queue->front());
+        queue->pop_front();
+
+        // Start reading the files of the next queued assets, so that they're already in memory
+        // by the time their bridges get to them. Files of progressive bridges are skipped, as they
+        // are read a piece at a time instead.
+        std::size_t prefetched = 0;
+        for (auto it = mLoaderQueue.rbegin(); it != mLoaderQueue.rend() && prefetched < PrefetchCount; ++it)
+        {
+            for (std::size_t i = 0; i < it->size() && prefetched < PrefetchCount; ++i, ++prefetched)
+            {
+                const auto& next = (*it)[i];
+                if (!next.bridge->progressive() && !mLoaderPrefetched.contains(next.handle.getId()))
+                {
+                    mLoaderPrefetched.emplace(next.handle.getId(), core::data::FileSystem::readAsync(next.path));
+                }
+            }
+        }
+
         loaderLock.unlock(); // Unlock the mutex before loading the asset.
 
-        if (!task.bridge->load(*this, task.handle))
+        // Run the task, unless it has to wait for its dependencies. If its bridge requires assets
+        // which aren't loaded yet, the task has to wait for them too.
+        bool finished = false;
+        while (!finished && !this->suspendTask(task))
         {
-            CUBOS_ERROR("Failed to load asset '{}'", core::data::old::Debug(task.handle));
+            finished = this->runTask(task);
+        }
+    }
+}
 
-            auto assetEntry = this->entry(task.handle);
-            CUBOS_ASSERT(assetEntry != nullptr, "This should never happen");
-            assetEntry->status = Assets::Status::Unloaded;
-            assetEntry->cond.notify_all();
+bool Assets::isLoaderThread() const
+{
+    return currentLoaderOwner == this;
+}
+
+void Assets::startLoaders(std::size_t count)
+{
+    mLoaderShouldExit = false;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        mLoaderThreads.emplace_back([this]() { this->loader(); });
+    }
+}
+
+void Assets::stopLoaders()
+{
+    // Signal the loader threads to exit.
+    {
+        std::unique_lock loaderLock(mLoaderMutex);
+        mLoaderShouldExit = true;
+        mLoaderCond.notify_all();
+    }
+
+    // Wait for the loader threads to exit.
+    for (auto& thread : mLoaderThreads)
+    {
+        thread.join();
+    }
+    mLoaderThreads.clear();
+}
+
+bool Assets::suspendTask(Task& task) const
+{
+    // Queue the dependencies with the priority of the task which needs them, and keep them from
+    // being unloaded until the task runs.
+    for (auto& dependency : task.dependencies)
+    {
+        dependency = this->load(dependency, task.priority);
+        if (dependency.isNull())
+        {
+            task.dependencyFailed = true;
+            return false;
         }
-        else
+    }
+
+    std::unique_lock loaderLock(mLoaderMutex);
+
+    // Dependencies which finish loading from now on resume the task, as they need the lock to do so.
+    std::vector<uuids::uuid> pending;
+    for (const auto& dependency : task.dependencies)
+    {
+        auto status = this->status(dependency);
+        if (status == Status::Loading)
         {
-            auto assetEntry = this->entry(task.handle);
-            CUBOS_ASSERT(assetEntry != nullptr);
-            CUBOS_ASSERT(assetEntry->type == task.bridge->assetType());
+            pending.push_back(dependency.getId());
+        }
+        else if (status != Status::Loaded)
+        {
+            task.dependencyFailed = true;
+            return false;
         }
     }
+
+    if (pending.empty())
+    {
+        return false;
+    }
+
+    // The task would never be resumed if it were itself, directly or not, one of its dependencies.
+    std::vector<uuids::uuid> stack = pending;
+    std::unordered_set<uuids::uuid> visited;
+    while (!stack.empty())
+    {
+        auto id = stack.back();
+        stack.pop_back();
+        if (id == task.handle.getId())
+        {
+            CUBOS_ERROR("Asset {} depends on itself through its dependencies", core::data::old::Debug(task.handle));
+            task.dependencyFailed = true;
+            return false;
+        }
+
+        auto suspended = mLoaderSuspended.find(id);
+        if (visited.insert(id).second && suspended != mLoaderSuspended.end())
+        {
+            for (const auto& dependency : suspended->second.task.dependencies)
+            {
+                stack.push_back(dependency.getId());
+            }
+        }
+    }
+
+    CUBOS_DEBUG("Suspending load of asset {} until {} of its dependencies are loaded",
+                core::data::old::Debug(task.handle), pending.size());
+    for (const auto& id : pending)
+    {
+        mLoaderDependents.emplace(id, task.handle.getId());
+    }
+    auto id = task.handle.getId();
+    mLoaderSuspended.emplace(id, SuspendedTask{std::move(task), pending.size()});
+    return true;
+}
+
+void Assets::resumeDependents(const AnyAsset& handle, bool success) const
+{
+    auto [begin, end] = mLoaderDependents.equal_range(handle.getId());
+    for (auto it = begin; it != end; ++it)
+    {
+        auto suspended = mLoaderSuspended.find(it->second);
+        CUBOS_ASSERT(suspended != mLoaderSuspended.end(), "This should never happen");
+
+        // Tasks whose dependencies failed are still resumed, so that they fail too.
+        auto& [task, pending] = suspended->second;
+        task.dependencyFailed |= !success;
+        if (--pending == 0)
+        {
+            CUBOS_DEBUG("Resuming load of asset {}", core::data::old::Debug(task.handle));
+            mLoaderQueue[static_cast<std::size_t>(task.priority)].push_back(std::move(task));
+            mLoaderSuspended.erase(suspended);
+            mLoaderCond.notify_one();
+        }
+    }
+
+    mLoaderDependents.erase(begin, end);
+}
+
+bool Assets::runTask(Task& task) const
+{
+    std::size_t bytesRead = 0;
+    std::vector<AnyAsset> required;
+    currentBytesRead = &bytesRead;
+    currentRequired = &required;
+
+    auto start = std::chrono::steady_clock::now();
+    bool success = false;
+    if (task.dependencyFailed)
+    {
+        CUBOS_ERROR("Could not load asset {}: some of its dependencies failed to load",
+                    core::data::old::Debug(task.handle));
+    }
+    else
+    {
+        // The const_cast is okay since the const qualifiers are only used to make the interface more
+        // readable.
+        success = task.bridge->load(const_cast<Assets&>(*this), task.handle);
+    }
+    auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    currentBytesRead = nullptr;
+    currentRequired = nullptr;
+
+    auto assetEntry = this->entry(task.handle);
+    CUBOS_ASSERT(assetEntry != nullptr, "This should never happen");
+    if (!success && !required.empty())
+    {
+        // The bridge gave up because it requires assets which aren't loaded yet, and will run again
+        // once they are. The asset is still loading meanwhile.
+        std::unique_lock lock(assetEntry->mutex);
+        if (assetEntry->refining.exchange(false) && assetEntry->data != nullptr)
+        {
+            const_cast<Assets*>(this)->unload(*assetEntry);
+        }
+        assetEntry->status = Assets::Status::Loading;
+
+        task.dependencies.insert(task.dependencies.end(), required.begin(), required.end());
+        return false;
+    }
+
+    bool wasRefining;
+    if (!success)
+    {
+        CUBOS_ERROR("Failed to load asset '{}'", core::data::old::Debug(task.handle));
+
+        // Discard the coarse version of the asset, if the bridge stored one before failing.
+        std::unique_lock lock(assetEntry->mutex);
+        wasRefining = assetEntry->refining.exchange(false);
+        if (wasRefining && assetEntry->data != nullptr)
+        {
+            const_cast<Assets*>(this)->unload(*assetEntry);
+        }
+        assetEntry->status = Assets::Status::Unloaded;
+        assetEntry->cond.notify_all();
+    }
+    else
+    {
+        CUBOS_ASSERT(assetEntry->type == task.bridge->assetType());
+
+        // Measure the asset again, as it may have grown while being refined, unless it was
+        // already unloaded meanwhile.
+        std::unique_lock lock(assetEntry->mutex);
+        if (assetEntry->data != nullptr)
+        {
+            mMemoryUsed -= assetEntry->size;
+            assetEntry->size = task.bridge->memorySize(assetEntry->data);
+            mMemoryUsed += assetEntry->size;
+        }
+
+        // Wake up anyone waiting for the asset to be fully refined.
+        wasRefining = assetEntry->refining.exchange(false);
+        assetEntry->cond.notify_all();
+    }
+
+    if (wasRefining)
+    {
+        const_cast<Assets*>(this)->markRefined(task.handle);
+    }
+
+    // Update the statistics and discard the prefetched file if the bridge didn't use it.
+    std::unique_lock loaderLock(mLoaderMutex);
+    auto& stats = mBridgeStats[task.extension];
+    stats.loads += success ? 1 : 0;
+    stats.failures += success ? 0 : 1;
+    stats.totalTime += time;
+    stats.maxTime = std::max(stats.maxTime, time);
+    stats.bytesRead += bytesRead;
+
+    std::size_t bucket = 0;
+    while (bucket + 1 < LoadTimeBuckets && time * 1000.0 >= static_cast<double>(1U << bucket))
+    {
+        bucket += 1;
+    }
+    stats.loadTimes[bucket] += 1;
+
+    mLoaderPrefetched.erase(task.handle.getId());
+    this->resumeDependents(task.handle, success);
+    return true;
+}
+
+std::unordered_map<std::string, Assets::BridgeStats> Assets::bridgeStats() const
+{
+    std::unique_lock loaderLock(mLoaderMutex);
+    return mBridgeStats;
+}
+
+void Assets::markRefined(const AnyAsset& handle)
+{
+    // Refining doesn't increase the version by itself, as it's done through refine().
+    if (auto* assetEntry = this->entry(handle))
+    {
+        std::unique_lock lock(assetEntry->mutex);
+        assetEntry->version++;
+    }
+
+    this->markModified(handle);
+}
+
+std::vector<AnyAsset> Assets::takeModified()
+{
+    std::unique_lock lock(mMutex);
+    return std::exchange(mModified, {});
+}
+
+void Assets::markModified(const AnyAsset& handle) const
+{
+    std::unique_lock lock(mMutex);
+    if (std::none_of(mModified.begin(), mModified.end(),
+                     [&](const AnyAsset& other) { return other.getId() == handle.getId(); }))
+    {
+        mModified.emplace_back(handle.getId());
+    }
+}
+
+Assets::MemoryStats Assets::memoryStats() const
+{
+    return MemoryStats{
+        .budget = mMemoryBudget,
+        .used = mMemoryUsed,
+        .loaded = mLoadedCount,
+        .evictions = mEvictions,
+    };
+}
+
+Assets::LoaderStats Assets::loaderStats() const
+{
+    LoaderStats stats{};
+    stats.prefetchHits = mPrefetchHits;
+    stats.prefetchMisses = mPrefetchMisses;
+
+    std::unique_lock loaderLock(mLoaderMutex);
+    for (const auto& queue : mLoaderQueue)
+    {
+        stats.queued += queue.size();
+    }
+    stats.maxQueued = mLoaderMaxQueued;
+    stats.suspended = mLoaderSuspended.size();
+
+    for (const auto& [thread, waits] : mWaitStats)
+    {
+        std::ostringstream name;
+        name << thread;
+        stats.waits.emplace(name.str(), waits);
+    }
+
+    return stats;
+}
+
+void Assets::writeStats(core::memory::Stream& stream) const
+{
+    auto bridges = this->bridgeStats();
+    auto loader = this->loaderStats();
+    auto memory = this->memoryStats();
+    auto cache = mCache->stats();
+
+    core::data::old::JSONSerializer ser{stream, 4};
+    ser.beginObject(nullptr);
+
+    ser.beginDictionary(bridges.size(), "bridges");
+    for (const auto& [extension, stats] : bridges)
+    {
+        ser.writeString(extension.c_str(), nullptr);
+        ser.beginObject(nullptr);
+        ser.writeU64(stats.loads, "loads");
+        ser.writeU64(stats.failures, "failures");
+        ser.writeF64(stats.totalTime, "totalTime");
+        ser.writeF64(stats.maxTime, "maxTime");
+        ser.writeU64(stats.bytesRead, "bytesRead");
+        ser.beginArray(stats.loadTimes.size(), "loadTimes");
+        for (auto count : stats.loadTimes)
+        {
+            ser.writeU64(count, nullptr);
+        }
+        ser.endArray();
+        ser.endObject();
+    }
+    ser.endDictionary();
+
+    ser.beginObject("loader");
+    ser.writeU64(loader.queued, "queued");
+    ser.writeU64(loader.maxQueued, "maxQueued");
+    ser.writeU64(loader.suspended, "suspended");
+    ser.writeU64(loader.prefetchHits, "prefetchHits");
+    ser.writeU64(loader.prefetchMisses, "prefetchMisses");
+    ser.beginDictionary(loader.waits.size(), "waits");
+    for (const auto& [thread, waits] : loader.waits)
+    {
+        ser.writeString(thread.c_str(), nullptr);
+        ser.beginObject(nullptr);
+        ser.writeU64(waits.waits, "waits");
+        ser.writeF64(waits.totalTime, "totalTime");
+        ser.writeF64(waits.maxTime, "maxTime");
+        ser.endObject();
+    }
+    ser.endDictionary();
+    ser.endObject();
+
+    ser.beginObject("memory");
+    ser.writeU64(memory.budget, "budget");
+    ser.writeU64(memory.used, "used");
+    ser.writeU64(memory.loaded, "loaded");
+    ser.writeU64(memory.evictions, "evictions");
+    ser.endObject();
+
+    ser.beginObject("cache");
+    ser.writeU64(cache.hits, "hits");
+    ser.writeU64(cache.misses, "misses");
+    ser.writeU64(cache.writes, "writes");
+    ser.endObject();
+
+    ser.endObject();
 }
 
 std::vector<AnyAsset> Assets::listAll() const
 {
+    std::shared_lock lock(mMutex);
+
     std::vector<AnyAsset> out;
-    for (auto const& [entry, _] : mEntries)
+    out.reserve(mEntryList.size());
+    for (auto const& [id, entry] : mEntryList)
     {
-        out.emplace_back(entry);
+        this->assignSlot(out.emplace_back(id), *entry);
     }
     return out;
 }
@@ -9,3 +9,8 @@ bool AssetBridge::save(const Assets& /*assets*/, const AnyAsset& /*handle*/)
     CUBOS_ERROR("This asset bridge does not support saving assets");
     return false;
 }
+
+std::size_t AssetBridge::memorySize(const void* /*data*/) const
+{
+    return 0;
+}
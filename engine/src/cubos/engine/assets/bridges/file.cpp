@@ -10,7 +10,7 @@ using cubos::core::data::FileSystem;
 bool FileBridge::load(Assets& assets, const AnyAsset& handle)
 {
     auto path = assets.readMeta(handle)->get("path").value();
-    auto stream = FileSystem::open(path, File::OpenMode::Read);
+    auto stream = assets.openFile(handle);
     if (stream == nullptr)
     {
         CUBOS_ERROR("Could not open file '{}'", path);
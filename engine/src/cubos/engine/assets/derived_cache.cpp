@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <cubos/core/data/fs/file_system.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+#include <cubos/engine/assets/derived_cache.hpp>
+
+using cubos::core::data::File;
+using cubos::core::data::FileSystem;
+using cubos::core::memory::BufferStream;
+using cubos::core::memory::CompressedStream;
+using cubos::core::memory::fromLittleEndian;
+using cubos::core::memory::toLittleEndian;
+
+using namespace cubos::engine;
+
+/// @brief Magic number at the start of cache entries, before compression.
+static constexpr char Magic[4] = {'C', 'D', 'R', 'V'};
+
+/// @brief Size of the header of cache entries: magic, version, key and data size.
+static constexpr std::size_t HeaderSize = sizeof(Magic) + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint64_t);
+
+/// @brief Largest data size accepted from a cache entry, to reject corrupt headers.
+static constexpr uint64_t MaxEntrySize = uint64_t{1} << 32;
+
+/// @brief Number of bytes read at once from a cache entry.
+static constexpr std::size_t ReadChunkSize = std::size_t{1} << 20;
+
+DerivedCache::DerivedCache(std::string root)
+    : mRoot(std::move(root))
+{
+}
+
+DerivedCache::DerivedCache(const DerivedCache& other)
+    : mRoot(other.mRoot)
+    , mHits(other.mHits.load())
+    , mMisses(other.mMisses.load())
+    , mWrites(other.mWrites.load())
+{
+}
+
+DerivedCache& DerivedCache::operator=(const DerivedCache& other)
+{
+    mRoot = other.mRoot;
+    mHits = other.mHits.load();
+    mMisses = other.mMisses.load();
+    mWrites = other.mWrites.load();
+    return *this;
+}
+
+bool DerivedCache::enabled() const
+{
+    return !mRoot.empty();
+}
+
+/// @brief Rotates the bits of a 64-bit word to the left.
+static uint64_t rotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/// @brief Scrambles a single word of the data, as MurmurHash3 does.
+static uint64_t mixWord(uint64_t word)
+{
+    word *= 0x87C37B91114253D5ULL;
+    word = rotateLeft(word, 31);
+    return word * 0x4CF5AD432745937FULL;
+}
+
+uint64_t DerivedCache::hash(const void* data, std::size_t size, uint64_t seed)
+{
+    // Hashes whole words at a time, with the body of MurmurHash3, as large inputs such as the
+    // contents of voxel grids are hashed every time they're looked up.
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        seed ^= mixWord(fromLittleEndian(word));
+        seed = rotateLeft(seed, 27) * 5 + 0x52DCE729;
+    }
+
+    // Bytes which don't fill a whole word are packed into a last one.
+    if (i < size)
+    {
+        uint64_t word = 0;
+        for (std::size_t j = 0; i + j < size; ++j)
+        {
+            word |= static_cast<uint64_t>(bytes[i + j]) << (8 * j);
+        }
+        seed ^= mixWord(word);
+    }
+
+    // Finalize, so that every bit of the input affects every bit of the result.
+    seed ^= size;
+    seed ^= seed >> 33;
+    seed *= 0xFF51AFD7ED558CCDULL;
+    seed ^= seed >> 33;
+    seed *= 0xC4CEB9FE1A85EC53ULL;
+    seed ^= seed >> 33;
+    return seed;
+}
+
+bool DerivedCache::read(std::string_view kind, uint64_t key, uint32_t version, std::vector<char>& data) const
+{
+    if (!this->enabled())
+    {
+        return false;
+    }
+
+    bool hit = this->readEntry(kind, key, version, data);
+    (hit ? mHits : mMisses) += 1;
+    return hit;
+}
+
+bool DerivedCache::readEntry(std::string_view kind, uint64_t key, uint32_t version, std::vector<char>& data) const
+{
+    // Files are decompressed transparently when opened.
+    auto file = FileSystem::find(this->path(kind, key));
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    auto stream = file->open(File::OpenMode::Read);
+    if (stream == nullptr)
+    {
+        return false;
+    }
+
+    char header[HeaderSize];
+    if (stream->read(header, HeaderSize) != HeaderSize || std::memcmp(header, Magic, sizeof(Magic)) != 0)
+    {
+        CUBOS_WARN("Ignoring invalid {} cache entry {:016x}", kind, key);
+        return false;
+    }
+
+    uint32_t storedVersion;
+    uint64_t storedKey;
+    uint64_t size;
+    std::memcpy(&storedVersion, header + sizeof(Magic), sizeof(uint32_t));
+    std::memcpy(&storedKey, header + sizeof(Magic) + sizeof(uint32_t), sizeof(uint64_t));
+    std::memcpy(&size, header + sizeof(Magic) + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint64_t));
+    if (fromLittleEndian(storedVersion) != version || fromLittleEndian(storedKey) != key)
+    {
+        CUBOS_DEBUG("Ignoring outdated {} cache entry {:016x}", kind, key);
+        return false;
+    }
+
+    size = fromLittleEndian(size);
+    if (size > MaxEntrySize)
+    {
+        CUBOS_WARN("Ignoring invalid {} cache entry {:016x}", kind, key);
+        return false;
+    }
+
+    // The stream may be compressed, so its remaining size isn't known up front. Grow the buffer
+    // only as data is actually read, so that a corrupt size can't cause a huge allocation.
+    data.clear();
+    while (data.size() < size)
+    {
+        auto offset = data.size();
+        auto chunk = static_cast<std::size_t>(std::min<uint64_t>(size - offset, ReadChunkSize));
+        data.resize(offset + chunk);
+        if (stream->read(data.data() + offset, chunk) != chunk)
+        {
+            CUBOS_WARN("Ignoring truncated {} cache entry {:016x}", kind, key);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DerivedCache::write(std::string_view kind, uint64_t key, uint32_t version, const void* data,
+                         std::size_t size) const
+{
+    if (!this->enabled())
+    {
+        return false;
+    }
+
+    // Prepend the header to the data, so that it is all compressed together.
+    std::vector<char> buffer(HeaderSize + size);
+    auto leVersion = toLittleEndian(version);
+    auto leKey = toLittleEndian(key);
+    auto leSize = toLittleEndian(static_cast<uint64_t>(size));
+    std::memcpy(buffer.data(), Magic, sizeof(Magic));
+    std::memcpy(buffer.data() + sizeof(Magic), &leVersion, sizeof(uint32_t));
+    std::memcpy(buffer.data() + sizeof(Magic) + sizeof(uint32_t), &leKey, sizeof(uint64_t));
+    std::memcpy(buffer.data() + sizeof(Magic) + sizeof(uint32_t) + sizeof(uint64_t), &leSize, sizeof(uint64_t));
+    if (size > 0)
+    {
+        std::memcpy(buffer.data() + HeaderSize, data, size);
+    }
+
+    auto path = this->path(kind, key);
+    auto file = FileSystem::create(path);
+    if (file == nullptr)
+    {
+        CUBOS_ERROR("Could not write {} cache entry: could not create file '{}'", kind, path);
+        return false;
+    }
+
+    auto stream = file->open(File::OpenMode::Write);
+    BufferStream in{buffer.data(), buffer.size()};
+    if (stream == nullptr || !CompressedStream::compress(in, *stream))
+    {
+        CUBOS_ERROR("Could not write {} cache entry: could not write to file '{}'", kind, path);
+        return false;
+    }
+
+    CUBOS_DEBUG("Wrote {} cache entry {:016x} ({} bytes)", kind, key, size);
+    mWrites += 1;
+    return true;
+}
+
+DerivedCache::Stats DerivedCache::stats() const
+{
+    return {mHits, mMisses, mWrites};
+}
+
+std::string DerivedCache::path(std::string_view kind, uint64_t key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016" PRIx64, key);
+    return mRoot + "/" + std::string(kind) + "/" + name;
+}
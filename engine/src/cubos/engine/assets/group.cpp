@@ -0,0 +1,63 @@
+#include <cubos/engine/assets/assets.hpp>
+#include <cubos/engine/assets/group.hpp>
+
+using namespace cubos::engine;
+
+std::size_t AssetGroup::total() const
+{
+    return mAssets.size() + mUnqueued;
+}
+
+std::size_t AssetGroup::loaded() const
+{
+    std::size_t count = 0;
+    for (const auto& handle : mAssets)
+    {
+        count += mManager->status(handle) == Assets::Status::Loaded ? 1 : 0;
+    }
+    return count;
+}
+
+std::size_t AssetGroup::failed() const
+{
+    // Since the group holds strong handles to its assets, they're never unloaded by cleanup, and
+    // thus an unloaded asset is one whose load failed.
+    std::size_t count = mUnqueued;
+    for (const auto& handle : mAssets)
+    {
+        count += mManager->status(handle) == Assets::Status::Unloaded ? 1 : 0;
+    }
+    return count;
+}
+
+float AssetGroup::progress() const
+{
+    if (this->total() == 0)
+    {
+        return 1.0F;
+    }
+
+    return static_cast<float>(this->loaded() + this->failed()) / static_cast<float>(this->total());
+}
+
+bool AssetGroup::done() const
+{
+    for (const auto& handle : mAssets)
+    {
+        if (mManager->status(handle) == Assets::Status::Loading)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetGroup::wait() const
+{
+    bool success = mUnqueued == 0;
+    for (const auto& handle : mAssets)
+    {
+        success = mManager->wait(handle) && success;
+    }
+    return success;
+}
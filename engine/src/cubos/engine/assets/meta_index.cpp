@@ -0,0 +1,322 @@
+#include <cstring>
+#include <vector>
+
+#include <cubos/core/data/fs/file_system.hpp>
+#include <cubos/core/data/old/json_deserializer.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+#include <cubos/engine/assets/meta_index.hpp>
+
+using cubos::core::data::File;
+using cubos::core::data::FileSystem;
+using cubos::core::memory::fromLittleEndian;
+using cubos::core::memory::Stream;
+using cubos::core::memory::toLittleEndian;
+
+using namespace cubos::engine;
+
+/// @brief Magic number at the start of index files.
+static constexpr char Magic[4] = {'C', 'M', 'I', 'X'};
+
+template <typename T>
+static bool writeInt(Stream& stream, T value)
+{
+    value = toLittleEndian(value);
+    return stream.write(&value, sizeof(T)) == sizeof(T);
+}
+
+template <typename T>
+static bool readInt(Stream& stream, T& value)
+{
+    if (stream.read(&value, sizeof(T)) != sizeof(T))
+    {
+        return false;
+    }
+    value = fromLittleEndian(value);
+    return true;
+}
+
+static bool writeString(Stream& stream, std::string_view str)
+{
+    return writeInt(stream, static_cast<uint32_t>(str.size())) &&
+           stream.write(str.data(), str.size()) == str.size();
+}
+
+static bool readString(Stream& stream, std::string& str)
+{
+    uint32_t size;
+    if (!readInt(stream, size))
+    {
+        return false;
+    }
+    str.resize(size);
+    return stream.read(str.data(), size) == size;
+}
+
+static bool writeNames(Stream& stream, const std::vector<std::string>& names)
+{
+    if (!writeInt(stream, static_cast<uint32_t>(names.size())))
+    {
+        return false;
+    }
+
+    for (const auto& name : names)
+    {
+        if (!writeString(stream, name))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readNames(Stream& stream, std::vector<std::string>& names)
+{
+    uint32_t count;
+    if (!readInt(stream, count))
+    {
+        return false;
+    }
+
+    names.clear();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!readString(stream, names.emplace_back()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetMetaIndex::readFile(File& file, AssetMeta& meta)
+{
+    auto stream = file.open(File::OpenMode::Read);
+    if (stream == nullptr)
+    {
+        return false;
+    }
+
+    auto des = core::data::old::JSONDeserializer(*stream);
+    des.read(meta);
+    return !des.failed();
+}
+
+bool AssetMetaIndex::build(std::string_view path)
+{
+    auto root = FileSystem::find(path);
+    if (root == nullptr)
+    {
+        CUBOS_ERROR("Couldn't build asset metadata index: file '{}' not found", path);
+        return false;
+    }
+
+    bool success = true;
+    std::vector<File::Handle> stack{root};
+    while (!stack.empty())
+    {
+        auto file = std::move(stack.back());
+        stack.pop_back();
+
+        auto relative = std::string(file->path().substr(root->path().size()));
+        if (!file->directory())
+        {
+            // Only reached if the root itself is a file.
+            success &= this->buildFile(*file, std::move(relative));
+            continue;
+        }
+
+        Directory directory{file->modificationTime(), {}, {}};
+        bool indexed = true;
+        for (auto child = file->child(); child != nullptr; child = child->sibling())
+        {
+            if (child->directory())
+            {
+                directory.directories.emplace_back(child->name());
+                stack.push_back(child);
+            }
+            else if (child->name().ends_with(".meta"))
+            {
+                indexed &= this->buildFile(*child, relative + "/" + std::string(child->name()));
+                directory.metas.emplace_back(child->name());
+            }
+        }
+
+        // Directories with files which couldn't be indexed are left out, so that they're always
+        // listed, and the files are read again.
+        if (indexed)
+        {
+            this->insertDirectory(std::move(relative), std::move(directory));
+        }
+        success &= indexed;
+    }
+
+    return success;
+}
+
+bool AssetMetaIndex::buildFile(File& file, std::string path)
+{
+    if (!file.name().ends_with(".meta"))
+    {
+        return true;
+    }
+
+    Entry entry{file.modificationTime(), {}};
+    if (!readFile(file, entry.meta))
+    {
+        CUBOS_ERROR("Couldn't index asset metadata: JSON deserialization failed for file '{}'", file.path());
+        return false;
+    }
+
+    this->insert(std::move(path), std::move(entry));
+    return true;
+}
+
+void AssetMetaIndex::insert(std::string path, Entry entry)
+{
+    mEntries.insert_or_assign(std::move(path), std::move(entry));
+}
+
+const AssetMetaIndex::Entry* AssetMetaIndex::find(const std::string& path) const
+{
+    auto it = mEntries.find(path);
+    return it == mEntries.end() ? nullptr : &it->second;
+}
+
+void AssetMetaIndex::insertDirectory(std::string path, Directory directory)
+{
+    mDirectories.insert_or_assign(std::move(path), std::move(directory));
+}
+
+const AssetMetaIndex::Directory* AssetMetaIndex::findDirectory(const std::string& path) const
+{
+    auto it = mDirectories.find(path);
+    return it == mDirectories.end() ? nullptr : &it->second;
+}
+
+std::size_t AssetMetaIndex::size() const
+{
+    return mEntries.size();
+}
+
+bool AssetMetaIndex::read(Stream& stream)
+{
+    mEntries.clear();
+    mDirectories.clear();
+
+    char magic[sizeof(Magic)];
+    uint32_t version;
+    uint64_t count;
+    if (stream.read(magic, sizeof(Magic)) != sizeof(Magic) || std::memcmp(magic, Magic, sizeof(Magic)) != 0 ||
+        !readInt(stream, version) || !readInt(stream, count))
+    {
+        CUBOS_ERROR("Couldn't read asset metadata index: invalid header");
+        return false;
+    }
+
+    if (version != Version)
+    {
+        CUBOS_WARN("Ignoring asset metadata index with version {}, expected version {}", version, Version);
+        return false;
+    }
+
+    mEntries.reserve(static_cast<std::size_t>(count));
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        std::string path;
+        Entry entry{};
+        uint32_t paramCount;
+        if (!readString(stream, path) || !readInt(stream, entry.modificationTime) || !readInt(stream, paramCount))
+        {
+            CUBOS_ERROR("Couldn't read asset metadata index: truncated entry");
+            mEntries.clear();
+            return false;
+        }
+
+        for (uint32_t j = 0; j < paramCount; ++j)
+        {
+            std::string key;
+            std::string value;
+            if (!readString(stream, key) || !readString(stream, value))
+            {
+                CUBOS_ERROR("Couldn't read asset metadata index: truncated entry");
+                mEntries.clear();
+                return false;
+            }
+            entry.meta.params().emplace(std::move(key), std::move(value));
+        }
+
+        mEntries.emplace(std::move(path), std::move(entry));
+    }
+
+    if (!readInt(stream, count))
+    {
+        CUBOS_ERROR("Couldn't read asset metadata index: truncated directory table");
+        mEntries.clear();
+        return false;
+    }
+
+    mDirectories.reserve(static_cast<std::size_t>(count));
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        std::string path;
+        Directory directory{};
+        if (!readString(stream, path) || !readInt(stream, directory.modificationTime) ||
+            !readNames(stream, directory.directories) || !readNames(stream, directory.metas))
+        {
+            CUBOS_ERROR("Couldn't read asset metadata index: truncated directory");
+            mEntries.clear();
+            mDirectories.clear();
+            return false;
+        }
+
+        mDirectories.emplace(std::move(path), std::move(directory));
+    }
+
+    return true;
+}
+
+bool AssetMetaIndex::write(Stream& stream) const
+{
+    if (stream.write(Magic, sizeof(Magic)) != sizeof(Magic) || !writeInt(stream, Version) ||
+        !writeInt(stream, static_cast<uint64_t>(mEntries.size())))
+    {
+        CUBOS_ERROR("Couldn't write asset metadata index header");
+        return false;
+    }
+
+    for (const auto& [path, entry] : mEntries)
+    {
+        bool success = writeString(stream, path) && writeInt(stream, entry.modificationTime) &&
+                       writeInt(stream, static_cast<uint32_t>(entry.meta.params().size()));
+        for (const auto& [key, value] : entry.meta.params())
+        {
+            success = success && writeString(stream, key) && writeString(stream, value);
+        }
+
+        if (!success)
+        {
+            CUBOS_ERROR("Couldn't write asset metadata index entry '{}'", path);
+            return false;
+        }
+    }
+
+    if (!writeInt(stream, static_cast<uint64_t>(mDirectories.size())))
+    {
+        CUBOS_ERROR("Couldn't write asset metadata index directory table");
+        return false;
+    }
+
+    for (const auto& [path, directory] : mDirectories)
+    {
+        if (!writeString(stream, path) || !writeInt(stream, directory.modificationTime) ||
+            !writeNames(stream, directory.directories) || !writeNames(stream, directory.metas))
+        {
+            CUBOS_ERROR("Couldn't write asset metadata index directory '{}'", path);
+            return false;
+        }
+    }
+
+    return true;
+}
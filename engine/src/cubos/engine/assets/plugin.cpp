@@ -1,11 +1,17 @@
+#include <algorithm>
+#include <thread>
+
 #include <cubos/core/data/fs/file_system.hpp>
 #include <cubos/core/data/fs/standard_archive.hpp>
+#include <cubos/core/log.hpp>
 
 #include <cubos/engine/assets/plugin.hpp>
 #include <cubos/engine/settings/plugin.hpp>
 
+using cubos::core::data::File;
 using cubos::core::data::FileSystem;
 using cubos::core::data::StandardArchive;
+using cubos::core::ecs::EventWriter;
 using cubos::core::ecs::Write;
 
 using namespace cubos::engine;
@@ -13,34 +19,83 @@ using namespace cubos::engine;
 static void init(Write<Assets> assets, Write<Settings> settings)
 {
     // Get the relevant settings.
+    auto defaultThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    auto threads = settings->getInteger("assets.loader.threads", defaultThreads);
+    assets->loaderThreads(static_cast<std::size_t>(std::max(1, threads)));
+    auto budget = settings->getInteger("assets.memory.budget", 0);
+    assets->memoryBudget(static_cast<std::size_t>(std::max(0, budget)) * 1024 * 1024);
+
     if (settings->getBool("assets.io.enabled", true))
     {
         std::filesystem::path path = settings->getString("assets.io.path", "assets");
         bool readOnly = settings->getBool("assets.io.readOnly", true);
 
         // Create a standard archive for the assets directory and mount it.
-        FileSystem::mount("/assets", std::make_unique<StandardArchive>(path, true, readOnly));
+        auto archive = std::make_unique<StandardArchive>(path, true, readOnly);
+        if (settings->getBool("assets.io.watch", false))
+        {
+            archive->watch();
+        }
+        FileSystem::mount("/assets", std::move(archive));
 
-        // Load the meta files on the assets directory.
-        assets->loadMeta("/assets");
+        // Load the meta files on the assets directory, using its metadata index if there is one.
+        AssetMetaIndex index{};
+        auto indexPath = settings->getString("assets.io.index", "assets.index");
+        if (!indexPath.empty())
+        {
+            auto file = FileSystem::find("/assets/" + indexPath);
+            auto stream = file == nullptr ? nullptr : file->open(File::OpenMode::Read);
+            if (stream != nullptr && !index.read(*stream))
+            {
+                CUBOS_WARN("Ignoring invalid asset metadata index '{}'", indexPath);
+            }
+        }
+        assets->loadMeta("/assets", index);
+    }
+
+    if (settings->getBool("assets.cache.enabled", false))
+    {
+        // Create a writable standard archive for the cache directory and mount it.
+        std::filesystem::path path = settings->getString("assets.cache.path", "cache");
+        if (FileSystem::mount("/cache", std::make_unique<StandardArchive>(path, true, false)))
+        {
+            assets->cache() = DerivedCache("/cache");
+        }
     }
 }
 
 static void cleanup(Write<Assets> assets)
 {
-    // TODO: maybe don't do this every frame?
+    // Only a few assets are visited on each call, so this is cheap enough to do every frame.
     assets->cleanup();
 }
 
+static void watch(Write<Assets> assets, EventWriter<AssetModifiedEvent> events)
+{
+    // Reloading assets invalidates them, and thus they're also reported as modified below.
+    auto paths = FileSystem::modified();
+    if (!paths.empty())
+    {
+        assets->reloadModified(paths);
+    }
+
+    for (auto& handle : assets->takeModified())
+    {
+        events.push(AssetModifiedEvent{std::move(handle)});
+    }
+}
+
 void cubos::engine::assetsPlugin(Cubos& cubos)
 {
     cubos.addPlugin(settingsPlugin);
 
     cubos.addResource<Assets>();
+    cubos.addEvent<AssetModifiedEvent>();
 
     cubos.startupTag("cubos.assets.init").after("cubos.settings");
     cubos.startupTag("cubos.assets.bridge").after("cubos.assets.init").before("cubos.assets");
 
     cubos.startupSystem(init).tagged("cubos.assets.init");
     cubos.system(cleanup).tagged("cubos.assets.cleanup");
+    cubos.system(watch).tagged("cubos.assets.watch");
 }
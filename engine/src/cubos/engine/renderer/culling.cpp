@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include <cubos/engine/renderer/culling.hpp>
+
+/// @brief Number of draw commands tested at once.
+static constexpr std::size_t CullingBatchSize = 64;
+
+void cubos::engine::cullDrawCmds(const glm::mat4& viewProjection, const std::vector<RendererFrame::DrawCmd>& drawCmds,
+                                 std::vector<std::size_t>& visible)
+{
+    visible.clear();
+
+    // Extract the planes of the frustum from the rows of the matrix, with their normals pointing
+    // inwards. They aren't normalized, as only the sign of the distances matters.
+    auto rows = glm::transpose(viewProjection);
+    const glm::vec4 planes[6] = {
+        rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+        rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2],
+    };
+
+    float centerX[CullingBatchSize];
+    float centerY[CullingBatchSize];
+    float centerZ[CullingBatchSize];
+    float extentX[CullingBatchSize];
+    float extentY[CullingBatchSize];
+    float extentZ[CullingBatchSize];
+    uint32_t inside[CullingBatchSize];
+
+    for (std::size_t first = 0; first < drawCmds.size(); first += CullingBatchSize)
+    {
+        auto count = std::min(CullingBatchSize, drawCmds.size() - first);
+
+        // Transform the local boxes to world space boxes which contain them.
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& model = drawCmds[first + i].modelMat;
+            const auto& aabb = drawCmds[first + i].grid->localAABB;
+            auto center = glm::vec3(model * glm::vec4(aabb.center(), 1.0F));
+            auto halfSize = (aabb.max() - aabb.min()) * 0.5F;
+            auto extent = glm::abs(glm::vec3(model[0])) * halfSize.x + glm::abs(glm::vec3(model[1])) * halfSize.y +
+                          glm::abs(glm::vec3(model[2])) * halfSize.z;
+
+            centerX[i] = center.x;
+            centerY[i] = center.y;
+            centerZ[i] = center.z;
+            extentX[i] = extent.x;
+            extentY[i] = extent.y;
+            extentZ[i] = extent.z;
+            inside[i] = 1;
+        }
+
+        // A box is outside of the frustum if it's entirely behind one of its planes.
+        for (const auto& plane : planes)
+        {
+            auto absPlane = glm::abs(glm::vec3(plane));
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float distance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+                float radius = absPlane.x * extentX[i] + absPlane.y * extentY[i] + absPlane.z * extentZ[i];
+                inside[i] &= static_cast<uint32_t>(distance + radius >= 0.0F);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (inside[i] != 0)
+            {
+                visible.push_back(first + i);
+            }
+        }
+    }
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <random>
+#include <unordered_map>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/compatibility.hpp>
@@ -9,39 +13,97 @@
 #include <cubos/core/gl/util.hpp>
 #include <cubos/core/log.hpp>
 
+#include <cubos/engine/renderer/culling.hpp>
 #include <cubos/engine/renderer/deferred_renderer.hpp>
 #include <cubos/engine/renderer/frame.hpp>
+#include <cubos/engine/renderer/mesh_allocator.hpp>
 #include <cubos/engine/renderer/vertex.hpp>
 
 using namespace cubos::core::gl;
 using cubos::engine::DeferredRenderer;
+using cubos::engine::MeshAllocator;
 
-/// Deferred renderer grid implementation.
-struct DeferredGrid : public cubos::engine::impl::RendererGrid
+struct DeferredGrid;
+
+/// Number of vertices of each shared vertex buffer. Grids with more vertices get buffers sized
+/// for them alone.
+static constexpr std::size_t MeshPageVertices = std::size_t{1} << 18;
+
+/// Number of indices of each shared index buffer, which is enough to draw the vertices as quads.
+static constexpr std::size_t MeshPageIndices = MeshPageVertices / 4 * 6;
+
+/// Shared vertex and index buffers, which the meshes of many grids are sub-allocated from.
+class cubos::engine::impl::DeferredMeshPage
 {
+public:
+    DeferredMeshPage(std::size_t vertexCapacity, std::size_t indexCapacity)
+        : vertices(vertexCapacity)
+        , indices(indexCapacity)
+    {
+    }
+
     VertexArray va;
+    VertexBuffer vb;
     IndexBuffer ib;
-    std::size_t indexCount;
+    MeshAllocator vertices;           ///< Allocations of the vertex buffer, in vertices.
+    MeshAllocator indices;            ///< Allocations of the index buffer, in indices.
+    bool packed;                      ///< Whether the vertices use the packed layout.
+    bool shortIndices;                ///< Whether the indices are 16 bit.
+    std::vector<DeferredGrid*> grids; ///< Grids whose meshes were allocated from the page.
+
+    /// Gets the size of each vertex, in bytes.
+    std::size_t vertexSize() const
+    {
+        return packed ? sizeof(cubos::engine::PackedVoxelVertex) : sizeof(cubos::engine::VoxelVertex);
+    }
+
+    /// Gets the size of each index, in bytes.
+    std::size_t indexSize() const
+    {
+        return shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+    }
 };
 
-/// Holds the model view matrix sent to the GPU.
-struct MVP
+using cubos::engine::impl::DeferredMeshPage;
+
+/// Deferred renderer grid implementation.
+struct DeferredGrid : public cubos::engine::impl::RendererGrid
 {
-    glm::mat4 m;
-    glm::mat4 v;
-    glm::mat4 p;
+    ~DeferredGrid() override
+    {
+        // Give the memory of the mesh back to the page it was allocated from.
+        if (page != nullptr)
+        {
+            page->vertices.free(baseVertex);
+            page->indices.free(firstIndex);
+            auto it = std::find(page->grids.begin(), page->grids.end(), this);
+            *it = page->grids.back();
+            page->grids.pop_back();
+        }
+    }
+
+    std::shared_ptr<DeferredMeshPage> page; ///< Page of the mesh, or null if the mesh is empty.
+    std::size_t baseVertex{0};              ///< Offset of the vertices of the mesh on the page.
+    std::size_t firstIndex{0};              ///< Offset of the indices of the mesh on the page.
+    std::size_t indexCount{0};              ///< Number of indices of the mesh.
 };
 
-// Holds the data of a spot light, ready to be sent to the lighting pass pipeline.
-struct SpotLightData
+/// Maximum number of instances drawn from a single range of the instances buffer. Must match the
+/// size of the array in the geometry pass vertex shaders.
+static constexpr std::size_t MaxInstancesPerBatch = 256;
+
+/// Size in bytes of each range of the instances buffer. Ranges are placed apart by this size rounded
+/// up to the constant buffer offset alignment of the render device.
+static constexpr std::size_t InstancesBatchSize = MaxInstancesPerBatch * sizeof(glm::mat4);
+
+/// Number of batches which fit in the instances ring buffer when it's first created.
+static constexpr std::size_t InitialInstancesBatches = 4;
+
+/// Holds the view and projection matrices sent to the GPU.
+struct VP
 {
-    glm::vec4 position;
-    glm::mat4 rotation;
-    glm::vec4 color;
-    float intensity;
-    float range;
-    float spotCutoff;
-    float innerSpotCutoff;
+    glm::mat4 v;
+    glm::mat4 p;
 };
 
 // Holds the data of a directional light, ready to be sent to the lighting pass pipeline.
@@ -53,28 +115,32 @@ struct DirectionalLightData
     float padding[3]; // Necessary to align the struct to a 16 byte boundary.
 };
 
-// Holds the data of a point light, ready to be sent to the lighting pass pipeline.
-struct PointLightData
-{
-    glm::vec4 position;
-    glm::vec4 color;
-    float intensity;
-    float range;
-    float padding[2]; // Necessary to align the struct to a 16 byte boundary.
-};
-
-/// Holds all of the light data sent to the lighting pass pipeline.
+/// Holds the light data sent to the lighting pass pipeline which affects every pixel. Point and
+/// spot lights are sent on textures instead, along with the clusters they were assigned to.
 struct LightsData
 {
     glm::vec4 ambientLight;
-    SpotLightData spotLights[CUBOS_DEFERRED_RENDERER_MAX_SPOT_LIGHT_COUNT];
     DirectionalLightData directionalLights[CUBOS_DEFERRED_RENDERER_MAX_DIRECTIONAL_LIGHT_COUNT];
-    PointLightData pointLights[CUBOS_DEFERRED_RENDERER_MAX_POINT_LIGHT_COUNT];
-    uint32_t numSpotLights;
     uint32_t numDirectionalLights;
-    uint32_t numPointLights;
 };
 
+/// Maximum number of point and spot lights drawn, as the number of lights of a cluster is stored
+/// in 16 bits.
+static constexpr std::size_t MaxClusteredLights = 65535;
+
+/// Number of consecutive texels of the light data texture used by each light, and number of lights
+/// on each row of it. Must match the lighting pass pixel shader.
+static constexpr std::size_t LightDataTexels = 4;
+static constexpr std::size_t LightsPerRow = 256;
+
+/// Width of the texture with the lists of lights of each cluster. Must match the lighting pass
+/// pixel shader.
+static constexpr std::size_t LightIndicesWidth = 1024;
+
+/// Types of the lights on the light data texture. Must match the lighting pass pixel shader.
+static constexpr float PointLightType = 0.0F;
+static constexpr float SpotLightType = 1.0F;
+
 /// The vertex shader of the geometry pass pipeline.
 static const char* geometryPassVs = R"glsl(
 #version 330 core
@@ -87,15 +153,22 @@ out vec3 fragPosition;
 out vec3 fragNormal;
 flat out uint fragMaterial;
 
-uniform MVP
+layout(std140) uniform VP
 {
-    mat4 M;
     mat4 V;
     mat4 P;
 };
 
+layout(std140) uniform Instances
+{
+    mat4 models[256];
+};
+
+uniform int baseInstance;
+
 void main()
 {
+    mat4 M = models[baseInstance + gl_InstanceID];
     vec4 worldPosition = M * vec4(position, 1.0);
     vec4 viewPosition = V * worldPosition;
     fragPosition = vec3(worldPosition);
@@ -109,6 +182,50 @@ void main()
 }
 )glsl";
 
+/// The vertex shader of the geometry pass pipeline, for grids with packed vertices.
+static const char* packedGeometryPassVs = R"glsl(
+#version 330 core
+
+in uint position;
+in uint data;
+
+out vec3 fragPosition;
+out vec3 fragNormal;
+flat out uint fragMaterial;
+
+layout(std140) uniform VP
+{
+    mat4 V;
+    mat4 P;
+};
+
+layout(std140) uniform Instances
+{
+    mat4 models[256];
+};
+
+uniform int baseInstance;
+
+void main()
+{
+    mat4 M = models[baseInstance + gl_InstanceID];
+    vec3 unpackedPosition = vec3(position & 1023u, (position >> 10) & 1023u, (position >> 20) & 1023u);
+    vec4 worldPosition = M * vec4(unpackedPosition, 1.0);
+    vec4 viewPosition = V * worldPosition;
+    fragPosition = vec3(worldPosition);
+
+    uint face = (data >> 16) & 7u;
+    vec3 normal = vec3(0.0);
+    normal[face >> 1] = (face & 1u) == 0u ? 1.0 : -1.0;
+    mat3 N = transpose(inverse(mat3(M)));
+    fragNormal = N * normal;
+
+    gl_Position = P * viewPosition;
+
+    fragMaterial = data & 65535u;
+}
+)glsl";
+
 /// The pixel shader of the geometry pass pipeline.
 static const char* geometryPassPs = R"glsl(
 #version 330 core
@@ -168,16 +285,23 @@ uniform vec2 uvOffset;
 uniform mat4 invV;
 uniform mat4 invP;
 
-struct SpotLight
-{
-    vec4 position;
-    mat4 rotation;
-    vec4 color;
-    float intensity;
-    float range;
-    float spotCutoff;
-    float innerSpotCutoff;
-};
+uniform mat4 V;
+
+// Clusters of the view frustum, with the offset of their lists of lights in the light indices
+// texture and the number of lights on them. The number of clusters on each axis and the layout of
+// the textures must match the ones used by the renderer.
+uniform usampler2D clusters;
+uniform usampler2D lightIndices;
+uniform sampler2D lightData;
+uniform float clusterScale;
+uniform float clusterBias;
+
+const int ClusterTilesX = 16;
+const int ClusterTilesY = 9;
+const int ClusterSlices = 24;
+const int LightsPerRow = 256;
+const uint LightIndicesWidth = 1024u;
+const float SpotLightType = 1.0;
 
 struct DirectionalLight
 {
@@ -186,23 +310,11 @@ struct DirectionalLight
     float intensity;
 };
 
-struct PointLight
-{
-    vec4 position;
-    vec4 color;
-    float intensity;
-    float range;
-};
-
 layout(std140) uniform Lights
 {
     vec4 ambientLight;
-    SpotLight spotLights[128];
     DirectionalLight directionalLights[128];
-    PointLight pointLights[128];
-    uint numSpotLights;
     uint numDirectionalLights;
-    uint numPointLights;
 };
 
 layout(location = 0) out vec4 color;
@@ -211,36 +323,37 @@ float remap(float value, float min1, float max1, float min2, float max2) {
     return max2 + (value - min1) * (max2 - min2) / (max1 - min1);
 }
 
-vec3 spotLightCalc(vec3 fragPos, vec3 fragNormal, SpotLight light) {
-    vec3 toLight = vec3(light.position) - fragPos;
-    float r = length(toLight) / light.range;
-    if (r < 1) {
-        vec3 toLightNormalized = normalize(toLight);
-        float a = dot(toLightNormalized, -vec3(light.rotation * vec4(0,0,1,1)));
-        if (a > light.spotCutoff) {
-            float angleValue = clamp(remap(a, light.innerSpotCutoff, light.spotCutoff, 1, 0), 0, 1);
-            float attenuation = clamp(1.0 / (1.0 + 25.0 * r * r) * clamp((1 - r) * 5.0, 0, 1), 0 , 1);
-            float diffuse = max(dot(fragNormal, toLightNormalized), 0);
-            return angleValue * attenuation * diffuse * light.intensity * vec3(light.color);
-        }
-    }
-    return vec3(0);
-}
-
 vec3 directionalLightCalc(vec3 fragNormal, DirectionalLight light)
 {
     return max(dot(fragNormal, -vec3(light.rotation * vec4(0,0,1,1))), 0) * light.intensity * vec3(light.color);
 }
 
-vec3 pointLightCalc(vec3 fragPos, vec3 fragNormal, PointLight light) {
-    vec3 toLight = vec3(light.position) - fragPos;
-    float r = length(toLight) / light.range;
-    if (r < 1) {
-        float attenuation = clamp(1.0 / (1.0 + 25.0 * r * r) * clamp((1 - r) * 5.0, 0, 1), 0, 1);
-        float diffuse = max(dot(fragNormal, vec3(normalize(toLight))), 0);
-        return attenuation * diffuse * light.intensity * vec3(light.color);
+// Calculates the lighting of a point or spot light, whose data is on four texels of the light data texture.
+vec3 clusteredLightCalc(vec3 fragPos, vec3 fragNormal, int light) {
+    ivec2 base = ivec2((light % LightsPerRow) * 4, light / LightsPerRow);
+    vec4 positionRange = texelFetch(lightData, base, 0);
+    vec3 toLight = positionRange.xyz - fragPos;
+    float r = length(toLight) / positionRange.w;
+    if (r >= 1) {
+        return vec3(0);
     }
-    return vec3(0);
+
+    vec4 colorIntensity = texelFetch(lightData, base + ivec2(1, 0), 0);
+    vec3 toLightNormalized = normalize(toLight);
+    float angleValue = 1.0;
+    vec4 innerCutoffType = texelFetch(lightData, base + ivec2(3, 0), 0);
+    if (innerCutoffType.y == SpotLightType) {
+        vec4 directionCutoff = texelFetch(lightData, base + ivec2(2, 0), 0);
+        float a = dot(toLightNormalized, -directionCutoff.xyz);
+        if (a <= directionCutoff.w) {
+            return vec3(0);
+        }
+        angleValue = clamp(remap(a, innerCutoffType.x, directionCutoff.w, 1, 0), 0, 1);
+    }
+
+    float attenuation = clamp(1.0 / (1.0 + 25.0 * r * r) * clamp((1 - r) * 5.0, 0, 1), 0, 1);
+    float diffuse = max(dot(fragNormal, toLightNormalized), 0);
+    return angleValue * attenuation * diffuse * colorIntensity.w * colorIntensity.rgb;
 }
 
 vec4 fetchAlbedo(uint material)
@@ -270,14 +383,22 @@ void main()
         vec3 lighting = ambientLight.rgb;
         vec3 fragPos = texture(position, fragUv).xyz;
         vec3 fragNormal = texture(normal, fragUv).xyz;
-        for (uint i = 0u; i < numSpotLights; i++) {
-            lighting += spotLightCalc(fragPos, fragNormal, spotLights[i]);
-        }
         for (uint i = 0u; i < numDirectionalLights; i++) {
             lighting += directionalLightCalc(fragNormal, directionalLights[i]);
         }
-        for (uint i = 0u; i < numPointLights; i++) {
-            lighting += pointLightCalc(fragPos, fragNormal, pointLights[i]);
+
+        // Only the point and spot lights of the fragment's cluster can reach it.
+        vec2 screenUv = (fragUv - uvOffset) / uvScale;
+        ivec2 tile = clamp(ivec2(screenUv * vec2(ClusterTilesX, ClusterTilesY)), ivec2(0),
+                           ivec2(ClusterTilesX - 1, ClusterTilesY - 1));
+        float depth = max(-(V * vec4(fragPos, 1.0)).z, 1e-6);
+        int slice = clamp(int(floor(log(depth) * clusterScale + clusterBias)), 0, ClusterSlices - 1);
+        uvec4 cluster = texelFetch(clusters, ivec2(tile.x + tile.y * ClusterTilesX, slice), 0);
+        uint offset = cluster.r | (cluster.g << 16u);
+        for (uint i = 0u; i < cluster.b; i++) {
+            uint index = offset + i;
+            uint light = texelFetch(lightIndices, ivec2(index % LightIndicesWidth, index / LightIndicesWidth), 0).r;
+            lighting += clusteredLightCalc(fragPos, fragNormal, int(light));
         }
         color = vec4(albedo * lighting, 1.0);
         color.r = min(color.r, 1.0);
@@ -417,10 +538,26 @@ DeferredRenderer::DeferredRenderer(RenderDevice& renderDevice, glm::uvec2 size,
     auto geometryVS = mRenderDevice.createShaderStage(Stage::Vertex, geometryPassVs);
     auto geometryPS = mRenderDevice.createShaderStage(Stage::Pixel, geometryPassPs);
     mGeometryPipeline = mRenderDevice.createShaderPipeline(geometryVS, geometryPS);
-    mVpBp = mGeometryPipeline->getBindingPoint("MVP");
-
-    // Create the MVP constant buffer.
-    mVpBuffer = renderDevice.createConstantBuffer(sizeof(MVP), nullptr, Usage::Dynamic);
+    mVpBp = mGeometryPipeline->getBindingPoint("VP");
+    mInstancesBp = mGeometryPipeline->getBindingPoint("Instances");
+    mBaseInstanceBp = mGeometryPipeline->getBindingPoint("baseInstance");
+
+    // Create the geometry pipeline used for grids with packed vertices.
+    auto packedGeometryVS = mRenderDevice.createShaderStage(Stage::Vertex, packedGeometryPassVs);
+    mPackedGeometryPipeline = mRenderDevice.createShaderPipeline(packedGeometryVS, geometryPS);
+    mPackedVpBp = mPackedGeometryPipeline->getBindingPoint("VP");
+    mPackedInstancesBp = mPackedGeometryPipeline->getBindingPoint("Instances");
+    mPackedBaseInstanceBp = mPackedGeometryPipeline->getBindingPoint("baseInstance");
+    mPackedVertices = settings.getBool("cubos.renderer.vertices.packed", false);
+
+    // Create the VP and instances constant buffers.
+    mVpBuffer = renderDevice.createConstantBuffer(sizeof(VP), nullptr, Usage::Dynamic);
+    auto alignment =
+        static_cast<std::size_t>(std::max(renderDevice.getProperty(Property::ConstantBufferOffsetAlignment), 1));
+    mInstancesBatchStride = (InstancesBatchSize + alignment - 1) / alignment * alignment;
+    mInstancesBuffer =
+        renderDevice.createConstantBuffer(InitialInstancesBatches * mInstancesBatchStride, nullptr, Usage::Dynamic);
+    mInstancesBatches = InitialInstancesBatches;
 
     // Create the lighting pipeline.
     auto lightingVS = mRenderDevice.createShaderStage(Stage::Vertex, lightingPassVs);
@@ -439,6 +576,12 @@ DeferredRenderer::DeferredRenderer(RenderDevice& renderDevice, glm::uvec2 size,
     mSkyGradientTopBp = mLightingPipeline->getBindingPoint("skyGradient[1]");
     mInvVBp = mLightingPipeline->getBindingPoint("invV");
     mInvPBp = mLightingPipeline->getBindingPoint("invP");
+    mVBp = mLightingPipeline->getBindingPoint("V");
+    mClusterScaleBp = mLightingPipeline->getBindingPoint("clusterScale");
+    mClusterBiasBp = mLightingPipeline->getBindingPoint("clusterBias");
+    mClustersBp = mLightingPipeline->getBindingPoint("clusters");
+    mLightIndicesBp = mLightingPipeline->getBindingPoint("lightIndices");
+    mLightDataBp = mLightingPipeline->getBindingPoint("lightData");
 
     // Create the SSAO pipeline.
     auto ssaoVS = mRenderDevice.createShaderStage(Stage::Vertex, ssaoPassVs);
@@ -479,6 +622,24 @@ DeferredRenderer::DeferredRenderer(RenderDevice& renderDevice, glm::uvec2 size,
     // Create the lights constant buffer.
     mLightsBuffer = mRenderDevice.createConstantBuffer(sizeof(LightsData), nullptr, Usage::Dynamic);
 
+    // Create the clusters texture, with the offset of the list of lights of each cluster split into
+    // its two lower channels, and the number of lights in the third one.
+    texDesc.width = LightClusters::TilesX * LightClusters::TilesY;
+    texDesc.height = LightClusters::Slices;
+    texDesc.format = TextureFormat::RGBA16UInt;
+    texDesc.usage = Usage::Dynamic;
+    mClustersTex = mRenderDevice.createTexture2D(texDesc);
+    mClustersData.resize(static_cast<std::size_t>(LightClusters::Count) * 4);
+
+    // The light data and light indices textures grow with the number of lights.
+    texDesc.width = LightDataTexels * LightsPerRow;
+    texDesc.height = 1;
+    texDesc.format = TextureFormat::RGBA32Float;
+    mLightDataTex = mRenderDevice.createTexture2D(texDesc);
+    texDesc.width = LightIndicesWidth;
+    texDesc.format = TextureFormat::R16UInt;
+    mLightIndicesTex = mRenderDevice.createTexture2D(texDesc);
+
     // Generate a screen quad for the lighting pass.
     generateScreenQuad(mRenderDevice, mLightingPipeline, mScreenQuadVa);
 
@@ -504,47 +665,349 @@ DeferredRenderer::~DeferredRenderer()
     core::gl::Debug::terminate();
 }
 
-cubos::engine::RendererGrid DeferredRenderer::upload(const VoxelGrid& grid)
+cubos::engine::RendererGrid DeferredRenderer::onUpload(const std::vector<VoxelVertex>& vertices,
+                                                       const std::vector<uint32_t>& indices)
 {
     auto deferredGrid = std::make_shared<DeferredGrid>();
+    deferredGrid->indexCount = indices.size();
+    if (indices.empty())
+    {
+        // Empty grids have nothing to draw, and thus take no memory.
+        return deferredGrid;
+    }
 
-    // First, triangulate the grid.
-    // This may be improved in the future by doing it in a separate thread and only blocking on it when the grid needs
-    // to be drawn.
-    std::vector<VoxelVertex> vertices;
-    std::vector<uint32_t> indices;
-    triangulate(grid, vertices, indices);
+    // Use the packed layout if it's enabled and the grid is small enough for it, and 16 bit
+    // indices if every vertex can be addressed by them, as indices are local to each mesh.
+    std::vector<PackedVoxelVertex> packed;
+    bool isPacked = mPackedVertices && pack(vertices, packed);
+    bool shortIndices = vertices.size() <= std::numeric_limits<uint16_t>::max() + std::size_t{1};
+    auto page = this->allocateMesh(isPacked, shortIndices, vertices.size(), indices.size(), deferredGrid->baseVertex,
+                                   deferredGrid->firstIndex);
+
+    // Write the mesh to the ranges allocated for it.
+    const void* vertexData = isPacked ? static_cast<const void*>(packed.data()) : vertices.data();
+    page->vb->update(deferredGrid->baseVertex * page->vertexSize(), vertices.size() * page->vertexSize(), vertexData);
+    if (shortIndices)
+    {
+        std::vector<uint16_t> shortIndexData(indices.begin(), indices.end());
+        page->ib->update(deferredGrid->firstIndex * sizeof(uint16_t), shortIndexData.size() * sizeof(uint16_t),
+                         shortIndexData.data());
+    }
+    else
+    {
+        page->ib->update(deferredGrid->firstIndex * sizeof(uint32_t), indices.size() * sizeof(uint32_t),
+                         indices.data());
+    }
+
+    deferredGrid->page = page;
+    page->grids.push_back(deferredGrid.get());
+    return deferredGrid;
+}
+
+std::shared_ptr<DeferredMeshPage> DeferredRenderer::allocateMesh(bool packed, bool shortIndices,
+                                                                 std::size_t vertexCount, std::size_t indexCount,
+                                                                 std::size_t& baseVertex, std::size_t& firstIndex)
+{
+    // Release pages which were left empty, keeping a single one of the default size around.
+    bool keptEmpty = false;
+    for (auto it = mMeshPages.begin(); it != mMeshPages.end();)
+    {
+        auto& page = **it;
+        if (page.grids.empty() && (keptEmpty || page.vertices.capacity() != MeshPageVertices ||
+                                   page.indices.capacity() != MeshPageIndices))
+        {
+            it = mMeshPages.erase(it);
+            continue;
+        }
+
+        keptEmpty |= page.grids.empty();
+        ++it;
+    }
 
-    // Create the vertex array, vertex buffer and index buffer.
+    // Allocates the mesh from the given page, if it has room for it.
+    auto tryAllocate = [&](DeferredMeshPage& page) {
+        if (page.vertices.largestFree() < vertexCount || page.indices.largestFree() < indexCount)
+        {
+            return false;
+        }
+
+        baseVertex = page.vertices.allocate(vertexCount);
+        firstIndex = page.indices.allocate(indexCount);
+        return true;
+    };
+
+    // First look for a page with free ranges big enough for the mesh, and only then defragment
+    // pages which have enough free space in total, as defragmenting copies every mesh of the page.
+    for (const auto& page : mMeshPages)
+    {
+        if (page->packed == packed && page->shortIndices == shortIndices && tryAllocate(*page))
+        {
+            return page;
+        }
+    }
+
+    for (const auto& page : mMeshPages)
+    {
+        if (page->packed == packed && page->shortIndices == shortIndices &&
+            page->vertices.capacity() - page->vertices.used() >= vertexCount &&
+            page->indices.capacity() - page->indices.used() >= indexCount)
+        {
+            this->defragment(*page);
+            tryAllocate(*page);
+            return page;
+        }
+    }
+
+    // Otherwise, create a new page, big enough for the mesh if it's larger than the default size.
+    auto page = std::make_shared<DeferredMeshPage>(std::max(MeshPageVertices, vertexCount),
+                                                   std::max(MeshPageIndices, indexCount));
+    page->packed = packed;
+    page->shortIndices = shortIndices;
+    page->vb = mRenderDevice.createVertexBuffer(page->vertices.capacity() * page->vertexSize(), nullptr,
+                                                Usage::Dynamic);
+    page->ib = mRenderDevice.createIndexBuffer(page->indices.capacity() * page->indexSize(), nullptr,
+                                               shortIndices ? IndexFormat::UShort : IndexFormat::UInt, Usage::Dynamic);
+    page->va = this->createMeshVertexArray(packed, page->vb);
+    mMeshPages.push_back(page);
+    tryAllocate(*page);
+    return page;
+}
+
+void DeferredRenderer::defragment(DeferredMeshPage& page)
+{
+    // Ranges of a buffer can't be copied to overlapping ranges of the same buffer, so the meshes
+    // are copied to new buffers instead.
+    auto vb = mRenderDevice.createVertexBuffer(page.vertices.capacity() * page.vertexSize(), nullptr, Usage::Dynamic);
+    auto ib = mRenderDevice.createIndexBuffer(page.indices.capacity() * page.indexSize(), nullptr,
+                                              page.shortIndices ? IndexFormat::UShort : IndexFormat::UInt,
+                                              Usage::Dynamic);
+
+    std::unordered_map<std::size_t, std::size_t> vertexMoves;
+    for (const auto& move : page.vertices.defragment())
+    {
+        vb->copy(*page.vb, move.from * page.vertexSize(), move.to * page.vertexSize(), move.size * page.vertexSize());
+        vertexMoves.emplace(move.from, move.to);
+    }
+
+    std::unordered_map<std::size_t, std::size_t> indexMoves;
+    for (const auto& move : page.indices.defragment())
+    {
+        ib->copy(*page.ib, move.from * page.indexSize(), move.to * page.indexSize(), move.size * page.indexSize());
+        indexMoves.emplace(move.from, move.to);
+    }
+
+    // Indices are local to each mesh, so only the offsets of the meshes have to be updated.
+    for (auto* grid : page.grids)
+    {
+        grid->baseVertex = vertexMoves.at(grid->baseVertex);
+        grid->firstIndex = indexMoves.at(grid->firstIndex);
+    }
+
+    page.vb = vb;
+    page.ib = ib;
+    page.va = this->createMeshVertexArray(page.packed, vb);
+}
+
+VertexArray DeferredRenderer::createMeshVertexArray(bool packed, VertexBuffer vb)
+{
     VertexArrayDesc vaDesc;
-    vaDesc.elementCount = 3;
-    vaDesc.elements[0].name = "position";
-    vaDesc.elements[0].type = Type::UInt;
-    vaDesc.elements[0].size = 3;
-    vaDesc.elements[0].buffer.index = 0;
-    vaDesc.elements[0].buffer.offset = offsetof(VoxelVertex, position);
-    vaDesc.elements[0].buffer.stride = sizeof(VoxelVertex);
-    vaDesc.elements[1].name = "normal";
-    vaDesc.elements[1].type = Type::Float;
-    vaDesc.elements[1].size = 3;
-    vaDesc.elements[1].buffer.index = 0;
-    vaDesc.elements[1].buffer.offset = offsetof(VoxelVertex, normal);
-    vaDesc.elements[1].buffer.stride = sizeof(VoxelVertex);
-    vaDesc.elements[2].name = "material";
-    vaDesc.elements[2].type = Type::UShort;
-    vaDesc.elements[2].size = 1;
-    vaDesc.elements[2].buffer.index = 0;
-    vaDesc.elements[2].buffer.offset = offsetof(VoxelVertex, material);
-    vaDesc.elements[2].buffer.stride = sizeof(VoxelVertex);
-    vaDesc.buffers[0] =
-        mRenderDevice.createVertexBuffer(vertices.size() * sizeof(VoxelVertex), vertices.data(), Usage::Static);
-    vaDesc.shaderPipeline = mGeometryPipeline;
-    deferredGrid->va = mRenderDevice.createVertexArray(vaDesc);
-    deferredGrid->ib = mRenderDevice.createIndexBuffer(indices.size() * sizeof(uint32_t), indices.data(),
-                                                       IndexFormat::UInt, Usage::Static);
-    deferredGrid->indexCount = indices.size();
+    if (packed)
+    {
+        vaDesc.elementCount = 2;
+        vaDesc.elements[0].name = "position";
+        vaDesc.elements[0].type = Type::UInt;
+        vaDesc.elements[0].size = 1;
+        vaDesc.elements[0].buffer.index = 0;
+        vaDesc.elements[0].buffer.offset = offsetof(PackedVoxelVertex, position);
+        vaDesc.elements[0].buffer.stride = sizeof(PackedVoxelVertex);
+        vaDesc.elements[1].name = "data";
+        vaDesc.elements[1].type = Type::UInt;
+        vaDesc.elements[1].size = 1;
+        vaDesc.elements[1].buffer.index = 0;
+        vaDesc.elements[1].buffer.offset = offsetof(PackedVoxelVertex, data);
+        vaDesc.elements[1].buffer.stride = sizeof(PackedVoxelVertex);
+        vaDesc.shaderPipeline = mPackedGeometryPipeline;
+    }
+    else
+    {
+        vaDesc.elementCount = 3;
+        vaDesc.elements[0].name = "position";
+        vaDesc.elements[0].type = Type::UInt;
+        vaDesc.elements[0].size = 3;
+        vaDesc.elements[0].buffer.index = 0;
+        vaDesc.elements[0].buffer.offset = offsetof(VoxelVertex, position);
+        vaDesc.elements[0].buffer.stride = sizeof(VoxelVertex);
+        vaDesc.elements[1].name = "normal";
+        vaDesc.elements[1].type = Type::Float;
+        vaDesc.elements[1].size = 3;
+        vaDesc.elements[1].buffer.index = 0;
+        vaDesc.elements[1].buffer.offset = offsetof(VoxelVertex, normal);
+        vaDesc.elements[1].buffer.stride = sizeof(VoxelVertex);
+        vaDesc.elements[2].name = "material";
+        vaDesc.elements[2].type = Type::UShort;
+        vaDesc.elements[2].size = 1;
+        vaDesc.elements[2].buffer.index = 0;
+        vaDesc.elements[2].buffer.offset = offsetof(VoxelVertex, material);
+        vaDesc.elements[2].buffer.stride = sizeof(VoxelVertex);
+        vaDesc.shaderPipeline = mGeometryPipeline;
+    }
+    vaDesc.buffers[0] = std::move(vb);
+    return mRenderDevice.createVertexArray(vaDesc);
+}
 
-    return deferredGrid;
+std::size_t DeferredRenderer::writeInstances(const RendererFrame& frame)
+{
+    auto batches = (mVisibleDrawCmds.size() + MaxInstancesPerBatch - 1) / MaxInstancesPerBatch;
+    if (batches == 0)
+    {
+        return 0;
+    }
+
+    // Grow the ring if a single render doesn't fit in it, leaving room for the next renders of the
+    // frame, such as those of other viewports.
+    if (batches > mInstancesBatches)
+    {
+        mInstancesBatches = batches * 2;
+        mInstancesBuffer =
+            mRenderDevice.createConstantBuffer(mInstancesBatches * mInstancesBatchStride, nullptr, Usage::Dynamic);
+        mInstancesHead = 0;
+    }
+
+    // When the ring wraps around, its previous contents are discarded, so that draws which may still
+    // be reading them aren't affected. Otherwise, the range written was never used since then, and
+    // thus can be mapped without synchronizing.
+    bool discard = false;
+    if (mInstancesHead + batches > mInstancesBatches)
+    {
+        mInstancesHead = 0;
+        discard = true;
+    }
+
+    // Each batch starts at a multiple of the stride, so that it can be bound on its own.
+    auto offset = mInstancesHead * mInstancesBatchStride;
+    auto* data = static_cast<char*>(mInstancesBuffer->mapRange(offset, batches * mInstancesBatchStride, discard));
+    for (std::size_t i = 0; i < mVisibleDrawCmds.size(); ++i)
+    {
+        auto* models = reinterpret_cast<glm::mat4*>(data + (i / MaxInstancesPerBatch) * mInstancesBatchStride);
+        models[i % MaxInstancesPerBatch] = frame.drawCmds()[mVisibleDrawCmds[i]].modelMat;
+    }
+    mInstancesBuffer->unmap();
+
+    mInstancesHead += batches;
+    return offset;
+}
+
+/// Gets the smallest power of two which is greater than or equal to the given value.
+static std::size_t nextPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+void DeferredRenderer::clusterLights(const glm::mat4& view, const Camera& camera, float aspect,
+                                     const RendererFrame& frame)
+{
+    auto count = frame.pointLights().size() + frame.spotLights().size();
+    if (count > MaxClusteredLights)
+    {
+        CUBOS_WARN("Number of point and spot lights to be drawn this frame exceeds the maximum allowed ({}).",
+                   MaxClusteredLights);
+        count = MaxClusteredLights;
+    }
+
+    // Gather the bounding spheres and the data of the lights, with each light taking four texels:
+    // position and range, color and intensity, direction and cutoff, and inner cutoff and type.
+    mLightSpheres.clear();
+    mLightData.clear();
+    for (const auto& [transform, light] : frame.pointLights())
+    {
+        if (mLightSpheres.size() == count)
+        {
+            break;
+        }
+
+        auto position = glm::vec3(transform * glm::vec4(0.0F, 0.0F, 0.0F, 1.0F));
+        mLightSpheres.emplace_back(position, light.range);
+        mLightData.emplace_back(position, light.range);
+        mLightData.emplace_back(light.color, light.intensity);
+        mLightData.emplace_back(0.0F);
+        mLightData.emplace_back(0.0F, PointLightType, 0.0F, 0.0F);
+    }
+    for (const auto& [transform, light] : frame.spotLights())
+    {
+        if (mLightSpheres.size() == count)
+        {
+            break;
+        }
+
+        auto position = glm::vec3(transform * glm::vec4(0.0F, 0.0F, 0.0F, 1.0F));
+        auto direction = glm::vec3(glm::toMat4(glm::quat_cast(transform)) * glm::vec4(0.0F, 0.0F, 1.0F, 1.0F));
+        mLightSpheres.emplace_back(position, light.range);
+        mLightData.emplace_back(position, light.range);
+        mLightData.emplace_back(light.color, light.intensity);
+        mLightData.emplace_back(direction, glm::cos(light.spotAngle));
+        mLightData.emplace_back(0.0F, SpotLightType, 0.0F, 0.0F);
+    }
+
+    mLightClusters.build(view, camera.fovY, aspect, camera.zNear, camera.zFar, mLightSpheres);
+
+    // Upload the light data, growing its texture if the lights don't fit in it.
+    auto lightRows = (count + LightsPerRow - 1) / LightsPerRow;
+    if (lightRows > mLightDataRows)
+    {
+        mLightDataRows = nextPowerOfTwo(lightRows);
+        Texture2DDesc texDesc;
+        texDesc.width = LightDataTexels * LightsPerRow;
+        texDesc.height = mLightDataRows;
+        texDesc.format = TextureFormat::RGBA32Float;
+        texDesc.usage = Usage::Dynamic;
+        mLightDataTex = mRenderDevice.createTexture2D(texDesc);
+    }
+    if (lightRows > 0)
+    {
+        mLightData.resize(lightRows * LightsPerRow * LightDataTexels, glm::vec4(0.0F));
+        mLightDataTex->update(0, 0, LightDataTexels * LightsPerRow, lightRows, mLightData.data());
+    }
+
+    // Upload the offset and number of lights of each cluster.
+    const auto& offsets = mLightClusters.offsets();
+    const auto& counts = mLightClusters.counts();
+    for (std::size_t i = 0; i < LightClusters::Count; ++i)
+    {
+        mClustersData[i * 4 + 0] = static_cast<uint16_t>(offsets[i] & 0xFFFF);
+        mClustersData[i * 4 + 1] = static_cast<uint16_t>(offsets[i] >> 16);
+        mClustersData[i * 4 + 2] = static_cast<uint16_t>(counts[i]);
+        mClustersData[i * 4 + 3] = 0;
+    }
+    mClustersTex->update(0, 0, LightClusters::TilesX * LightClusters::TilesY, LightClusters::Slices,
+                         mClustersData.data());
+
+    // Upload the lists of lights of every cluster, growing their texture if they don't fit in it.
+    const auto& indices = mLightClusters.indices();
+    auto indexRows = (indices.size() + LightIndicesWidth - 1) / LightIndicesWidth;
+    if (indexRows > mLightIndicesRows)
+    {
+        mLightIndicesRows = nextPowerOfTwo(indexRows);
+        Texture2DDesc texDesc;
+        texDesc.width = LightIndicesWidth;
+        texDesc.height = mLightIndicesRows;
+        texDesc.format = TextureFormat::R16UInt;
+        texDesc.usage = Usage::Dynamic;
+        mLightIndicesTex = mRenderDevice.createTexture2D(texDesc);
+    }
+    if (indexRows > 0)
+    {
+        mLightIndicesData.assign(indexRows * LightIndicesWidth, 0);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            mLightIndicesData[i] = static_cast<uint16_t>(indices[i]);
+        }
+        mLightIndicesTex->update(0, 0, LightIndicesWidth, indexRows, mLightIndicesData.data());
+    }
 }
 
 void DeferredRenderer::setPalette(const VoxelPalette& palette)
@@ -610,55 +1073,36 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
                                 const RendererFrame& frame, Framebuffer target)
 {
     // Steps:
-    // 1. Prepare the MVP matrix.
-    // 2. Fill the light buffer with the light data.
+    // 1. Prepare the VP matrices.
+    // 2. Fill the light buffer with the light data, and assign point and spot lights to clusters.
     // 3. Set the renderer state.
     // 4. Geometry pass:
     //   1. Set the geometry pass state.
     //   2. Clear the GBuffer.
-    //   3. For each draw command:
-    //     1. Update the MVP constant buffer with the model matrix.
-    //     2. Draw the geometry.
+    //   3. Update the VP constant buffer.
+    //   4. Sort the draw commands inside the camera's view frustum by page and grid.
+    //   5. Write their model matrices to the instances ring buffer.
+    //   6. For each batch of draw commands:
+    //     1. Bind the range of the instances buffer with their model matrices.
+    //     2. Draw each grid of the batch with a single instanced draw call, from its page's buffers.
     // 5. Lighting pass:
     //   1. Set the lighting pass state.
     //   2. Draw the screen quad.
 
-    // 1. Prepare the MVP matrix.
-    MVP mvp;
-    mvp.v = view;
-    mvp.p = glm::perspective(glm::radians(camera.fovY), float(viewport.size.x) / float(viewport.size.y), camera.zNear,
-                             camera.zFar);
+    // 1. Prepare the VP matrices.
+    VP vp;
+    vp.v = view;
+    vp.p = glm::perspective(glm::radians(camera.fovY), float(viewport.size.x) / float(viewport.size.y), camera.zNear,
+                            camera.zFar);
 
     // 2. Fill the light buffer with the light data.
     // First map the buffer.
     LightsData& lightData = *static_cast<LightsData*>(mLightsBuffer->map());
-    lightData.numSpotLights = 0;
     lightData.numDirectionalLights = 0;
-    lightData.numPointLights = 0;
 
     // Set the ambient light.
     lightData.ambientLight = glm::vec4(frame.ambient(), 1.0F);
 
-    // Spotlights.
-    for (const auto& [transform, light] : frame.spotLights())
-    {
-        if (lightData.numSpotLights >= CUBOS_DEFERRED_RENDERER_MAX_SPOT_LIGHT_COUNT)
-        {
-            CUBOS_WARN("Number of spot lights to be drawn "
-                       "this frame exceeds the maximum allowed ({}).",
-                       CUBOS_DEFERRED_RENDERER_MAX_SPOT_LIGHT_COUNT);
-            break;
-        }
-
-        lightData.spotLights[lightData.numSpotLights].position = transform * glm::vec4(0.0F, 0.0F, 0.0F, 1.0F);
-        lightData.spotLights[lightData.numSpotLights].rotation = glm::toMat4(glm::quat_cast(transform));
-        lightData.spotLights[lightData.numSpotLights].color = glm::vec4(light.color, 1.0F);
-        lightData.spotLights[lightData.numSpotLights].intensity = light.intensity;
-        lightData.spotLights[lightData.numSpotLights].range = light.range;
-        lightData.spotLights[lightData.numSpotLights].spotCutoff = glm::cos(light.spotAngle);
-        lightData.numSpotLights += 1;
-    }
-
     // Directional lights.
     for (const auto& [transform, light] : frame.directionalLights())
     {
@@ -676,26 +1120,12 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
         lightData.numDirectionalLights += 1;
     }
 
-    // Point lights.
-    for (const auto& [transform, light] : frame.pointLights())
-    {
-        if (lightData.numPointLights >= CUBOS_DEFERRED_RENDERER_MAX_POINT_LIGHT_COUNT)
-        {
-            CUBOS_WARN("Number of point lights to be drawn "
-                       "this frame exceeds the maximum allowed ({}).",
-                       CUBOS_DEFERRED_RENDERER_MAX_POINT_LIGHT_COUNT);
-            break;
-        }
-        lightData.pointLights[lightData.numPointLights].position = transform * glm::vec4(0.0F, 0.0F, 0.0F, 1.0F);
-        lightData.pointLights[lightData.numPointLights].color = glm::vec4(light.color, 1.0F);
-        lightData.pointLights[lightData.numPointLights].intensity = light.intensity;
-        lightData.pointLights[lightData.numPointLights].range = light.range;
-        lightData.numPointLights += 1;
-    }
-
     // Unmap the buffer.
     mLightsBuffer->unmap();
 
+    // Point and spot lights.
+    this->clusterLights(vp.v, camera, float(viewport.size.x) / float(viewport.size.y), frame);
+
     // 3. Set the renderer state.
     mRenderDevice.setViewport(viewport.position.x, viewport.position.y, viewport.size.x, viewport.size.y);
 
@@ -705,8 +1135,15 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
     mRenderDevice.setRasterState(mGeometryRasterState);
     mRenderDevice.setBlendState(mGeometryBlendState);
     mRenderDevice.setDepthStencilState(mGeometryDepthStencilState);
-    mRenderDevice.setShaderPipeline(mGeometryPipeline);
-    mVpBp->bind(mVpBuffer);
+
+    // Binds the geometry pipeline for the given vertex layout, along with its constant buffers.
+    bool packedPipeline = false;
+    auto useGeometryPipeline = [&](bool packed) {
+        packedPipeline = packed;
+        mRenderDevice.setShaderPipeline(packed ? mPackedGeometryPipeline : mGeometryPipeline);
+        (packed ? mPackedVpBp : mVpBp)->bind(mVpBuffer);
+    };
+    useGeometryPipeline(false);
 
     // 4.2. Clear the GBuffer.
     mRenderDevice.clearTargetColor(0, 0.0F, 0.0F, 0.0F, 1.0F);
@@ -714,19 +1151,71 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
     mRenderDevice.clearTargetColor(2, 0.0F, 0.0F, 0.0F, 0.0F);
     mRenderDevice.clearDepth(1.0F);
 
-    // 4.3. For each draw command:
-    for (const auto& drawCmd : frame.drawCmds())
+    // 4.3. Update the VP constant buffer.
+    memcpy(mVpBuffer->map(), &vp, sizeof(VP));
+    mVpBuffer->unmap();
+
+    // 4.4. Sort the draw commands inside the camera's view frustum by page and grid, so that the
+    // draws of each grid are next to each other, and those of each page too.
+    const auto& drawCmds = frame.drawCmds();
+    cullDrawCmds(vp.p * vp.v, drawCmds, mVisibleDrawCmds);
+    auto pageOf = [&](std::size_t i) { return static_cast<const DeferredGrid&>(*drawCmds[i].grid).page.get(); };
+    std::sort(mVisibleDrawCmds.begin(), mVisibleDrawCmds.end(), [&](std::size_t a, std::size_t b) {
+        if (pageOf(a) != pageOf(b))
+        {
+            return std::less<>{}(pageOf(a), pageOf(b));
+        }
+        return drawCmds[a].grid < drawCmds[b].grid || (drawCmds[a].grid == drawCmds[b].grid && a < b);
+    });
+
+    // 4.5. Write the model matrices of every visible draw command to the instances ring buffer.
+    auto instancesOffset = this->writeInstances(frame);
+
+    // 4.6. For each batch of draw commands:
+    const DeferredMeshPage* currentPage = nullptr;
+    for (std::size_t first = 0; first < mVisibleDrawCmds.size(); first += MaxInstancesPerBatch)
     {
-        // 4.3.1. Update the MVP constant buffer with the model matrix.
-        mvp.m = drawCmd.modelMat;
-        memcpy(mVpBuffer->map(), &mvp, sizeof(MVP));
-        mVpBuffer->unmap();
+        auto count = std::min(MaxInstancesPerBatch, mVisibleDrawCmds.size() - first);
 
-        // 4.3.2. Draw the geometry.
-        auto grid = std::static_pointer_cast<DeferredGrid>(drawCmd.grid);
-        mRenderDevice.setVertexArray(grid->va);
-        mRenderDevice.setIndexBuffer(grid->ib);
-        mRenderDevice.drawTrianglesIndexed(0, grid->indexCount);
+        // 4.6.1. Bind the range of the instances buffer with their model matrices.
+        auto batchOffset = instancesOffset + (first / MaxInstancesPerBatch) * mInstancesBatchStride;
+        (packedPipeline ? mPackedInstancesBp : mInstancesBp)->bind(mInstancesBuffer, batchOffset, InstancesBatchSize);
+
+        // 4.6.2. Draw each grid of the batch with a single instanced draw call, switching pipelines
+        // if the grid's vertex layout differs from the previous one, and buffers if its page does.
+        for (std::size_t i = 0; i < count;)
+        {
+            const auto& handle = drawCmds[mVisibleDrawCmds[first + i]].grid;
+            auto instances = std::size_t{1};
+            while (i + instances < count && drawCmds[mVisibleDrawCmds[first + i + instances]].grid == handle)
+            {
+                instances += 1;
+            }
+
+            const auto& grid = static_cast<const DeferredGrid&>(*handle);
+            if (grid.page == nullptr)
+            {
+                i += instances;
+                continue;
+            }
+
+            if (grid.page->packed != packedPipeline)
+            {
+                useGeometryPipeline(grid.page->packed);
+                (packedPipeline ? mPackedInstancesBp : mInstancesBp)
+                    ->bind(mInstancesBuffer, batchOffset, InstancesBatchSize);
+            }
+            if (grid.page.get() != currentPage)
+            {
+                currentPage = grid.page.get();
+                mRenderDevice.setVertexArray(currentPage->va);
+                mRenderDevice.setIndexBuffer(currentPage->ib);
+            }
+            (packedPipeline ? mPackedBaseInstanceBp : mBaseInstanceBp)->setConstant(static_cast<int>(i));
+            mRenderDevice.drawTrianglesIndexedInstancedBaseVertex(grid.firstIndex, grid.indexCount, instances,
+                                                                  grid.baseVertex);
+            i += instances;
+        }
     }
 
     // 5. SSAO pass.
@@ -744,8 +1233,8 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
         mSsaoNormalBp->bind(mSampler);
         mSsaoNoiseBp->bind(mSsaoNoiseTex);
         mSsaoNoiseBp->bind(mSsaoNoiseSampler);
-        mSsaoViewBp->setConstant(mvp.v);
-        mSsaoProjectionBp->setConstant(mvp.p);
+        mSsaoViewBp->setConstant(vp.v);
+        mSsaoProjectionBp->setConstant(vp.p);
         mSsaoScreenSizeBp->setConstant(glm::vec2(mSize));
 
         // Samples
@@ -792,15 +1281,24 @@ void DeferredRenderer::onRender(const glm::mat4& view, const Viewport& viewport,
         glm::vec2((float)viewport.position.x / (float)mSize.x, (float)viewport.position.y / (float)mSize.y));
     mSkyGradientBottomBp->setConstant(frame.skyGradient(0));
     mSkyGradientTopBp->setConstant(frame.skyGradient(1));
-    mInvVBp->setConstant(glm::inverse(mvp.v));
-    mInvPBp->setConstant(glm::inverse(mvp.p));
+    mInvVBp->setConstant(glm::inverse(vp.v));
+    mInvPBp->setConstant(glm::inverse(vp.p));
+    mVBp->setConstant(vp.v);
+    mClusterScaleBp->setConstant(mLightClusters.depthScale());
+    mClusterBiasBp->setConstant(mLightClusters.depthBias());
+    mClustersBp->bind(mClustersTex);
+    mClustersBp->bind(mSampler);
+    mLightIndicesBp->bind(mLightIndicesTex);
+    mLightIndicesBp->bind(mSampler);
+    mLightDataBp->bind(mLightDataTex);
+    mLightDataBp->bind(mSampler);
 
     // 6.3. Draw the screen quad.
     mRenderDevice.setVertexArray(mScreenQuadVa);
     mRenderDevice.drawTriangles(0, 6);
 
     /// FIXME: This should not be on production code.
-    core::gl::Debug::flush(mvp.p * mvp.v, 1 / 60.0F);
+    core::gl::Debug::flush(vp.p * vp.v, 1 / 60.0F);
 
     // Provide custom inputs to the PPS manager.
     this->pps().provideInput(PostProcessingInput::Position, mPositionTex);
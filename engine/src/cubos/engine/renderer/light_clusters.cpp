@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+
+#include <cubos/engine/renderer/light_clusters.hpp>
+
+using cubos::engine::LightClusters;
+
+/// @brief Number of lights tested at once.
+static constexpr std::size_t ClusteringBatchSize = 64;
+
+/// @brief Maps a view depth to the slice which contains it.
+static uint32_t depthSlice(float depth, float scale, float bias)
+{
+    auto slice = std::floor(std::log(depth) * scale + bias);
+    return static_cast<uint32_t>(std::clamp(slice, 0.0F, static_cast<float>(LightClusters::Slices - 1)));
+}
+
+void LightClusters::build(const glm::mat4& view, float fovY, float aspect, float zNear, float zFar,
+                          const std::vector<glm::vec4>& spheres)
+{
+    mDepthScale = static_cast<float>(Slices) / std::log(zFar / zNear);
+    mDepthBias = -std::log(zNear) * mDepthScale;
+
+    // The planes between tiles all go through the camera, and are described by their normals in
+    // view space. A point is on the right of the i-th vertical plane if its x coordinate in NDC is
+    // greater than -1 + 2i / TilesX, which happens when sx * x + ndc * z > 0, as z is negative.
+    auto sy = 1.0F / std::tan(glm::radians(fovY) * 0.5F);
+    auto sx = sy / aspect;
+    float planeX[TilesX + 1][2];
+    float planeY[TilesY + 1][2];
+    for (uint32_t i = 0; i <= TilesX; ++i)
+    {
+        auto ndc = -1.0F + 2.0F * static_cast<float>(i) / static_cast<float>(TilesX);
+        auto length = std::sqrt(sx * sx + ndc * ndc);
+        planeX[i][0] = sx / length;
+        planeX[i][1] = ndc / length;
+    }
+    for (uint32_t i = 0; i <= TilesY; ++i)
+    {
+        auto ndc = -1.0F + 2.0F * static_cast<float>(i) / static_cast<float>(TilesY);
+        auto length = std::sqrt(sy * sy + ndc * ndc);
+        planeY[i][0] = sy / length;
+        planeY[i][1] = ndc / length;
+    }
+
+    float centerX[ClusteringBatchSize];
+    float centerY[ClusteringBatchSize];
+    float centerZ[ClusteringBatchSize];
+    float radius[ClusteringBatchSize];
+    uint32_t minX[ClusteringBatchSize];
+    uint32_t maxX[ClusteringBatchSize];
+    uint32_t minY[ClusteringBatchSize];
+    uint32_t maxY[ClusteringBatchSize];
+    uint32_t inside[ClusteringBatchSize];
+
+    // 1. Find the box of clusters of each light.
+    mBounds.resize(spheres.size());
+    for (std::size_t first = 0; first < spheres.size(); first += ClusteringBatchSize)
+    {
+        auto count = std::min(ClusteringBatchSize, spheres.size() - first);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto center = view * glm::vec4(glm::vec3(spheres[first + i]), 1.0F);
+            centerX[i] = center.x;
+            centerY[i] = center.y;
+            centerZ[i] = center.z;
+            radius[i] = spheres[first + i].w;
+            minX[i] = maxX[i] = minY[i] = maxY[i] = 0;
+            inside[i] = 1;
+        }
+
+        // A sphere starts on the tile after every inner plane it's entirely on the right of, and
+        // ends on the tile after every inner plane it's partially on the right of.
+        for (uint32_t p = 1; p < TilesX; ++p)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float distance = planeX[p][0] * centerX[i] + planeX[p][1] * centerZ[i];
+                minX[i] += static_cast<uint32_t>(distance > radius[i]);
+                maxX[i] += static_cast<uint32_t>(distance > -radius[i]);
+            }
+        }
+        for (uint32_t p = 1; p < TilesY; ++p)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float distance = planeY[p][0] * centerY[i] + planeY[p][1] * centerZ[i];
+                minY[i] += static_cast<uint32_t>(distance > radius[i]);
+                maxY[i] += static_cast<uint32_t>(distance > -radius[i]);
+            }
+        }
+
+        // Spheres entirely outside of the sides of the frustum are discarded.
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            inside[i] &= static_cast<uint32_t>(planeX[0][0] * centerX[i] + planeX[0][1] * centerZ[i] > -radius[i]);
+            inside[i] &= static_cast<uint32_t>(planeX[TilesX][0] * centerX[i] + planeX[TilesX][1] * centerZ[i] <
+                                               radius[i]);
+            inside[i] &= static_cast<uint32_t>(planeY[0][0] * centerY[i] + planeY[0][1] * centerZ[i] > -radius[i]);
+            inside[i] &= static_cast<uint32_t>(planeY[TilesY][0] * centerY[i] + planeY[TilesY][1] * centerZ[i] <
+                                               radius[i]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& bounds = mBounds[first + i];
+            float nearDepth = -centerZ[i] - radius[i];
+            float farDepth = -centerZ[i] + radius[i];
+
+            // The tests against the tile planes only hold for spheres entirely in front of the
+            // camera, so the remaining ones are assigned to every tile.
+            bool behind = centerZ[i] + radius[i] >= 0.0F;
+            if (farDepth < zNear || nearDepth > zFar || (!behind && inside[i] == 0))
+            {
+                bounds.min = glm::uvec3(1);
+                bounds.max = glm::uvec3(0);
+                continue;
+            }
+
+            if (behind)
+            {
+                bounds.min = {0, 0, 0};
+                bounds.max = {TilesX - 1, TilesY - 1, 0};
+            }
+            else
+            {
+                bounds.min = {minX[i], minY[i], 0};
+                bounds.max = {maxX[i], maxY[i], 0};
+            }
+
+            bounds.min.z = depthSlice(std::max(nearDepth, zNear), mDepthScale, mDepthBias);
+            bounds.max.z = depthSlice(std::min(farDepth, zFar), mDepthScale, mDepthBias);
+        }
+    }
+
+    // 2. Count the lights of each cluster, and place the lists of each cluster one after the other.
+    mCounts.assign(Count, 0);
+    for (const auto& bounds : mBounds)
+    {
+        for (uint32_t z = bounds.min.z; z <= bounds.max.z; ++z)
+        {
+            for (uint32_t y = bounds.min.y; y <= bounds.max.y; ++y)
+            {
+                for (uint32_t x = bounds.min.x; x <= bounds.max.x; ++x)
+                {
+                    mCounts[index({x, y, z})] += 1;
+                }
+            }
+        }
+    }
+
+    mOffsets.resize(Count);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        mOffsets[i] = offset;
+        offset += mCounts[i];
+        mCounts[i] = 0;
+    }
+
+    // 3. Fill the lists, which end up sorted by light index.
+    mIndices.resize(offset);
+    for (std::size_t light = 0; light < mBounds.size(); ++light)
+    {
+        const auto& bounds = mBounds[light];
+        for (uint32_t z = bounds.min.z; z <= bounds.max.z; ++z)
+        {
+            for (uint32_t y = bounds.min.y; y <= bounds.max.y; ++y)
+            {
+                for (uint32_t x = bounds.min.x; x <= bounds.max.x; ++x)
+                {
+                    auto cluster = index({x, y, z});
+                    mIndices[mOffsets[cluster] + mCounts[cluster]] = static_cast<uint32_t>(light);
+                    mCounts[cluster] += 1;
+                }
+            }
+        }
+    }
+}
+
+std::size_t LightClusters::index(const glm::uvec3& cluster)
+{
+    return cluster.x + (cluster.y + static_cast<std::size_t>(cluster.z) * TilesY) * TilesX;
+}
+
+const std::vector<uint32_t>& LightClusters::offsets() const
+{
+    return mOffsets;
+}
+
+const std::vector<uint32_t>& LightClusters::counts() const
+{
+    return mCounts;
+}
+
+const std::vector<uint32_t>& LightClusters::indices() const
+{
+    return mIndices;
+}
+
+float LightClusters::depthScale() const
+{
+    return mDepthScale;
+}
+
+float LightClusters::depthBias() const
+{
+    return mDepthBias;
+}
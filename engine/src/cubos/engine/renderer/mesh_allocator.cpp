@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include <cubos/engine/renderer/mesh_allocator.hpp>
+
+using cubos::engine::MeshAllocator;
+
+MeshAllocator::MeshAllocator(std::size_t capacity)
+    : mCapacity(capacity)
+{
+    if (capacity > 0)
+    {
+        mFree.emplace(0, capacity);
+    }
+}
+
+std::size_t MeshAllocator::allocate(std::size_t size)
+{
+    assert(size > 0);
+
+    // Pick the smallest free range which fits the allocation.
+    auto best = mFree.end();
+    for (auto it = mFree.begin(); it != mFree.end(); ++it)
+    {
+        if (it->second >= size && (best == mFree.end() || it->second < best->second))
+        {
+            best = it;
+            if (it->second == size)
+            {
+                break;
+            }
+        }
+    }
+
+    if (best == mFree.end())
+    {
+        return InvalidOffset;
+    }
+
+    // Take the start of the range, and keep the rest free.
+    auto offset = best->first;
+    auto remaining = best->second - size;
+    mFree.erase(best);
+    if (remaining > 0)
+    {
+        mFree.emplace(offset + size, remaining);
+    }
+
+    mAllocated.emplace(offset, size);
+    mUsed += size;
+    return offset;
+}
+
+void MeshAllocator::free(std::size_t offset)
+{
+    auto allocation = mAllocated.find(offset);
+    assert(allocation != mAllocated.end());
+    auto size = allocation->second;
+    mAllocated.erase(allocation);
+    mUsed -= size;
+
+    // Merge the range with the free ranges right after and right before it.
+    auto next = mFree.lower_bound(offset);
+    if (next != mFree.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = mFree.erase(next);
+    }
+
+    if (next != mFree.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+
+    mFree.emplace_hint(next, offset, size);
+}
+
+void MeshAllocator::grow(std::size_t capacity)
+{
+    assert(capacity >= mCapacity);
+    if (capacity == mCapacity)
+    {
+        return;
+    }
+
+    // Extend the last free range if it reaches the end, or add a new one.
+    auto added = capacity - mCapacity;
+    if (!mFree.empty() && mFree.rbegin()->first + mFree.rbegin()->second == mCapacity)
+    {
+        mFree.rbegin()->second += added;
+    }
+    else
+    {
+        mFree.emplace(mCapacity, added);
+    }
+    mCapacity = capacity;
+}
+
+std::vector<MeshAllocator::Move> MeshAllocator::defragment()
+{
+    std::vector<Move> moves;
+    moves.reserve(mAllocated.size());
+
+    std::map<std::size_t, std::size_t> allocated;
+    std::size_t offset = 0;
+    for (const auto& [from, size] : mAllocated)
+    {
+        moves.push_back({from, offset, size});
+        allocated.emplace_hint(allocated.end(), offset, size);
+        offset += size;
+    }
+
+    mAllocated = std::move(allocated);
+    mFree.clear();
+    if (offset < mCapacity)
+    {
+        mFree.emplace(offset, mCapacity - offset);
+    }
+    return moves;
+}
+
+std::size_t MeshAllocator::capacity() const
+{
+    return mCapacity;
+}
+
+std::size_t MeshAllocator::used() const
+{
+    return mUsed;
+}
+
+std::size_t MeshAllocator::largestFree() const
+{
+    std::size_t largest = 0;
+    for (const auto& [offset, size] : mFree)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+bool MeshAllocator::empty() const
+{
+    return mAllocated.empty();
+}
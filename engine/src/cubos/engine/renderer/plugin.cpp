@@ -1,3 +1,5 @@
+#include <unordered_set>
+
 #include <cubos/core/ecs/component/reflection.hpp>
 #include <cubos/core/ecs/system/query.hpp>
 #include <cubos/core/reflection/external/glm.hpp>
@@ -32,10 +34,18 @@ CUBOS_REFLECT_IMPL(RenderableGrid)
         .build();
 }
 
-static void init(Write<Renderer> renderer, Read<Window> window, Write<Settings> settings)
+CUBOS_REFLECT_IMPL(RenderableChunkedGrid)
+{
+    return core::ecs::ComponentTypeBuilder<RenderableChunkedGrid>("cubos::engine::RenderableChunkedGrid")
+        .withField("offset", &RenderableChunkedGrid::offset)
+        .build();
+}
+
+static void init(Write<Renderer> renderer, Read<Window> window, Write<Settings> settings, Read<Assets> assets)
 {
     auto& renderDevice = (*window)->renderDevice();
     *renderer = std::make_shared<DeferredRenderer>(renderDevice, (*window)->framebufferSize(), *settings);
+    (*renderer)->meshCache(assets->sharedCache());
 
     if (settings->getBool("cubos.renderer.bloom.enabled", false))
     {
@@ -55,19 +65,60 @@ static void resize(Write<Renderer> renderer, EventReader<WindowEvent> evs)
 }
 
 static void frameGrids(Read<Assets> assets, Write<Renderer> renderer, Write<RendererFrame> frame,
-                       Query<Write<RenderableGrid>, Read<LocalToWorld>> query)
+                       EventReader<AssetModifiedEvent> modified, Query<Write<RenderableGrid>, Read<LocalToWorld>> query)
 {
+    // Only grids whose assets were modified need to be checked for changes.
+    std::unordered_set<uuids::uuid> modifiedIds;
+    for (const auto& event : modified)
+    {
+        modifiedIds.insert(event.asset.getId());
+    }
+
     for (auto [entity, grid, localToWorld] : query)
     {
-        if (grid->handle == nullptr || assets->update(grid->asset))
+        if ((grid->handle == nullptr && grid->pending == nullptr) ||
+            (modifiedIds.contains(grid->asset.getId()) && assets->update(grid->asset)))
         {
-            // If the grid wasn't already uploaded, we need to upload it now.
+            // If the grid wasn't already uploaded, or was modified, it's triangulated in the background.
+            // Replacing a pending job drops it, so that stale meshes are never uploaded.
             grid->asset = assets->load(grid->asset);
             auto gridRead = assets->read(grid->asset);
-            grid->handle = (*renderer)->upload(gridRead.get());
+            grid->pending = (*renderer)->uploadAsync(gridRead.get());
+        }
+
+        if (grid->pending != nullptr)
+        {
+            // Until the new mesh is ready, the previous one, if any, keeps being drawn.
+            if (auto handle = (*renderer)->poll(grid->pending))
+            {
+                grid->handle = std::move(handle);
+                grid->pending = nullptr;
+            }
         }
 
-        frame->draw(grid->handle, localToWorld->mat * glm::translate(glm::mat4(1.0F), grid->offset));
+        if (grid->handle != nullptr)
+        {
+            frame->draw(grid->handle, localToWorld->mat * glm::translate(glm::mat4(1.0F), grid->offset));
+        }
+    }
+}
+
+static void frameChunkedGrids(Write<Renderer> renderer, Write<RendererFrame> frame,
+                              Query<Write<RenderableChunkedGrid>, Read<LocalToWorld>> query)
+{
+    for (auto [entity, grid, localToWorld] : query)
+    {
+        // Only the chunks which were modified since the last frame are uploaded again.
+        (*renderer)->upload(grid->grid, grid->chunks);
+
+        auto transform = localToWorld->mat * glm::translate(glm::mat4(1.0F), grid->offset);
+        for (const auto& chunk : grid->chunks)
+        {
+            if (chunk != nullptr)
+            {
+                frame->draw(chunk, transform);
+            }
+        }
     }
 }
 
@@ -189,6 +240,7 @@ void cubos::engine::rendererPlugin(Cubos& cubos)
     cubos.addResource<RendererEnvironment>();
 
     cubos.addComponent<RenderableGrid>();
+    cubos.addComponent<RenderableChunkedGrid>();
     cubos.addComponent<Camera>();
     cubos.addComponent<SpotLight>();
     cubos.addComponent<DirectionalLight>();
@@ -200,6 +252,7 @@ void cubos::engine::rendererPlugin(Cubos& cubos)
 
     cubos.startupSystem(init).tagged("cubos.renderer.init");
     cubos.system(frameGrids).tagged("cubos.renderer.frame");
+    cubos.system(frameChunkedGrids).tagged("cubos.renderer.frame");
     cubos.system(frameSpotLights).tagged("cubos.renderer.frame");
     cubos.system(frameDirectionalLights).tagged("cubos.renderer.frame");
     cubos.system(framePointLights).tagged("cubos.renderer.frame");
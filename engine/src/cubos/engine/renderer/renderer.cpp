@@ -1,16 +1,145 @@
+#include <algorithm>
+#include <atomic>
+
 #include <cubos/engine/renderer/renderer.hpp>
 
 using cubos::core::gl::RenderDevice;
 using cubos::engine::BaseRenderer;
+using cubos::engine::ChunkedVoxelGrid;
+using cubos::engine::DerivedCache;
+using cubos::engine::RendererGrid;
+using cubos::engine::RendererMeshJob;
+using cubos::engine::VoxelGrid;
+using cubos::engine::VoxelVertex;
+
+/// @brief Maximum number of threads used to triangulate grids in the background.
+static constexpr std::size_t MaxMeshingThreads = 4;
+
+/// @brief State shared between a mesh job and the worker thread which triangulates it.
+///
+/// Holds no GPU resources, as the worker thread may end up releasing the last reference to it.
+struct MeshingState
+{
+    VoxelGrid grid;                    ///< Snapshot of the grid, released once it's triangulated.
+    std::vector<VoxelVertex> vertices; ///< Vertices of the mesh, valid once ready.
+    std::vector<uint32_t> indices;     ///< Indices of the mesh, valid once ready.
+    std::atomic<bool> ready{false};    ///< Whether the mesh has been triangulated.
+};
+
+/// @brief Mesh job, only ever referenced from the thread which uses the render device.
+class cubos::engine::impl::RendererMeshJob
+{
+public:
+    std::shared_ptr<MeshingState> meshing; ///< State shared with the worker thread, until uploaded.
+    cubos::engine::RendererGrid uploaded;  ///< Handle of the uploaded grid, set by the first successful poll.
+};
+
+/// @brief Triangulates a grid, through the given cache if there's one.
+static void triangulateGrid(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices, std::vector<uint32_t>& indices,
+                            const DerivedCache* cache)
+{
+    if (cache != nullptr)
+    {
+        triangulate(grid, vertices, indices, *cache);
+    }
+    else
+    {
+        triangulate(grid, vertices, indices);
+    }
+}
+
+/// @brief Picks the number of meshing threads, leaving one core for the thread which renders.
+static std::size_t meshingThreadCount()
+{
+    auto cores = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return std::clamp<std::size_t>(cores > 1 ? cores - 1 : 1, 1, MaxMeshingThreads);
+}
 
 BaseRenderer::BaseRenderer(RenderDevice& renderDevice, glm::uvec2 size)
     : mRenderDevice(renderDevice)
     , mPpsManager(renderDevice, size)
     , mSize(size)
+    , mMeshingPool(meshingThreadCount())
 {
     this->resizeTex(size);
 }
 
+RendererGrid BaseRenderer::upload(const VoxelGrid& grid)
+{
+    std::vector<VoxelVertex> vertices;
+    std::vector<uint32_t> indices;
+    triangulateGrid(grid, vertices, indices, mMeshCache.get());
+    return this->uploadMesh(vertices, indices);
+}
+
+RendererMeshJob BaseRenderer::uploadAsync(const VoxelGrid& grid)
+{
+    auto job = std::make_shared<impl::RendererMeshJob>();
+    job->meshing = std::make_shared<MeshingState>();
+    // Copying a grid only shares its data, which is copied only if the original is modified before
+    // the snapshot is released, so the render thread never copies whole grids.
+    job->meshing->grid = grid;
+
+    // The task only keeps a weak reference, so that jobs which were dropped, for example because
+    // their grid was modified again in the meantime, are skipped instead of triangulated. It never
+    // sees the job itself, which holds the uploaded grid, so that it is always released by the render thread.
+    // It shares ownership of the cache, which thus stays alive even if its owner is destroyed first.
+    mMeshingPool.addTask([weak = std::weak_ptr<MeshingState>(job->meshing), cache = mMeshCache]() {
+        auto meshing = weak.lock();
+        if (meshing == nullptr)
+        {
+            return;
+        }
+
+        triangulateGrid(meshing->grid, meshing->vertices, meshing->indices, cache.get());
+        meshing->grid = VoxelGrid{};
+        meshing->ready.store(true, std::memory_order_release);
+    });
+
+    return job;
+}
+
+std::size_t BaseRenderer::upload(ChunkedVoxelGrid& grid, std::vector<RendererGrid>& chunks)
+{
+    const auto& count = grid.chunkCount();
+    chunks.resize(static_cast<std::size_t>(count.x) * count.y * count.z);
+
+    auto dirty = grid.dirtyChunks();
+    std::vector<VoxelVertex> vertices;
+    std::vector<uint32_t> indices;
+    for (const auto& chunk : dirty)
+    {
+        auto& handle = chunks[grid.chunkIndex(chunk)];
+        handle = nullptr;
+        if (!grid.empty(chunk))
+        {
+            vertices.clear();
+            indices.clear();
+            triangulate(grid, chunk, vertices, indices);
+            if (!indices.empty())
+            {
+                handle = this->uploadMesh(vertices, indices);
+            }
+        }
+        grid.clean(chunk);
+    }
+
+    return dirty.size();
+}
+
+RendererGrid BaseRenderer::poll(const RendererMeshJob& job)
+{
+    if (job->uploaded == nullptr && job->meshing->ready.load(std::memory_order_acquire))
+    {
+        job->uploaded = this->uploadMesh(job->meshing->vertices, job->meshing->indices);
+
+        // The mesh data isn't needed anymore, and the job may be kept around for a while.
+        job->meshing = nullptr;
+    }
+
+    return job->uploaded;
+}
+
 void BaseRenderer::resize(glm::uvec2 size)
 {
     mSize = size;
@@ -24,6 +153,11 @@ glm::uvec2 BaseRenderer::size() const
     return mSize;
 }
 
+void BaseRenderer::meshCache(std::shared_ptr<const DerivedCache> cache)
+{
+    mMeshCache = std::move(cache);
+}
+
 void BaseRenderer::render(const glm::mat4& view, const Viewport& viewport, const engine::Camera& camera,
                           const RendererFrame& frame, bool usePostProcessing, const core::gl::Framebuffer& target)
 {
@@ -44,6 +178,27 @@ cubos::engine::PostProcessingManager& BaseRenderer::pps()
     return mPpsManager;
 }
 
+RendererGrid BaseRenderer::uploadMesh(const std::vector<VoxelVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    auto grid = this->onUpload(vertices, indices);
+
+    glm::vec3 min{0.0F};
+    glm::vec3 max{0.0F};
+    if (!vertices.empty())
+    {
+        min = max = glm::vec3(vertices[0].position);
+        for (const auto& vertex : vertices)
+        {
+            min = glm::min(min, glm::vec3(vertex.position));
+            max = glm::max(max, glm::vec3(vertex.position));
+        }
+    }
+    grid->localAABB.min(min);
+    grid->localAABB.max(max);
+
+    return grid;
+}
+
 void BaseRenderer::resizeTex(glm::uvec2 size)
 {
     core::gl::Texture2DDesc textureDesc;
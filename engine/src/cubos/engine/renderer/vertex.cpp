@@ -1,8 +1,20 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <type_traits>
 #include <vector>
 
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+#include <cubos/engine/assets/derived_cache.hpp>
 #include <cubos/engine/renderer/vertex.hpp>
+#include <cubos/engine/voxels/chunked_grid.hpp>
 #include <cubos/engine/voxels/grid.hpp>
 
+using cubos::core::memory::fromLittleEndian;
+using cubos::core::memory::toLittleEndian;
+
 using namespace cubos::engine;
 
 void cubos::core::data::old::serialize(Serializer& serializer, const VoxelVertex& vertex, const char* name)
@@ -23,150 +35,589 @@ void cubos::core::data::old::deserialize(Deserializer& deserializer, VoxelVertex
     deserializer.endObject();
 }
 
-void cubos::engine::triangulate(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices,
-                                std::vector<uint32_t>& indices)
+bool cubos::engine::pack(const std::vector<VoxelVertex>& vertices, std::vector<PackedVoxelVertex>& packed)
+{
+    packed.resize(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const auto& position = vertices[i].position;
+        if (position.x > PackedVoxelVertex::MaxCoordinate || position.y > PackedVoxelVertex::MaxCoordinate ||
+            position.z > PackedVoxelVertex::MaxCoordinate)
+        {
+            packed.clear();
+            return false;
+        }
+
+        // Normals produced by triangulate() are always aligned with one of the axes.
+        const auto& normal = vertices[i].normal;
+        uint32_t face = normal.x != 0.0F ? 0 : (normal.y != 0.0F ? 2 : 4);
+        if (normal.x + normal.y + normal.z < 0.0F)
+        {
+            face += 1;
+        }
+
+        packed[i].position = position.x | (position.y << 10) | (position.z << 20);
+        packed[i].data = static_cast<uint32_t>(vertices[i].material) | (face << 16);
+    }
+
+    return true;
+}
+
+/// @brief Number of bits in each word of an occupancy mask.
+static constexpr std::size_t WordBits = 64;
+
+/// @brief Number of set bits below which a 64x64 block of bits is transposed bit by bit.
+static constexpr std::size_t SparseBlockBits = 256;
+
+namespace
+{
+    /// @brief Box-shaped region of a grid, whose voxels are stored in a flat array.
+    struct Region
+    {
+        const uint16_t* data;  ///< Voxels of the region.
+        glm::uvec3 size;       ///< Size of the region.
+        glm::ivec3 origin;     ///< Position of the region's first voxel on the grid.
+        std::size_t stride[3]; ///< Distance between neighbouring voxels in the array, on each axis.
+    };
+
+    /// @brief Which voxels of a region are solid, seen along one axis.
+    ///
+    /// Stores one bit per voxel, for each row of each layer perpendicular to the axis. Includes
+    /// the layers just outside the region on both sides, so that faces on its boundary can be
+    /// found like any other.
+    struct Occupancy
+    {
+        std::size_t rows;           ///< Rows in each layer.
+        std::size_t words;          ///< Words in each row.
+        std::vector<uint64_t> bits; ///< Bits of every row, layer after layer.
+
+        uint64_t* row(int layer, std::size_t row)
+        {
+            return &bits[(static_cast<std::size_t>(layer + 1) * rows + row) * words];
+        }
+    };
+} // namespace
+
+/// @brief Sets bit @p i of a row.
+static void setBit(uint64_t* row, std::size_t i)
+{
+    row[i / WordBits] |= uint64_t{1} << (i % WordBits);
+}
+
+/// @brief Clears @p count bits of a row, starting at bit @p i.
+static void clearBits(uint64_t* row, std::size_t i, std::size_t count)
+{
+    while (count > 0)
+    {
+        auto bit = i % WordBits;
+        auto n = std::min(count, WordBits - bit);
+        auto mask = n == WordBits ? ~uint64_t{0} : ((uint64_t{1} << n) - 1) << bit;
+        row[i / WordBits] &= ~mask;
+        i += n;
+        count -= n;
+    }
+}
+
+/// @brief Transposes a 64x64 matrix of bits, where bit j of word i is the element on row i and
+/// column j.
+static void transpose64(uint64_t* block)
+{
+    uint64_t mask = 0x00000000FFFFFFFF;
+    for (std::size_t j = 32; j != 0; j >>= 1, mask ^= mask << j)
+    {
+        for (std::size_t k = 0; k < 64; k = ((k | j) + 1) & ~j)
+        {
+            auto t = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k] ^= t << j;
+            block[k | j] ^= t;
+        }
+    }
+}
+
+/// @brief Transposes a matrix of bits, block by block.
+/// @tparam S Type of the function which gets the words of a row of the source matrix.
+/// @tparam D Type of the function which gets the words of a row of the destination matrix.
+/// @param rows Number of rows of the source matrix.
+/// @param columns Number of columns of the source matrix, and thus of rows of the destination.
+/// @param src Function which gets the words of a row of the source matrix.
+/// @param dst Function which gets the words of a row of the destination matrix.
+template <typename S, typename D>
+static void transpose(std::size_t rows, std::size_t columns, const S& src, const D& dst)
+{
+    uint64_t block[WordBits];
+    for (std::size_t rowWord = 0; rowWord * WordBits < rows; ++rowWord)
+    {
+        for (std::size_t columnWord = 0; columnWord * WordBits < columns; ++columnWord)
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < WordBits; ++i)
+            {
+                auto row = rowWord * WordBits + i;
+                block[i] = row < rows ? src(row)[columnWord] : 0;
+                count += static_cast<std::size_t>(std::popcount(block[i]));
+            }
+
+            // Sparse blocks, which are common on small grids, are cheaper to transpose bit by bit.
+            if (count < SparseBlockBits)
+            {
+                uint64_t transposed[WordBits] = {};
+                for (std::size_t i = 0; i < WordBits; ++i)
+                {
+                    for (auto bits = block[i]; bits != 0; bits &= bits - 1)
+                    {
+                        transposed[std::countr_zero(bits)] |= uint64_t{1} << i;
+                    }
+                }
+                std::copy(std::begin(transposed), std::end(transposed), std::begin(block));
+            }
+            else
+            {
+                transpose64(block);
+            }
+
+            for (std::size_t i = 0; i < WordBits && columnWord * WordBits + i < columns; ++i)
+            {
+                dst(columnWord * WordBits + i)[rowWord] = block[i];
+            }
+        }
+    }
+}
+
+/// @brief Counts the consecutive set bits of a row, starting at @p i and stopping at @p end.
+static std::size_t runLength(const uint64_t* row, std::size_t i, std::size_t end)
+{
+    std::size_t length = 0;
+    while (i + length < end)
+    {
+        auto bit = (i + length) % WordBits;
+        auto ones = static_cast<std::size_t>(std::countr_one(row[(i + length) / WordBits] >> bit));
+        length += ones;
+        if (ones < WordBits - bit)
+        {
+            break;
+        }
+    }
+    return std::min(length, end - i);
+}
+
+/// @brief Triangulates a box-shaped region of voxels.
+///
+/// Uses binary greedy meshing: the solid voxels of each axis are first packed into bit rows,
+/// so that the visible faces of a whole row are found with a couple of bitwise operations, and
+/// quads are then grown from runs of set bits. Materials are only read for visible faces.
+///
+/// Faces between voxels inside the region and voxels outside of it are generated only if the
+/// voxel inside is the solid one, so that adjacent regions can be triangulated independently.
+/// Quads are produced in the same order and with the same shapes as a scalar greedy mesher
+/// scanning each slice row by row.
+///
+/// @tparam G Type of the function used to get the material of a voxel outside of the region,
+/// which must return 0 for voxels outside of the grid, or std::nullptr_t if the region is the
+/// whole grid.
+/// @param region Region to triangulate.
+/// @param outside Function used to get the material of a voxel outside of the region.
+/// @param vertices Vertices of the mesh.
+/// @param indices Indices of the mesh.
+template <typename G>
+static void triangulateRegion(const Region& region, const G& outside, std::vector<VoxelVertex>& vertices,
+                              std::vector<uint32_t>& indices)
 {
-    std::vector<uint16_t> mask;
+    const auto& sz = region.size;
+
+    // Pack the solid voxels of every axis in a single pass over the region.
+    Occupancy occupancy[3];
+    for (int d = 0; d < 3; ++d)
+    {
+        int u = (d + 1) % 3;
+        int v = (d + 2) % 3;
+        occupancy[d].rows = sz[v];
+        occupancy[d].words = (sz[u] + WordBits - 1) / WordBits;
+        occupancy[d].bits.assign((sz[d] + 2) * occupancy[d].rows * occupancy[d].words, 0);
+    }
+
+    // Pack the voxels along x, which is how they're stored, and then get the masks of the other
+    // axes by transposing 64x64 blocks of bits. Also check whether all solid voxels share the same
+    // material, as then quads can be grown without reading materials at all.
+    uint16_t materialsOr = 0;
+    uint16_t materialsAnd = 0xFFFF;
+    for (std::size_t z = 0; z < sz.z; ++z)
+    {
+        for (std::size_t y = 0; y < sz.y; ++y)
+        {
+            const auto* voxels = region.data + y * region.stride[1] + z * region.stride[2];
+            auto* row = occupancy[2].row(static_cast<int>(z), y);
+            for (std::size_t x = 0; x < sz.x; ++x)
+            {
+                auto mat = voxels[x * region.stride[0]];
+                materialsOr |= mat;
+                materialsAnd &= mat != 0 ? mat : 0xFFFF;
+                row[x / WordBits] |= static_cast<uint64_t>(mat != 0) << (x % WordBits);
+            }
+        }
+    }
 
-    const auto& sz = grid.size();
+    if (materialsOr == 0)
+    {
+        return;
+    }
+    bool uniform = materialsOr == materialsAnd;
+
+    for (std::size_t z = 0; z < sz.z; ++z)
+    {
+        transpose(
+            sz.y, sz.x, [&](std::size_t y) { return occupancy[2].row(static_cast<int>(z), y); },
+            [&](std::size_t x) { return occupancy[0].row(static_cast<int>(x), z); });
+    }
 
-    // For both back and front faces.
-    bool backFace = true;
-    do
+    for (std::size_t y = 0; y < sz.y; ++y)
     {
-        backFace = !backFace;
+        transpose(
+            sz.z, sz.x, [&](std::size_t z) { return occupancy[2].row(static_cast<int>(z), y); },
+            [&](std::size_t x) { return occupancy[1].row(static_cast<int>(y), x); });
+    }
+
+    // The layers just outside the region may belong to neighbouring regions.
+    if constexpr (!std::is_same_v<G, std::nullptr_t>)
+    {
+        for (int d = 0; d < 3; ++d)
+        {
+            int u = (d + 1) % 3;
+            int v = (d + 2) % 3;
+            for (int layer : {-1, static_cast<int>(sz[d])})
+            {
+                glm::ivec3 p = {0, 0, 0};
+                p[d] = layer;
+                for (p[v] = 0; p[v] < static_cast<int>(sz[v]); ++p[v])
+                {
+                    for (p[u] = 0; p[u] < static_cast<int>(sz[u]); ++p[u])
+                    {
+                        if (outside(region.origin + p) != 0)
+                        {
+                            setBit(occupancy[d].row(layer, static_cast<std::size_t>(p[v])),
+                                   static_cast<std::size_t>(p[u]));
+                        }
+                    }
+                }
+            }
+        }
+    }
 
+    std::vector<uint64_t> faces;
+    for (bool backFace : {false, true})
+    {
         // For each axis.
         for (int d = 0; d < 3; ++d)
         {
             int u = (d + 1) % 3;
             int v = (d + 2) % 3;
 
-            glm::ivec3 x = {0, 0, 0};
+            auto& occ = occupancy[d];
+            faces.resize(occ.rows * occ.words);
+
             glm::ivec3 q = {0, 0, 0};
             q[d] = 1;
-            mask.resize(static_cast<std::size_t>(sz[u]) * static_cast<std::size_t>(sz[v]));
 
-            for (x[d] = -1; x[d] < int(sz[d]);)
+            for (int s = -1; s < static_cast<int>(sz[d]); ++s)
             {
-                std::size_t n = 0;
+                // Front faces of the layer before the region and back faces of the layer after it
+                // belong to other regions.
+                if ((!backFace && s < 0) || (backFace && s == static_cast<int>(sz[d]) - 1))
+                {
+                    continue;
+                }
 
-                // Create mask
-                for (x[v] = 0; x[v] < int(sz[v]); ++x[v])
+                // Faces are visible where a solid voxel is next to an empty one.
+                const auto* before = occ.row(s, 0);
+                const auto* after = occ.row(s + 1, 0);
+                uint64_t any = 0;
+                for (std::size_t k = 0; k < faces.size(); ++k)
                 {
-                    for (x[u] = 0; x[u] < int(sz[u]); ++x[u])
-                    {
-                        if (x[d] < 0)
-                        {
-                            mask[n++] = backFace ? grid.get(x + q) : 0;
-                        }
-                        else if (x[d] == int(sz[d]) - 1)
-                        {
-                            mask[n++] = backFace ? 0 : grid.get(x);
-                        }
-                        else if (grid.get(x) == 0 || grid.get(x + q) == 0)
-                        {
-                            mask[n++] = backFace ? grid.get(x + q) : grid.get(x);
-                        }
-                        else
-                        {
-                            mask[n++] = 0;
-                        }
-                    }
+                    faces[k] = backFace ? after[k] & ~before[k] : before[k] & ~after[k];
+                    any |= faces[k];
+                }
+
+                if (any == 0)
+                {
+                    continue;
                 }
 
-                ++x[d];
-                n = 0;
+                // The material of a face is the one of its solid voxel.
+                auto layer = static_cast<std::size_t>(backFace ? s + 1 : s);
+                const auto* base = region.data + layer * region.stride[d];
+                auto strideU = region.stride[u];
+                auto strideV = region.stride[v];
+                auto material = [&](std::size_t i, std::size_t j) { return base[i * strideU + j * strideV]; };
 
-                // Generate mesh from mask
+                // Generate the mesh by growing quads from the first visible face of each row.
                 for (std::size_t j = 0; j < sz[v]; ++j)
                 {
-                    for (std::size_t i = 0; i < sz[u];)
+                    auto* row = &faces[j * occ.words];
+                    for (std::size_t word = 0; word < occ.words; ++word)
                     {
-                        if (mask[n] != 0)
+                        while (row[word] != 0)
                         {
-                            std::size_t w;
-                            std::size_t h;
-                            for (w = 1; i + w < sz[u] && mask[n + w] == mask[n]; ++w)
-                            {
-                                ;
-                            }
-                            bool done = false;
-                            for (h = 1; j + h < sz[v]; ++h)
+                            auto i = word * WordBits + static_cast<std::size_t>(std::countr_zero(row[word]));
+                            auto mat = material(i, j);
+
+                            // Grow the quad along u over the run of faces with the same material.
+                            auto w = runLength(row, i, sz[u]);
+                            if (!uniform)
                             {
-                                for (std::size_t k = 0; k < w; ++k)
+                                for (std::size_t k = 1; k < w; ++k)
                                 {
-                                    if (mask[n + k + h * sz[u]] == 0 || mask[n + k + h * sz[u]] != mask[n])
+                                    if (material(i + k, j) != mat)
                                     {
-                                        done = true;
+                                        w = k;
                                         break;
                                     }
                                 }
+                            }
 
-                                if (done)
+                            // Then along v, while the next rows have the same faces.
+                            std::size_t h;
+                            for (h = 1; j + h < sz[v]; ++h)
+                            {
+                                if (runLength(&faces[(j + h) * occ.words], i, i + w) != w)
                                 {
                                     break;
                                 }
-                            }
 
-                            if (mask[n] != 0)
-                            {
-                                x[u] = static_cast<int>(i);
-                                x[v] = static_cast<int>(j);
-
-                                glm::ivec3 du = {0, 0, 0};
-                                glm::ivec3 dv = {0, 0, 0};
-                                du[u] = static_cast<int>(w);
-                                dv[v] = static_cast<int>(h);
-
-                                auto vi = vertices.size();
-                                vertices.resize(vi + 4, {{}, backFace ? -q : q, mask[n]});
-                                vertices[vi + 0].position = x;
-                                vertices[vi + 1].position = x + du;
-                                vertices[vi + 2].position = x + du + dv;
-                                vertices[vi + 3].position = x + dv;
-
-                                auto ii = indices.size();
-                                indices.resize(ii + 6);
-                                if (backFace)
+                                std::size_t k = 0;
+                                while (!uniform && k < w && material(i + k, j + h) == mat)
                                 {
-                                    indices[ii + 0] = static_cast<uint32_t>(vi) + 0;
-                                    indices[ii + 1] = static_cast<uint32_t>(vi) + 2;
-                                    indices[ii + 2] = static_cast<uint32_t>(vi) + 1;
-                                    indices[ii + 3] = static_cast<uint32_t>(vi) + 3;
-                                    indices[ii + 4] = static_cast<uint32_t>(vi) + 2;
-                                    indices[ii + 5] = static_cast<uint32_t>(vi) + 0;
+                                    ++k;
                                 }
-                                else
+
+                                if (!uniform && k < w)
                                 {
-                                    indices[ii + 0] = static_cast<uint32_t>(vi) + 0;
-                                    indices[ii + 1] = static_cast<uint32_t>(vi) + 1;
-                                    indices[ii + 2] = static_cast<uint32_t>(vi) + 2;
-                                    indices[ii + 3] = static_cast<uint32_t>(vi) + 2;
-                                    indices[ii + 4] = static_cast<uint32_t>(vi) + 3;
-                                    indices[ii + 5] = static_cast<uint32_t>(vi) + 0;
+                                    break;
                                 }
                             }
 
                             for (std::size_t l = 0; l < h; ++l)
                             {
-                                for (std::size_t k = 0; k < w; ++k)
-                                {
-                                    mask[n + k + l * sz[u]] = 0;
-                                }
+                                clearBits(&faces[(j + l) * occ.words], i, w);
                             }
 
-                            i += w;
-                            n += w;
-                        }
-                        else
-                        {
-                            ++i;
-                            ++n;
+                            glm::ivec3 x = {0, 0, 0};
+                            x[d] = s + 1;
+                            x[u] = static_cast<int>(i);
+                            x[v] = static_cast<int>(j);
+
+                            glm::ivec3 du = {0, 0, 0};
+                            glm::ivec3 dv = {0, 0, 0};
+                            du[u] = static_cast<int>(w);
+                            dv[v] = static_cast<int>(h);
+
+                            auto vi = static_cast<uint32_t>(vertices.size());
+                            VoxelVertex vertex{{}, backFace ? -q : q, mat};
+                            for (const auto& corner : {x, x + du, x + du + dv, x + dv})
+                            {
+                                vertex.position = region.origin + corner;
+                                vertices.push_back(vertex);
+                            }
+
+                            if (backFace)
+                            {
+                                indices.insert(indices.end(), {vi + 0, vi + 2, vi + 1, vi + 3, vi + 2, vi + 0});
+                            }
+                            else
+                            {
+                                indices.insert(indices.end(), {vi + 0, vi + 1, vi + 2, vi + 2, vi + 3, vi + 0});
+                            }
                         }
                     }
                 }
             }
         }
-    } while (!backFace);
+    }
+}
+
+void cubos::engine::triangulate(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices,
+                                std::vector<uint32_t>& indices)
+{
+    const auto& size = grid.size();
+    Region region{grid.data(), size, {0, 0, 0}, {1, size.x, static_cast<std::size_t>(size.x) * size.y}};
+    triangulateRegion(region, nullptr, vertices, indices);
+}
+
+void cubos::engine::triangulate(const ChunkedVoxelGrid& grid, const glm::uvec3& chunk,
+                                std::vector<VoxelVertex>& vertices, std::vector<uint32_t>& indices)
+{
+    // Only solid voxels inside the chunk generate faces, so empty chunks have none.
+    const auto* data = grid.chunkData(chunk);
+    if (data == nullptr)
+    {
+        return;
+    }
+
+    // Chunks on the far edges of the grid may be cut short.
+    constexpr auto ChunkSize = ChunkedVoxelGrid::ChunkSize;
+    auto origin = chunk * ChunkSize;
+    Region region{data,
+                  glm::min(grid.size() - origin, glm::uvec3(ChunkSize)),
+                  glm::ivec3(origin),
+                  {1, ChunkSize, static_cast<std::size_t>(ChunkSize) * ChunkSize}};
+    triangulateRegion(region, [&](const glm::ivec3& position) { return grid.get(position); }, vertices, indices);
+}
+
+/// @brief Format of the mesh cache entries, hashed into their keys, so that entries written in
+/// another format are never read.
+static constexpr uint32_t MeshEntryFormat = 2;
+
+/// @brief Size of each vertex in mesh cache entries: position, normal and material.
+static constexpr std::size_t MeshEntryVertexSize = 3 * sizeof(uint32_t) + 3 * sizeof(float) + sizeof(uint16_t);
+
+/// @brief Size of the header of mesh cache entries: vertex and index counts.
+static constexpr std::size_t MeshEntryHeaderSize = 2 * sizeof(uint64_t);
+
+/// @brief Writes a value to a buffer in little endian byte order, and advances past it.
+template <typename T>
+static void putLittleEndian(char*& out, T value)
+{
+    using Bits = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+    auto bits = toLittleEndian(std::bit_cast<Bits>(value));
+    std::memcpy(out, &bits, sizeof(bits));
+    out += sizeof(bits);
+}
+
+/// @brief Reads a value in little endian byte order from a buffer, and advances past it.
+template <typename T>
+static T getLittleEndian(const char*& in)
+{
+    using Bits = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+    Bits bits;
+    std::memcpy(&bits, in, sizeof(bits));
+    in += sizeof(bits);
+    return std::bit_cast<T>(fromLittleEndian(bits));
+}
+
+/// @brief Writes the part of a mesh added from the given vertex and index onwards to a mesh cache
+/// entry. Vertex fields are written one by one, so that no padding is stored.
+/// @param vertices Vertices of the mesh.
+/// @param firstVertex Index of the first vertex to write.
+/// @param indices Indices of the mesh.
+/// @param firstIndex Index of the first index to write.
+/// @param data Entry data.
+static void writeMeshEntry(const std::vector<VoxelVertex>& vertices, std::size_t firstVertex,
+                           const std::vector<uint32_t>& indices, std::size_t firstIndex, std::vector<char>& data)
+{
+    auto vertexCount = vertices.size() - firstVertex;
+    auto indexCount = indices.size() - firstIndex;
+    data.resize(MeshEntryHeaderSize + vertexCount * MeshEntryVertexSize + indexCount * sizeof(uint32_t));
+
+    char* out = data.data();
+    putLittleEndian(out, static_cast<uint64_t>(vertexCount));
+    putLittleEndian(out, static_cast<uint64_t>(indexCount));
+    for (std::size_t i = firstVertex; i < vertices.size(); ++i)
+    {
+        const auto& vertex = vertices[i];
+        for (int j = 0; j < 3; ++j)
+        {
+            putLittleEndian(out, static_cast<uint32_t>(vertex.position[j]));
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            putLittleEndian(out, static_cast<float>(vertex.normal[j]));
+        }
+        putLittleEndian(out, vertex.material);
+    }
+    for (std::size_t i = firstIndex; i < indices.size(); ++i)
+    {
+        putLittleEndian(out, static_cast<uint32_t>(indices[i] - firstVertex));
+    }
+}
+
+/// @brief Reads a mesh written by @ref writeMeshEntry() and appends it to the given mesh.
+/// @param data Entry data.
+/// @param vertices Vertices of the mesh.
+/// @param indices Indices of the mesh.
+/// @return Whether the entry was valid. On failure, part of the mesh may have been appended.
+static bool readMeshEntry(const std::vector<char>& data, std::vector<VoxelVertex>& vertices,
+                          std::vector<uint32_t>& indices)
+{
+    if (data.size() < MeshEntryHeaderSize)
+    {
+        return false;
+    }
+
+    const char* in = data.data();
+    auto vertexCount = getLittleEndian<uint64_t>(in);
+    auto indexCount = getLittleEndian<uint64_t>(in);
+    auto bodySize = data.size() - MeshEntryHeaderSize;
+    if (vertexCount > bodySize / MeshEntryVertexSize ||
+        indexCount != (bodySize - vertexCount * MeshEntryVertexSize) / sizeof(uint32_t) ||
+        (bodySize - vertexCount * MeshEntryVertexSize) % sizeof(uint32_t) != 0)
+    {
+        return false;
+    }
+
+    auto firstVertex = vertices.size();
+    vertices.reserve(firstVertex + vertexCount);
+    for (uint64_t i = 0; i < vertexCount; ++i)
+    {
+        VoxelVertex vertex{};
+        for (int j = 0; j < 3; ++j)
+        {
+            vertex.position[j] = getLittleEndian<uint32_t>(in);
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            vertex.normal[j] = getLittleEndian<float>(in);
+        }
+        vertex.material = getLittleEndian<uint16_t>(in);
+        vertices.push_back(vertex);
+    }
+
+    // Indices out of the mesh would make draws read past its vertices.
+    indices.reserve(indices.size() + indexCount);
+    for (uint64_t i = 0; i < indexCount; ++i)
+    {
+        auto index = getLittleEndian<uint32_t>(in);
+        if (index >= vertexCount)
+        {
+            return false;
+        }
+        indices.push_back(static_cast<uint32_t>(firstVertex + index));
+    }
+
+    return true;
+}
+
+void cubos::engine::triangulate(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices,
+                                std::vector<uint32_t>& indices, const DerivedCache& cache)
+{
+    if (!cache.enabled())
+    {
+        triangulate(grid, vertices, indices);
+        return;
+    }
+
+    const auto& size = grid.size();
+    auto format = MeshEntryFormat;
+    auto key = DerivedCache::hash(&format, sizeof(format));
+    key = DerivedCache::hash(&size, sizeof(size), key);
+    key = DerivedCache::hash(grid.data(), static_cast<std::size_t>(size.x) * size.y * size.z * sizeof(uint16_t), key);
+
+    // The mesh is appended to the output, and thus its indices are offset by the vertices which
+    // were already there. Cached meshes store indices relative to their own first vertex.
+    auto firstVertex = vertices.size();
+    auto firstIndex = indices.size();
+
+    std::vector<char> data;
+    if (cache.read("mesh", key, TriangulateVersion, data))
+    {
+        if (readMeshEntry(data, vertices, indices))
+        {
+            return;
+        }
+
+        CUBOS_WARN("Ignoring invalid mesh cache entry {:016x}", key);
+        vertices.resize(firstVertex);
+        indices.resize(firstIndex);
+    }
+
+    triangulate(grid, vertices, indices);
+    writeMeshEntry(vertices, firstVertex, indices, firstIndex, data);
+    cache.write("mesh", key, TriangulateVersion, data.data(), data.size());
 }
@@ -1,4 +1,7 @@
-#include <cubos/core/data/fs/file_system.hpp>
+#include <cstring>
+
+#include <cubos/core/data/old/binary_deserializer.hpp>
+#include <cubos/core/data/old/binary_serializer.hpp>
 #include <cubos/core/data/old/json_deserializer.hpp>
 #include <cubos/core/ecs/entity/hash.hpp>
 
@@ -6,39 +9,106 @@
 #include <cubos/engine/scene/bridge.hpp>
 #include <cubos/engine/scene/scene.hpp>
 
-using cubos::core::data::File;
-using cubos::core::data::FileSystem;
+using cubos::core::data::old::BinaryDeserializer;
+using cubos::core::data::old::BinarySerializer;
 using cubos::core::data::old::JSONDeserializer;
 using cubos::core::data::old::SerializationMap;
 using cubos::core::ecs::Entity;
 using cubos::core::ecs::EntityHash;
+using cubos::core::memory::SeekOrigin;
+using cubos::core::memory::Stream;
 
 using namespace cubos::engine;
 
+/// @brief Magic number at the start of compiled scene files.
+static constexpr char CompiledMagic[4] = {'C', 'S', 'C', 'N'};
+
+/// @brief Version of the compiled scene format.
+static constexpr uint32_t CompiledVersion = 3;
+
+static bool loadCompiled(Assets& assets, const AnyAsset& handle, const std::string& path, Stream& stream)
+{
+    auto deserializer = BinaryDeserializer(stream);
+    auto scene = Scene();
+
+    uint32_t version = 0;
+    deserializer.read(version);
+    if (version != CompiledVersion)
+    {
+        CUBOS_ERROR("Compiled scene file '{}' has version {}, expected {}", path, version, CompiledVersion);
+        return false;
+    }
+
+    // The imported scenes were already merged into the blueprint when the scene was compiled, and
+    // thus only their handles are kept.
+    std::unordered_map<std::string, std::string> imports;
+    deserializer.read(imports);
+    if (deserializer.failed())
+    {
+        CUBOS_ERROR("Could not read imports of compiled scene file '{}'", path);
+        return false;
+    }
+
+    for (const auto& [name, id] : imports)
+    {
+        scene.imports[name] = Asset<Scene>(id);
+    }
+
+    if (!scene.blueprint.readCompiled(stream))
+    {
+        CUBOS_ERROR("Could not read blueprint of compiled scene file '{}'", path);
+        return false;
+    }
+
+    assets.store(handle, std::move(scene));
+    return true;
+}
+
+bool SceneBridge::saveCompiled(const Scene& scene, Stream& stream)
+{
+    if (stream.write(CompiledMagic, sizeof(CompiledMagic)) != sizeof(CompiledMagic))
+    {
+        return false;
+    }
+
+    std::unordered_map<std::string, std::string> imports;
+    for (const auto& [name, handle] : scene.imports)
+    {
+        imports[name] = uuids::to_string(handle.getId());
+    }
+
+    auto serializer = BinarySerializer(stream);
+    serializer.write(CompiledVersion, "version");
+    serializer.write(imports, "imports");
+    if (serializer.failed())
+    {
+        return false;
+    }
+
+    return scene.blueprint.writeCompiled(stream);
+}
+
 bool SceneBridge::load(Assets& assets, const AnyAsset& handle)
 {
     // Open the scene file.
     auto path = assets.readMeta(handle)->get("path").value();
-    auto stream = FileSystem::open(path, File::OpenMode::Read);
+    auto stream = assets.openFile(handle);
     if (stream == nullptr)
     {
         CUBOS_ERROR("Could not open scene file '{}'", path);
         return false;
     }
 
-    // Dump the file contents into a string.
-    std::string contents;
-    stream->readUntil(contents, nullptr);
-    stream.reset(); // Close the file.
-
-    // Deserialize the scene file.
-    auto deserializer = JSONDeserializer(contents);
-    if (deserializer.failed())
+    // Compiled scenes are detected by their magic number, and skip the JSON path entirely.
+    char magic[sizeof(CompiledMagic)];
+    if (stream->read(magic, sizeof(magic)) == sizeof(magic) && std::memcmp(magic, CompiledMagic, sizeof(magic)) == 0)
     {
-        CUBOS_ERROR("Could not parse scene file '{}' as JSON", path);
-        return false;
+        return loadCompiled(assets, handle, path, *stream);
     }
+    stream->seek(0, SeekOrigin::Begin);
 
+    // Deserialize the scene file as it is read.
+    auto deserializer = JSONDeserializer(*stream);
     auto scene = Scene();
 
     // Add a SerializationMap for entity handle deserialization.
@@ -53,7 +123,9 @@ bool SceneBridge::load(Assets& assets, const AnyAsset& handle)
 
     deserializer.beginObject();
 
-    // First, read the imports section.
+    // First, read the imports section. Imported scenes which aren't loaded yet are all required
+    // at once, so that the scene waits for all of them before being loaded again.
+    bool importsReady = true;
     std::size_t len = deserializer.beginDictionary();
     for (std::size_t i = 0; i < len; ++i)
     {
@@ -77,14 +149,27 @@ bool SceneBridge::load(Assets& assets, const AnyAsset& handle)
             CUBOS_ERROR("Scenes cannot import themselves");
             return false;
         }
-        auto imported = assets.read(importedHandle);
 
-        // Add the imported scene to the scene.
+        // Add the imported scene to the scene, if it's already loaded.
+        importsReady = assets.require(importedHandle) && importsReady;
         scene.imports[name] = importedHandle;
-        scene.blueprint.merge(name, imported->blueprint);
+        if (importsReady)
+        {
+            auto imported = assets.read(importedHandle);
+            if (!scene.blueprint.merge(name, imported->blueprint))
+            {
+                CUBOS_ERROR("Could not merge imported scene '{}' into scene '{}'", name, path);
+                return false;
+            }
+        }
     }
     deserializer.endDictionary();
 
+    if (!importsReady)
+    {
+        return false;
+    }
+
     // Then, read the entities section. Here, we may find entities that have already been added
     // by the imports section, in which case we'll just update them.
     len = deserializer.beginDictionary();
@@ -128,6 +213,11 @@ bool SceneBridge::load(Assets& assets, const AnyAsset& handle)
     deserializer.endDictionary();
 
     deserializer.endObject();
+    if (deserializer.failed())
+    {
+        CUBOS_ERROR("Could not parse scene file '{}' as JSON", path);
+        return false;
+    }
 
     // Finally, write the scene to the asset.
     assets.store(handle, std::move(scene));
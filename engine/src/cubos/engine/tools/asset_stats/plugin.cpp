@@ -0,0 +1,139 @@
+#include <array>
+#include <cfloat>
+#include <cstdio>
+
+#include <imgui.h>
+
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/standard_stream.hpp>
+
+#include <cubos/engine/assets/plugin.hpp>
+#include <cubos/engine/imgui/plugin.hpp>
+#include <cubos/engine/settings/plugin.hpp>
+#include <cubos/engine/tools/asset_stats/plugin.hpp>
+
+using cubos::core::ecs::Read;
+using cubos::core::ecs::Write;
+
+using namespace cubos::engine;
+
+/// @brief Number of frames the loader queue depth is shown for.
+static constexpr std::size_t HistoryLength = 256;
+
+/// @brief Resource which keeps the loader queue depth of the last frames.
+struct QueueHistory
+{
+    std::array<float, HistoryLength> samples{}; ///< Queue depth on each frame.
+    std::size_t next{0};                        ///< Index of the oldest sample, which is replaced next.
+};
+
+static void dump(const Assets& assets, const std::string& path)
+{
+    auto* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        CUBOS_ERROR("Could not open file '{}' to dump asset statistics", path);
+        return;
+    }
+
+    auto stream = cubos::core::memory::StandardStream(file, true);
+    assets.writeStats(stream);
+    CUBOS_INFO("Dumped asset statistics to '{}'", path);
+}
+
+static void showBridges(const Assets& assets)
+{
+    auto bridges = assets.bridgeStats();
+    if (bridges.empty())
+    {
+        ImGui::Text("No assets were loaded yet.");
+        return;
+    }
+
+    for (const auto& [extension, stats] : bridges)
+    {
+        if (!ImGui::TreeNode(extension.c_str()))
+        {
+            continue;
+        }
+
+        auto count = static_cast<double>(stats.loads + stats.failures);
+        ImGui::Text("Loads: %zu (%zu failed)", stats.loads, stats.failures);
+        ImGui::Text("Load time: %.2f ms average, %.2f ms max", count == 0.0 ? 0.0 : stats.totalTime * 1000.0 / count,
+                    stats.maxTime * 1000.0);
+        ImGui::Text("Read: %.2f MiB", static_cast<double>(stats.bytesRead) / (1024.0 * 1024.0));
+
+        std::array<float, Assets::LoadTimeBuckets> histogram{};
+        for (std::size_t i = 0; i < histogram.size(); ++i)
+        {
+            histogram[i] = static_cast<float>(stats.loadTimes[i]);
+        }
+        ImGui::PlotHistogram("Load times (log2 ms)", histogram.data(), static_cast<int>(histogram.size()),
+                             0, nullptr, 0.0F, FLT_MAX, ImVec2(0.0F, 60.0F));
+
+        ImGui::TreePop();
+    }
+}
+
+static void showStats(Read<Assets> assets, Write<QueueHistory> history, Write<Settings> settings)
+{
+    auto loader = assets->loaderStats();
+    history->samples[history->next] = static_cast<float>(loader.queued);
+    history->next = (history->next + 1) % HistoryLength;
+
+    ImGui::Begin("Asset Statistics");
+    if (!ImGui::IsWindowCollapsed())
+    {
+        if (ImGui::CollapsingHeader("Loader", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::Text("Queued: %zu (at most %zu)", loader.queued, loader.maxQueued);
+            ImGui::Text("Waiting for dependencies: %zu", loader.suspended);
+            ImGui::PlotLines("Queue depth", history->samples.data(), static_cast<int>(HistoryLength),
+                             static_cast<int>(history->next), nullptr, 0.0F, FLT_MAX, ImVec2(0.0F, 60.0F));
+            ImGui::Text("Prefetched files: %zu used, %zu missed", loader.prefetchHits, loader.prefetchMisses);
+            for (const auto& [thread, waits] : loader.waits)
+            {
+                ImGui::BulletText("Thread %s waited %zu times, %.2f ms total, %.2f ms max", thread.c_str(),
+                                  waits.waits, waits.totalTime * 1000.0, waits.maxTime * 1000.0);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Bridges", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            showBridges(*assets);
+        }
+
+        if (ImGui::CollapsingHeader("Memory"))
+        {
+            auto memory = assets->memoryStats();
+            ImGui::Text("Used: %.2f MiB of %.2f MiB budget", static_cast<double>(memory.used) / (1024.0 * 1024.0),
+                        static_cast<double>(memory.budget) / (1024.0 * 1024.0));
+            ImGui::Text("Loaded: %zu, evicted: %zu", memory.loaded, memory.evictions);
+        }
+
+        if (ImGui::CollapsingHeader("Cache"))
+        {
+            auto cache = assets->cache().stats();
+            auto reads = cache.hits + cache.misses;
+            ImGui::Text("Hits: %zu, misses: %zu (%.1f%% hit rate), writes: %zu", cache.hits, cache.misses,
+                        reads == 0 ? 0.0 : 100.0 * static_cast<double>(cache.hits) / static_cast<double>(reads),
+                        cache.writes);
+        }
+
+        if (ImGui::Button("Dump to JSON"))
+        {
+            dump(*assets, settings->getString("assets.stats.path", "asset_stats.json"));
+        }
+    }
+    ImGui::End();
+}
+
+void cubos::engine::tools::assetStatsPlugin(Cubos& cubos)
+{
+    cubos.addPlugin(imguiPlugin);
+    cubos.addPlugin(assetsPlugin);
+
+    cubos.addResource<QueueHistory>();
+
+    cubos.system(showStats).tagged("cubos.imgui");
+}
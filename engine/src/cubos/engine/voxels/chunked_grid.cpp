@@ -0,0 +1,197 @@
+#include <cassert>
+
+#include <cubos/core/log.hpp>
+
+#include <cubos/engine/voxels/chunked_grid.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+
+using cubos::engine::ChunkedVoxelGrid;
+
+/// @brief Number of voxels in a chunk.
+static constexpr std::size_t ChunkVolume =
+    static_cast<std::size_t>(ChunkedVoxelGrid::ChunkSize) * ChunkedVoxelGrid::ChunkSize * ChunkedVoxelGrid::ChunkSize;
+
+ChunkedVoxelGrid::ChunkedVoxelGrid()
+    : ChunkedVoxelGrid({1, 1, 1})
+{
+}
+
+ChunkedVoxelGrid::ChunkedVoxelGrid(const glm::uvec3& size)
+{
+    if (size.x < 1 || size.y < 1 || size.z < 1)
+    {
+        CUBOS_WARN("Grid size must be at least 1 in each dimension: was ({}, {}, {}), defaulting to (1, 1, 1).", size.x,
+                   size.y, size.z);
+        mSize = {1, 1, 1};
+    }
+    else
+    {
+        mSize = size;
+    }
+
+    mChunkCount = (mSize + ChunkSize - 1U) / ChunkSize;
+    mChunks.resize(static_cast<std::size_t>(mChunkCount.x) * mChunkCount.y * mChunkCount.z);
+}
+
+ChunkedVoxelGrid::ChunkedVoxelGrid(const VoxelGrid& grid)
+    : ChunkedVoxelGrid(grid.size())
+{
+    const auto* data = grid.data();
+    for (int z = 0; z < static_cast<int>(mSize.z); ++z)
+    {
+        for (int y = 0; y < static_cast<int>(mSize.y); ++y)
+        {
+            for (int x = 0; x < static_cast<int>(mSize.x); ++x)
+            {
+                if (*data != 0)
+                {
+                    this->set({x, y, z}, *data);
+                }
+                ++data;
+            }
+        }
+    }
+}
+
+const glm::uvec3& ChunkedVoxelGrid::size() const
+{
+    return mSize;
+}
+
+const glm::uvec3& ChunkedVoxelGrid::chunkCount() const
+{
+    return mChunkCount;
+}
+
+void ChunkedVoxelGrid::set(const glm::ivec3& position, uint16_t mat)
+{
+    assert(position.x >= 0 && position.x < static_cast<int>(mSize.x));
+    assert(position.y >= 0 && position.y < static_cast<int>(mSize.y));
+    assert(position.z >= 0 && position.z < static_cast<int>(mSize.z));
+
+    auto chunkPos = glm::uvec3(position) / ChunkSize;
+    auto local = glm::uvec3(position) % ChunkSize;
+    auto& chunk = mChunks[this->chunkIndex(chunkPos)];
+    if (chunk.voxels.empty())
+    {
+        if (mat == 0)
+        {
+            return;
+        }
+
+        chunk.voxels.resize(ChunkVolume, 0);
+    }
+
+    auto& voxel = chunk.voxels[local.x + (local.y + local.z * ChunkSize) * ChunkSize];
+    if (voxel == mat)
+    {
+        return;
+    }
+
+    if (voxel == 0)
+    {
+        chunk.count += 1;
+    }
+    else if (mat == 0)
+    {
+        chunk.count -= 1;
+    }
+    voxel = mat;
+
+    // Release the memory of chunks which became empty.
+    if (chunk.count == 0)
+    {
+        chunk.voxels = {};
+    }
+
+    // Voxels on the border of a chunk also affect the faces of the neighbouring chunks.
+    auto chunkInt = glm::ivec3(chunkPos);
+    this->markDirty(chunkInt);
+    for (glm::length_t axis = 0; axis < 3; ++axis)
+    {
+        auto offset = glm::ivec3(0);
+        if (local[axis] == 0)
+        {
+            offset[axis] = -1;
+            this->markDirty(chunkInt + offset);
+        }
+        else if (local[axis] == ChunkSize - 1)
+        {
+            offset[axis] = 1;
+            this->markDirty(chunkInt + offset);
+        }
+    }
+}
+
+uint16_t ChunkedVoxelGrid::get(const glm::ivec3& position) const
+{
+    if (position.x < 0 || position.y < 0 || position.z < 0 || position.x >= static_cast<int>(mSize.x) ||
+        position.y >= static_cast<int>(mSize.y) || position.z >= static_cast<int>(mSize.z))
+    {
+        return 0;
+    }
+
+    const auto& chunk = mChunks[this->chunkIndex(glm::uvec3(position) / ChunkSize)];
+    if (chunk.voxels.empty())
+    {
+        return 0;
+    }
+
+    auto local = glm::uvec3(position) % ChunkSize;
+    return chunk.voxels[local.x + (local.y + local.z * ChunkSize) * ChunkSize];
+}
+
+bool ChunkedVoxelGrid::empty(const glm::uvec3& chunk) const
+{
+    return mChunks[this->chunkIndex(chunk)].count == 0;
+}
+
+const uint16_t* ChunkedVoxelGrid::chunkData(const glm::uvec3& chunk) const
+{
+    const auto& voxels = mChunks[this->chunkIndex(chunk)].voxels;
+    return voxels.empty() ? nullptr : voxels.data();
+}
+
+bool ChunkedVoxelGrid::dirty(const glm::uvec3& chunk) const
+{
+    return mChunks[this->chunkIndex(chunk)].dirty;
+}
+
+void ChunkedVoxelGrid::clean(const glm::uvec3& chunk)
+{
+    mChunks[this->chunkIndex(chunk)].dirty = false;
+}
+
+std::vector<glm::uvec3> ChunkedVoxelGrid::dirtyChunks() const
+{
+    std::vector<glm::uvec3> chunks;
+    for (uint32_t z = 0; z < mChunkCount.z; ++z)
+    {
+        for (uint32_t y = 0; y < mChunkCount.y; ++y)
+        {
+            for (uint32_t x = 0; x < mChunkCount.x; ++x)
+            {
+                if (mChunks[this->chunkIndex({x, y, z})].dirty)
+                {
+                    chunks.emplace_back(x, y, z);
+                }
+            }
+        }
+    }
+    return chunks;
+}
+
+std::size_t ChunkedVoxelGrid::chunkIndex(const glm::uvec3& chunk) const
+{
+    assert(chunk.x < mChunkCount.x && chunk.y < mChunkCount.y && chunk.z < mChunkCount.z);
+    return chunk.x + (chunk.y + static_cast<std::size_t>(chunk.z) * mChunkCount.y) * mChunkCount.x;
+}
+
+void ChunkedVoxelGrid::markDirty(const glm::ivec3& chunk)
+{
+    if (chunk.x >= 0 && chunk.y >= 0 && chunk.z >= 0 && chunk.x < static_cast<int>(mChunkCount.x) &&
+        chunk.y < static_cast<int>(mChunkCount.y) && chunk.z < static_cast<int>(mChunkCount.z))
+    {
+        mChunks[this->chunkIndex(glm::uvec3(chunk))].dirty = true;
+    }
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 
 #include <cubos/core/log.hpp>
@@ -30,7 +32,7 @@ VoxelGrid::VoxelGrid(const glm::uvec3& size)
         mSize = size;
     }
 
-    mIndices.resize(
+    mIndices = std::make_shared<std::vector<uint16_t>>(
         static_cast<std::size_t>(mSize.x) * static_cast<std::size_t>(mSize.y) * static_cast<std::size_t>(mSize.z), 0);
 }
 
@@ -54,19 +56,19 @@ VoxelGrid::VoxelGrid(const glm::uvec3& size, const std::vector<uint16_t>& indice
         mSize = size;
     }
 
-    mIndices = indices;
+    mIndices = std::make_shared<std::vector<uint16_t>>(indices);
 }
 
 VoxelGrid::VoxelGrid(VoxelGrid&& other) noexcept
     : mSize(other.mSize)
+    , mIndices(std::move(other.mIndices))
 {
-    new (&mIndices) std::vector<uint16_t>(std::move(other.mIndices));
 }
 
 VoxelGrid::VoxelGrid()
 {
     mSize = {1, 1, 1};
-    mIndices.resize(1, 0);
+    mIndices = std::make_shared<std::vector<uint16_t>>(1, 0);
 }
 
 VoxelGrid& VoxelGrid::operator=(const VoxelGrid& rhs) = default;
@@ -85,9 +87,9 @@ void VoxelGrid::setSize(const glm::uvec3& size)
         return;
     }
 
+    // The previous contents are discarded, so there's no need to copy them if they're shared.
     mSize = size;
-    mIndices.clear();
-    mIndices.resize(
+    mIndices = std::make_shared<std::vector<uint16_t>>(
         static_cast<std::size_t>(mSize.x) * static_cast<std::size_t>(mSize.y) * static_cast<std::size_t>(mSize.z), 0);
 }
 
@@ -96,12 +98,21 @@ const glm::uvec3& VoxelGrid::size() const
     return mSize;
 }
 
+const uint16_t* VoxelGrid::data() const
+{
+    return mIndices->data();
+}
+
+uint16_t* VoxelGrid::data()
+{
+    this->detach();
+    return mIndices->data();
+}
+
 void VoxelGrid::clear()
 {
-    for (auto& i : mIndices)
-    {
-        i = 0;
-    }
+    this->detach();
+    std::fill(mIndices->begin(), mIndices->end(), uint16_t{0});
 }
 
 uint16_t VoxelGrid::get(const glm::ivec3& position) const
@@ -110,7 +121,7 @@ uint16_t VoxelGrid::get(const glm::ivec3& position) const
     assert(position.y >= 0 && position.y < static_cast<int>(mSize.y));
     assert(position.z >= 0 && position.z < static_cast<int>(mSize.z));
     auto index = position.x + position.y * static_cast<int>(mSize.x) + position.z * static_cast<int>(mSize.x * mSize.y);
-    return mIndices[static_cast<std::size_t>(index)];
+    return (*mIndices)[static_cast<std::size_t>(index)];
 }
 
 void VoxelGrid::set(const glm::ivec3& position, uint16_t mat)
@@ -119,7 +130,8 @@ void VoxelGrid::set(const glm::ivec3& position, uint16_t mat)
     assert(position.y >= 0 && position.y < static_cast<int>(mSize.y));
     assert(position.z >= 0 && position.z < static_cast<int>(mSize.z));
     auto index = position.x + position.y * static_cast<int>(mSize.x) + position.z * static_cast<int>(mSize.x * mSize.y);
-    mIndices[static_cast<std::size_t>(index)] = mat;
+    this->detach();
+    (*mIndices)[static_cast<std::size_t>(index)] = mat;
 }
 
 bool VoxelGrid::convert(const VoxelPalette& src, const VoxelPalette& dst, float minSimilarity)
@@ -138,42 +150,64 @@ bool VoxelGrid::convert(const VoxelPalette& src, const VoxelPalette& dst, float
     // Check if the mappings are complete for every material being used in the grid.
     for (uint32_t i = 0; i < mSize.x * mSize.y * mSize.z; ++i)
     {
-        if (mappings.find(mIndices[i]) == mappings.end())
+        if (mappings.find((*mIndices)[i]) == mappings.end())
         {
             return false;
         }
     }
 
     // Apply the mappings.
+    this->detach();
     for (uint32_t i = 0; i < mSize.x * mSize.y * mSize.z; ++i)
     {
-        mIndices[i] = mappings[mIndices[i]];
+        (*mIndices)[i] = mappings[(*mIndices)[i]];
     }
 
     return true;
 }
 
+void VoxelGrid::detach()
+{
+    if (mIndices == nullptr)
+    {
+        // Only happens after the grid was moved from.
+        mIndices = std::make_shared<std::vector<uint16_t>>();
+    }
+    else if (mIndices.use_count() > 1)
+    {
+        mIndices = std::make_shared<std::vector<uint16_t>>(*mIndices);
+    }
+    else
+    {
+        // Copies on other threads may have just been released, and their reads must happen before
+        // the writes which follow.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+}
+
 void cubos::core::data::old::serialize(Serializer& serializer, const VoxelGrid& grid, const char* name)
 {
     serializer.beginObject(name);
     serializer.write(grid.mSize, "size");
-    serializer.write(grid.mIndices, "data");
+    serializer.write(*grid.mIndices, "data");
     serializer.endObject();
 }
 
 void cubos::core::data::old::deserialize(Deserializer& deserializer, VoxelGrid& grid)
 {
+    // The indices are read into a new vector, as the previous one may be shared with copies.
+    auto indices = std::make_shared<std::vector<uint16_t>>();
     deserializer.beginObject();
     deserializer.read(grid.mSize);
-    deserializer.read(grid.mIndices);
+    deserializer.read(*indices);
     deserializer.endObject();
+    grid.mIndices = std::move(indices);
 
-    if (grid.mSize.x * grid.mSize.y * grid.mSize.z != static_cast<unsigned int>(grid.mIndices.size()))
+    if (grid.mSize.x * grid.mSize.y * grid.mSize.z != static_cast<unsigned int>(grid.mIndices->size()))
     {
         CUBOS_WARN("Grid size and indices size mismatch: was ({}, {}, {}), indices size is {}.", grid.mSize.x,
-                   grid.mSize.y, grid.mSize.z, grid.mIndices.size());
+                   grid.mSize.y, grid.mSize.z, grid.mIndices->size());
         grid.mSize = {1, 1, 1};
-        grid.mIndices.clear();
-        grid.mIndices.resize(1, 0);
+        grid.mIndices = std::make_shared<std::vector<uint16_t>>(1, 0);
     }
 }
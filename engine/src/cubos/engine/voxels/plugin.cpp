@@ -1,3 +1,8 @@
+#include <algorithm>
+
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
 #include <cubos/engine/assets/bridges/binary.hpp>
 #include <cubos/engine/assets/plugin.hpp>
 #include <cubos/engine/voxels/grid.hpp>
@@ -5,13 +10,179 @@
 #include <cubos/engine/voxels/plugin.hpp>
 
 using cubos::core::ecs::Write;
+using cubos::core::memory::fromLittleEndian;
+using cubos::core::memory::isLittleEndian;
+using cubos::core::memory::SeekOrigin;
+using cubos::core::memory::Stream;
 using namespace cubos::engine;
 
+/// @brief Number of voxels from which grids are loaded progressively.
+static constexpr std::size_t ProgressiveVoxelCount = 128 * 128 * 128;
+
+/// @brief Number of voxels read from the file at a time when loading grids progressively.
+static constexpr std::size_t ChunkVoxelCount = 256 * 1024;
+
+/// @brief Distance between the layers which are read first when loading grids progressively.
+static constexpr uint32_t CoarseLayerStride = 8;
+
+/// @brief Number of times a progressively loaded grid is reported as refined while it's loading.
+static constexpr std::size_t RefineSteps = 4;
+
+/// @brief Reads voxels stored in little endian directly into the given array.
+/// @param stream Stream to read from.
+/// @param voxels Array to read into.
+/// @param count Number of voxels to read.
+/// @return Whether the voxels were read successfully.
+static bool readVoxels(Stream& stream, uint16_t* voxels, std::size_t count)
+{
+    if (stream.read(voxels, count * sizeof(uint16_t)) != count * sizeof(uint16_t))
+    {
+        CUBOS_ERROR("Could not read grid voxels: unexpected end of file");
+        return false;
+    }
+
+    if (!isLittleEndian())
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            voxels[i] = fromLittleEndian(voxels[i]);
+        }
+    }
+
+    return true;
+}
+
+/// @brief Bridge for grids which also accounts for the memory used by their voxels.
+///
+/// Reads the voxels straight into the grid which is stored, instead of deserializing them one by
+/// one into a temporary grid. Large grids are stored as soon as one of every few of their layers
+/// is read, with the layers in between filled with copies of the layer before them. The skipped
+/// layers are then read in place, a chunk at a time, so that the grids can be used while they're
+/// still loading.
+class GridBridge : public BinaryBridge<VoxelGrid>
+{
+public:
+    std::size_t memorySize(const void* data) const override
+    {
+        const auto& size = static_cast<const VoxelGrid*>(data)->size();
+        return sizeof(VoxelGrid) + static_cast<std::size_t>(size.x) * size.y * size.z * sizeof(uint16_t);
+    }
+
+    bool progressive() const override
+    {
+        return true;
+    }
+
+protected:
+    bool loadFromFile(Assets& assets, const AnyAsset& handle, Stream& stream) override
+    {
+        // Read the header written by the grid serializer: its size and the length of its voxel array.
+        uint32_t size[3];
+        uint64_t length;
+        if (stream.read(size, sizeof(size)) != sizeof(size) || stream.read(&length, sizeof(length)) != sizeof(length))
+        {
+            CUBOS_ERROR("Could not read grid header: unexpected end of file");
+            return false;
+        }
+
+        glm::uvec3 gridSize{fromLittleEndian(size[0]), fromLittleEndian(size[1]), fromLittleEndian(size[2])};
+        auto count = static_cast<std::size_t>(gridSize.x) * gridSize.y * gridSize.z;
+        if (count == 0 || count != fromLittleEndian(length))
+        {
+            CUBOS_ERROR("Grid size ({}, {}, {}) doesn't match its voxel count {}", gridSize.x, gridSize.y, gridSize.z,
+                        fromLittleEndian(length));
+            return false;
+        }
+
+        if (count < ProgressiveVoxelCount)
+        {
+            VoxelGrid grid{gridSize};
+            if (!readVoxels(stream, grid.data(), count))
+            {
+                return false;
+            }
+
+            assets.store(handle, std::move(grid));
+            return true;
+        }
+
+        // Read one of every few layers first, and repeat each of them over the layers which
+        // follow it, so that a coarse version of the whole grid can be stored right away. It's
+        // built in the grid which is stored, and thus takes no extra memory.
+        auto layer = static_cast<std::size_t>(gridSize.x) * gridSize.y;
+        auto start = static_cast<std::ptrdiff_t>(stream.tell());
+        VoxelGrid grid{gridSize};
+        for (uint32_t z = 0; z < gridSize.z; z += CoarseLayerStride)
+        {
+            auto* voxels = grid.data() + z * layer;
+            stream.seek(start + static_cast<std::ptrdiff_t>(z * layer * sizeof(uint16_t)), SeekOrigin::Begin);
+            if (!readVoxels(stream, voxels, layer))
+            {
+                return false;
+            }
+
+            for (uint32_t i = z + 1; i < std::min(z + CoarseLayerStride, gridSize.z); ++i)
+            {
+                std::copy_n(voxels, layer, grid.data() + i * layer);
+            }
+        }
+
+        // Then, read the layers which were skipped, a chunk at a time. The chunks are read into a
+        // small buffer first, so that the grid is only locked while they're copied. Copying them
+        // doesn't report the grid as modified, so that its users only pick up the refinement steps.
+        assets.storeCoarse(handle, std::move(grid));
+        std::vector<uint16_t> chunk(ChunkVoxelCount);
+        auto refineCount = count - ((gridSize.z + CoarseLayerStride - 1) / CoarseLayerStride) * layer;
+        std::size_t refined = 0;
+        std::size_t nextStep = 1;
+        for (uint32_t z = 0; z < gridSize.z; z += CoarseLayerStride)
+        {
+            auto end = std::min(z + CoarseLayerStride, gridSize.z) * layer;
+            auto offset = (z + 1) * layer;
+            stream.seek(start + static_cast<std::ptrdiff_t>(offset * sizeof(uint16_t)), SeekOrigin::Begin);
+            while (offset < end)
+            {
+                auto chunkCount = std::min(ChunkVoxelCount, end - offset);
+                if (!readVoxels(stream, chunk.data(), chunkCount))
+                {
+                    return false;
+                }
+
+                {
+                    auto stored = assets.refine<VoxelGrid>(handle);
+                    std::copy_n(chunk.data(), chunkCount, stored->data() + offset);
+                }
+                offset += chunkCount;
+                refined += chunkCount;
+
+                // The last step is reported by the asset manager once the bridge returns.
+                if (refined < refineCount && refined >= refineCount * nextStep / RefineSteps)
+                {
+                    assets.markRefined(handle);
+                    nextStep += 1;
+                }
+            }
+        }
+
+        return true;
+    }
+};
+
+/// @brief Bridge for palettes which also accounts for the memory used by their materials.
+class PaletteBridge : public BinaryBridge<VoxelPalette>
+{
+public:
+    std::size_t memorySize(const void* data) const override
+    {
+        return sizeof(VoxelPalette) + static_cast<const VoxelPalette*>(data)->size() * sizeof(VoxelMaterial);
+    }
+};
+
 static void bridges(Write<Assets> assets)
 {
     // Add the bridges to load .grd and .pal files.
-    assets->registerBridge(".grd", std::make_unique<BinaryBridge<VoxelGrid>>());
-    assets->registerBridge(".pal", std::make_unique<BinaryBridge<VoxelPalette>>());
+    assets->registerBridge(".grd", std::make_unique<GridBridge>());
+    assets->registerBridge(".pal", std::make_unique<PaletteBridge>());
 }
 
 void cubos::engine::voxelsPlugin(Cubos& cubos)
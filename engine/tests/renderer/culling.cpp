@@ -0,0 +1,59 @@
+#include <doctest/doctest.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cubos/engine/renderer/culling.hpp>
+
+using namespace cubos::engine;
+
+/// @brief Grid which is never uploaded, used only for its bounding box.
+struct BoxGrid : impl::RendererGrid
+{
+    BoxGrid(const glm::vec3& min, const glm::vec3& max)
+    {
+        localAABB.min(min);
+        localAABB.max(max);
+    }
+};
+
+TEST_CASE("cullDrawCmds")
+{
+    // Camera at the origin, looking down the negative z axis.
+    auto viewProjection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F) *
+                          glm::lookAt(glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    auto grid = std::make_shared<BoxGrid>(glm::vec3(0.0F), glm::vec3(2.0F));
+
+    RendererFrame frame{};
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(-1.0F, -1.0F, -10.0F)));  // In front.
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(-1.0F, -1.0F, 10.0F)));   // Behind.
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(50.0F, -1.0F, -10.0F)));  // Far to the right.
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(-1.0F, -1.0F, -200.0F))); // Beyond the far plane.
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(-1.0F, -1.0F, -0.5F)));   // Crossing the near plane.
+
+    // Scaled grids which are out of view until their box grows into it.
+    frame.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(-20.0F, -1.0F, -10.0F)));
+    frame.draw(grid, glm::scale(glm::translate(glm::mat4(1.0F), glm::vec3(-20.0F, -1.0F, -10.0F)), glm::vec3(10.0F)));
+
+    std::vector<std::size_t> visible;
+    cullDrawCmds(viewProjection, frame.drawCmds(), visible);
+    REQUIRE(visible.size() == 3);
+    CHECK(visible[0] == 0);
+    CHECK(visible[1] == 4);
+    CHECK(visible[2] == 6);
+
+    SUBCASE("draws beyond the first batch")
+    {
+        RendererFrame many{};
+        for (int i = 0; i < 200; ++i)
+        {
+            auto x = i % 2 == 0 ? -1.0F : 50.0F;
+            many.draw(grid, glm::translate(glm::mat4(1.0F), glm::vec3(x, -1.0F, -10.0F)));
+        }
+
+        cullDrawCmds(viewProjection, many.drawCmds(), visible);
+        REQUIRE(visible.size() == 100);
+        for (std::size_t i = 0; i < visible.size(); ++i)
+        {
+            CHECK(visible[i] == 2 * i);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+
+#include <doctest/doctest.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cubos/engine/renderer/light_clusters.hpp>
+
+using namespace cubos::engine;
+
+static constexpr float FovY = 60.0F;
+static constexpr float Aspect = 16.0F / 9.0F;
+static constexpr float ZNear = 0.1F;
+static constexpr float ZFar = 100.0F;
+
+/// @brief Checks whether a light was assigned to a cluster.
+static bool contains(const LightClusters& clusters, const glm::uvec3& cluster, uint32_t light)
+{
+    auto index = LightClusters::index(cluster);
+    auto begin = clusters.indices().begin() + clusters.offsets()[index];
+    auto end = begin + clusters.counts()[index];
+    return std::find(begin, end, light) != end;
+}
+
+/// @brief Counts the clusters a light was assigned to.
+static std::size_t clusterCount(const LightClusters& clusters, uint32_t light)
+{
+    return static_cast<std::size_t>(std::count(clusters.indices().begin(), clusters.indices().end(), light));
+}
+
+TEST_CASE("LightClusters")
+{
+    // Camera at the origin, looking down the negative z axis.
+    auto view = glm::lookAt(glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    auto projection = glm::perspective(glm::radians(FovY), Aspect, ZNear, ZFar);
+
+    std::vector<glm::vec4> spheres = {
+        {0.0F, 0.0F, -10.0F, 1.0F},   // In front.
+        {0.0F, 0.0F, 20.0F, 1.0F},    // Behind.
+        {100.0F, 0.0F, -10.0F, 1.0F}, // Far to the right.
+        {0.0F, 0.0F, -200.0F, 1.0F},  // Beyond the far plane.
+        {0.0F, 0.0F, 0.0F, 2.0F},     // Around the camera.
+        {-6.0F, 3.0F, -15.0F, 4.0F},  // Near the top left corner.
+        {30.0F, -5.0F, -60.0F, 8.0F}, // Crossing the right side.
+    };
+
+    LightClusters clusters{};
+    clusters.build(view, FovY, Aspect, ZNear, ZFar, spheres);
+    REQUIRE(clusters.offsets().size() == LightClusters::Count);
+    REQUIRE(clusters.counts().size() == LightClusters::Count);
+
+    // Lights which can't be seen aren't assigned to any cluster.
+    CHECK(clusterCount(clusters, 1) == 0);
+    CHECK(clusterCount(clusters, 2) == 0);
+    CHECK(clusterCount(clusters, 3) == 0);
+
+    // A small light in front of the camera covers only a few tiles around the center.
+    auto slice = static_cast<uint32_t>(std::floor(std::log(10.0F) * clusters.depthScale() + clusters.depthBias()));
+    CHECK(contains(clusters, {LightClusters::TilesX / 2, LightClusters::TilesY / 2, slice}, 0));
+    CHECK_FALSE(contains(clusters, {0, 0, slice}, 0));
+    CHECK_FALSE(contains(clusters, {LightClusters::TilesX / 2, LightClusters::TilesY / 2, 0}, 0));
+    CHECK(clusterCount(clusters, 0) < 4 * 3 * 3);
+
+    // A light around the camera covers every tile of the nearest slices.
+    for (uint32_t y = 0; y < LightClusters::TilesY; ++y)
+    {
+        for (uint32_t x = 0; x < LightClusters::TilesX; ++x)
+        {
+            CHECK(contains(clusters, {x, y, 0}, 4));
+        }
+    }
+    CHECK_FALSE(contains(clusters, {0, 0, LightClusters::Slices - 1}, 4));
+
+    SUBCASE("every visible point of a light is in one of its clusters")
+    {
+        for (uint32_t light = 0; light < spheres.size(); ++light)
+        {
+            auto center = glm::vec3(spheres[light]);
+            auto radius = spheres[light].w;
+            for (int i = -4; i <= 4; ++i)
+            {
+                for (int j = -4; j <= 4; ++j)
+                {
+                    for (int k = -4; k <= 4; ++k)
+                    {
+                        auto offset = glm::vec3(static_cast<float>(i), static_cast<float>(j), static_cast<float>(k));
+                        auto point = center + offset * (radius / 4.0F);
+                        if (glm::length(point - center) > radius)
+                        {
+                            continue;
+                        }
+
+                        // Find the cluster of the point, if it's inside the frustum.
+                        auto clip = projection * view * glm::vec4(point, 1.0F);
+                        auto depth = clip.w;
+                        if (depth < ZNear || depth > ZFar || std::abs(clip.x) >= depth || std::abs(clip.y) >= depth)
+                        {
+                            continue;
+                        }
+
+                        auto x = static_cast<uint32_t>((clip.x / depth * 0.5F + 0.5F) * LightClusters::TilesX);
+                        auto y = static_cast<uint32_t>((clip.y / depth * 0.5F + 0.5F) * LightClusters::TilesY);
+                        auto z = std::floor(std::log(depth) * clusters.depthScale() + clusters.depthBias());
+                        z = std::clamp(z, 0.0F, static_cast<float>(LightClusters::Slices - 1));
+                        CHECK(contains(clusters, {x, y, static_cast<uint32_t>(z)}, light));
+                    }
+                }
+            }
+        }
+    }
+
+    SUBCASE("rebuilding replaces the previous lights")
+    {
+        clusters.build(view, FovY, Aspect, ZNear, ZFar, {});
+        CHECK(clusters.indices().empty());
+        CHECK(clusters.counts()[0] == 0);
+    }
+}
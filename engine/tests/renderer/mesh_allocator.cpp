@@ -0,0 +1,78 @@
+#include <doctest/doctest.h>
+
+#include <cubos/engine/renderer/mesh_allocator.hpp>
+
+using namespace cubos::engine;
+
+TEST_CASE("MeshAllocator")
+{
+    MeshAllocator allocator{100};
+    CHECK(allocator.empty());
+    CHECK(allocator.capacity() == 100);
+    CHECK(allocator.largestFree() == 100);
+
+    auto a = allocator.allocate(10);
+    auto b = allocator.allocate(20);
+    auto c = allocator.allocate(30);
+    CHECK(a == 0);
+    CHECK(b == 10);
+    CHECK(c == 30);
+    CHECK(allocator.used() == 60);
+    CHECK(allocator.largestFree() == 40);
+    CHECK(allocator.allocate(41) == MeshAllocator::InvalidOffset);
+
+    SUBCASE("freed ranges are reused by the allocations which fit them best")
+    {
+        allocator.free(a);
+        CHECK(allocator.used() == 50);
+        CHECK(allocator.allocate(5) == 0);
+        CHECK(allocator.allocate(35) == 60);
+        CHECK(allocator.allocate(5) == 5);
+        CHECK(allocator.largestFree() == 5);
+    }
+
+    SUBCASE("adjacent free ranges are merged")
+    {
+        allocator.free(a);
+        allocator.free(c);
+        CHECK(allocator.largestFree() == 70);
+        allocator.free(b);
+        CHECK(allocator.empty());
+        CHECK(allocator.largestFree() == 100);
+        CHECK(allocator.allocate(100) == 0);
+    }
+
+    SUBCASE("growing extends the free range at the end")
+    {
+        allocator.grow(150);
+        CHECK(allocator.capacity() == 150);
+        CHECK(allocator.largestFree() == 90);
+        CHECK(allocator.allocate(90) == 60);
+
+        allocator.grow(160);
+        CHECK(allocator.largestFree() == 10);
+        CHECK(allocator.allocate(10) == 150);
+    }
+
+    SUBCASE("defragmenting packs allocations at the start")
+    {
+        allocator.free(b);
+        CHECK(allocator.allocate(50) == MeshAllocator::InvalidOffset);
+
+        auto moves = allocator.defragment();
+        REQUIRE(moves.size() == 2);
+        CHECK(moves[0].from == 0);
+        CHECK(moves[0].to == 0);
+        CHECK(moves[0].size == 10);
+        CHECK(moves[1].from == 30);
+        CHECK(moves[1].to == 10);
+        CHECK(moves[1].size == 30);
+        CHECK(allocator.used() == 40);
+        CHECK(allocator.largestFree() == 60);
+
+        // The moved allocations are freed by their new offsets.
+        CHECK(allocator.allocate(50) == 40);
+        allocator.free(10);
+        CHECK(allocator.largestFree() == 30);
+    }
+}
@@ -0,0 +1,295 @@
+#include <random>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/renderer/vertex.hpp>
+#include <cubos/engine/voxels/chunked_grid.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+
+using namespace cubos::engine;
+
+/// @brief Scalar greedy mesher which the bitmask one must match, vertex for vertex and index for
+/// index.
+///
+/// Builds the face mask of each slice one voxel at a time, and then merges the faces row by row,
+/// first along u and then along v.
+///
+/// @tparam G Type of the function used to get the material of a voxel, which must return 0 for
+/// voxels outside of the grid.
+/// @param get Function used to get the material of a voxel.
+/// @param origin Position of the region's first voxel, which is added to the vertex positions.
+/// @param sz Size of the region.
+/// @param vertices Vertices of the mesh.
+/// @param indices Indices of the mesh.
+template <typename G>
+static void triangulateScalar(const G& get, glm::ivec3 origin, glm::uvec3 sz, std::vector<VoxelVertex>& vertices,
+                              std::vector<uint32_t>& indices)
+{
+    std::vector<uint16_t> mask;
+    for (bool backFace : {false, true})
+    {
+        for (int d = 0; d < 3; ++d)
+        {
+            int u = (d + 1) % 3;
+            int v = (d + 2) % 3;
+
+            glm::ivec3 x = {0, 0, 0};
+            glm::ivec3 q = {0, 0, 0};
+            q[d] = 1;
+            mask.resize(static_cast<std::size_t>(sz[u]) * static_cast<std::size_t>(sz[v]));
+
+            for (x[d] = -1; x[d] < int(sz[d]);)
+            {
+                // Faces between voxels inside and outside the region belong to the solid voxel.
+                std::size_t n = 0;
+                for (x[v] = 0; x[v] < int(sz[v]); ++x[v])
+                {
+                    for (x[u] = 0; x[u] < int(sz[u]); ++x[u], ++n)
+                    {
+                        auto front = get(origin + x);
+                        auto back = get(origin + x + q);
+                        if (x[d] < 0)
+                        {
+                            mask[n] = backFace && front == 0 ? back : 0;
+                        }
+                        else if (x[d] == int(sz[d]) - 1)
+                        {
+                            mask[n] = !backFace && back == 0 ? front : 0;
+                        }
+                        else if (front == 0 || back == 0)
+                        {
+                            mask[n] = backFace ? back : front;
+                        }
+                        else
+                        {
+                            mask[n] = 0;
+                        }
+                    }
+                }
+
+                ++x[d];
+                n = 0;
+                for (std::size_t j = 0; j < sz[v]; ++j)
+                {
+                    for (std::size_t i = 0; i < sz[u];)
+                    {
+                        auto material = mask[n];
+                        if (material == 0)
+                        {
+                            ++i;
+                            ++n;
+                            continue;
+                        }
+
+                        std::size_t w = 1;
+                        while (i + w < sz[u] && mask[n + w] == material)
+                        {
+                            ++w;
+                        }
+
+                        std::size_t h = 1;
+                        for (; j + h < sz[v]; ++h)
+                        {
+                            std::size_t k = 0;
+                            while (k < w && mask[n + k + h * sz[u]] == material)
+                            {
+                                ++k;
+                            }
+                            if (k < w)
+                            {
+                                break;
+                            }
+                        }
+
+                        x[u] = static_cast<int>(i);
+                        x[v] = static_cast<int>(j);
+                        glm::ivec3 du = {0, 0, 0};
+                        glm::ivec3 dv = {0, 0, 0};
+                        du[u] = static_cast<int>(w);
+                        dv[v] = static_cast<int>(h);
+
+                        auto vi = static_cast<uint32_t>(vertices.size());
+                        auto normal = glm::vec3(backFace ? -q : q);
+                        vertices.push_back({glm::uvec3(origin + x), normal, material});
+                        vertices.push_back({glm::uvec3(origin + x + du), normal, material});
+                        vertices.push_back({glm::uvec3(origin + x + du + dv), normal, material});
+                        vertices.push_back({glm::uvec3(origin + x + dv), normal, material});
+                        if (backFace)
+                        {
+                            indices.insert(indices.end(), {vi + 0, vi + 2, vi + 1, vi + 3, vi + 2, vi + 0});
+                        }
+                        else
+                        {
+                            indices.insert(indices.end(), {vi + 0, vi + 1, vi + 2, vi + 2, vi + 3, vi + 0});
+                        }
+
+                        for (std::size_t l = 0; l < h; ++l)
+                        {
+                            for (std::size_t k = 0; k < w; ++k)
+                            {
+                                mask[n + k + l * sz[u]] = 0;
+                            }
+                        }
+
+                        i += w;
+                        n += w;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Fills a grid with random voxels.
+/// @param rng Random number generator.
+/// @param size Size of the grid.
+/// @param density Percentage of solid voxels.
+/// @param materials Number of different materials used.
+/// @param set Function used to set the material of a voxel.
+template <typename S>
+static void fillRandom(std::mt19937& rng, glm::uvec3 size, unsigned int density, unsigned int materials, const S& set)
+{
+    for (int z = 0; z < static_cast<int>(size.z); ++z)
+    {
+        for (int y = 0; y < static_cast<int>(size.y); ++y)
+        {
+            for (int x = 0; x < static_cast<int>(size.x); ++x)
+            {
+                if (rng() % 100 < density)
+                {
+                    set({x, y, z}, static_cast<uint16_t>(1 + rng() % materials));
+                }
+            }
+        }
+    }
+}
+
+/// @brief Checks whether two vertices are exactly the same.
+static bool sameVertex(const VoxelVertex& a, const VoxelVertex& b)
+{
+    return a.position == b.position && a.normal == b.normal && a.material == b.material;
+}
+
+/// @brief Checks that two meshes are exactly the same.
+static void checkSameMesh(const std::vector<VoxelVertex>& vertices, const std::vector<uint32_t>& indices,
+                          const std::vector<VoxelVertex>& expectedVertices,
+                          const std::vector<uint32_t>& expectedIndices)
+{
+    REQUIRE(vertices.size() == expectedVertices.size());
+    REQUIRE(indices.size() == expectedIndices.size());
+
+    // Report only the first difference, instead of checking every vertex separately.
+    std::size_t vertex = 0;
+    while (vertex < vertices.size() && sameVertex(vertices[vertex], expectedVertices[vertex]))
+    {
+        ++vertex;
+    }
+    CAPTURE(vertex);
+    CHECK(vertex == vertices.size());
+    CHECK(indices == expectedIndices);
+}
+
+TEST_CASE("triangulate")
+{
+    std::mt19937 rng{1234};
+
+    SUBCASE("grids are meshed like the scalar greedy mesher does")
+    {
+        // Sizes around the 64 voxel words used by the bitmask mesher, and boxes which are much
+        // longer along one axis than along the others.
+        std::vector<glm::uvec3> sizes = {
+            {1, 1, 1}, {64, 64, 4}, {65, 63, 9}, {9, 65, 63}, {63, 9, 65}, {70, 5, 130}, {1, 129, 1}, {127, 2, 66},
+        };
+        for (int i = 0; i < 40; ++i)
+        {
+            sizes.emplace_back(1 + rng() % 12, 1 + rng() % 12, 1 + rng() % 12);
+        }
+
+        for (const auto& size : sizes)
+        {
+            // Cover empty, sparse, dense and full grids, with one or several materials.
+            for (unsigned int density : {0U, 10U, 50U, 90U, 100U})
+            {
+                for (unsigned int materials : {1U, 3U})
+                {
+                    CAPTURE(size.x);
+                    CAPTURE(size.y);
+                    CAPTURE(size.z);
+                    CAPTURE(density);
+                    CAPTURE(materials);
+
+                    VoxelGrid grid{size};
+                    fillRandom(rng, size, density, materials,
+                               [&](const glm::ivec3& position, uint16_t material) { grid.set(position, material); });
+
+                    auto get = [&](const glm::ivec3& position) -> uint16_t {
+                        if (position.x < 0 || position.y < 0 || position.z < 0 ||
+                            position.x >= static_cast<int>(size.x) || position.y >= static_cast<int>(size.y) ||
+                            position.z >= static_cast<int>(size.z))
+                        {
+                            return 0;
+                        }
+                        return grid.get(position);
+                    };
+
+                    std::vector<VoxelVertex> expectedVertices;
+                    std::vector<uint32_t> expectedIndices;
+                    triangulateScalar(get, {0, 0, 0}, size, expectedVertices, expectedIndices);
+
+                    std::vector<VoxelVertex> vertices;
+                    std::vector<uint32_t> indices;
+                    triangulate(grid, vertices, indices);
+                    checkSameMesh(vertices, indices, expectedVertices, expectedIndices);
+                }
+            }
+        }
+    }
+
+    SUBCASE("chunks are meshed like the scalar greedy mesher does with their sub-region")
+    {
+        // Includes chunks cut short by the edges of the grid on every axis.
+        constexpr auto S = ChunkedVoxelGrid::ChunkSize;
+        std::vector<glm::uvec3> sizes = {{S, S, S}, {2 * S + 5, S + 1, 7}, {3, 2 * S, S + 17}, {S + 31, 1, 2 * S - 1}};
+        for (const auto& size : sizes)
+        {
+            for (unsigned int density : {10U, 60U, 100U})
+            {
+                CAPTURE(size.x);
+                CAPTURE(size.y);
+                CAPTURE(size.z);
+                CAPTURE(density);
+
+                ChunkedVoxelGrid grid{size};
+                fillRandom(rng, size, density, 3,
+                           [&](const glm::ivec3& position, uint16_t material) { grid.set(position, material); });
+                auto get = [&](const glm::ivec3& position) { return grid.get(position); };
+
+                const auto& count = grid.chunkCount();
+                for (uint32_t z = 0; z < count.z; ++z)
+                {
+                    for (uint32_t y = 0; y < count.y; ++y)
+                    {
+                        for (uint32_t x = 0; x < count.x; ++x)
+                        {
+                            CAPTURE(x);
+                            CAPTURE(y);
+                            CAPTURE(z);
+
+                            auto origin = glm::uvec3(x, y, z) * S;
+                            auto chunkSize = glm::min(size - origin, glm::uvec3(S));
+
+                            std::vector<VoxelVertex> expectedVertices;
+                            std::vector<uint32_t> expectedIndices;
+                            triangulateScalar(get, glm::ivec3(origin), chunkSize, expectedVertices, expectedIndices);
+
+                            std::vector<VoxelVertex> vertices;
+                            std::vector<uint32_t> indices;
+                            triangulate(grid, {x, y, z}, vertices, indices);
+                            checkSameMesh(vertices, indices, expectedVertices, expectedIndices);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
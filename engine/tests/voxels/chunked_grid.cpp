@@ -0,0 +1,112 @@
+#include <cstdlib>
+
+#include <doctest/doctest.h>
+
+#include <cubos/engine/renderer/vertex.hpp>
+#include <cubos/engine/voxels/chunked_grid.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+
+using namespace cubos::engine;
+
+/// @brief Sums the areas of the faces of a mesh, which doesn't depend on how faces were merged.
+static std::size_t faceArea(const std::vector<VoxelVertex>& vertices)
+{
+    std::size_t area = 0;
+    for (std::size_t i = 0; i < vertices.size(); i += 4)
+    {
+        auto diagonal = glm::ivec3(vertices[i + 2].position) - glm::ivec3(vertices[i].position);
+        std::size_t quad = 1;
+        for (glm::length_t axis = 0; axis < 3; ++axis)
+        {
+            quad *= diagonal[axis] == 0 ? 1 : static_cast<std::size_t>(std::abs(diagonal[axis]));
+        }
+        area += quad;
+    }
+    return area;
+}
+
+/// @brief Sums the areas of the faces of the meshes of every chunk of a grid.
+static std::size_t chunkedFaceArea(const ChunkedVoxelGrid& grid)
+{
+    std::size_t area = 0;
+    const auto& count = grid.chunkCount();
+    for (uint32_t z = 0; z < count.z; ++z)
+    {
+        for (uint32_t y = 0; y < count.y; ++y)
+        {
+            for (uint32_t x = 0; x < count.x; ++x)
+            {
+                std::vector<VoxelVertex> vertices;
+                std::vector<uint32_t> indices;
+                triangulate(grid, {x, y, z}, vertices, indices);
+                area += faceArea(vertices);
+            }
+        }
+    }
+    return area;
+}
+
+TEST_CASE("ChunkedVoxelGrid")
+{
+    constexpr auto S = static_cast<int>(ChunkedVoxelGrid::ChunkSize);
+
+    ChunkedVoxelGrid grid{{2 * S + 1, S, S}};
+    CHECK(grid.chunkCount() == glm::uvec3(3, 1, 1));
+    CHECK(grid.get({0, 0, 0}) == 0);
+    CHECK(grid.get({-1, 0, 0}) == 0);
+    CHECK(grid.empty({0, 0, 0}));
+
+    // New chunks start dirty, so that they're uploaded for the first time.
+    CHECK(grid.dirtyChunks().size() == 3);
+    for (uint32_t x = 0; x < 3; ++x)
+    {
+        grid.clean({x, 0, 0});
+    }
+    CHECK(grid.dirtyChunks().empty());
+
+    SUBCASE("interior edits only dirty their chunk")
+    {
+        grid.set({S + 5, 5, 5}, 1);
+        CHECK(grid.get({S + 5, 5, 5}) == 1);
+        CHECK_FALSE(grid.empty({1, 0, 0}));
+        REQUIRE(grid.dirtyChunks().size() == 1);
+        CHECK(grid.dirty({1, 0, 0}));
+
+        // Setting the same material again changes nothing.
+        grid.clean({1, 0, 0});
+        grid.set({S + 5, 5, 5}, 1);
+        CHECK(grid.dirtyChunks().empty());
+
+        // Removing the only voxel empties the chunk again.
+        grid.set({S + 5, 5, 5}, 0);
+        CHECK(grid.empty({1, 0, 0}));
+        CHECK(grid.dirty({1, 0, 0}));
+    }
+
+    SUBCASE("border edits also dirty the neighbouring chunks")
+    {
+        grid.set({S, 0, 0}, 1);
+        CHECK(grid.dirtyChunks().size() == 2);
+        CHECK(grid.dirty({0, 0, 0}));
+        CHECK(grid.dirty({1, 0, 0}));
+        CHECK_FALSE(grid.dirty({2, 0, 0}));
+    }
+
+    SUBCASE("chunk meshes are equivalent to the whole grid's mesh")
+    {
+        VoxelGrid flat{grid.size()};
+        for (int x = S - 3; x < S + 3; ++x)
+        {
+            for (int y = 0; y < 4; ++y)
+            {
+                flat.set({x, y, 0}, static_cast<uint16_t>(1 + (x & 1)));
+            }
+        }
+        flat.set({2 * S, 0, 0}, 3);
+
+        std::vector<VoxelVertex> vertices;
+        std::vector<uint32_t> indices;
+        triangulate(flat, vertices, indices);
+        CHECK(chunkedFaceArea(ChunkedVoxelGrid{flat}) == faceArea(vertices));
+    }
+}
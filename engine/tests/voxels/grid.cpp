@@ -0,0 +1,43 @@
+#include <doctest/doctest.h>
+
+#include <cubos/engine/voxels/grid.hpp>
+
+using namespace cubos::engine;
+
+TEST_CASE("engine::VoxelGrid")
+{
+    VoxelGrid grid{{2, 2, 2}};
+    grid.set({1, 0, 0}, 3);
+
+    SUBCASE("copies share their data until modified")
+    {
+        VoxelGrid copy{};
+        copy = grid;
+        CHECK(static_cast<const VoxelGrid&>(copy).data() == static_cast<const VoxelGrid&>(grid).data());
+
+        grid.set({1, 0, 0}, 5);
+        CHECK(grid.get({1, 0, 0}) == 5);
+        CHECK(copy.get({1, 0, 0}) == 3);
+        CHECK(static_cast<const VoxelGrid&>(copy).data() != static_cast<const VoxelGrid&>(grid).data());
+    }
+
+    SUBCASE("mutable data of a copy doesn't affect the original")
+    {
+        VoxelGrid copy{};
+        copy = grid;
+        copy.data()[0] = 7;
+        CHECK(copy.get({0, 0, 0}) == 7);
+        CHECK(grid.get({0, 0, 0}) == 0);
+    }
+
+    SUBCASE("resizing a copy doesn't affect the original")
+    {
+        VoxelGrid copy{};
+        copy = grid;
+        copy.setSize({3, 3, 3});
+        copy.clear();
+        CHECK(copy.get({2, 2, 2}) == 0);
+        CHECK(grid.size() == glm::uvec3(2, 2, 2));
+        CHECK(grid.get({1, 0, 0}) == 3);
+    }
+}
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cubos/core/data/old/binary_deserializer.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/standard_stream.hpp>
+
+#include <cubos/engine/renderer/vertex.hpp>
+#include <cubos/engine/voxels/grid.hpp>
+
+namespace data = cubos::core::data;
+namespace memory = cubos::core::memory;
+using namespace cubos::engine;
+
+using Clock = std::chrono::steady_clock;
+
+/// The input options of the program.
+struct BenchmarkOptions
+{
+    std::vector<std::string> paths; ///< Paths of the grid files meshed.
+    std::size_t repetitions = 5;    ///< Number of times each grid is meshed by each mesher.
+    bool synthetic = true;          ///< Also meshes generated terrains and spheres.
+    bool help = false;              ///< Prints the help message.
+};
+
+/// Prints the help message of the program.
+static void printHelp()
+{
+    std::cerr << "Usage: mesher-benchmark [OPTIONS] [GRID...]" << std::endl;
+    std::cerr << "Triangulates grids with the scalar greedy mesher which triangulate() used to be, and with "
+                 "triangulate() itself, checks that both produce the same meshes, and reports how long each one "
+                 "took, single-threaded."
+              << std::endl;
+    std::cerr << "Grids are read from .grd files, such as engine/samples/exercises/assets/castle.grd and "
+                 "engine/samples/voxels/assets/car.grd."
+              << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -r <COUNT>  Number of times each grid is meshed, of which the fastest is reported (default 5)."
+              << std::endl;
+    std::cerr << "  -n          Doesn't mesh the generated terrains and spheres." << std::endl;
+    std::cerr << "  -h          Prints this help message." << std::endl;
+}
+
+/// Parses the command line arguments.
+/// @param argc The number of arguments.
+/// @param argv The arguments.
+/// @param options The options to fill.
+/// @return True if the arguments were parsed successfully, false otherwise.
+static bool parseArguments(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-r")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing argument for " << arg << "." << std::endl;
+                return false;
+            }
+
+            char* end = nullptr;
+            auto parsed = std::strtoul(argv[i + 1], &end, 10);
+            if (end == argv[i + 1] || *end != '\0' || parsed == 0)
+            {
+                std::cerr << "Invalid argument for " << arg << ", expected a positive integer." << std::endl;
+                return false;
+            }
+            options.repetitions = static_cast<std::size_t>(parsed);
+            i++;
+        }
+        else if (arg == "-n")
+        {
+            options.synthetic = false;
+        }
+        else if (arg == "-h")
+        {
+            options.help = true;
+            return true;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::cerr << "Unknown argument " << arg << "." << std::endl;
+            return false;
+        }
+        else
+        {
+            options.paths.push_back(arg);
+        }
+    }
+
+    return true;
+}
+
+/// Triangulates a box-shaped region of voxels with the scalar greedy mesher which triangulate()
+/// replaced, and whose output it must match exactly.
+///
+/// Builds the face mask of each slice one voxel at a time, through the given function, and then
+/// merges the faces row by row, first along u and then along v.
+///
+/// @tparam G Type of the function used to get the material of a voxel, which must return 0 for
+/// voxels outside of the grid.
+/// @param get Function used to get the material of a voxel.
+/// @param origin Position of the region's first voxel, which is added to the vertex positions.
+/// @param sz Size of the region.
+/// @param vertices Vertices of the mesh.
+/// @param indices Indices of the mesh.
+template <typename G>
+static void triangulateRegion(const G& get, glm::ivec3 origin, glm::uvec3 sz, std::vector<VoxelVertex>& vertices,
+                              std::vector<uint32_t>& indices)
+{
+    std::vector<uint16_t> mask;
+
+    // For both back and front faces.
+    bool backFace = true;
+    do
+    {
+        backFace = !backFace;
+
+        // For each axis.
+        for (int d = 0; d < 3; ++d)
+        {
+            int u = (d + 1) % 3;
+            int v = (d + 2) % 3;
+
+            glm::ivec3 x = {0, 0, 0};
+            glm::ivec3 q = {0, 0, 0};
+            q[d] = 1;
+            mask.resize(static_cast<std::size_t>(sz[u]) * static_cast<std::size_t>(sz[v]));
+
+            for (x[d] = -1; x[d] < int(sz[d]);)
+            {
+                std::size_t n = 0;
+
+                // Create mask
+                for (x[v] = 0; x[v] < int(sz[v]); ++x[v])
+                {
+                    for (x[u] = 0; x[u] < int(sz[u]); ++x[u])
+                    {
+                        auto front = get(origin + x);
+                        auto back = get(origin + x + q);
+                        if (x[d] < 0)
+                        {
+                            mask[n++] = backFace && front == 0 ? back : 0;
+                        }
+                        else if (x[d] == int(sz[d]) - 1)
+                        {
+                            mask[n++] = !backFace && back == 0 ? front : 0;
+                        }
+                        else if (front == 0 || back == 0)
+                        {
+                            mask[n++] = backFace ? back : front;
+                        }
+                        else
+                        {
+                            mask[n++] = 0;
+                        }
+                    }
+                }
+
+                ++x[d];
+                n = 0;
+
+                // Generate mesh from mask
+                for (std::size_t j = 0; j < sz[v]; ++j)
+                {
+                    for (std::size_t i = 0; i < sz[u];)
+                    {
+                        if (mask[n] != 0)
+                        {
+                            std::size_t w;
+                            std::size_t h;
+                            for (w = 1; i + w < sz[u] && mask[n + w] == mask[n]; ++w)
+                            {
+                                ;
+                            }
+                            bool done = false;
+                            for (h = 1; j + h < sz[v]; ++h)
+                            {
+                                for (std::size_t k = 0; k < w; ++k)
+                                {
+                                    if (mask[n + k + h * sz[u]] == 0 || mask[n + k + h * sz[u]] != mask[n])
+                                    {
+                                        done = true;
+                                        break;
+                                    }
+                                }
+
+                                if (done)
+                                {
+                                    break;
+                                }
+                            }
+
+                            if (mask[n] != 0)
+                            {
+                                x[u] = static_cast<int>(i);
+                                x[v] = static_cast<int>(j);
+
+                                glm::ivec3 du = {0, 0, 0};
+                                glm::ivec3 dv = {0, 0, 0};
+                                du[u] = static_cast<int>(w);
+                                dv[v] = static_cast<int>(h);
+
+                                auto vi = vertices.size();
+                                vertices.resize(vi + 4, {{}, backFace ? -q : q, mask[n]});
+                                vertices[vi + 0].position = origin + x;
+                                vertices[vi + 1].position = origin + x + du;
+                                vertices[vi + 2].position = origin + x + du + dv;
+                                vertices[vi + 3].position = origin + x + dv;
+
+                                auto ii = indices.size();
+                                indices.resize(ii + 6);
+                                if (backFace)
+                                {
+                                    indices[ii + 0] = static_cast<uint32_t>(vi) + 0;
+                                    indices[ii + 1] = static_cast<uint32_t>(vi) + 2;
+                                    indices[ii + 2] = static_cast<uint32_t>(vi) + 1;
+                                    indices[ii + 3] = static_cast<uint32_t>(vi) + 3;
+                                    indices[ii + 4] = static_cast<uint32_t>(vi) + 2;
+                                    indices[ii + 5] = static_cast<uint32_t>(vi) + 0;
+                                }
+                                else
+                                {
+                                    indices[ii + 0] = static_cast<uint32_t>(vi) + 0;
+                                    indices[ii + 1] = static_cast<uint32_t>(vi) + 1;
+                                    indices[ii + 2] = static_cast<uint32_t>(vi) + 2;
+                                    indices[ii + 3] = static_cast<uint32_t>(vi) + 2;
+                                    indices[ii + 4] = static_cast<uint32_t>(vi) + 3;
+                                    indices[ii + 5] = static_cast<uint32_t>(vi) + 0;
+                                }
+                            }
+
+                            for (std::size_t l = 0; l < h; ++l)
+                            {
+                                for (std::size_t k = 0; k < w; ++k)
+                                {
+                                    mask[n + k + l * sz[u]] = 0;
+                                }
+                            }
+
+                            i += w;
+                            n += w;
+                        }
+                        else
+                        {
+                            ++i;
+                            ++n;
+                        }
+                    }
+                }
+            }
+        }
+    } while (!backFace);
+}
+
+/// Triangulates a grid with the scalar greedy mesher, through bounds-checked lookups.
+/// @param grid The grid to triangulate.
+/// @param vertices The vertices of the mesh.
+/// @param indices The indices of the mesh.
+static void triangulateScalar(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices,
+                              std::vector<uint32_t>& indices)
+{
+    const auto& size = grid.size();
+    auto get = [&](const glm::ivec3& position) -> uint16_t {
+        if (position.x < 0 || position.y < 0 || position.z < 0 || position.x >= static_cast<int>(size.x) ||
+            position.y >= static_cast<int>(size.y) || position.z >= static_cast<int>(size.z))
+        {
+            return 0;
+        }
+        return grid.get(position);
+    };
+
+    triangulateRegion(get, {0, 0, 0}, size, vertices, indices);
+}
+
+/// Triangulates a grid with the bitmask mesher, which is what triangulate() does.
+/// @param grid The grid to triangulate.
+/// @param vertices The vertices of the mesh.
+/// @param indices The indices of the mesh.
+static void triangulateBitmask(const VoxelGrid& grid, std::vector<VoxelVertex>& vertices,
+                               std::vector<uint32_t>& indices)
+{
+    triangulate(grid, vertices, indices);
+}
+
+/// Tries to load a grid from the given path.
+/// @param path The path of the grid.
+/// @param grid The grid to fill.
+/// @return True if the grid was loaded successfully, false otherwise.
+static bool loadGrid(const std::string& path, VoxelGrid& grid)
+{
+    auto* file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        std::cerr << "Could not open " << path << "." << std::endl;
+        return false;
+    }
+
+    auto stream = memory::StandardStream(file, true);
+    auto deserializer = data::old::BinaryDeserializer(stream);
+    deserializer.read(grid);
+    if (deserializer.failed())
+    {
+        std::cerr << "Failed to deserialize grid " << path << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// Generates a grid with rolling hills, made of three materials.
+/// @param size The size of the grid on each axis.
+/// @return The grid.
+static VoxelGrid generateTerrain(unsigned int size)
+{
+    auto side = static_cast<int>(size);
+    VoxelGrid grid{glm::uvec3(size)};
+    for (int x = 0; x < side; ++x)
+    {
+        for (int z = 0; z < side; ++z)
+        {
+            auto height = static_cast<float>(side) * (0.5F + 0.25F * std::sin(static_cast<float>(x) * 0.3F) *
+                                                                 std::cos(static_cast<float>(z) * 0.2F));
+            for (int y = 0; y < std::min(side, static_cast<int>(height)); ++y)
+            {
+                grid.set({x, y, z}, static_cast<uint16_t>(1 + (x + y + z) % 3));
+            }
+        }
+    }
+    return grid;
+}
+
+/// Generates a grid with a single sphere, made of a single material.
+/// @param size The size of the grid on each axis.
+/// @return The grid.
+static VoxelGrid generateSphere(unsigned int size)
+{
+    auto side = static_cast<int>(size);
+    auto center = static_cast<float>(side) * 0.5F;
+    auto radius = static_cast<float>(side) * 0.45F;
+    VoxelGrid grid{glm::uvec3(size)};
+    for (int z = 0; z < side; ++z)
+    {
+        for (int y = 0; y < side; ++y)
+        {
+            for (int x = 0; x < side; ++x)
+            {
+                auto offset = glm::vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) -
+                              glm::vec3(center);
+                if (glm::dot(offset, offset) < radius * radius)
+                {
+                    grid.set({x, y, z}, 1);
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+/// Measures the fastest of several runs of a mesher on a grid.
+/// @param mesher The mesher.
+/// @param grid The grid to triangulate.
+/// @param repetitions The number of runs.
+/// @param vertices The vertices of the mesh.
+/// @param indices The indices of the mesh.
+/// @return The time of the fastest run, in microseconds.
+template <typename M>
+static double measure(const M& mesher, const VoxelGrid& grid, std::size_t repetitions,
+                      std::vector<VoxelVertex>& vertices, std::vector<uint32_t>& indices)
+{
+    double best = 0.0;
+    for (std::size_t i = 0; i < repetitions; ++i)
+    {
+        vertices.clear();
+        indices.clear();
+        auto start = Clock::now();
+        mesher(grid, vertices, indices);
+        auto time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        best = i == 0 ? time : std::min(best, time);
+    }
+    return best;
+}
+
+/// Checks whether two meshes are exactly the same.
+static bool sameMesh(const std::vector<VoxelVertex>& aVertices, const std::vector<uint32_t>& aIndices,
+                     const std::vector<VoxelVertex>& bVertices, const std::vector<uint32_t>& bIndices)
+{
+    return aIndices == bIndices &&
+           std::equal(aVertices.begin(), aVertices.end(), bVertices.begin(), bVertices.end(),
+                      [](const VoxelVertex& a, const VoxelVertex& b) {
+                          return a.position == b.position && a.normal == b.normal && a.material == b.material;
+                      });
+}
+
+/// Meshes a grid with both meshers and prints the results.
+/// @param name The name of the grid.
+/// @param grid The grid.
+/// @param repetitions The number of runs of each mesher.
+/// @return True if both meshers produced the same mesh, false otherwise.
+static bool benchmark(const std::string& name, const VoxelGrid& grid, std::size_t repetitions)
+{
+    std::vector<VoxelVertex> scalarVertices;
+    std::vector<uint32_t> scalarIndices;
+    auto scalarTime = measure(triangulateScalar, grid, repetitions, scalarVertices, scalarIndices);
+
+    std::vector<VoxelVertex> vertices;
+    std::vector<uint32_t> indices;
+    auto time = measure(triangulateBitmask, grid, repetitions, vertices, indices);
+
+    const auto& size = grid.size();
+    std::cout << name << " (" << size.x << "x" << size.y << "x" << size.z << ", " << vertices.size() / 4
+              << " quads): scalar " << scalarTime << " us, triangulate " << time << " us, " << scalarTime / time
+              << "x faster" << std::endl;
+
+    if (!sameMesh(vertices, indices, scalarVertices, scalarIndices))
+    {
+        std::cerr << "The meshes of " << name << " differ." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options{};
+    if (!parseArguments(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.help)
+    {
+        printHelp();
+        return 0;
+    }
+
+    cubos::core::disableLogging();
+
+    bool success = true;
+    for (const auto& path : options.paths)
+    {
+        VoxelGrid grid{};
+        if (!loadGrid(path, grid))
+        {
+            return 1;
+        }
+        success &= benchmark(path, grid, options.repetitions);
+    }
+
+    if (options.synthetic)
+    {
+        for (unsigned int size : {64U, 128U, 256U})
+        {
+            success &= benchmark("terrain", generateTerrain(size), options.repetitions);
+            success &= benchmark("sphere", generateSphere(size), options.repetitions);
+        }
+    }
+
+    return success ? 0 : 1;
+}
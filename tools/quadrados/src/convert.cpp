@@ -1,14 +1,20 @@
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <unordered_map>
 
+#include <cubos/core/data/fs/file_system.hpp>
+#include <cubos/core/data/fs/standard_archive.hpp>
 #include <cubos/core/data/old/binary_deserializer.hpp>
 #include <cubos/core/data/old/binary_serializer.hpp>
 #include <cubos/core/log.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
 #include <cubos/core/memory/endianness.hpp>
 #include <cubos/core/memory/standard_stream.hpp>
 
+#include <cubos/engine/assets/derived_cache.hpp>
 #include <cubos/engine/voxels/grid.hpp>
 #include <cubos/engine/voxels/palette.hpp>
 
@@ -25,10 +31,12 @@ struct ConvertOptions
 {
     fs::path input = "";                             ///< The input file path.
     fs::path palette = "";                           ///< The palette path.
+    fs::path cache = "";                             ///< The cache directory path, if any.
     std::unordered_map<std::size_t, fs::path> grids; ///< The output paths of the grids.
     bool write = false;                              ///< Whether to write to the palette.
     bool verbose = false;                            ///< Enables verbose mode.
     bool force = false;                              ///< Enables force mode.
+    bool compress = false;                           ///< Whether to compress the grids.
     bool help = false;                               ///< Prints the help message.
     float similarity = 1.0F;                         ///< The similarity threshold.
 };
@@ -49,6 +57,8 @@ static void printHelp()
     std::cerr << "  -g<N> <PATH> Sets the output path of the grid <N>." << std::endl;
     std::cerr << "  -p <PATH>    Specifies the path of the palette being used." << std::endl;
     std::cerr << "  -w           Allows the palette to be written to." << std::endl;
+    std::cerr << "  -c           Compresses the output grids, which are decompressed when read." << std::endl;
+    std::cerr << "  -C <PATH>    Caches converted grids in the given directory." << std::endl;
     std::cerr << "  -v           Enables verbose mode." << std::endl;
     std::cerr << "  -f           Disables asking for confirmation when overwriting files." << std::endl;
     std::cerr << "  -h           Prints this help message." << std::endl;
@@ -105,6 +115,19 @@ static bool parseArguments(int argc, char** argv, ConvertOptions& options)
                 return false;
             }
         }
+        else if (std::string(argv[i]) == "-C")
+        {
+            if (i + 1 < argc)
+            {
+                options.cache = argv[i + 1];
+                i++;
+            }
+            else
+            {
+                std::cerr << "Missing argument for -C." << std::endl;
+                return false;
+            }
+        }
         else if (std::string(argv[i]) == "-s")
         {
             if (i + 1 < argc)
@@ -128,6 +151,10 @@ static bool parseArguments(int argc, char** argv, ConvertOptions& options)
         {
             options.write = true;
         }
+        else if (std::string(argv[i]) == "-c")
+        {
+            options.compress = true;
+        }
         else if (std::string(argv[i]) == "-v")
         {
             options.verbose = true;
@@ -381,7 +408,8 @@ static bool savePalette(const fs::path& path, const VoxelPalette& palette)
 /// Saves the given grid to the given path.
 /// @param path The path of the grid.
 /// @param grid The grid to export.
-static bool saveGrid(const fs::path& path, const VoxelGrid& grid)
+/// @param compress Whether to compress the grid.
+static bool saveGrid(const fs::path& path, const VoxelGrid& grid, bool compress)
 {
     auto* file = fopen(path.string().c_str(), "wb");
     if (file == nullptr)
@@ -390,7 +418,22 @@ static bool saveGrid(const fs::path& path, const VoxelGrid& grid)
     }
 
     auto stream = memory::StandardStream(file, true);
-    auto serializer = data::old::BinarySerializer(stream);
+    if (!compress)
+    {
+        auto serializer = data::old::BinarySerializer(stream);
+        serializer.write(grid, nullptr);
+        if (serializer.failed())
+        {
+            std::cerr << "Failed to serialize grid." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    // Serialize the grid to memory first, and then compress it into the file.
+    auto buffer = memory::BufferStream();
+    auto serializer = data::old::BinarySerializer(buffer);
     serializer.write(grid, nullptr);
     if (serializer.failed())
     {
@@ -398,6 +441,54 @@ static bool saveGrid(const fs::path& path, const VoxelGrid& grid)
         return false;
     }
 
+    auto serialized = memory::BufferStream(buffer.getBuffer(), buffer.tell());
+    if (!memory::CompressedStream::compress(serialized, stream))
+    {
+        std::cerr << "Failed to compress grid." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/// Version of the grid conversion, stored with cached grids. Must be increased whenever the
+/// conversion changes.
+static constexpr uint32_t ConvertVersion = 1;
+
+/// Converts a grid from one palette to another, reusing the result from the cache if possible.
+/// @param grid The grid to convert.
+/// @param src The palette of the grid.
+/// @param dst The palette to convert to.
+/// @param similarity The similarity threshold.
+/// @param cache The cache to use.
+/// @return True if the conversion was successful, false otherwise.
+static bool convertGrid(VoxelGrid& grid, const VoxelPalette& src, const VoxelPalette& dst, float similarity,
+                        const DerivedCache& cache)
+{
+    // Converted grids are keyed by the original grid, both palettes and the similarity threshold.
+    auto size = grid.size();
+    auto count = static_cast<std::size_t>(size.x) * size.y * size.z;
+    auto key = DerivedCache::hash(&size, sizeof(size));
+    key = DerivedCache::hash(grid.data(), count * sizeof(uint16_t), key);
+    key = DerivedCache::hash(src.data(), src.size() * sizeof(VoxelMaterial), key);
+    key = DerivedCache::hash(dst.data(), dst.size() * sizeof(VoxelMaterial), key);
+    key = DerivedCache::hash(&similarity, sizeof(similarity), key);
+
+    std::vector<char> data;
+    if (cache.read("grid", key, ConvertVersion, data) && data.size() == count * sizeof(uint16_t))
+    {
+        std::vector<uint16_t> indices(count);
+        std::memcpy(indices.data(), data.data(), data.size());
+        grid = VoxelGrid(size, indices);
+        return true;
+    }
+
+    if (!grid.convert(src, dst, similarity))
+    {
+        return false;
+    }
+
+    cache.write("grid", key, ConvertVersion, grid.data(), count * sizeof(uint16_t));
     return true;
 }
 
@@ -425,6 +516,19 @@ static bool convert(const ConvertOptions& options)
         }
     }
 
+    // Mount the cache directory, if one was given.
+    DerivedCache cache;
+    if (!options.cache.empty())
+    {
+        if (!data::FileSystem::mount("/cache", std::make_unique<data::StandardArchive>(options.cache, true, false)))
+        {
+            std::cerr << "Failed to mount cache directory " << options.cache << "." << std::endl;
+            return false;
+        }
+
+        cache = DerivedCache("/cache");
+    }
+
     // Then, parse the Qubicle file.
     if (options.input.extension() != ".qb")
     {
@@ -492,7 +596,7 @@ static bool convert(const ConvertOptions& options)
             }
 
             // Convert the grid to the main palette.
-            if (!model[i].grid.convert(model[i].palette, palette, options.similarity))
+            if (!convertGrid(model[i].grid, model[i].palette, palette, options.similarity, cache))
             {
                 std::cerr << "Failed to convert grid " << i << " from its palette to the palette chosen." << std::endl;
 
@@ -511,7 +615,7 @@ static bool convert(const ConvertOptions& options)
             }
 
             // Save the grid to the given path.
-            if (!saveGrid(path, model[i].grid))
+            if (!saveGrid(path, model[i].grid, options.compress))
             {
                 std::cerr << "Failed to save grid " << i << " to " << path << "." << std::endl;
                 return false;
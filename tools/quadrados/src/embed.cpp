@@ -1,11 +1,17 @@
 #include <array>
+#include <cstdio>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <vector>
 
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/memory/compressed_stream.hpp>
+#include <cubos/core/memory/standard_stream.hpp>
+
 #include "tools.hpp"
 
+namespace memory = cubos::core::memory;
+
 namespace fs = std::filesystem;
 
 /// The input options of the program.
@@ -14,6 +20,7 @@ struct EmbedOptions
     std::string name;       ///< The name of the output data.
     fs::path input = "";    ///< The input file path.
     bool recursive = false; ///< Whether to recursively embed all files.
+    bool compress = false;  ///< Whether to compress the embedded files.
     bool verbose = false;   ///< Enables verbose mode.
     bool help = false;      ///< Prints the help message.
 };
@@ -25,6 +32,7 @@ static void printHelp()
     std::cerr << "Options:" << std::endl;
     std::cerr << "  -n <name>    Sets the name of the output data." << std::endl;
     std::cerr << "  -r           Recursively embed all files in the input directory." << std::endl;
+    std::cerr << "  -c           Compresses the embedded files, which are decompressed when read." << std::endl;
     std::cerr << "  -v           Enables verbose mode." << std::endl;
     std::cerr << "  -h           Prints this help message." << std::endl;
 }
@@ -58,6 +66,10 @@ static bool parseArguments(int argc, char** argv, EmbedOptions& options)
         {
             options.recursive = true;
         }
+        else if (std::string(argv[i]) == "-c")
+        {
+            options.compress = true;
+        }
         else if (std::string(argv[i]) == "-v")
         {
             options.verbose = true;
@@ -229,29 +241,47 @@ static bool embedFileData(State& state, std::size_t id)
         }
 
         // Open the file.
-        std::ifstream file(state.entries[id - 1].path, std::ios::binary);
-        if (!file.is_open())
+        auto* file = fopen(state.entries[id - 1].path.string().c_str(), "rb");
+        if (file == nullptr)
         {
             std::cerr << "Failed to open file '" << state.entries[id - 1].path.string() << "'." << std::endl;
             return false;
         }
 
-        state.out << "static const uint8_t fileData" << id << "[] = { ";
-
-        // Write the file data.
-        while (file.good())
+        // Read the file data, compressing it if requested.
+        auto stream = memory::StandardStream(file, true);
+        memory::BufferStream data{};
+        if (state.options.compress)
+        {
+            if (!memory::CompressedStream::compress(stream, data))
+            {
+                std::cerr << "Failed to compress file '" << state.entries[id - 1].path.string() << "'." << std::endl;
+                return false;
+            }
+        }
+        else
         {
             char buffer[1024];
-            file.read(buffer, sizeof(buffer));
-            for (std::size_t i = 0; i < static_cast<std::size_t>(file.gcount()); ++i)
+            while (auto read = stream.read(buffer, sizeof(buffer)))
             {
-                state.out << "0x" << std::hex << static_cast<uint32_t>(buffer[i]) << ", ";
+                data.write(buffer, read);
             }
         }
 
-        state.out << "};" << std::endl;
+        if (state.options.verbose && state.options.compress)
+        {
+            std::cerr << "Compressed file data of '" << state.entries[id - 1].path.string() << "' to "
+                      << data.tell() << " bytes" << std::endl;
+        }
 
-        file.close();
+        // Write the file data.
+        state.out << "static const uint8_t fileData" << id << "[] = { ";
+        const auto* bytes = static_cast<const uint8_t*>(data.getBuffer());
+        for (std::size_t i = 0; i < data.tell(); ++i)
+        {
+            state.out << "0x" << std::hex << static_cast<uint32_t>(bytes[i]) << std::dec << ", ";
+        }
+        state.out << "};" << std::endl;
     }
 
     return true;
@@ -0,0 +1,149 @@
+#include <filesystem>
+#include <iostream>
+
+#include <cubos/core/data/fs/file_system.hpp>
+#include <cubos/core/data/fs/standard_archive.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/standard_stream.hpp>
+
+#include <cubos/engine/assets/meta_index.hpp>
+
+#include "tools.hpp"
+
+namespace memory = cubos::core::memory;
+using cubos::core::data::FileSystem;
+using cubos::core::data::StandardArchive;
+using namespace cubos::engine;
+
+namespace fs = std::filesystem;
+
+/// The input options of the program.
+struct IndexOptions
+{
+    fs::path input = "";  ///< The assets directory to index.
+    fs::path output = ""; ///< The output index path.
+    bool verbose = false; ///< Enables verbose mode.
+    bool help = false;    ///< Prints the help message.
+};
+
+/// Prints the help message of the program.
+static void printHelp()
+{
+    std::cerr << "Usage: quadrados index <ASSETS> [OPTIONS]" << std::endl;
+    std::cerr << "Builds an index of the metadata files in an assets directory." << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -o <PATH> Specifies the path of the index (default '<ASSETS>/assets.index')." << std::endl;
+    std::cerr << "  -v        Enables verbose mode." << std::endl;
+    std::cerr << "  -h        Prints this help message." << std::endl;
+}
+
+/// Parses the command line arguments.
+/// @param argc The number of arguments.
+/// @param argv The arguments.
+/// @param options The options to fill.
+/// @return True if the arguments were parsed successfully, false otherwise.
+static bool parseArguments(int argc, char** argv, IndexOptions& options)
+{
+    bool foundInput = false;
+
+    // Iterate over the arguments.
+    for (int i = 0; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "-o")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing argument for -o." << std::endl;
+                return false;
+            }
+
+            options.output = argv[i + 1];
+            i++;
+        }
+        else if (std::string(argv[i]) == "-v")
+        {
+            options.verbose = true;
+        }
+        else if (std::string(argv[i]) == "-h")
+        {
+            options.help = true;
+            return true;
+        }
+        else
+        {
+            if (foundInput)
+            {
+                std::cerr << "Too many arguments." << std::endl;
+                return false;
+            }
+
+            foundInput = true;
+            options.input = argv[i];
+        }
+    }
+
+    if (options.input.empty())
+    {
+        std::cerr << "Missing assets directory." << std::endl;
+        return false;
+    }
+    if (options.output.empty())
+    {
+        options.output = options.input / "assets.index";
+    }
+    return true;
+}
+
+int runIndex(int argc, char** argv)
+{
+    IndexOptions options{};
+    if (!parseArguments(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.help)
+    {
+        printHelp();
+        return 0;
+    }
+
+    if (!options.verbose)
+    {
+        cubos::core::disableLogging();
+    }
+
+    if (!FileSystem::mount("/assets", std::make_unique<StandardArchive>(options.input, true, true)))
+    {
+        std::cerr << "Could not mount assets directory " << options.input << "." << std::endl;
+        return 1;
+    }
+
+    AssetMetaIndex index{};
+    if (!index.build("/assets"))
+    {
+        std::cerr << "Could not read some of the metadata files, run with -v for details." << std::endl;
+        return 1;
+    }
+
+    auto* file = fopen(options.output.string().c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cerr << "Could not open output file " << options.output << "." << std::endl;
+        return 1;
+    }
+
+    auto stream = memory::StandardStream(file, true);
+    if (!index.write(stream))
+    {
+        std::cerr << "Could not write index." << std::endl;
+        return 1;
+    }
+
+    if (options.verbose)
+    {
+        std::cerr << "Indexed " << index.size() << " metadata files." << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <filesystem>
+#include <iostream>
+
+#include <cubos/core/data/fs/file_system.hpp>
+#include <cubos/core/data/fs/standard_archive.hpp>
+#include <cubos/core/log.hpp>
+#include <cubos/core/memory/standard_stream.hpp>
+
+#include <cubos/engine/assets/assets.hpp>
+#include <cubos/engine/scene/bridge.hpp>
+#include <cubos/engine/scene/scene.hpp>
+
+#include "tools.hpp"
+
+namespace memory = cubos::core::memory;
+using cubos::core::data::FileSystem;
+using cubos::core::data::StandardArchive;
+using namespace cubos::engine;
+
+namespace fs = std::filesystem;
+
+/// The input options of the program.
+struct SceneOptions
+{
+    fs::path input = "";        ///< The input scene path.
+    fs::path output = "";       ///< The output compiled scene path.
+    fs::path assets = "assets"; ///< The assets directory which contains the scene.
+    bool verbose = false;       ///< Enables verbose mode.
+    bool help = false;          ///< Prints the help message.
+};
+
+/// Prints the help message of the program.
+static void printHelp()
+{
+    std::cerr << "Usage: quadrados scene <INPUT> -o <OUTPUT> [OPTIONS]" << std::endl;
+    std::cerr << "Compiles a JSON scene into the binary scene format." << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -o <PATH> Specifies the path of the compiled scene." << std::endl;
+    std::cerr << "  -a <PATH> Specifies the assets directory which contains the scene and its imports" << std::endl;
+    std::cerr << "            (default 'assets')." << std::endl;
+    std::cerr << "  -v        Enables verbose mode." << std::endl;
+    std::cerr << "  -h        Prints this help message." << std::endl;
+}
+
+/// Parses the command line arguments.
+/// @param argc The number of arguments.
+/// @param argv The arguments.
+/// @param options The options to fill.
+/// @return True if the arguments were parsed successfully, false otherwise.
+static bool parseArguments(int argc, char** argv, SceneOptions& options)
+{
+    bool foundInput = false;
+
+    // Iterate over the arguments.
+    for (int i = 0; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "-o" || std::string(argv[i]) == "-a")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing argument for " << argv[i] << "." << std::endl;
+                return false;
+            }
+
+            (argv[i][1] == 'o' ? options.output : options.assets) = argv[i + 1];
+            i++;
+        }
+        else if (std::string(argv[i]) == "-v")
+        {
+            options.verbose = true;
+        }
+        else if (std::string(argv[i]) == "-h")
+        {
+            options.help = true;
+            return true;
+        }
+        else
+        {
+            if (foundInput)
+            {
+                std::cerr << "Too many arguments." << std::endl;
+                return false;
+            }
+
+            foundInput = true;
+            options.input = argv[i];
+        }
+    }
+
+    if (options.input.empty())
+    {
+        std::cerr << "Missing input file." << std::endl;
+        return false;
+    }
+    if (options.output.empty())
+    {
+        std::cerr << "Missing output file." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int runScene(int argc, char** argv)
+{
+    SceneOptions options{};
+    if (!parseArguments(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.help)
+    {
+        printHelp();
+        return 0;
+    }
+
+    if (!options.verbose)
+    {
+        cubos::core::disableLogging();
+    }
+
+    // The scene must be inside the assets directory, so that its imports can be found.
+    auto relative = fs::relative(options.input, options.assets);
+    if (relative.empty() || *relative.begin() == "..")
+    {
+        std::cerr << "Scene " << options.input << " is not inside the assets directory " << options.assets << "."
+                  << std::endl;
+        return 1;
+    }
+
+    if (!FileSystem::mount("/assets", std::make_unique<StandardArchive>(options.assets, true, true)))
+    {
+        std::cerr << "Could not mount assets directory " << options.assets << "." << std::endl;
+        return 1;
+    }
+
+    Assets assets{};
+    assets.registerBridge(".cubos", std::make_shared<SceneBridge>());
+    assets.loadMeta("/assets");
+
+    // Find the handle of the scene from its path.
+    auto path = "/assets/" + relative.generic_string();
+    AnyAsset handle{};
+    for (const auto& asset : assets.listAll())
+    {
+        if (assets.readMeta(asset)->get("path") == path)
+        {
+            handle = asset;
+            break;
+        }
+    }
+
+    if (handle.isNull())
+    {
+        std::cerr << "Could not find scene " << path << ", is its .meta file missing?" << std::endl;
+        return 1;
+    }
+
+    Asset<Scene> sceneHandle = handle;
+    auto scene = assets.read(sceneHandle);
+
+    auto* file = fopen(options.output.string().c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cerr << "Could not open output file " << options.output << "." << std::endl;
+        return 1;
+    }
+
+    auto stream = memory::StandardStream(file, true);
+    if (!SceneBridge::saveCompiled(scene.get(), stream))
+    {
+        std::cerr << "Could not write compiled scene, are all of its components registered?" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
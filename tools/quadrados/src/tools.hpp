@@ -12,9 +12,13 @@ struct Tool
 int runHelp(int argc, char** argv);
 int runEmbed(int argc, char** argv);
 int runConvert(int argc, char** argv);
+int runScene(int argc, char** argv);
+int runIndex(int argc, char** argv);
 
 static const Tool Tools[] = {
     {"help", runHelp},
     {"embed", runEmbed},
     {"convert", runConvert},
+    {"scene", runScene},
+    {"index", runIndex},
 };
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cubos/core/gl/recording_render_device.hpp>
+#include <cubos/core/log.hpp>
+
+#include <cubos/engine/renderer/deferred_renderer.hpp>
+#include <cubos/engine/renderer/frame.hpp>
+#include <cubos/engine/renderer/point_light.hpp>
+#include <cubos/engine/renderer/pps/bloom.hpp>
+#include <cubos/engine/settings/settings.hpp>
+
+using cubos::core::gl::RecordingRenderDevice;
+using namespace cubos::engine;
+
+using Clock = std::chrono::steady_clock;
+
+/// The input options of the program.
+struct BenchmarkOptions
+{
+    std::size_t grids = 64;      ///< Number of grids drawn.
+    std::size_t distinct = 0;    ///< Number of distinct grids uploaded, or 0 if every grid is distinct.
+    std::size_t gridSize = 32;   ///< Size of each grid on each axis.
+    std::size_t lights = 16;     ///< Number of point lights.
+    std::size_t frames = 100;    ///< Number of frames rendered.
+    glm::uvec2 size{1920, 1080}; ///< Size of the frames.
+    bool async = false;          ///< Triangulates the grids on the renderer's meshing threads.
+    bool packed = false;         ///< Uploads the grids with the packed vertex layout.
+    bool bloom = false;          ///< Enables the bloom post processing pass.
+    bool ssao = false;           ///< Enables SSAO.
+    bool verbose = false;        ///< Enables verbose mode.
+    bool help = false;           ///< Prints the help message.
+};
+
+/// Prints the help message of the program.
+static void printHelp()
+{
+    std::cerr << "Usage: renderer-benchmark [OPTIONS]" << std::endl;
+    std::cerr << "Renders a synthetic scene through the deferred renderer on a render device which creates no GPU "
+                 "objects, and reports the CPU frame time and the render device calls made."
+              << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -g <COUNT>  Number of grids drawn (default 64)." << std::endl;
+    std::cerr << "  -u <COUNT>  Number of distinct grids, which are repeated to reach the number of grids drawn "
+                 "(default: every grid is distinct)."
+              << std::endl;
+    std::cerr << "  -s <SIZE>   Size of each grid on each axis (default 32)." << std::endl;
+    std::cerr << "  -l <COUNT>  Number of point lights (default 16)." << std::endl;
+    std::cerr << "  -f <COUNT>  Number of frames rendered (default 100)." << std::endl;
+    std::cerr << "  -j          Triangulates the grids on the renderer's meshing threads." << std::endl;
+    std::cerr << "  -p          Uploads the grids with the packed vertex layout." << std::endl;
+    std::cerr << "  -b          Enables the bloom post processing pass." << std::endl;
+    std::cerr << "  -a          Enables SSAO." << std::endl;
+    std::cerr << "  -v          Enables verbose mode." << std::endl;
+    std::cerr << "  -h          Prints this help message." << std::endl;
+}
+
+/// Parses a positive integer argument.
+/// @param str The argument.
+/// @param value The value to fill.
+/// @return True if the argument is a positive integer, false otherwise.
+static bool parseCount(const char* str, std::size_t& value)
+{
+    char* end = nullptr;
+    auto parsed = std::strtoul(str, &end, 10);
+    if (end == str || *end != '\0' || parsed == 0)
+    {
+        return false;
+    }
+
+    value = static_cast<std::size_t>(parsed);
+    return true;
+}
+
+/// Parses the command line arguments.
+/// @param argc The number of arguments.
+/// @param argv The arguments.
+/// @param options The options to fill.
+/// @return True if the arguments were parsed successfully, false otherwise.
+static bool parseArguments(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-g" || arg == "-u" || arg == "-s" || arg == "-l" || arg == "-f")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing argument for " << arg << "." << std::endl;
+                return false;
+            }
+
+            auto& value = arg == "-g"   ? options.grids
+                          : arg == "-u" ? options.distinct
+                          : arg == "-s" ? options.gridSize
+                          : arg == "-l" ? options.lights
+                                        : options.frames;
+            if (!parseCount(argv[i + 1], value))
+            {
+                std::cerr << "Invalid argument for " << arg << ", expected a positive integer." << std::endl;
+                return false;
+            }
+            i++;
+        }
+        else if (arg == "-j")
+        {
+            options.async = true;
+        }
+        else if (arg == "-p")
+        {
+            options.packed = true;
+        }
+        else if (arg == "-b")
+        {
+            options.bloom = true;
+        }
+        else if (arg == "-a")
+        {
+            options.ssao = true;
+        }
+        else if (arg == "-v")
+        {
+            options.verbose = true;
+        }
+        else if (arg == "-h")
+        {
+            options.help = true;
+            return true;
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << arg << "." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Generates a grid with rolling hills, which differ with the given seed.
+/// @param size The size of the grid on each axis.
+/// @param seed The seed.
+/// @return The grid.
+static VoxelGrid generateGrid(std::size_t size, std::size_t seed)
+{
+    auto side = static_cast<int>(size);
+    VoxelGrid grid{glm::uvec3(static_cast<unsigned int>(size))};
+    for (int x = 0; x < side; ++x)
+    {
+        for (int z = 0; z < side; ++z)
+        {
+            auto phase = static_cast<float>(seed) * 0.7F;
+            auto height = static_cast<float>(side) *
+                          (0.5F + 0.25F * std::sin(static_cast<float>(x) * 0.3F + phase) *
+                                      std::cos(static_cast<float>(z) * 0.2F - phase));
+            for (int y = 0; y < std::min(side, static_cast<int>(height)); ++y)
+            {
+                grid.set({x, y, z}, static_cast<uint16_t>(1 + (x + y + z + static_cast<int>(seed)) % 3));
+            }
+        }
+    }
+    return grid;
+}
+
+/// Converts a duration to milliseconds.
+static double milliseconds(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options{};
+    if (!parseArguments(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.help)
+    {
+        printHelp();
+        return 0;
+    }
+
+    if (!options.verbose)
+    {
+        cubos::core::disableLogging();
+    }
+
+    Settings settings{};
+    settings.setBool("renderer.ssao.enabled", options.ssao);
+    settings.setBool("cubos.renderer.vertices.packed", options.packed);
+
+    RecordingRenderDevice device{};
+    device.logCommands(false);
+
+    DeferredRenderer renderer{device, options.size, settings};
+    if (options.bloom)
+    {
+        renderer.pps().addPass<PostProcessingBloom>();
+    }
+    renderer.setPalette(VoxelPalette{{
+        {{0.4F, 0.7F, 0.3F, 1.0F}},
+        {{0.5F, 0.4F, 0.3F, 1.0F}},
+        {{0.6F, 0.6F, 0.6F, 1.0F}},
+    }});
+
+    // Upload the grids, which measures the time spent meshing them.
+    device.clear();
+    auto distinct = options.distinct == 0 ? options.grids : std::min(options.distinct, options.grids);
+    std::vector<VoxelGrid> voxelGrids;
+    for (std::size_t i = 0; i < distinct; ++i)
+    {
+        voxelGrids.push_back(generateGrid(options.gridSize, i));
+    }
+
+    std::vector<RendererGrid> grids;
+    auto uploadStart = Clock::now();
+    if (options.async)
+    {
+        std::vector<RendererMeshJob> jobs;
+        for (const auto& grid : voxelGrids)
+        {
+            jobs.push_back(renderer.uploadAsync(grid));
+        }
+
+        for (const auto& job : jobs)
+        {
+            while (renderer.poll(job) == nullptr)
+            {
+                std::this_thread::yield();
+            }
+            grids.push_back(renderer.poll(job));
+        }
+    }
+    else
+    {
+        for (const auto& grid : voxelGrids)
+        {
+            grids.push_back(renderer.upload(grid));
+        }
+    }
+    auto uploadTime = Clock::now() - uploadStart;
+    auto uploadStats = device.stats();
+
+    // Lay the grids out on a square, with the lights spread over it.
+    auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(options.grids))));
+    auto spacing = static_cast<float>(options.gridSize) * 1.25F;
+    auto extent = static_cast<float>(side) * spacing;
+
+    RendererFrame frame{};
+    frame.ambient({0.1F, 0.1F, 0.1F});
+    frame.skyGradient({0.1F, 0.2F, 0.4F}, {0.6F, 0.6F, 0.8F});
+    for (std::size_t i = 0; i < options.grids; ++i)
+    {
+        auto position = glm::vec3(static_cast<float>(i % side) * spacing, 0.0F, static_cast<float>(i / side) * spacing);
+        frame.draw(grids[i % grids.size()], glm::translate(glm::mat4(1.0F), position));
+    }
+    for (std::size_t i = 0; i < options.lights; ++i)
+    {
+        auto angle = static_cast<float>(i) * 6.2831853F / static_cast<float>(options.lights);
+        auto position = glm::vec3(extent * (0.5F + 0.4F * std::cos(angle)), static_cast<float>(options.gridSize),
+                                  extent * (0.5F + 0.4F * std::sin(angle)));
+        frame.light(glm::translate(glm::mat4(1.0F), position),
+                    PointLight{.color = {1.0F, 0.9F, 0.8F}, .intensity = 1.0F, .range = spacing * 2.0F});
+    }
+
+    // Render the frames with an orbiting camera.
+    Camera camera{.fovY = 60.0F, .zNear = 0.1F, .zFar = extent * 4.0F};
+    BaseRenderer::Viewport viewport{{0, 0}, glm::ivec2(options.size)};
+    auto center = glm::vec3(extent * 0.5F, 0.0F, extent * 0.5F);
+
+    std::vector<double> frameTimes;
+    for (std::size_t i = 0; i < options.frames; ++i)
+    {
+        auto angle = static_cast<float>(i) * 0.01F;
+        auto eye = center + glm::vec3(std::cos(angle) * extent, extent * 0.5F, std::sin(angle) * extent);
+        auto view = glm::lookAt(eye, center, glm::vec3(0.0F, 1.0F, 0.0F));
+
+        device.clear();
+        auto start = Clock::now();
+        renderer.render(view, viewport, camera, frame, options.bloom);
+        frameTimes.push_back(milliseconds(Clock::now() - start));
+    }
+    const auto& frameStats = device.stats();
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double total = 0.0;
+    for (auto time : frameTimes)
+    {
+        total += time;
+    }
+
+    std::cout << "Uploaded " << distinct << " grids of size " << options.gridSize << " in "
+              << milliseconds(uploadTime) << " ms (" << milliseconds(uploadTime) / static_cast<double>(distinct)
+              << " ms per grid, " << uploadStats.bytesUploaded << " bytes uploaded)" << std::endl;
+    std::cout << "Rendered " << options.frames << " frames: " << total / static_cast<double>(frameTimes.size())
+              << " ms average, " << frameTimes.front() << " ms min, " << frameTimes[frameTimes.size() / 2]
+              << " ms median, " << frameTimes.back() << " ms max" << std::endl;
+    std::cout << "Calls on the last frame:" << std::endl;
+    std::cout << "  draw calls:     " << frameStats.drawCalls << " (" << frameStats.triangles << " triangles)"
+              << std::endl;
+    std::cout << "  state changes:  " << frameStats.stateChanges << " (" << frameStats.redundantStateChanges
+              << " redundant)" << std::endl;
+    std::cout << "  clears:         " << frameStats.clears << std::endl;
+    std::cout << "  dispatches:     " << frameStats.dispatches << std::endl;
+    std::cout << "  buffer maps:    " << frameStats.maps << " (" << frameStats.unmaps << " unmaps)" << std::endl;
+    std::cout << "  bytes uploaded: " << frameStats.bytesUploaded << std::endl;
+    std::cout << "  errors:         " << frameStats.errors << std::endl;
+
+    return frameStats.errors == 0 ? 0 : 1;
+}